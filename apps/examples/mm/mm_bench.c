@@ -0,0 +1,439 @@
+/****************************************************************************
+ * examples/mm/mm_bench.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <nuttx/arch.h>
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_NSLOTS
+#  define CONFIG_EXAMPLES_MM_BENCH_NSLOTS 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_NITER
+#  define CONFIG_EXAMPLES_MM_BENCH_NITER 20000
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_MM_BENCH_MAXSIZE 1024
+#endif
+
+#ifdef CONFIG_MM_TLSF
+#  define MM_BENCH_ALLOCATOR "TLSF"
+#else
+#  define MM_BENCH_ALLOCATOR "default"
+#endif
+
+#define NSEC_PER_SEC 1000000000L
+
+/* The operations that are timed */
+
+#define BENCH_MALLOC  0
+#define BENCH_REALLOC 1
+#define BENCH_FREE    2
+#define BENCH_NOPS    3
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct mm_benchstat_s
+{
+  unsigned long count;     /* Number of timed operations */
+  uint64_t      total;     /* Total time of all batches (nsec) */
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  uint32_t      max;       /* Longest single operation (usec) */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR void *g_slot[CONFIG_EXAMPLES_MM_BENCH_NSLOTS];
+static size_t    g_size[CONFIG_EXAMPLES_MM_BENCH_NSLOTS];
+static int       g_index[CONFIG_EXAMPLES_MM_BENCH_NSLOTS];
+static uint32_t  g_seed;
+static unsigned long g_nfail;
+
+static FAR const char *g_opname[BENCH_NOPS] =
+{
+  "malloc", "realloc", "free"
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* A simple LCG so that every allocator sees the same request sequence */
+
+static uint32_t bench_rand(void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+static void bench_now(FAR struct timespec *ts)
+{
+#ifdef CONFIG_CLOCK_MONOTONIC
+  (void)clock_gettime(CLOCK_MONOTONIC, ts);
+#else
+  (void)clock_gettime(CLOCK_REALTIME, ts);
+#endif
+}
+
+static uint32_t bench_elapsed(FAR const struct timespec *start,
+                              FAR const struct timespec *end)
+{
+  int64_t nsec;
+
+  nsec = (int64_t)(end->tv_sec - start->tv_sec) * NSEC_PER_SEC +
+         (end->tv_nsec - start->tv_nsec);
+
+  return nsec < 0 ? 0 : (uint32_t)nsec;
+}
+
+static void bench_show(int op, FAR const struct mm_benchstat_s *stat)
+{
+  unsigned long avg = 0;
+
+  if (stat->count > 0)
+    {
+      avg = (unsigned long)(stat->total / stat->count);
+    }
+
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  printf("  %-8s %8lu ops  avg %6lu nsec  max %6lu usec\n",
+         g_opname[op], stat->count, avg, (unsigned long)stat->max);
+#else
+  printf("  %-8s %8lu ops  avg %6lu nsec\n",
+         g_opname[op], stat->count, avg);
+#endif
+}
+
+/****************************************************************************
+ * Name: bench_size
+ *
+ * Description:
+ *   Mostly small requests with an occasional large one.  The mix of sizes
+ *   and lifetimes fragments the heap, which is where the search time of
+ *   the allocators differ.
+ *
+ ****************************************************************************/
+
+static size_t bench_size(void)
+{
+  if ((bench_rand() & 7) == 0)
+    {
+      return 1 + bench_rand() % CONFIG_EXAMPLES_MM_BENCH_MAXSIZE;
+    }
+
+  return 1 + bench_rand() % 128;
+}
+
+/****************************************************************************
+ * Name: bench_select
+ *
+ * Description:
+ *   Select the slots for the next batch of one operation and place them in
+ *   g_index[] in random order:  All empty slots are allocated, about a
+ *   quarter of the allocated slots are reallocated and about half of them
+ *   are freed.  The request sizes are chosen here too so that none of
+ *   this is included in the time of the batch.
+ *
+ ****************************************************************************/
+
+static int bench_select(int op)
+{
+  bool select;
+  int tmp;
+  int n;
+  int i;
+  int j;
+
+  for (j = 0, n = 0; j < CONFIG_EXAMPLES_MM_BENCH_NSLOTS; j++)
+    {
+      switch (op)
+        {
+          case BENCH_MALLOC:
+            select = g_slot[j] == NULL;
+            break;
+
+          case BENCH_REALLOC:
+            select = g_slot[j] != NULL && (bench_rand() & 3) == 0;
+            break;
+
+          default:
+            select = g_slot[j] != NULL && (bench_rand() & 1) == 0;
+            break;
+        }
+
+      if (select)
+        {
+          g_size[j]    = bench_size();
+          g_index[n++] = j;
+        }
+    }
+
+  for (i = n - 1; i > 0; i--)
+    {
+      j          = bench_rand() % (i + 1);
+      tmp        = g_index[i];
+      g_index[i] = g_index[j];
+      g_index[j] = tmp;
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: bench_exec
+ *
+ * Description:
+ *   Perform one operation on one slot.
+ *
+ ****************************************************************************/
+
+static void bench_exec(int op, int j)
+{
+  FAR void *mem;
+
+  switch (op)
+    {
+      case BENCH_MALLOC:
+        g_slot[j] = malloc(g_size[j]);
+        if (g_slot[j] == NULL)
+          {
+            g_nfail++;
+          }
+        break;
+
+      case BENCH_REALLOC:
+        mem = realloc(g_slot[j], g_size[j]);
+        if (mem == NULL)
+          {
+            g_nfail++;
+          }
+        else
+          {
+            g_slot[j] = mem;
+          }
+        break;
+
+      default:
+        free(g_slot[j]);
+        g_slot[j] = NULL;
+        break;
+    }
+}
+
+/****************************************************************************
+ * Name: bench_batch
+ *
+ * Description:
+ *   Perform the selected batch of one operation.  The batch is timed as a
+ *   whole for the average.  With 'trace', each operation is instead timed
+ *   with up_trace_clock() for the worst case.
+ *
+ ****************************************************************************/
+
+static void bench_batch(int op, int n, FAR struct mm_benchstat_s *stat,
+                        bool trace)
+{
+  struct timespec start;
+  struct timespec end;
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  uint32_t begin;
+  uint32_t usec;
+#endif
+  int k;
+
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  if (trace)
+    {
+      for (k = 0; k < n; k++)
+        {
+          begin = up_trace_clock();
+          bench_exec(op, g_index[k]);
+          usec  = up_trace_clock() - begin;
+
+          if (usec > stat->max)
+            {
+              stat->max = usec;
+            }
+        }
+
+      return;
+    }
+#endif
+
+  bench_now(&start);
+  for (k = 0; k < n; k++)
+    {
+      bench_exec(op, g_index[k]);
+    }
+
+  bench_now(&end);
+
+  stat->count += n;
+  stat->total += bench_elapsed(&start, &end);
+}
+
+/****************************************************************************
+ * Name: bench_run
+ *
+ * Description:
+ *   Run the request sequence:  Rounds of a batch of allocations, a batch
+ *   of reallocations and a batch of frees until about
+ *   CONFIG_EXAMPLES_MM_BENCH_NITER operations have been performed.  The
+ *   allocations that survive a round fragment the heap for the next ones.
+ *   If 'info' is not NULL, it receives the state of the heap at the end.
+ *
+ ****************************************************************************/
+
+static void bench_run(FAR struct mm_benchstat_s *stat, bool trace,
+                      FAR struct mallinfo *info)
+{
+  unsigned long nops = 0;
+  int op;
+  int n;
+  int k;
+  int j;
+
+  memset(g_slot, 0, sizeof(g_slot));
+  g_seed  = 0x5eed;
+  g_nfail = 0;
+
+  while (nops < CONFIG_EXAMPLES_MM_BENCH_NITER)
+    {
+      for (op = 0; op < BENCH_NOPS; op++)
+        {
+          n = bench_select(op);
+          bench_batch(op, n, &stat[op], trace);
+          nops += n;
+
+          /* Touch the new allocations, outside of the timed batch */
+
+          if (op == BENCH_MALLOC)
+            {
+              for (k = 0; k < n; k++)
+                {
+                  j = g_index[k];
+                  if (g_slot[j] != NULL)
+                    {
+                      memset(g_slot[j], j, g_size[j]);
+                    }
+                }
+            }
+        }
+    }
+
+  if (info != NULL)
+    {
+      *info = mallinfo();
+    }
+
+  for (j = 0; j < CONFIG_EXAMPLES_MM_BENCH_NSLOTS; j++)
+    {
+      free(g_slot[j]);
+      g_slot[j] = NULL;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_benchmark
+ *
+ * Description:
+ *   Time a reproducible sequence of malloc(), realloc() and free() calls
+ *   on randomly selected slots.  Each operation is timed in batches and
+ *   its average time is reported together with the fragmentation of the
+ *   heap at the end of the run.  If the architecture provides
+ *   up_trace_clock(), the sequence is run again with each call timed on
+ *   its own and the longest call is reported too.  Build with
+ *   CONFIG_MM_TLSF enabled and disabled to compare the two heap
+ *   allocators.
+ *
+ ****************************************************************************/
+
+void mm_benchmark(void)
+{
+  struct mm_benchstat_s stat[BENCH_NOPS];
+  struct mallinfo info;
+  unsigned long nfail;
+  int op;
+
+  printf("mm_benchmark: %s allocator, %d iterations, %d slots\n",
+         MM_BENCH_ALLOCATOR, CONFIG_EXAMPLES_MM_BENCH_NITER,
+         CONFIG_EXAMPLES_MM_BENCH_NSLOTS);
+
+  memset(stat, 0, sizeof(stat));
+
+  bench_run(stat, false, &info);
+  nfail = g_nfail;
+
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  bench_run(stat, true, NULL);
+#endif
+
+  for (op = 0; op < BENCH_NOPS; op++)
+    {
+      bench_show(op, &stat[op]);
+    }
+
+  printf("  fragments %d  largest free %d  total free %d  failures %lu\n",
+         info.ordblks, info.mxordblk, info.fordblks, nfail);
+}
+
+#endif /* CONFIG_EXAMPLES_MM_BENCH */
@@ -64,6 +64,14 @@
 # define SIZEOF_MM_ALLOCNODE   8
 #endif
 
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH
+void mm_benchmark(void);
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -310,6 +318,12 @@ int mm_main(int argc, char *argv[])
 
   do_frees(allocs, alloc_sizes, random1, NTEST_ALLOCS);
 
+#ifdef CONFIG_EXAMPLES_MM_BENCH
+  /* Time the allocator */
+
+  mm_benchmark();
+#endif
+
   printf("TEST COMPLETE\n");
   return 0;
 }
@@ -0,0 +1,373 @@
+/****************************************************************************
+ * examples/nxffs/nxffs_bench.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/ioctl.h>
+
+#ifdef CONFIG_EXAMPLES_NXFFS_BENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_NXFFS_MOUNTPT
+#  define CONFIG_EXAMPLES_NXFFS_MOUNTPT "/mnt/nxffs"
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXFFS_BENCH_NFILES
+#  define CONFIG_EXAMPLES_NXFFS_BENCH_NFILES 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXFFS_BENCH_NLOOKUPS
+#  define CONFIG_EXAMPLES_NXFFS_BENCH_NLOOKUPS 256
+#endif
+
+#ifdef CONFIG_NXFFS_INDEX
+#  define NXFFS_BENCH_LOOKUP "index"
+#else
+#  define NXFFS_BENCH_LOOKUP "scan"
+#endif
+
+#define NXFFS_BENCH_MAXSIZE 256
+#define NSEC_PER_SEC        1000000000L
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct nxffs_benchstat_s
+{
+  unsigned long count;     /* Number of timed operations */
+  uint64_t      total;     /* Total time of all operations (nsec) */
+  uint32_t      worst;     /* Longest single operation (nsec) */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t g_benchbuf[NXFFS_BENCH_MAXSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void bench_now(FAR struct timespec *ts)
+{
+#ifdef CONFIG_CLOCK_MONOTONIC
+  (void)clock_gettime(CLOCK_MONOTONIC, ts);
+#else
+  (void)clock_gettime(CLOCK_REALTIME, ts);
+#endif
+}
+
+static uint32_t bench_elapsed(FAR const struct timespec *start,
+                              FAR const struct timespec *end)
+{
+  int64_t nsec;
+
+  nsec = (int64_t)(end->tv_sec - start->tv_sec) * NSEC_PER_SEC +
+         (end->tv_nsec - start->tv_nsec);
+
+  return nsec < 0 ? 0 : (uint32_t)nsec;
+}
+
+static void bench_account(FAR struct nxffs_benchstat_s *stat,
+                          FAR const struct timespec *start)
+{
+  struct timespec end;
+  uint32_t nsec;
+
+  bench_now(&end);
+  nsec = bench_elapsed(start, &end);
+
+  stat->count++;
+  stat->total += nsec;
+  if (nsec > stat->worst)
+    {
+      stat->worst = nsec;
+    }
+}
+
+static void bench_show(FAR const char *name,
+                       FAR const struct nxffs_benchstat_s *stat)
+{
+  unsigned long avg = 0;
+
+  if (stat->count > 0)
+    {
+      avg = (unsigned long)(stat->total / stat->count);
+    }
+
+  printf("  %-10s %6lu ops  avg %8lu nsec  worst %9lu nsec\n",
+         name, stat->count, avg, (unsigned long)stat->worst);
+}
+
+static void bench_path(FAR char *path, FAR const char *name, int i)
+{
+  snprintf(path, 64, "%s/%s%03d", CONFIG_EXAMPLES_NXFFS_MOUNTPT, name, i);
+}
+
+/****************************************************************************
+ * Name: bench_wrfile
+ *
+ * Description:
+ *   Create one small file.  Returns zero on success.
+ *
+ ****************************************************************************/
+
+static int bench_wrfile(FAR const char *path, size_t len)
+{
+  ssize_t nwritten;
+  int fd;
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      printf("  ERROR: open(%s) failed: %d\n", path, errno);
+      return -1;
+    }
+
+  nwritten = write(fd, g_benchbuf, len);
+  close(fd);
+
+  if (nwritten != (ssize_t)len)
+    {
+      printf("  ERROR: write(%s) failed: %d\n", path, errno);
+      return -1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: bench_lookups
+ *
+ * Description:
+ *   Time stat() of the existing files, stat() of files that do not exist,
+ *   and open()/close() of the existing files.  Only every stride'th file
+ *   (the last one of each group of stride files) is looked up.
+ *
+ ****************************************************************************/
+
+static void bench_lookups(int nfiles, int stride)
+{
+  struct nxffs_benchstat_s hstat;
+  struct nxffs_benchstat_s mstat;
+  struct nxffs_benchstat_s ostat;
+  struct timespec start;
+  struct stat buf;
+  char path[64];
+  int nfail = 0;
+  int file;
+  int fd;
+  int i;
+
+  memset(&hstat, 0, sizeof(struct nxffs_benchstat_s));
+  memset(&mstat, 0, sizeof(struct nxffs_benchstat_s));
+  memset(&ostat, 0, sizeof(struct nxffs_benchstat_s));
+
+  for (i = 0; i < CONFIG_EXAMPLES_NXFFS_BENCH_NLOOKUPS; i++)
+    {
+      file = stride * ((i * 7) % (nfiles / stride)) + stride - 1;
+      bench_path(path, "bench", file);
+      bench_now(&start);
+      if (stat(path, &buf) < 0)
+        {
+          nfail++;
+        }
+
+      bench_account(&hstat, &start);
+
+      bench_path(path, "missing", i % nfiles);
+      bench_now(&start);
+      if (stat(path, &buf) == 0)
+        {
+          nfail++;
+        }
+
+      bench_account(&mstat, &start);
+
+      bench_path(path, "bench", file);
+      bench_now(&start);
+      fd = open(path, O_RDONLY);
+      if (fd < 0)
+        {
+          nfail++;
+        }
+      else
+        {
+          close(fd);
+        }
+
+      bench_account(&ostat, &start);
+    }
+
+  bench_show("stat", &hstat);
+  bench_show("stat miss", &mstat);
+  bench_show("open", &ostat);
+
+  if (nfail > 0)
+    {
+      printf("  ERROR: %d look-ups gave the wrong result\n", nfail);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_benchmark
+ *
+ * Description:
+ *   Create a set of small files with deleted files in between them, then
+ *   time file look-ups (stat() of existing and missing files, open()) and
+ *   the re-packing of the volume after half of the files are deleted.
+ *   Build with CONFIG_NXFFS_INDEX enabled and disabled to compare the RAM
+ *   inode index with the FLASH scan.
+ *
+ ****************************************************************************/
+
+void nxffs_benchmark(void)
+{
+  struct nxffs_benchstat_s pstat;
+  struct timespec start;
+  char path[64];
+  size_t len;
+  int nfiles;
+  int fd;
+  int ret;
+  int i;
+
+  printf("nxffs_benchmark: %s look-up, %d files, %d look-ups\n",
+         NXFFS_BENCH_LOOKUP, CONFIG_EXAMPLES_NXFFS_BENCH_NFILES,
+         CONFIG_EXAMPLES_NXFFS_BENCH_NLOOKUPS);
+
+  for (i = 0; i < NXFFS_BENCH_MAXSIZE; i++)
+    {
+      g_benchbuf[i] = (uint8_t)i;
+    }
+
+  /* Create the files.  Each is followed by a deleted file so that the
+   * volume has to be re-packed later.
+   */
+
+  for (nfiles = 0; nfiles < CONFIG_EXAMPLES_NXFFS_BENCH_NFILES; nfiles++)
+    {
+      len = 32 + (nfiles * 37) % (NXFFS_BENCH_MAXSIZE - 32);
+      bench_path(path, "bench", nfiles);
+      if (bench_wrfile(path, len) < 0)
+        {
+          break;
+        }
+
+      bench_path(path, "scratch", nfiles);
+      if (bench_wrfile(path, NXFFS_BENCH_MAXSIZE) < 0)
+        {
+          break;
+        }
+
+      (void)unlink(path);
+    }
+
+  if (nfiles < 2)
+    {
+      printf("  ERROR: Could not create the files\n");
+      goto errout;
+    }
+
+  bench_lookups(nfiles, 1);
+
+  /* Delete every other file and re-pack the volume */
+
+  for (i = 0; i < nfiles; i += 2)
+    {
+      bench_path(path, "bench", i);
+      (void)unlink(path);
+    }
+
+  bench_path(path, "bench", 1);
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("  ERROR: open(%s) failed: %d\n", path, errno);
+      goto errout;
+    }
+
+  memset(&pstat, 0, sizeof(struct nxffs_benchstat_s));
+  bench_now(&start);
+  ret = ioctl(fd, FIOC_OPTIMIZE, 0);
+  bench_account(&pstat, &start);
+  close(fd);
+
+  if (ret < 0)
+    {
+      printf("  ERROR: ioctl(FIOC_OPTIMIZE) failed: %d\n", errno);
+    }
+
+  bench_show("pack", &pstat);
+
+  /* Time the look-ups again on the re-packed volume (only the odd numbered
+   * files remain).
+   */
+
+  bench_lookups(nfiles, 2);
+
+errout:
+  for (i = 0; i < CONFIG_EXAMPLES_NXFFS_BENCH_NFILES; i++)
+    {
+      bench_path(path, "bench", i);
+      (void)unlink(path);
+    }
+}
+
+#endif /* CONFIG_EXAMPLES_NXFFS_BENCH */
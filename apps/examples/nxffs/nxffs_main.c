@@ -161,6 +161,10 @@ static struct mallinfo g_mmafter;
 extern FAR struct mtd_dev_s *nxffs_archinitialize(void);
 #endif
 
+#ifdef CONFIG_EXAMPLES_NXFFS_BENCH
+void nxffs_benchmark(void);
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -943,6 +947,14 @@ int nxffs_main(int argc, char *argv[])
   nxffs_delallfiles();
   nxffs_endmemusage();
   msgflush();
+
+#ifdef CONFIG_EXAMPLES_NXFFS_BENCH
+  /* Time file look-ups on the now empty volume */
+
+  nxffs_benchmark();
+  msgflush();
+#endif
+
   return 0;
 }
 
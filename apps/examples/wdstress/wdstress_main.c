@@ -0,0 +1,381 @@
+/****************************************************************************
+ * examples/wdstress/wdstress_main.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/wdog.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_WDSTRESS_NWDOGS
+#  define CONFIG_EXAMPLES_WDSTRESS_NWDOGS 256
+#endif
+
+#ifndef CONFIG_EXAMPLES_WDSTRESS_NPERIODIC
+#  define CONFIG_EXAMPLES_WDSTRESS_NPERIODIC 16
+#endif
+
+#if CONFIG_EXAMPLES_WDSTRESS_NPERIODIC >= CONFIG_EXAMPLES_WDSTRESS_NWDOGS
+#  error CONFIG_EXAMPLES_WDSTRESS_NPERIODIC must be less than CONFIG_EXAMPLES_WDSTRESS_NWDOGS
+#endif
+
+#ifndef CONFIG_EXAMPLES_WDSTRESS_NITER
+#  define CONFIG_EXAMPLES_WDSTRESS_NITER 100000
+#endif
+
+#ifndef CONFIG_EXAMPLES_WDSTRESS_BATCH
+#  define CONFIG_EXAMPLES_WDSTRESS_BATCH 1000
+#endif
+
+#define NWDOGS    CONFIG_EXAMPLES_WDSTRESS_NWDOGS
+#define NPERIODIC CONFIG_EXAMPLES_WDSTRESS_NPERIODIC
+#define NBATCHES  (CONFIG_EXAMPLES_WDSTRESS_NITER / CONFIG_EXAMPLES_WDSTRESS_BATCH)
+
+/* The long delays are chosen so that those watchdogs never expire while
+ * the test runs.  The periodic watchdogs restart every few ticks.
+ */
+
+#define LONG_DELAY    1000000
+#define LONG_RANGE    1000000
+#define PERIODIC_MAX  8
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+#  define WDSTRESS_IMPL "timing wheel"
+#else
+#  define WDSTRESS_IMPL "ordered list"
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct wdstress_wdog_s
+{
+  WDOG_ID  wdog;           /* The watchdog */
+  uint32_t expected;       /* Earliest system time at which it may expire */
+};
+
+struct wdstress_stat_s
+{
+  uint32_t total;          /* Total time of all batches (usec) */
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  uint32_t max;            /* Longest single operation (usec) */
+#endif
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct wdstress_wdog_s g_wdogs[NWDOGS];
+static volatile unsigned long g_nexpired;
+static volatile unsigned long g_nearly;
+static int g_longest;
+static int g_maxdelay;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wdstress_periodic and wdstress_idle
+ *
+ * Description:
+ *   Watchdog handlers.  The periodic handler checks that its watchdog did
+ *   not expire early and then restarts it.  The idle handler should never
+ *   run.
+ *
+ ****************************************************************************/
+
+static void wdstress_periodic(int argc, uint32_t arg)
+{
+  FAR struct wdstress_wdog_s *wd = &g_wdogs[arg];
+  uint32_t now = clock_systimer();
+  int delay;
+
+  if ((int32_t)(now - wd->expected) < 0)
+    {
+      g_nearly++;
+    }
+
+  g_nexpired++;
+
+  delay        = 1 + (int)(now % PERIODIC_MAX);
+  wd->expected = now + delay;
+  (void)wd_start(wd->wdog, delay, (wdentry_t)wdstress_periodic, 1, arg);
+}
+
+static void wdstress_idle(int argc, uint32_t arg)
+{
+  g_nexpired++;
+}
+
+/****************************************************************************
+ * Name: wdstress_random, wdstress_longest and wdstress_cancel
+ *
+ * Description:
+ *   The timed operations.  Each is a single call to the watchdog API and so
+ *   a single critical section.
+ *
+ *   wdstress_random  - Restart a random watchdog with a random delay.  This
+ *                      is the typical use by protocol timeouts.
+ *   wdstress_longest - Restart the watchdog with the longest delay with a
+ *                      still longer delay.  This is the worst case for an
+ *                      ordered list.
+ *   wdstress_cancel  - Cancel a random watchdog.
+ *
+ ****************************************************************************/
+
+static void wdstress_start(int ndx, int delay)
+{
+  (void)wd_start(g_wdogs[ndx].wdog, delay, (wdentry_t)wdstress_idle, 1,
+                 (uint32_t)ndx);
+}
+
+static inline int wdstress_pick(void)
+{
+  return NPERIODIC + rand() % (NWDOGS - NPERIODIC);
+}
+
+static void wdstress_random(void)
+{
+  int ndx = wdstress_pick();
+
+  if (ndx != g_longest)
+    {
+      wdstress_start(ndx, LONG_DELAY + rand() % LONG_RANGE);
+    }
+}
+
+static void wdstress_longest(void)
+{
+  wdstress_start(g_longest, ++g_maxdelay);
+}
+
+static void wdstress_cancel(void)
+{
+  (void)wd_cancel(g_wdogs[wdstress_pick()].wdog);
+}
+
+/****************************************************************************
+ * Name: wdstress_elapsed
+ ****************************************************************************/
+
+static uint32_t wdstress_elapsed(FAR const struct timespec *start,
+                                 FAR const struct timespec *end)
+{
+  int64_t nsec;
+
+  nsec = (int64_t)(end->tv_sec - start->tv_sec) * NSEC_PER_SEC +
+         (end->tv_nsec - start->tv_nsec);
+
+  return nsec < 0 ? 0 : (uint32_t)nsec;
+}
+
+/****************************************************************************
+ * Name: wdstress_run
+ *
+ * Description:
+ *   Time CONFIG_EXAMPLES_WDSTRESS_NITER operations in batches and report
+ *   the average time per operation.  If the architecture provides
+ *   up_trace_clock(), another CONFIG_EXAMPLES_WDSTRESS_NITER operations
+ *   are timed one by one and the longest is reported too.  These are not
+ *   included in the average, which would otherwise include the reading of
+ *   the clock.
+ *
+ ****************************************************************************/
+
+static void wdstress_run(FAR const char *name, CODE void (*op)(void))
+{
+  struct wdstress_stat_s stat;
+  struct timespec start;
+  struct timespec end;
+  uint32_t nsec;
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  uint32_t begin;
+  uint32_t usec;
+#endif
+  int i;
+  int j;
+
+  memset(&stat, 0, sizeof(struct wdstress_stat_s));
+
+  for (i = 0; i < NBATCHES; i++)
+    {
+      (void)clock_gettime(CLOCK_REALTIME, &start);
+      for (j = 0; j < CONFIG_EXAMPLES_WDSTRESS_BATCH; j++)
+        {
+          op();
+        }
+
+      (void)clock_gettime(CLOCK_REALTIME, &end);
+
+      nsec        = wdstress_elapsed(&start, &end);
+      stat.total += nsec / 1000;
+    }
+
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  for (i = 0; i < CONFIG_EXAMPLES_WDSTRESS_NITER; i++)
+    {
+      begin = up_trace_clock();
+      op();
+      usec  = up_trace_clock() - begin;
+
+      if (usec > stat.max)
+        {
+          stat.max = usec;
+        }
+    }
+
+  printf("  %-10s avg %8lu nsec  max %6lu usec\n", name,
+         (unsigned long)((uint64_t)stat.total * 1000 /
+                         CONFIG_EXAMPLES_WDSTRESS_NITER),
+         (unsigned long)stat.max);
+#else
+  printf("  %-10s avg %8lu nsec\n", name,
+         (unsigned long)((uint64_t)stat.total * 1000 /
+                         CONFIG_EXAMPLES_WDSTRESS_NITER));
+#endif
+}
+
+/****************************************************************************
+ * Name: wdstress_arm
+ *
+ * Description:
+ *   (Re-)start all idle watchdogs with long random delays.  The last one
+ *   gets the longest delay.
+ *
+ ****************************************************************************/
+
+static void wdstress_arm(void)
+{
+  int i;
+
+  for (i = NPERIODIC; i < NWDOGS - 1; i++)
+    {
+      wdstress_start(i, LONG_DELAY + rand() % LONG_RANGE);
+    }
+
+  g_longest  = NWDOGS - 1;
+  g_maxdelay = LONG_DELAY + LONG_RANGE;
+  wdstress_start(g_longest, g_maxdelay);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wdstress_main
+ ****************************************************************************/
+
+int wdstress_main(int argc, char *argv[])
+{
+  int i;
+
+  printf("wdstress: %s, %d watchdogs (%d periodic), %d operations\n",
+         WDSTRESS_IMPL, NWDOGS, NPERIODIC, CONFIG_EXAMPLES_WDSTRESS_NITER);
+
+  for (i = 0; i < NWDOGS; i++)
+    {
+      g_wdogs[i].wdog = wd_create();
+      if (g_wdogs[i].wdog == NULL)
+        {
+          printf("wdstress: ERROR: wd_create failed for watchdog %d\n", i);
+          goto errout;
+        }
+    }
+
+  srand(1);
+  g_nexpired = 0;
+  g_nearly   = 0;
+
+  /* Start the periodic watchdogs and arm all others */
+
+  for (i = 0; i < NPERIODIC; i++)
+    {
+      g_wdogs[i].expected = clock_systimer() + 1;
+      (void)wd_start(g_wdogs[i].wdog, 1, (wdentry_t)wdstress_periodic, 1,
+                     (uint32_t)i);
+    }
+
+  wdstress_arm();
+
+  /* Time the operations.  All run entirely with interrupts disabled. */
+
+  wdstress_run("random", wdstress_random);
+  wdstress_run("longest", wdstress_longest);
+  wdstress_run("cancel", wdstress_cancel);
+
+  /* Re-arm the cancelled watchdogs and let the periodic ones run a bit
+   * longer against the full set.
+   */
+
+  wdstress_arm();
+  usleep(500 * 1000);
+
+  printf("  expirations %lu  early %lu\n", g_nexpired, g_nearly);
+  if (g_nearly > 0)
+    {
+      printf("wdstress: ERROR: watchdogs expired early\n");
+    }
+
+errout:
+  for (i = 0; i < NWDOGS; i++)
+    {
+      if (g_wdogs[i].wdog != NULL)
+        {
+          (void)wd_delete(g_wdogs[i].wdog);
+          g_wdogs[i].wdog = NULL;
+        }
+    }
+
+  return g_nearly > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -196,6 +196,10 @@ static const struct cmdmap_s g_cmdmap[] =
 # endif
 #endif
 
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_NSH_DISABLE_HEAPPROF)
+  { "heapprof", cmd_heapprof, 1, 4, "[-r] [-n <count>]" },
+#endif
+
 #ifndef CONFIG_NSH_DISABLE_HELP
 # ifdef CONFIG_NSH_HELP_TERSE
   { "help",     cmd_help,     1, 2, "[<cmd>]" },
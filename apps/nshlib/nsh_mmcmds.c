@@ -39,7 +39,14 @@
 
 #include <nuttx/config.h>
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_NSH_DISABLE_HEAPPROF)
+#  include <nuttx/mm/mm.h>
+#endif
 
 #include "nsh.h"
 #include "nsh_console.h"
@@ -68,6 +75,55 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: heapprof_rate
+ *
+ * Description:
+ *   Return the allocation rate of a site, in allocations per second since
+ *   the previous snapshot.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_NSH_DISABLE_HEAPPROF)
+static uint32_t g_heapprof_elapsed;
+
+static uint32_t heapprof_rate(FAR const struct mm_prsite_s *site)
+{
+  if (g_heapprof_elapsed == 0)
+    {
+      return 0;
+    }
+
+  return (uint32_t)(((uint64_t)(site->ps_nallocs - site->ps_lastallocs) *
+                     1000) / g_heapprof_elapsed);
+}
+
+/****************************************************************************
+ * Name: heapprof_cmplive/heapprof_cmprate
+ *
+ * Description:
+ *   qsort() comparison functions that order sites by decreasing live bytes
+ *   or by decreasing allocation rate.
+ *
+ ****************************************************************************/
+
+static int heapprof_cmplive(FAR const void *a, FAR const void *b)
+{
+  size_t live_a = ((FAR const struct mm_prsite_s *)a)->ps_live;
+  size_t live_b = ((FAR const struct mm_prsite_s *)b)->ps_live;
+
+  return live_a < live_b ? 1 : live_a > live_b ? -1 : 0;
+}
+
+static int heapprof_cmprate(FAR const void *a, FAR const void *b)
+{
+  uint32_t rate_a = heapprof_rate((FAR const struct mm_prsite_s *)a);
+  uint32_t rate_b = heapprof_rate((FAR const struct mm_prsite_s *)b);
+
+  return rate_a < rate_b ? 1 : rate_a > rate_b ? -1 : 0;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -100,3 +156,117 @@ int cmd_free(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
   return OK;
 }
 #endif /* !CONFIG_NSH_DISABLE_FREE */
+
+/****************************************************************************
+ * Name: cmd_heapprof
+ ****************************************************************************/
+
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_NSH_DISABLE_HEAPPROF)
+int cmd_heapprof(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  FAR struct mm_prsite_s *sites;
+  uint32_t nclass[MM_NNODES];
+  uint32_t nchunks[MM_NNODES];
+  size_t nbytes[MM_NNODES];
+  bool byrate = false;
+  bool badarg = false;
+  int count = CONFIG_MM_PROFILE_NSITES;
+  int nsites;
+  int option;
+  int i;
+
+  /* Get the heapprof options */
+
+  while ((option = getopt(argc, argv, ":n:r")) != ERROR)
+    {
+      switch (option)
+        {
+          case 'n':
+            count = atoi(optarg);
+            if (count <= 0)
+              {
+                nsh_output(vtbl, g_fmtargrange, argv[0]);
+                badarg = true;
+              }
+            break;
+
+          case 'r':
+            byrate = true;
+            break;
+
+          case ':':
+            nsh_output(vtbl, g_fmtargrequired, argv[0]);
+            badarg = true;
+            break;
+
+          case '?':
+          default:
+            nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+            badarg = true;
+            break;
+        }
+    }
+
+  if (badarg)
+    {
+      return ERROR;
+    }
+
+  sites = (FAR struct mm_prsite_s *)
+    malloc(CONFIG_MM_PROFILE_NSITES * sizeof(struct mm_prsite_s));
+
+  if (!sites)
+    {
+      nsh_output(vtbl, g_fmtcmdoutofmemory, argv[0]);
+      return ERROR;
+    }
+
+  /* Take a snapshot of the user heap counters and order the sites */
+
+  nsites = mm_profile_snapshot(&g_mmheap, sites, CONFIG_MM_PROFILE_NSITES,
+                               nclass, &g_heapprof_elapsed);
+  mm_freehist(&g_mmheap, nchunks, nbytes);
+
+  qsort(sites, nsites, sizeof(struct mm_prsite_s),
+        byrate ? heapprof_cmprate : heapprof_cmplive);
+
+  if (count > nsites)
+    {
+      count = nsites;
+    }
+
+  /* Show the allocation sites.  Sizes include the chunk headers.  The rate
+   * is in allocations per second since the previous snapshot.
+   */
+
+  nsh_output(vtbl, "    caller       live  nlive       peak   allocs   rate\n");
+  for (i = 0; i < count; i++)
+    {
+      nsh_output(vtbl, "0x%08lx %10lu %6lu %10lu %8lu %6lu\n",
+                 (unsigned long)(uintptr_t)sites[i].ps_caller,
+                 (unsigned long)sites[i].ps_live,
+                 (unsigned long)sites[i].ps_nlive,
+                 (unsigned long)sites[i].ps_peak,
+                 (unsigned long)sites[i].ps_nallocs,
+                 (unsigned long)heapprof_rate(&sites[i]));
+    }
+
+  /* Then the number of allocations and free chunks of each size class */
+
+  nsh_output(vtbl, "\n     chunk   allocs  nfree       free\n");
+  for (i = 0; i < MM_NNODES; i++)
+    {
+      if (nclass[i] > 0 || nchunks[i] > 0)
+        {
+          nsh_output(vtbl, "%10lu %8lu %6lu %10lu\n",
+                     (unsigned long)MM_MIN_CHUNK << i,
+                     (unsigned long)nclass[i],
+                     (unsigned long)nchunks[i],
+                     (unsigned long)nbytes[i]);
+        }
+    }
+
+  free(sites);
+  return OK;
+}
+#endif /* CONFIG_MM_PROFILE && !CONFIG_NSH_DISABLE_HEAPPROF */
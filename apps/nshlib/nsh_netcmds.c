@@ -267,6 +267,13 @@ static inline void net_statistics(FAR struct nsh_vtbl_s *vtbl)
 #endif
   nsh_output(vtbl, "\n");
 #endif
+
+#ifdef CONFIG_NET_UDP_MMSG
+  nsh_output(vtbl, "  UDP Batch Snd: %04x/%04x Rcv: %04x/%04x Poll: %04x\n",
+             g_netstats.udp.sndbatch, g_netstats.udp.sndmsgs,
+             g_netstats.udp.rcvbatch, g_netstats.udp.rcvmsgs,
+             g_netstats.udp.pollbatch);
+#endif
   nsh_output(vtbl, "\n");
 }
 #else
@@ -70,6 +70,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <string.h>
 #include <sched.h>
 #include <errno.h>
 
@@ -90,6 +91,12 @@
 #  define HAVE_CPULOAD 1
 #endif
 
+#undef HAVE_CPUTIME
+#if defined(CONFIG_SCHED_CPUTIME) && defined(CONFIG_FS_PROCFS) && \
+   !defined(CONFIG_FS_PROCFS_EXCLUDE_PROCESS)
+#  define HAVE_CPUTIME 1
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -150,7 +157,7 @@ static const char *g_ttypenames[4] =
  * Name: readfile
  ****************************************************************************/
 
-#ifdef HAVE_CPULOAD
+#if defined(HAVE_CPULOAD) || defined(HAVE_CPUTIME)
 static int readfile(FAR const char *filename, FAR char *buffer, size_t buflen)
 {
   FAR char *bufptr;
@@ -254,6 +261,69 @@ static int loadavg(pid_t pid, FAR char *buffer, size_t buflen)
 }
 #endif
 
+/****************************************************************************
+ * Name: cputime
+ *
+ * Description:
+ *   Return one value from the 'cputime' pseudo-file of a thread:  Line 0 is
+ *   the time that the thread has run; line 1 is the time spent in interrupt
+ *   handlers.
+ *
+ ****************************************************************************/
+
+#ifdef HAVE_CPUTIME
+static int cputime(pid_t pid, int line, FAR char *buffer, size_t buflen)
+{
+  char path[24];
+  char file[96];
+  FAR char *ptr;
+  size_t len;
+  int ret;
+
+  /* Read the 'cputime' pseudo-file */
+
+  snprintf(path, sizeof(path), CONFIG_NSH_PROC_MOUNTPOUNT "/%d/cputime",
+           (int)pid);
+
+  ret = readfile(path, file, sizeof(file));
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Find the requested line and skip over its label */
+
+  for (ptr = file; line > 0 && ptr != NULL; line--)
+    {
+      ptr = strchr(ptr, '\n');
+      if (ptr != NULL)
+        {
+          ptr++;
+        }
+    }
+
+  if (ptr == NULL || *ptr == '\0')
+    {
+      return -EINVAL;
+    }
+
+  ptr += strcspn(ptr, " ");
+  ptr += strspn(ptr, " ");
+
+  /* Return the value */
+
+  len = strcspn(ptr, "\n");
+  if (len >= buflen)
+    {
+      len = buflen - 1;
+    }
+
+  memcpy(buffer, ptr, len);
+  buffer[len] = '\0';
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: ps_task
  ****************************************************************************/
@@ -262,8 +332,8 @@ static int loadavg(pid_t pid, FAR char *buffer, size_t buflen)
 static void ps_task(FAR struct tcb_s *tcb, FAR void *arg)
 {
   struct nsh_vtbl_s *vtbl = (struct nsh_vtbl_s*)arg;
-#ifdef HAVE_CPULOAD
-  char buffer[8];
+#if defined(HAVE_CPULOAD) || defined(HAVE_CPUTIME)
+  char buffer[16];
   int ret;
 #endif
 #if CONFIG_MAX_TASK_ARGS > 2
@@ -294,6 +364,18 @@ static void ps_task(FAR struct tcb_s *tcb, FAR void *arg)
   nsh_output(vtbl, "%-6s ", buffer);
 #endif
 
+#ifdef HAVE_CPUTIME
+  /* Get the time that the thread has run */
+
+  ret = cputime(tcb->pid, 0, buffer, sizeof(buffer));
+  if (ret < 0)
+    {
+      buffer[0] = '\0';
+    }
+
+  nsh_output(vtbl, "%12s ", buffer);
+#endif
+
   /* Show task name and arguments */
 
 #if CONFIG_TASK_NAME_SIZE > 0
@@ -369,12 +451,30 @@ int cmd_exec(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 #ifndef CONFIG_NSH_DISABLE_PS
 int cmd_ps(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 {
+#ifdef HAVE_CPUTIME
+  char buffer[16];
+#endif
+
+  nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE    ");
 #ifdef HAVE_CPULOAD
-  nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE    CPU    NAME\n");
-#else
-  nsh_output(vtbl, "PID   PRI SCHD TYPE   NP STATE    NAME\n");
+  nsh_output(vtbl, "CPU    ");
+#endif
+#ifdef HAVE_CPUTIME
+  nsh_output(vtbl, "        TIME ");
 #endif
+  nsh_output(vtbl, "NAME\n");
+
   sched_foreach(ps_task, vtbl);
+
+#ifdef HAVE_CPUTIME
+  /* Time spent in interrupt handlers is not charged to any thread */
+
+  if (cputime(0, 1, buffer, sizeof(buffer)) == OK)
+    {
+      nsh_output(vtbl, "Interrupt time: %s\n", buffer);
+    }
+#endif
+
   return OK;
 }
 #endif
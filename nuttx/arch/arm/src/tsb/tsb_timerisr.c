@@ -42,6 +42,10 @@
 
 int up_timerisr(int irq, uint32_t *regs)
 {
+   /* Keep the trace clock current: it cannot account for a full wrap of
+    * the cycle counter between two calls */
+   (void)up_trace_clock();
+
    /* Process timer interrupt */
    sched_process_timer();
    return 0;
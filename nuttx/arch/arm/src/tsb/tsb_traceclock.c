@@ -0,0 +1,116 @@
+/****************************************************************************
+ * arch/arm/src/tsb/tsb_traceclock.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include <nuttx/arch.h>
+#include <arch/irq.h>
+
+#include "nvic.h"
+#include "up_arch.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The core runs at 96 MHz (see tsb_timerisr.c) */
+
+#define TSB_CYCLES_PER_USEC   96
+
+/* Data Watchpoint and Trace unit */
+
+#define DWT_CTRL              0xe0001000
+#define DWT_CYCCNT            0xe0001004
+
+#define DWT_CTRL_CYCCNTENA    (1 << 0)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint32_t g_lastcycles;   /* CYCCNT at the previous call */
+static uint32_t g_fraccycles;   /* Cycles not yet converted to microseconds */
+static uint32_t g_usec;         /* Free-running microseconds */
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_trace_clock
+ *
+ * Description:
+ *   Return a free-running time in microseconds derived from the DWT cycle
+ *   counter.  The cycle counter wraps every 44 seconds so this must be
+ *   called at least that often.  up_timerisr() does so on every system
+ *   tick.
+ *
+ ****************************************************************************/
+
+uint32_t up_trace_clock(void)
+{
+  irqstate_t flags;
+  uint32_t cycles;
+  uint32_t usec;
+
+  flags = irqsave();
+
+  /* Start the cycle counter on the first call */
+
+  if ((getreg32(DWT_CTRL) & DWT_CTRL_CYCCNTENA) == 0)
+    {
+      modifyreg32(NVIC_DEMCR, 0, NVIC_DEMCR_TRCENA);
+      putreg32(0, DWT_CYCCNT);
+      modifyreg32(DWT_CTRL, 0, DWT_CTRL_CYCCNTENA);
+      g_lastcycles = 0;
+    }
+
+  cycles        = getreg32(DWT_CYCCNT);
+  g_fraccycles += cycles - g_lastcycles;
+  g_lastcycles  = cycles;
+
+  g_usec       += g_fraccycles / TSB_CYCLES_PER_USEC;
+  g_fraccycles %= TSB_CYCLES_PER_USEC;
+  usec          = g_usec;
+
+  irqrestore(flags);
+  return usec;
+}
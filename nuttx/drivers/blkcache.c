@@ -0,0 +1,1182 @@
+/****************************************************************************
+ * drivers/blkcache.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/clock.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/blkcache.h>
+
+#ifdef CONFIG_DRVR_BLKCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_SCHED_WORKQUEUE
+#  error "Worker thread support is required (CONFIG_SCHED_WORKQUEUE)"
+#endif
+
+#ifndef CONFIG_DRVR_BLKCACHE_NPAGES
+#  define CONFIG_DRVR_BLKCACHE_NPAGES 16
+#endif
+
+#ifndef CONFIG_DRVR_BLKCACHE_PAGESIZE
+#  define CONFIG_DRVR_BLKCACHE_PAGESIZE 4096
+#endif
+
+#ifndef CONFIG_DRVR_BLKCACHE_RAPAGES
+#  define CONFIG_DRVR_BLKCACHE_RAPAGES 4
+#endif
+
+#ifndef CONFIG_DRVR_BLKCACHE_WRDELAY
+#  define CONFIG_DRVR_BLKCACHE_WRDELAY 350
+#endif
+
+/* Never let readahead claim more than half of the pool */
+
+#if CONFIG_DRVR_BLKCACHE_RAPAGES > CONFIG_DRVR_BLKCACHE_NPAGES / 2
+#  define BLKCACHE_RAPAGES (CONFIG_DRVR_BLKCACHE_NPAGES / 2)
+#else
+#  define BLKCACHE_RAPAGES CONFIG_DRVR_BLKCACHE_RAPAGES
+#endif
+
+/* Valid and dirty state is kept in one bit per sector */
+
+#define BLKCACHE_MAXPGSECTORS 32
+
+/* Depth of the readahead request queue */
+
+#define BLKCACHE_NRAREQS      4
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Per block driver state.  The embedded block_operations must be first:
+ * the inode's i_bops points to it, which is how the cache finds this
+ * structure again from the inode.
+ */
+
+struct blkcache_dev_s
+{
+  struct block_operations ops;              /* Operations installed in the inode */
+  FAR const struct block_operations *lower; /* The driver's own operations */
+  FAR struct inode *inode;                  /* The block driver inode */
+  size_t   nsectors;                        /* Number of sectors on the device */
+  size_t   nextsector;                      /* Expected start of the next sequential read */
+  size_t   rahead;                          /* First sector not yet scheduled for readahead */
+  uint16_t sectsize;                        /* Size of one sector */
+  uint16_t wrseq;                           /* Count of direct media writes started */
+  uint16_t nwrites;                         /* Direct media writes in progress */
+  uint8_t  pgsectors;                       /* Sectors per page (0: not cacheable) */
+  uint8_t  seqcount;                        /* Number of consecutive sequential reads */
+};
+
+/* One page of the shared pool */
+
+struct blkcache_page_s
+{
+  FAR struct blkcache_dev_s *dev;           /* Owner (NULL if the page is free) */
+  FAR uint8_t *data;                        /* Page memory */
+  size_t   sector;                          /* First sector (page aligned) */
+  uint32_t valid;                           /* Valid sectors (bit set) */
+  uint32_t dirty;                           /* Dirty sectors (bit set) */
+  uint32_t stamp;                           /* Last access time (for LRU) */
+  bool     busy;                            /* Media I/O in progress on data */
+};
+
+/* A pending readahead request */
+
+struct blkcache_rareq_s
+{
+  FAR struct blkcache_dev_s *dev;
+  size_t   sector;
+  size_t   nsectors;
+};
+
+/* The shared cache */
+
+struct blkcache_s
+{
+  sem_t    sem;                             /* Protects everything below */
+  sem_t    waitsem;                         /* Posted when a page stops being busy */
+  uint16_t nwaiters;                        /* Threads waiting on waitsem */
+  uint32_t stamp;                           /* LRU clock */
+  FAR uint8_t *mem;                         /* Memory backing all pages */
+  FAR struct blkcache_dev_s *radev;         /* Device being read ahead */
+  struct work_s rawork;                     /* Readahead worker */
+  struct work_s wbwork;                     /* Delayed write-back worker */
+  uint8_t  rahead;                          /* Readahead queue head */
+  uint8_t  ratail;                          /* Readahead queue tail */
+  struct blkcache_rareq_s rareq[BLKCACHE_NRAREQS];
+  struct blkcache_page_s page[CONFIG_DRVR_BLKCACHE_NPAGES];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     blkcache_open(FAR struct inode *inode);
+static int     blkcache_close(FAR struct inode *inode);
+static ssize_t blkcache_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors);
+static ssize_t blkcache_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors);
+static int     blkcache_geometry(FAR struct inode *inode,
+                                 FAR struct geometry *geometry);
+static int     blkcache_ioctl(FAR struct inode *inode, int cmd,
+                              unsigned long arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct blkcache_s g_blkcache;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: blkcache_takesem and blkcache_givesem
+ *
+ * Description:
+ *   The cache semaphore protects the pool and the cache state of the
+ *   devices.  It is never held across a call into a block driver, so that
+ *   other devices, including a device stacked on a cached device (e.g., a
+ *   loop device), can use the cache meanwhile.  A page being filled or
+ *   written back is marked busy instead.
+ *
+ ****************************************************************************/
+
+static void blkcache_takesem(void)
+{
+  while (sem_wait(&g_blkcache.sem) != 0)
+    {
+      ASSERT(get_errno() == EINTR);
+    }
+}
+
+static void blkcache_givesem(void)
+{
+  sem_post(&g_blkcache.sem);
+}
+
+/****************************************************************************
+ * Name: blkcache_wait and blkcache_unbusy
+ *
+ * Description:
+ *   blkcache_wait() releases the cache semaphore until some busy page is
+ *   released by blkcache_unbusy().  The caller must look up its page again
+ *   afterwards.
+ *
+ ****************************************************************************/
+
+static void blkcache_wait(void)
+{
+  g_blkcache.nwaiters++;
+  blkcache_givesem();
+
+  while (sem_wait(&g_blkcache.waitsem) != 0)
+    {
+      ASSERT(get_errno() == EINTR);
+    }
+
+  blkcache_takesem();
+}
+
+static void blkcache_unbusy(FAR struct blkcache_page_s *pg)
+{
+  pg->busy = false;
+  while (g_blkcache.nwaiters > 0)
+    {
+      g_blkcache.nwaiters--;
+      sem_post(&g_blkcache.waitsem);
+    }
+}
+
+/****************************************************************************
+ * Name: blkcache_setup
+ *
+ * Description:
+ *   Get the sector geometry of the device if we don't have it yet.
+ *   Returns true if the device can be cached.  Called without the cache
+ *   semaphore.
+ *
+ ****************************************************************************/
+
+static bool blkcache_setup(FAR struct blkcache_dev_s *dev)
+{
+  struct geometry geo;
+  size_t pgsectors;
+
+  if (dev->pgsectors == 0 &&
+      dev->lower->geometry(dev->inode, &geo) == OK && geo.geo_available &&
+      geo.geo_sectorsize > 0 &&
+      geo.geo_sectorsize <= CONFIG_DRVR_BLKCACHE_PAGESIZE &&
+      (CONFIG_DRVR_BLKCACHE_PAGESIZE % geo.geo_sectorsize) == 0)
+    {
+      pgsectors = CONFIG_DRVR_BLKCACHE_PAGESIZE / geo.geo_sectorsize;
+      if (pgsectors > BLKCACHE_MAXPGSECTORS)
+        {
+          pgsectors = BLKCACHE_MAXPGSECTORS;
+        }
+
+      blkcache_takesem();
+      dev->sectsize   = geo.geo_sectorsize;
+      dev->nsectors   = geo.geo_nsectors;
+      dev->pgsectors  = pgsectors;
+      dev->nextsector = SIZE_MAX;
+      dev->seqcount   = 0;
+      dev->rahead     = 0;
+      blkcache_givesem();
+    }
+
+  return dev->pgsectors != 0;
+}
+
+/****************************************************************************
+ * Name: blkcache_find
+ *
+ * Description:
+ *   Return the page holding 'sector' of the device, or NULL.
+ *
+ ****************************************************************************/
+
+static FAR struct blkcache_page_s *
+blkcache_find(FAR struct blkcache_dev_s *dev, size_t sector)
+{
+  FAR struct blkcache_page_s *pg;
+  size_t pgsector = sector - sector % dev->pgsectors;
+  int i;
+
+  for (i = 0; i < CONFIG_DRVR_BLKCACHE_NPAGES; i++)
+    {
+      pg = &g_blkcache.page[i];
+      if (pg->dev == dev && pg->sector == pgsector)
+        {
+          return pg;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: blkcache_findidle
+ *
+ * Description:
+ *   Like blkcache_find(), but wait until the page is no longer busy.
+ *
+ ****************************************************************************/
+
+static FAR struct blkcache_page_s *
+blkcache_findidle(FAR struct blkcache_dev_s *dev, size_t sector)
+{
+  FAR struct blkcache_page_s *pg;
+
+  while ((pg = blkcache_find(dev, sector)) != NULL && pg->busy)
+    {
+      blkcache_wait();
+    }
+
+  return pg;
+}
+
+/****************************************************************************
+ * Name: blkcache_flushpage
+ *
+ * Description:
+ *   Write the dirty sectors of a page to the media.  Adjacent dirty
+ *   sectors are written with a single multi-sector request.
+ *
+ ****************************************************************************/
+
+static int blkcache_flushpage(FAR struct blkcache_page_s *pg)
+{
+  FAR struct blkcache_dev_s *dev = pg->dev;
+  ssize_t nwritten;
+  uint32_t run;
+  int first;
+  int last;
+  int ret = OK;
+
+  /* While the page is busy, it stays assigned to the device and nobody
+   * else changes its data, so the semaphore can be released for the write.
+   */
+
+  pg->busy = true;
+  while (pg->dirty != 0)
+    {
+      /* Find the next run of dirty sectors */
+
+      for (first = 0; (pg->dirty & (1u << first)) == 0; first++);
+      for (last = first;
+           last + 1 < dev->pgsectors && (pg->dirty & (1u << (last + 1))) != 0;
+           last++);
+
+      run = ((1u << (last - first)) * 2 - 1) << first;
+
+      blkcache_givesem();
+      nwritten = dev->lower->write(dev->inode,
+                                   &pg->data[first * dev->sectsize],
+                                   pg->sector + first, last - first + 1);
+      blkcache_takesem();
+
+      if (nwritten < 0)
+        {
+          fdbg("ERROR: Write of sector %lu failed: %d\n",
+               (unsigned long)(pg->sector + first), (int)nwritten);
+          ret = (int)nwritten;
+          break;
+        }
+
+      pg->dirty &= ~run;
+    }
+
+  blkcache_unbusy(pg);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: blkcache_flush
+ *
+ * Description:
+ *   Write back all dirty pages of a device, or of all devices if dev is
+ *   NULL.  When flushing one device, pages being written back by another
+ *   thread are waited for, so that all data is on the media on return.
+ *
+ ****************************************************************************/
+
+static int blkcache_flush(FAR struct blkcache_dev_s *dev)
+{
+  FAR struct blkcache_page_s *pg;
+  int result = OK;
+  int ret;
+  int i;
+
+  for (i = 0; i < CONFIG_DRVR_BLKCACHE_NPAGES; i++)
+    {
+      pg = &g_blkcache.page[i];
+      if (pg->dev == NULL || (dev != NULL && pg->dev != dev))
+        {
+          continue;
+        }
+
+      if (pg->busy)
+        {
+          if (dev != NULL)
+            {
+              /* The pool may have changed meanwhile.  Start over */
+
+              blkcache_wait();
+              i = -1;
+            }
+
+          continue;
+        }
+
+      if (pg->dirty != 0)
+        {
+          ret = blkcache_flushpage(pg);
+          if (ret < 0)
+            {
+              result = ret;
+            }
+        }
+    }
+
+  return result;
+}
+
+/****************************************************************************
+ * Name: blkcache_invalidate
+ *
+ * Description:
+ *   Discard all pages of a device, including dirty ones.  Busy pages are
+ *   waited for.
+ *
+ ****************************************************************************/
+
+static void blkcache_invalidate(FAR struct blkcache_dev_s *dev)
+{
+  FAR struct blkcache_page_s *pg;
+  int i;
+
+  for (i = 0; i < CONFIG_DRVR_BLKCACHE_NPAGES; i++)
+    {
+      pg = &g_blkcache.page[i];
+      if (pg->dev == dev && pg->busy)
+        {
+          blkcache_wait();
+          i = -1;
+        }
+      else if (pg->dev == dev)
+        {
+          pg->dev   = NULL;
+          pg->valid = 0;
+          pg->dirty = 0;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: blkcache_claim
+ *
+ * Description:
+ *   Assign a page of the pool to the page-aligned 'sector' of the device,
+ *   which must not be cached yet.  A free page is used if there is one;
+ *   otherwise the least recently used clean page is replaced.  If all
+ *   pages are dirty or busy, NULL is returned and *dirty is set to the
+ *   least recently used dirty page that is not busy, if any.
+ *
+ ****************************************************************************/
+
+static FAR struct blkcache_page_s *
+blkcache_claim(FAR struct blkcache_dev_s *dev, size_t sector,
+               FAR struct blkcache_page_s **dirty)
+{
+  FAR struct blkcache_page_s *pg;
+  FAR struct blkcache_page_s *clean = NULL;
+  int i;
+
+  *dirty = NULL;
+  for (i = 0; i < CONFIG_DRVR_BLKCACHE_NPAGES; i++)
+    {
+      pg = &g_blkcache.page[i];
+      if (pg->dev == NULL)
+        {
+          clean = pg;
+          break;
+        }
+      else if (pg->busy)
+        {
+          continue;
+        }
+      else if (pg->dirty == 0)
+        {
+          if (!clean || (int32_t)(pg->stamp - clean->stamp) < 0)
+            {
+              clean = pg;
+            }
+        }
+      else
+        {
+          if (!*dirty || (int32_t)(pg->stamp - (*dirty)->stamp) < 0)
+            {
+              *dirty = pg;
+            }
+        }
+    }
+
+  pg = clean;
+  if (pg)
+    {
+      pg->dev    = dev;
+      pg->sector = sector - sector % dev->pgsectors;
+      pg->valid  = 0;
+      pg->dirty  = 0;
+      pg->stamp  = ++g_blkcache.stamp;
+    }
+
+  return pg;
+}
+
+/****************************************************************************
+ * Name: blkcache_alloc
+ *
+ * Description:
+ *   Return the idle page holding 'sector' of the device, assigning one if
+ *   the sector is not cached yet.  If there is no clean page to replace,
+ *   the least recently used dirty page is written back first.  Returns
+ *   NULL if no page can be replaced.  The cache semaphore may be released
+ *   meanwhile.
+ *
+ ****************************************************************************/
+
+static FAR struct blkcache_page_s *
+blkcache_alloc(FAR struct blkcache_dev_s *dev, size_t sector)
+{
+  FAR struct blkcache_page_s *pg;
+  FAR struct blkcache_page_s *dirty;
+
+  for (; ; )
+    {
+      pg = blkcache_findidle(dev, sector);
+      if (pg == NULL)
+        {
+          pg = blkcache_claim(dev, sector, &dirty);
+        }
+
+      if (pg != NULL)
+        {
+          return pg;
+        }
+
+      /* The page may have been assigned while the semaphore was released
+       * for the write-back, so look it up again.
+       */
+
+      if (dirty == NULL || blkcache_flushpage(dirty) < 0)
+        {
+          return NULL;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: blkcache_raworker
+ *
+ * Description:
+ *   Work queue callback that fills pages for the queued readahead requests.
+ *
+ ****************************************************************************/
+
+static void blkcache_raworker(FAR void *arg)
+{
+  FAR struct blkcache_rareq_s *req;
+  FAR struct blkcache_dev_s *dev;
+  FAR struct blkcache_page_s *pg;
+  FAR struct blkcache_page_s *dirty;
+  size_t sector;
+  size_t end;
+  size_t nsectors;
+  size_t next;
+  ssize_t nread;
+  uint16_t wrseq;
+
+  blkcache_takesem();
+  while (g_blkcache.rahead != g_blkcache.ratail)
+    {
+      req = &g_blkcache.rareq[g_blkcache.rahead];
+      g_blkcache.rahead = (g_blkcache.rahead + 1) % BLKCACHE_NRAREQS;
+
+      dev = req->dev;
+      if (dev == NULL)
+        {
+          /* The device was detached */
+
+          continue;
+        }
+
+      /* blkcache_detach() clears radev, after which dev must not be
+       * touched again.
+       */
+
+      g_blkcache.radev = dev;
+
+      end = req->sector + req->nsectors;
+      if (end > dev->nsectors)
+        {
+          end = dev->nsectors;
+        }
+
+      for (sector = req->sector; sector < end; sector = next)
+        {
+          /* Whole pages only; pages that already hold any data are
+           * skipped rather than merged.  Readahead never waits for busy
+           * pages or writes dirty pages back to make room.
+           */
+
+          next = sector - sector % dev->pgsectors + dev->pgsectors;
+          if (blkcache_find(dev, sector) != NULL)
+            {
+              continue;
+            }
+
+          /* Media being written directly may be read before the write
+           * reaches it, leaving stale data in the cache.
+           */
+
+          if (dev->nwrites != 0)
+            {
+              break;
+            }
+
+          pg = blkcache_claim(dev, sector, &dirty);
+          if (pg == NULL)
+            {
+              break;
+            }
+
+          if (pg->sector + dev->pgsectors > dev->nsectors)
+            {
+              nsectors = dev->nsectors - pg->sector;
+            }
+          else
+            {
+              nsectors = dev->pgsectors;
+            }
+
+          /* blkcache_detach() waits for the busy page before freeing dev */
+
+          wrseq    = dev->wrseq;
+          pg->busy = true;
+
+          blkcache_givesem();
+          nread = dev->lower->read(dev->inode, pg->data, pg->sector, nsectors);
+          blkcache_takesem();
+
+          if (g_blkcache.radev != dev || nread != (ssize_t)nsectors ||
+              dev->wrseq != wrseq)
+            {
+              pg->dev = NULL;
+              blkcache_unbusy(pg);
+              break;
+            }
+
+          pg->valid = nsectors < 32 ? (1u << nsectors) - 1 : 0xffffffff;
+          blkcache_unbusy(pg);
+        }
+
+      g_blkcache.radev = NULL;
+    }
+
+  blkcache_givesem();
+}
+
+/****************************************************************************
+ * Name: blkcache_wbworker
+ *
+ * Description:
+ *   Work queue callback that writes back dirty pages some time after they
+ *   were written so that data does not stay in RAM indefinitely.
+ *
+ ****************************************************************************/
+
+static void blkcache_wbworker(FAR void *arg)
+{
+  blkcache_takesem();
+  (void)blkcache_flush(NULL);
+  blkcache_givesem();
+}
+
+/****************************************************************************
+ * Name: blkcache_readahead
+ *
+ * Description:
+ *   Called after each read.  If the read continues the previous one, queue
+ *   readahead of the sectors that follow it.
+ *
+ ****************************************************************************/
+
+static void blkcache_readahead(FAR struct blkcache_dev_s *dev, size_t start,
+                               size_t nsectors)
+{
+  FAR struct blkcache_rareq_s *req;
+  size_t end   = start + nsectors;
+  size_t raend = end + BLKCACHE_RAPAGES * dev->pgsectors;
+  uint8_t next;
+
+  if (start != dev->nextsector)
+    {
+      /* Not sequential.  Forget the stream */
+
+      dev->seqcount = 0;
+      dev->rahead   = 0;
+    }
+  else if (dev->seqcount < UINT8_MAX)
+    {
+      dev->seqcount++;
+    }
+
+  dev->nextsector = end;
+
+  /* Wait for a second sequential read before reading ahead, and only
+   * request what has not already been requested.
+   */
+
+  if (dev->seqcount < 1 || raend <= dev->rahead)
+    {
+      return;
+    }
+
+  if (dev->rahead > end)
+    {
+      end = dev->rahead;
+    }
+
+  /* Don't bother for less than a page */
+
+  if (raend - end < dev->pgsectors || end >= dev->nsectors)
+    {
+      return;
+    }
+
+  next = (g_blkcache.ratail + 1) % BLKCACHE_NRAREQS;
+  if (next == g_blkcache.rahead)
+    {
+      /* The queue is full */
+
+      return;
+    }
+
+  req           = &g_blkcache.rareq[g_blkcache.ratail];
+  req->dev      = dev;
+  req->sector   = end;
+  req->nsectors = raend - end;
+  g_blkcache.ratail = next;
+  dev->rahead   = raend;
+
+  if (work_available(&g_blkcache.rawork))
+    {
+      (void)work_queue(LPWORK, &g_blkcache.rawork, blkcache_raworker,
+                       NULL, 0);
+    }
+}
+
+/****************************************************************************
+ * Name: blkcache_open
+ ****************************************************************************/
+
+static int blkcache_open(FAR struct inode *inode)
+{
+  FAR struct blkcache_dev_s *dev = (FAR struct blkcache_dev_s *)inode->u.i_bops;
+
+  return dev->lower->open ? dev->lower->open(inode) : OK;
+}
+
+/****************************************************************************
+ * Name: blkcache_close
+ *
+ * Description:
+ *   Write back everything buffered for the device before closing it.
+ *
+ ****************************************************************************/
+
+static int blkcache_close(FAR struct inode *inode)
+{
+  FAR struct blkcache_dev_s *dev = (FAR struct blkcache_dev_s *)inode->u.i_bops;
+  int ret;
+
+  blkcache_takesem();
+  ret = blkcache_flush(dev);
+  blkcache_givesem();
+
+  if (dev->lower->close)
+    {
+      int ret2 = dev->lower->close(inode);
+      if (ret == OK)
+        {
+          ret = ret2;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: blkcache_read
+ *
+ * Description:
+ *   Copy cached sectors; read runs of uncached sectors directly from the
+ *   media into the caller's buffer.
+ *
+ ****************************************************************************/
+
+static ssize_t blkcache_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors)
+{
+  FAR struct blkcache_dev_s *dev = (FAR struct blkcache_dev_s *)inode->u.i_bops;
+  FAR struct blkcache_page_s *pg;
+  unsigned int i;
+  unsigned int run;
+  ssize_t ret = nsectors;
+  ssize_t nread;
+
+  if (!blkcache_setup(dev))
+    {
+      return dev->lower->read(inode, buffer, start_sector, nsectors);
+    }
+
+  blkcache_takesem();
+  for (i = 0; i < nsectors; i += run)
+    {
+      size_t sector = start_sector + i;
+
+      pg = blkcache_find(dev, sector);
+      if (pg && (pg->valid & (1u << (sector - pg->sector))) != 0)
+        {
+          memcpy(&buffer[i * dev->sectsize],
+                 &pg->data[(sector - pg->sector) * dev->sectsize],
+                 dev->sectsize);
+          pg->stamp = ++g_blkcache.stamp;
+          run       = 1;
+          continue;
+        }
+
+      /* Gather the run of sectors that are not in the cache */
+
+      for (run = 1; i + run < nsectors; run++)
+        {
+          pg = blkcache_find(dev, sector + run);
+          if (pg && (pg->valid & (1u << (sector + run - pg->sector))) != 0)
+            {
+              break;
+            }
+        }
+
+      blkcache_givesem();
+      nread = dev->lower->read(inode, &buffer[i * dev->sectsize], sector, run);
+      blkcache_takesem();
+
+      if (nread != (ssize_t)run)
+        {
+          ret = nread < 0 ? nread : (ssize_t)(i + (nread > 0 ? nread : 0));
+          break;
+        }
+    }
+
+  if (ret == (ssize_t)nsectors)
+    {
+      blkcache_readahead(dev, start_sector, nsectors);
+    }
+
+  blkcache_givesem();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: blkcache_write
+ *
+ * Description:
+ *   Buffer short writes in the pool for delayed, coalesced write-back.
+ *   Writes of more than a page go straight to the media.  Cached copies
+ *   of the written sectors are kept up to date in either case.
+ *
+ ****************************************************************************/
+
+static ssize_t blkcache_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors)
+{
+  FAR struct blkcache_dev_s *dev = (FAR struct blkcache_dev_s *)inode->u.i_bops;
+  FAR struct blkcache_page_s *pg;
+  FAR const unsigned char *src;
+  unsigned int i;
+  uint32_t bit;
+  ssize_t ret = nsectors;
+  bool through;
+
+  if (!blkcache_setup(dev))
+    {
+      return dev->lower->write(inode, buffer, start_sector, nsectors);
+    }
+
+  blkcache_takesem();
+
+  /* Readahead data of a stream that is being overwritten is useless */
+
+  dev->nextsector = SIZE_MAX;
+  dev->seqcount   = 0;
+  dev->rahead     = 0;
+
+  through = CONFIG_DRVR_BLKCACHE_WRDELAY == 0 || nsectors > dev->pgsectors;
+  for (i = 0; i < nsectors; i++)
+    {
+      size_t sector = start_sector + i;
+
+      src = &buffer[i * dev->sectsize];
+      if (through)
+        {
+          pg = blkcache_findidle(dev, sector);
+        }
+      else
+        {
+          pg = blkcache_alloc(dev, sector);
+        }
+
+      if (pg)
+        {
+          bit = 1u << (sector - pg->sector);
+          memcpy(&pg->data[(sector - pg->sector) * dev->sectsize], src,
+                 dev->sectsize);
+          pg->valid |= bit;
+          pg->stamp  = ++g_blkcache.stamp;
+
+          if (!through)
+            {
+              pg->dirty |= bit;
+              continue;
+            }
+
+          /* The media is written below */
+
+          pg->dirty &= ~bit;
+        }
+      else if (!through)
+        {
+          /* No page could be had; write this sector directly */
+
+          dev->wrseq++;
+          dev->nwrites++;
+          blkcache_givesem();
+          ret = dev->lower->write(inode, src, sector, 1);
+          blkcache_takesem();
+          dev->nwrites--;
+
+          if (ret != 1)
+            {
+              ret = ret < 0 ? ret : -EIO;
+              goto errout;
+            }
+
+          ret = nsectors;
+        }
+    }
+
+  if (through)
+    {
+      dev->wrseq++;
+      dev->nwrites++;
+      blkcache_givesem();
+      ret = dev->lower->write(inode, buffer, start_sector, nsectors);
+      blkcache_takesem();
+      dev->nwrites--;
+    }
+  else if (work_available(&g_blkcache.wbwork))
+    {
+      (void)work_queue(LPWORK, &g_blkcache.wbwork, blkcache_wbworker, NULL,
+                       MSEC2TICK(CONFIG_DRVR_BLKCACHE_WRDELAY));
+    }
+
+errout:
+  blkcache_givesem();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: blkcache_geometry
+ *
+ * Description:
+ *   Pass the request to the driver.  If the media changed, everything
+ *   cached for the old media is discarded.
+ *
+ ****************************************************************************/
+
+static int blkcache_geometry(FAR struct inode *inode,
+                             FAR struct geometry *geometry)
+{
+  FAR struct blkcache_dev_s *dev = (FAR struct blkcache_dev_s *)inode->u.i_bops;
+  int ret;
+
+  ret = dev->lower->geometry(inode, geometry);
+  if (ret != OK || !geometry->geo_available || geometry->geo_mediachanged)
+    {
+      blkcache_takesem();
+      blkcache_invalidate(dev);
+      dev->pgsectors = 0;
+      blkcache_givesem();
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: blkcache_ioctl
+ *
+ * Description:
+ *   BIOC_FLUSH writes back all buffered data of the device.  Any other
+ *   command may access the media behind the cache's back (e.g., the SMART
+ *   sector commands or BIOC_XIPBASE), so the device's pages are written
+ *   back and discarded first.
+ *
+ ****************************************************************************/
+
+static int blkcache_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
+{
+  FAR struct blkcache_dev_s *dev = (FAR struct blkcache_dev_s *)inode->u.i_bops;
+  int ret;
+
+  blkcache_takesem();
+  ret = blkcache_flush(dev);
+  if (cmd != BIOC_FLUSH)
+    {
+      blkcache_invalidate(dev);
+    }
+
+  blkcache_givesem();
+
+  if (cmd == BIOC_FLUSH)
+    {
+      /* Let the driver flush its own buffers, if it has any */
+
+      if (ret == OK && dev->lower->ioctl &&
+          dev->lower->ioctl(inode, cmd, arg) == OK)
+        {
+          return OK;
+        }
+
+      return ret;
+    }
+
+  return dev->lower->ioctl ? dev->lower->ioctl(inode, cmd, arg) : -ENOTTY;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: blkcache_attach
+ *
+ * Description:
+ *   See include/nuttx/blkcache.h
+ *
+ ****************************************************************************/
+
+int blkcache_attach(FAR struct inode *inode)
+{
+  FAR const struct block_operations *lower = inode->u.i_bops;
+  FAR struct blkcache_dev_s *dev;
+  int i;
+
+  /* Only drivers that can report their geometry and read can be cached */
+
+  if (!lower || !lower->geometry || !lower->read)
+    {
+      return -ENOSYS;
+    }
+
+  /* Set up the shared pool when the first driver is registered */
+
+  if (!g_blkcache.mem)
+    {
+      g_blkcache.mem = (FAR uint8_t *)kmm_malloc(CONFIG_DRVR_BLKCACHE_NPAGES *
+                                                 CONFIG_DRVR_BLKCACHE_PAGESIZE);
+      if (!g_blkcache.mem)
+        {
+          return -ENOMEM;
+        }
+
+      sem_init(&g_blkcache.sem, 0, 1);
+      sem_init(&g_blkcache.waitsem, 0, 0);
+
+      for (i = 0; i < CONFIG_DRVR_BLKCACHE_NPAGES; i++)
+        {
+          g_blkcache.page[i].data =
+            &g_blkcache.mem[i * CONFIG_DRVR_BLKCACHE_PAGESIZE];
+        }
+    }
+
+  dev = (FAR struct blkcache_dev_s *)kmm_zalloc(sizeof(struct blkcache_dev_s));
+  if (!dev)
+    {
+      return -ENOMEM;
+    }
+
+  dev->ops.open     = blkcache_open;
+  dev->ops.close    = blkcache_close;
+  dev->ops.read     = blkcache_read;
+  dev->ops.write    = lower->write ? blkcache_write : NULL;
+  dev->ops.geometry = blkcache_geometry;
+  dev->ops.ioctl    = blkcache_ioctl;
+  dev->lower        = lower;
+  dev->inode        = inode;
+
+  inode->u.i_bops   = &dev->ops;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: blkcache_detach
+ *
+ * Description:
+ *   See include/nuttx/blkcache.h
+ *
+ ****************************************************************************/
+
+void blkcache_detach(FAR struct inode *inode)
+{
+  FAR struct blkcache_dev_s *dev;
+  int i;
+
+  if (!inode->u.i_bops || inode->u.i_bops->geometry != blkcache_geometry)
+    {
+      return;
+    }
+
+  dev = (FAR struct blkcache_dev_s *)inode->u.i_bops;
+
+  blkcache_takesem();
+
+  /* Forget queued readahead for this device and stop the readahead in
+   * progress.  A page being filled is waited for below.
+   */
+
+  for (i = 0; i < BLKCACHE_NRAREQS; i++)
+    {
+      if (g_blkcache.rareq[i].dev == dev)
+        {
+          g_blkcache.rareq[i].dev = NULL;
+        }
+    }
+
+  if (g_blkcache.radev == dev)
+    {
+      g_blkcache.radev = NULL;
+    }
+
+  (void)blkcache_flush(dev);
+  blkcache_invalidate(dev);
+
+  inode->u.i_bops = dev->lower;
+  blkcache_givesem();
+
+  kmm_free(dev);
+}
+
+#endif /* CONFIG_DRVR_BLKCACHE */
@@ -30,11 +30,13 @@
 
 #include <nuttx/config.h>
 #include <nuttx/list.h>
+#include <nuttx/lfqueue.h>
 #include <nuttx/unipro/unipro.h>
 #include <nuttx/greybus/greybus.h>
 #include <nuttx/greybus/tape.h>
 #include <nuttx/greybus/debug.h>
 #include <nuttx/wdog.h>
+#include <nuttx/mm/slab.h>
 
 #include <arch/atomic.h>
 #include <arch/byteorder.h>
@@ -53,14 +55,23 @@
 
 #define TIMEOUT_WD_DELAY    (TIMEOUT_IN_MS * CLOCKS_PER_SEC) / ONE_SEC_IN_MSEC
 
+#ifndef CONFIG_GREYBUS_RX_QUEUE_DEPTH
+#define CONFIG_GREYBUS_RX_QUEUE_DEPTH   16
+#endif
+
+#if CONFIG_GREYBUS_RX_QUEUE_DEPTH < 2 || \
+    (CONFIG_GREYBUS_RX_QUEUE_DEPTH & (CONFIG_GREYBUS_RX_QUEUE_DEPTH - 1)) != 0
+#error CONFIG_GREYBUS_RX_QUEUE_DEPTH must be a power of two
+#endif
+
 struct gb_cport_driver {
     struct gb_driver *driver;
     struct list_head tx_fifo;
-    struct list_head rx_fifo;
-    sem_t rx_fifo_lock;
+    struct lfqueue_s rx_fifo;
     pthread_t thread;
     struct wdog_s timeout_wd;
     struct gb_operation timedout_operation;
+    volatile bool timedout_queued;
 };
 
 struct gb_tape_record_header {
@@ -73,6 +84,9 @@ static struct gb_cport_driver *g_cport;
 static struct gb_transport_backend *transport_backend;
 static struct gb_tape_mechanism *gb_tape;
 static int gb_tape_fd = -EBADFD;
+#ifdef CONFIG_MM_SLAB
+static struct slab_cache_s *gb_operation_cache;
+#endif
 static struct gb_operation_hdr timedout_hdr = {
     .size = sizeof(timedout_hdr),
     .result = GB_OP_TIMEOUT,
@@ -86,6 +100,24 @@ static struct gb_operation_hdr oom_hdr = {
 
 static void gb_operation_timeout(int argc, uint32_t cport, ...);
 
+static inline struct gb_operation *gb_operation_alloc(void)
+{
+#ifdef CONFIG_MM_SLAB
+    return slab_alloc(gb_operation_cache);
+#else
+    return malloc(sizeof(struct gb_operation));
+#endif
+}
+
+static inline void gb_operation_free(struct gb_operation *operation)
+{
+#ifdef CONFIG_MM_SLAB
+    slab_free(gb_operation_cache, operation);
+#else
+    free(operation);
+#endif
+}
+
 uint8_t gb_errno_to_op_result(int err)
 {
     switch (err) {
@@ -292,26 +324,19 @@ static void gb_process_response(struct gb_operation_hdr *hdr,
 static void *gb_pending_message_worker(void *data)
 {
     const int cportid = (int) data;
-    irqstate_t flags;
     struct gb_operation *operation;
-    struct list_head *head;
     struct gb_operation_hdr *hdr;
     int retval;
 
     while (1) {
-        retval = sem_wait(&g_cport[cportid].rx_fifo_lock);
+        retval = lfq_wait(&g_cport[cportid].rx_fifo, (void **) &operation);
         if (retval < 0)
             continue;
 
-        flags = irqsave();
-        head = g_cport[cportid].rx_fifo.next;
-        list_del(g_cport[cportid].rx_fifo.next);
-        irqrestore(flags);
-
-        operation = list_entry(head, struct gb_operation, list);
         hdr = operation->request_buffer;
 
         if (hdr == &timedout_hdr) {
+            g_cport[cportid].timedout_queued = false;
             gb_clean_timedout_operation(cportid);
             continue;
         }
@@ -328,7 +353,6 @@ static void *gb_pending_message_worker(void *data)
 
 int greybus_rx_handler(unsigned int cport, void *data, size_t size)
 {
-    irqstate_t flags;
     struct gb_operation *op;
     struct gb_operation_hdr *hdr = data;
     struct gb_operation_handler *op_handler;
@@ -381,10 +405,11 @@ int greybus_rx_handler(unsigned int cport, void *data, size_t size)
 
     memcpy(op->request_buffer, data, hdr_size);
 
-    flags = irqsave();
-    list_add(&g_cport[cport].rx_fifo, &op->list);
-    sem_post(&g_cport[cport].rx_fifo_lock);
-    irqrestore(flags);
+    if (lfq_push(&g_cport[cport].rx_fifo, op) < 0) {
+        gb_error("CP%u rx queue is full, dropping operation\n", cport);
+        gb_operation_destroy(op);
+        return -ENOMEM;
+    }
 
     return 0;
 }
@@ -504,18 +529,20 @@ int gb_stop_listening(unsigned int cport)
 
 static void gb_operation_timeout(int argc, uint32_t cport, ...)
 {
-    irqstate_t flags;
-
-    flags = irqsave();
-
     /* timedout operation could potentially already been queued */
-    if (list_is_empty(&g_cport[cport].timedout_operation.list)) {
+    if (g_cport[cport].timedout_queued) {
         return;
     }
 
-    list_add(&g_cport[cport].rx_fifo, &g_cport[cport].timedout_operation.list);
-    sem_post(&g_cport[cport].rx_fifo_lock);
-    irqrestore(flags);
+    if (lfq_push(&g_cport[cport].rx_fifo,
+                 &g_cport[cport].timedout_operation) < 0) {
+        /* rx queue is full, try again later */
+        wd_start(&g_cport[cport].timeout_wd, TIMEOUT_WD_DELAY,
+                 gb_operation_timeout, 1, cport);
+        return;
+    }
+
+    g_cport[cport].timedout_queued = true;
 }
 
 int gb_operation_send_request(struct gb_operation *operation,
@@ -699,7 +726,7 @@ void gb_operation_unref(struct gb_operation *operation)
     if (operation->response) {
         gb_operation_unref(operation->response);
     }
-    free(operation);
+    gb_operation_free(operation);
 }
 
 
@@ -712,7 +739,7 @@ struct gb_operation *gb_operation_create(unsigned int cport, uint8_t type,
     if (cport >= unipro_cport_count())
         return NULL;
 
-    operation = malloc(sizeof(*operation));
+    operation = gb_operation_alloc();
     if (!operation)
         return NULL;
 
@@ -733,7 +760,7 @@ struct gb_operation *gb_operation_create(unsigned int cport, uint8_t type,
 
     return operation;
 malloc_error:
-    free(operation);
+    gb_operation_free(operation);
     return NULL;
 }
 
@@ -775,15 +802,48 @@ uint8_t gb_operation_get_request_result(struct gb_operation *operation)
 
 int gb_init(struct gb_transport_backend *transport)
 {
+    struct lfq_cell_s *rx_cells;
+    int retval;
     int i;
 
     if (!transport)
         return -EINVAL;
 
     g_cport = zalloc(sizeof(struct gb_cport_driver) * unipro_cport_count());
+    rx_cells = zalloc(sizeof(struct lfq_cell_s) *
+                      CONFIG_GREYBUS_RX_QUEUE_DEPTH * unipro_cport_count());
+    if (!g_cport || !rx_cells) {
+        free(g_cport);
+        free(rx_cells);
+        g_cport = NULL;
+        return -ENOMEM;
+    }
+
+#ifdef CONFIG_MM_SLAB
+    if (!gb_operation_cache) {
+        gb_operation_cache = slab_create("gb_operation",
+                                         sizeof(struct gb_operation), 0,
+                                         NULL);
+        if (!gb_operation_cache) {
+            free(g_cport);
+            free(rx_cells);
+            g_cport = NULL;
+            return -ENOMEM;
+        }
+    }
+#endif
+
     for (i = 0; i < unipro_cport_count(); i++) {
-        sem_init(&g_cport[i].rx_fifo_lock, 0, 0);
-        list_init(&g_cport[i].rx_fifo);
+        retval = lfq_init(&g_cport[i].rx_fifo,
+                          &rx_cells[i * CONFIG_GREYBUS_RX_QUEUE_DEPTH],
+                          CONFIG_GREYBUS_RX_QUEUE_DEPTH, LFQ_SINGLE_CONSUMER);
+        if (retval < 0) {
+            free(g_cport);
+            free(rx_cells);
+            g_cport = NULL;
+            return retval;
+        }
+
         list_init(&g_cport[i].tx_fifo);
         wd_static(&g_cport[i].timeout_wd);
         g_cport[i].timedout_operation.request_buffer = &timedout_hdr;
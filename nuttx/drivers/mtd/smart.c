@@ -49,15 +49,24 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
+#include <semaphore.h>
+#include <assert.h>
 #include <debug.h>
 #include <errno.h>
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+#  include <crc32.h>
+#endif
 
+#include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/mtd/smart.h>
 #include <nuttx/fs/smart.h>
+#ifdef CONFIG_MTD_SMART_BGGC
+#  include <nuttx/wqueue.h>
+#endif
 
 /****************************************************************************
  * Private Definitions
@@ -119,6 +128,29 @@
 #define offsetof(type, member) ( (size_t) &( ( (type *) 0)->member))
 #endif
 
+#define SMART_CP_MAGIC            "SMCP"  /* Checkpoint header signature */
+#define SMART_CP_NSLOTS           2       /* Checkpoint slots (ping-pong) */
+
+#ifndef CONFIG_MTD_SMART_BGGC_WATERMARK
+#  define CONFIG_MTD_SMART_BGGC_WATERMARK 20
+#endif
+
+#ifndef CONFIG_MTD_SMART_BGGC_DELAY
+#  define CONFIG_MTD_SMART_BGGC_DELAY 100
+#endif
+
+#ifndef CONFIG_MTD_SMART_WEAR_LEVEL_THRESHOLD
+#  define CONFIG_MTD_SMART_WEAR_LEVEL_THRESHOLD 64
+#endif
+
+/* Background garbage collection is done while the free sectors are below
+ * the watermark percentage of the total sectors.
+ */
+
+#define SMART_NEEDGC(d) \
+  ((d)->freesectors < (uint32_t)(d)->totalsectors * \
+   CONFIG_MTD_SMART_BGGC_WATERMARK / 100)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -136,6 +168,19 @@ struct smart_struct_s
   FAR uint16_t         *sMap;             /* Virtual to physical sector map */
   FAR uint8_t          *releasecount;     /* Count of released sectors per erase block */
   FAR uint8_t          *freecount;        /* Count of free sectors per erase block */
+  FAR uint16_t         *erasecounts;      /* Count of erases per erase block */
+  uint16_t              allocblock;       /* Erase block sectors are allocated from */
+  uint32_t              blockerases;      /* Number of block erases */
+  uint32_t              hostwrites;       /* Sector allocations and writes requested */
+  uint32_t              flashwrites;      /* Sector writes performed on the device */
+  uint32_t              maxoptime;        /* Longest sector operation (ticks) */
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  uint32_t              wlerases;         /* blockerases at the last wear check */
+#endif
+#ifdef CONFIG_MTD_SMART_BGGC
+  sem_t                 exclsem;          /* Serializes against the GC worker */
+  struct work_s         gcwork;           /* Background garbage collection */
+#endif
   FAR char             *rwbuffer;         /* Our sector read/write buffer */
   char                  partname[SMART_PARTNAME_SIZE]; /* Optional partition name */
   uint8_t               formatversion;    /* Format version on the device */
@@ -145,6 +190,12 @@ struct smart_struct_s
   uint8_t               rootdirentries;   /* Number of root directory entries */
   uint8_t               minor;            /* Minor number of the block entry */
 #endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  uint16_t              cpblocks;         /* Erase blocks per checkpoint slot */
+  uint8_t               cpslot;           /* Slot holding the newest checkpoint */
+  bool                  cpclean;          /* Newest checkpoint matches the RAM map */
+  uint32_t              cpseq;            /* Sequence number of newest checkpoint */
+#endif
 };
 
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
@@ -171,6 +222,26 @@ struct smart_sect_header_s
                                            * Bit 1-0: Format version    */
 };
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+/* A checkpoint slot holds this header in its first sector, followed (at
+ * the start of the second sector) by a verbatim copy of the sMap,
+ * releasecount and freecount arrays.
+ */
+
+struct smart_cphdr_s
+{
+  uint8_t               magic[4];         /* SMART_CP_MAGIC */
+  uint8_t               valid;            /* Erased = valid, programmed = stale */
+  uint8_t               reserved[3];
+  uint32_t              seq;              /* Incrementing checkpoint number */
+  uint16_t              sectorsize;       /* Geometry the map was built for */
+  uint16_t              totalsectors;
+  uint16_t              neraseblocks;
+  uint16_t              freesectors;      /* Total number of free sectors */
+  uint32_t              crc;              /* CRC32 of the map and seq..freesectors */
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -187,6 +258,16 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
 #endif
 static int     smart_geometry(FAR struct inode *inode, struct geometry *geometry);
 static int     smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg);
+#if defined(CONFIG_MTD_SMART_CHECKPOINT) && defined(CONFIG_FS_WRITABLE)
+static int     smart_cpinvalidate(FAR struct smart_struct_s *dev);
+static int     smart_cpwrite(FAR struct smart_struct_s *dev);
+#endif
+#ifdef CONFIG_FS_WRITABLE
+static int     smart_erase(FAR struct smart_struct_s *dev, uint16_t block);
+#endif
+#ifdef CONFIG_MTD_SMART_BGGC
+static void    smart_schedgc(FAR struct smart_struct_s *dev);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -210,6 +291,29 @@ static const struct block_operations g_bops =
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: smart_semtake / smart_semgive
+ *
+ * Description: Serialize device access with the background garbage
+ *              collection worker.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_semtake(FAR struct smart_struct_s *dev)
+{
+  while (sem_wait(&dev->exclsem) != 0)
+    {
+      ASSERT(get_errno() == EINTR);
+    }
+}
+
+#  define smart_semgive(d) sem_post(&(d)->exclsem)
+#else
+#  define smart_semtake(d)
+#  define smart_semgive(d)
+#endif
+
 /****************************************************************************
  * Name: smart_open
  *
@@ -232,8 +336,37 @@ static int smart_open(FAR struct inode *inode)
 
 static int smart_close(FAR struct inode *inode)
 {
+#if defined(CONFIG_MTD_SMART_CHECKPOINT) && defined(CONFIG_FS_WRITABLE)
+  struct smart_struct_s *dev;
+  int ret;
+
+  fvdbg("Entry\n");
+
+  DEBUGASSERT(inode && inode->i_private);
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  dev = ((struct smart_multiroot_device_s*) inode->i_private)->dev;
+#else
+  dev = (struct smart_struct_s *)inode->i_private;
+#endif
+
+  /* Save the sector map so that the next mount does not need a scan */
+
+  smart_semtake(dev);
+#ifdef CONFIG_MTD_SMART_BGGC
+  /* Don't let a pending background collection change the map after the
+   * checkpoint was written.
+   */
+
+  (void)work_cancel(LPWORK, &dev->gcwork);
+#endif
+
+  ret = smart_cpwrite(dev);
+  smart_semgive(dev);
+  return ret;
+#else
   fvdbg("Entry\n");
   return OK;
+#endif
 }
 
 /****************************************************************************
@@ -326,7 +459,16 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
   dev = (struct smart_struct_s *)inode->i_private;
 #endif
 
-  /* I think maybe we need to lock on a mutex here */
+  smart_semtake(dev);
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  ret = smart_cpinvalidate(dev);
+  if (ret < 0)
+    {
+      smart_semgive(dev);
+      return ret;
+    }
+#endif
 
   /* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
    * per erase block is a power of 2, and (2) the erase begins with that same
@@ -361,13 +503,11 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
           /* Erase the erase block */
 
           eraseblock = alignedblock / mtdBlksPerErase;
-          ret = MTD_ERASE(dev->mtd, eraseblock, 1);
+          ret = smart_erase(dev, eraseblock);
           if (ret < 0)
             {
               fdbg("Erase block=%d failed: %d\n", eraseblock, ret);
-
-              /* Unlock the mutex if we add one */
-
+              smart_semgive(dev);
               return ret;
             }
         }
@@ -394,9 +534,7 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
           /* The block is not empty!!  What to do? */
 
           fdbg("Write block %d failed: %d.\n", nextblock, nxfrd);
-
-          /* Unlock the mutex if we add one */
-
+          smart_semgive(dev);
           return -EIO;
         }
 
@@ -408,6 +546,7 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
       alignedblock += mtdBlksPerErase;
     }
 
+  smart_semgive(dev);
   return nsectors;
 }
 #endif /* CONFIG_FS_WRITABLE */
@@ -448,7 +587,7 @@ static int smart_geometry(FAR struct inode *inode, struct geometry *geometry)
           erasesize = 65536;
         }
 
-      geometry->geo_nsectors      = dev->geo.neraseblocks * erasesize /
+      geometry->geo_nsectors      = dev->neraseblocks * erasesize /
                                      dev->sectorsize;
       geometry->geo_sectorsize    = dev->sectorsize;
 
@@ -463,6 +602,21 @@ static int smart_geometry(FAR struct inode *inode, struct geometry *geometry)
   return -EINVAL;
 }
 
+/****************************************************************************
+ * Name: smart_mapsize
+ *
+ * Description: Returns the size of the sector map allocation: the sMap
+ *              followed by the releasecount, freecount and erasecounts
+ *              arrays.
+ *
+ ****************************************************************************/
+
+static inline size_t smart_mapsize(uint32_t totalsectors, uint16_t neraseblocks)
+{
+  return totalsectors * sizeof(uint16_t) +
+         neraseblocks * (2 + sizeof(uint16_t));
+}
+
 /****************************************************************************
  * Name: smart_setsectorsize
  *
@@ -483,6 +637,13 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
       size = CONFIG_MTD_SMART_SECTOR_SIZE;
     }
 
+  /* Nothing changes if the size is the same.  Keep the erase counts. */
+
+  if (dev->sMap != NULL && size == dev->sectorsize)
+    {
+      return OK;
+    }
+
   erasesize = dev->geo.erasesize;
   dev->neraseblocks = dev->geo.neraseblocks;
 
@@ -499,6 +660,25 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
   dev->mtdBlksPerSector = dev->sectorsize / dev->geo.blocksize;
   dev->sectorsPerBlk = erasesize / dev->sectorsize;
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Reserve the erase blocks at the end of the device for the checkpoint
+   * slots.  Each slot holds a header sector plus the sector map and the
+   * per erase block counts.
+   */
+
+  totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
+  dev->cpblocks = (size + smart_mapsize(totalsectors, dev->neraseblocks) +
+                   erasesize - 1) / erasesize;
+
+  if (dev->cpblocks * SMART_CP_NSLOTS >= dev->neraseblocks)
+    {
+      fdbg("Device too small for SMART checkpoints\n");
+      return -EINVAL;
+    }
+
+  dev->neraseblocks -= dev->cpblocks * SMART_CP_NSLOTS;
+#endif
+
   /* Release any existing rwbuffer and sMap */
 
   if (dev->sMap != NULL)
@@ -518,8 +698,8 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
   totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
   dev->totalsectors = (uint16_t) totalsectors;
 
-  dev->sMap = (uint16_t *) kmm_malloc(totalsectors * sizeof(uint16_t) +
-              (dev->neraseblocks << 1));
+  dev->sMap = (uint16_t *) kmm_malloc(smart_mapsize(totalsectors,
+                                                    dev->neraseblocks));
   if (!dev->sMap)
     {
       fdbg("Error allocating SMART virtual map buffer\n");
@@ -529,6 +709,9 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
 
   dev->releasecount = (uint8_t *) dev->sMap + (totalsectors * sizeof(uint16_t));
   dev->freecount = dev->releasecount + dev->neraseblocks;
+  dev->erasecounts = (uint16_t *) (dev->freecount + dev->neraseblocks);
+  memset(dev->erasecounts, 0, dev->neraseblocks * sizeof(uint16_t));
+  dev->allocblock = 0xFFFF;
 
   /* Allocate a read/write buffer */
 
@@ -614,6 +797,336 @@ errout:
   return ret;
 }
 
+/****************************************************************************
+ * Name: smart_checkformat
+ *
+ * Description: Validates the format signature in the physical sector at
+ *              readaddress, which claims to be logical sector zero, and
+ *              records the format information.  Returns -EINVAL if the
+ *              signature is not valid.
+ *
+ ****************************************************************************/
+
+static int smart_checkformat(struct smart_struct_s *dev, size_t readaddress)
+{
+  int       ret;
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  int       x;
+  char      devname[22];
+  struct    smart_multiroot_device_s *rootdirdev;
+#endif
+
+  /* Read the sector data */
+
+  ret = MTD_READ(dev->mtd, readaddress, 32,
+                 (uint8_t*) dev->rwbuffer);
+  if (ret != 32)
+    {
+      fdbg("Error reading physical sector %d.\n",
+           readaddress / dev->geo.blocksize / dev->mtdBlksPerSector);
+      return -EIO;
+    }
+
+  /* Validate the format signature */
+
+  if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
+      dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
+      dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
+      dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
+   {
+     return -EINVAL;
+   }
+
+  /* TODO: May want to validate / save the erase block aging info */
+
+  /* Mark the volume as formatted and set the sector size */
+
+  dev->formatstatus = SMART_FMT_STAT_FORMATTED;
+  dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
+  dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
+
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
+
+  /* If rootdirentries is greater than 1, then we need to register
+   * additional block devices.
+   */
+
+  for (x = 1; x < dev->rootdirentries; x++)
+    {
+      if (dev->partname[0] != '\0')
+        {
+          snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d",
+                  dev->minor, dev->partname, x+1);
+        }
+      else
+        {
+          snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor,
+                   x + 1);
+        }
+
+      /* Inode private data is a reference to a struct containing
+       * the SMART device structure and the root directory number.
+       */
+
+      rootdirdev = (struct smart_multiroot_device_s*) kmm_malloc(sizeof(*rootdirdev));
+      if (rootdirdev == NULL)
+        {
+          fdbg("Memory alloc failed\n");
+          return -ENOMEM;
+        }
+
+      /* Populate the rootdirdev */
+
+      rootdirdev->dev = dev;
+      rootdirdev->rootdirnum = x;
+      ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
+
+      /* Inode private data is a reference to the SMART device structure */
+
+      ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
+    }
+#endif
+
+  return OK;
+}
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+/****************************************************************************
+ * Name: smart_cpaddress
+ *
+ * Description: Returns the byte address of the given checkpoint slot.
+ *
+ ****************************************************************************/
+
+static inline size_t smart_cpaddress(struct smart_struct_s *dev, int slot)
+{
+  return (size_t)(dev->neraseblocks + slot * dev->cpblocks) *
+         dev->sectorsPerBlk * dev->sectorsize;
+}
+
+/****************************************************************************
+ * Name: smart_cpcrc
+ *
+ * Description: Calculates the CRC of the in-memory sector map and the
+ *              checkpoint header fields that describe it.
+ *
+ ****************************************************************************/
+
+static uint32_t smart_cpcrc(struct smart_struct_s *dev,
+                            FAR const struct smart_cphdr_s *hdr)
+{
+  uint32_t crc;
+
+  crc = crc32((FAR const uint8_t *)dev->sMap,
+              smart_mapsize(dev->totalsectors, dev->neraseblocks));
+  return crc32part((FAR const uint8_t *)&hdr->seq,
+                   offsetof(struct smart_cphdr_s, crc) -
+                   offsetof(struct smart_cphdr_s, seq), crc);
+}
+
+/****************************************************************************
+ * Name: smart_cpload
+ *
+ * Description: Loads the sector map and erase block counts from the newest
+ *              checkpoint on the device.  The checkpoint is only used if it
+ *              was not invalidated by a later modification, matches the
+ *              current geometry and passes its CRC check.  Otherwise a full
+ *              scan is required.
+ *
+ ****************************************************************************/
+
+static int smart_cpload(struct smart_struct_s *dev)
+{
+  struct    smart_cphdr_s hdr;
+  struct    smart_cphdr_s newest;
+  size_t    len;
+  int       slot;
+  int       ret;
+
+  /* Find the slot with the highest sequence number */
+
+  newest.seq = 0;
+  for (slot = 0; slot < SMART_CP_NSLOTS; slot++)
+    {
+      ret = MTD_READ(dev->mtd, smart_cpaddress(dev, slot),
+                     sizeof(struct smart_cphdr_s), (uint8_t *) &hdr);
+      if (ret != sizeof(struct smart_cphdr_s))
+        {
+          return -EIO;
+        }
+
+      if (memcmp(hdr.magic, SMART_CP_MAGIC, 4) == 0 && hdr.seq >= newest.seq)
+        {
+          memcpy(&newest, &hdr, sizeof(struct smart_cphdr_s));
+          dev->cpslot = slot;
+          dev->cpseq  = hdr.seq;
+        }
+    }
+
+  if (newest.seq == 0)
+    {
+      return -ENOENT;
+    }
+
+  if (newest.sectorsize != dev->sectorsize ||
+      newest.totalsectors != dev->totalsectors ||
+      newest.neraseblocks != dev->neraseblocks)
+    {
+      fdbg("SMART checkpoint geometry mismatch\n");
+      return -EINVAL;
+    }
+
+  /* Read the map directly into place and verify it */
+
+  len = smart_mapsize(dev->totalsectors, dev->neraseblocks);
+  ret = MTD_READ(dev->mtd, smart_cpaddress(dev, dev->cpslot) + dev->sectorsize,
+                 len, (uint8_t *) dev->sMap);
+  if (ret != len || smart_cpcrc(dev, &newest) != newest.crc)
+    {
+      fdbg("SMART checkpoint %d CRC error\n", newest.seq);
+      memset(dev->erasecounts, 0, dev->neraseblocks * sizeof(uint16_t));
+      return -EINVAL;
+    }
+
+  /* Only the newest checkpoint can describe the current state of the
+   * device.  If it was invalidated, the device was modified afterwards
+   * and not checkpointed again (i.e., it was not cleanly unmounted).  The
+   * erase counts are still close enough to be kept.
+   */
+
+  if (newest.valid != CONFIG_SMARTFS_ERASEDSTATE)
+    {
+      return -ENOENT;
+    }
+
+  dev->freesectors = newest.freesectors;
+  dev->cpclean = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_cpinvalidate
+ *
+ * Description: Marks the newest checkpoint stale before the first change
+ *              to the sector map after it was written.  This costs a single
+ *              byte write per checkpoint.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static int smart_cpinvalidate(FAR struct smart_struct_s *dev)
+{
+  size_t    offset;
+  uint8_t   byte;
+  int       ret;
+
+  if (!dev->cpclean)
+    {
+      return OK;
+    }
+
+  byte   = (uint8_t) ~CONFIG_SMARTFS_ERASEDSTATE;
+  offset = smart_cpaddress(dev, dev->cpslot) +
+           offsetof(struct smart_cphdr_s, valid);
+  ret = smart_bytewrite(dev, offset, 1, &byte);
+  if (ret != 1)
+    {
+      fdbg("Error invalidating checkpoint %d\n", dev->cpseq);
+      return ret < 0 ? ret : -EIO;
+    }
+
+  dev->cpclean = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_cpwrite
+ *
+ * Description: Writes the sector map and erase block counts to the older
+ *              checkpoint slot if the map changed since the last
+ *              checkpoint.  The header is written last so that an
+ *              interrupted checkpoint is never mistaken for a valid one.
+ *
+ ****************************************************************************/
+
+static int smart_cpwrite(FAR struct smart_struct_s *dev)
+{
+  struct    smart_cphdr_s hdr;
+  size_t    address;
+  size_t    len;
+  size_t    offset;
+  size_t    nbytes;
+  int       slot;
+  int       ret;
+
+  if (dev->cpclean)
+    {
+      return OK;
+    }
+
+  /* Erase the slot not holding the newest checkpoint */
+
+  slot    = dev->cpslot ^ 1;
+  address = smart_cpaddress(dev, slot);
+  ret = MTD_ERASE(dev->mtd, dev->neraseblocks + slot * dev->cpblocks,
+                  dev->cpblocks);
+  if (ret < 0)
+    {
+      fdbg("Error %d erasing checkpoint slot %d\n", -ret, slot);
+      return ret;
+    }
+
+  /* Write the map one sector at a time, starting at the second sector */
+
+  len = smart_mapsize(dev->totalsectors, dev->neraseblocks);
+  for (offset = 0; offset < len; offset += nbytes)
+    {
+      nbytes = len - offset;
+      if (nbytes > dev->sectorsize)
+        {
+          nbytes = dev->sectorsize;
+        }
+
+      ret = smart_bytewrite(dev, address + dev->sectorsize + offset, nbytes,
+                            (FAR const uint8_t *)dev->sMap + offset);
+      if (ret != nbytes)
+        {
+          fdbg("Error writing checkpoint map\n");
+          return -EIO;
+        }
+    }
+
+  /* Now write the header */
+
+  memset(&hdr, 0, sizeof(struct smart_cphdr_s));
+  memcpy(hdr.magic, SMART_CP_MAGIC, 4);
+  hdr.valid        = CONFIG_SMARTFS_ERASEDSTATE;
+  hdr.seq          = dev->cpseq + 1;
+  hdr.sectorsize   = dev->sectorsize;
+  hdr.totalsectors = dev->totalsectors;
+  hdr.neraseblocks = dev->neraseblocks;
+  hdr.freesectors  = dev->freesectors;
+  hdr.crc          = smart_cpcrc(dev, &hdr);
+
+  ret = smart_bytewrite(dev, address, sizeof(struct smart_cphdr_s),
+                        (FAR const uint8_t *)&hdr);
+  if (ret != sizeof(struct smart_cphdr_s))
+    {
+      fdbg("Error writing checkpoint header\n");
+      return -EIO;
+    }
+
+  fvdbg("Checkpoint %d written to slot %d\n", hdr.seq, slot);
+
+  dev->cpseq   = hdr.seq;
+  dev->cpslot  = slot;
+  dev->cpclean = true;
+  return OK;
+}
+#endif /* CONFIG_FS_WRITABLE */
+#endif /* CONFIG_MTD_SMART_CHECKPOINT */
+
 /****************************************************************************
  * Name: smart_scan
  *
@@ -635,11 +1148,6 @@ static int smart_scan(struct smart_struct_s *dev)
   uint16_t  seq2;
   size_t    readaddress;
   struct    smart_sect_header_s header;
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-  int       x;
-  char      devname[22];
-  struct    smart_multiroot_device_s *rootdirdev;
-#endif
 
   fvdbg("Entry\n");
 
@@ -677,6 +1185,28 @@ static int smart_scan(struct smart_struct_s *dev)
   dev->formatstatus = SMART_FMT_STAT_NOFMT;
   dev->freesectors = totalsectors;
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Use the checkpoint if the device was cleanly unmounted.  Only the
+   * format sector then needs to be read.
+   */
+
+  if (smart_cpload(dev) == OK)
+    {
+      if (dev->sMap[0] != 0xFFFF)
+        {
+          ret = smart_checkformat(dev, dev->sMap[0] * dev->mtdBlksPerSector *
+                                  dev->geo.blocksize);
+          if (ret < 0 && ret != -EINVAL)
+            {
+              goto err_out;
+            }
+        }
+
+      fvdbg("SMART map loaded from checkpoint %d\n", dev->cpseq);
+      return OK;
+    }
+#endif
+
   /* Initialize the freecount and releasecount arrays */
 
   for (sector = 0; sector < dev->neraseblocks; sector++)
@@ -769,80 +1299,18 @@ static int smart_scan(struct smart_struct_s *dev)
 
       if (logicalsector == 0)
         {
-          /* Read the sector data */
-
-          ret = MTD_READ(dev->mtd, readaddress, 32,
-                         (uint8_t*) dev->rwbuffer);
-          if (ret != 32)
+          ret = smart_checkformat(dev, readaddress);
+          if (ret == -EINVAL)
             {
-              fdbg("Error reading physical sector %d.\n", sector);
-              goto err_out;
-            }
-
-          /* Validate the format signature */
-
-          if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
-              dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
-              dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
-              dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
-           {
-             /* Invalid signature on a sector claiming to be sector 0!
-              * What should we do?  Release it?*/
-
-             continue;
-           }
-
-          /* TODO: May want to validate / save the erase block aging info */
-
-          /* Mark the volume as formatted and set the sector size */
-
-          dev->formatstatus = SMART_FMT_STAT_FORMATTED;
-          dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
-          dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
-
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-          dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
-
-          /* If rootdirentries is greater than 1, then we need to register
-           * additional block devices.
-           */
+              /* Invalid signature on a sector claiming to be sector 0!
+               * What should we do?  Release it?*/
 
-          for (x = 1; x < dev->rootdirentries; x++)
+              continue;
+            }
+          else if (ret < 0)
             {
-              if (dev->partname[0] != '\0')
-                {
-                  snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d",
-                          dev->minor, dev->partname, x+1);
-                }
-              else
-                {
-                  snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor,
-                           x + 1);
-                }
-
-              /* Inode private data is a reference to a struct containing
-               * the SMART device structure and the root directory number.
-               */
-
-              rootdirdev = (struct smart_multiroot_device_s*) kmm_malloc(sizeof(*rootdirdev));
-              if (rootdirdev == NULL)
-                {
-                  fdbg("Memory alloc failed\n");
-                  ret = -ENOMEM;
-                  goto err_out;
-                }
-
-              /* Populate the rootdirdev */
-
-              rootdirdev->dev = dev;
-              rootdirdev->rootdirnum = x;
-              ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
-
-              /* Inode private data is a reference to the SMART device structure */
-
-              ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
+              goto err_out;
             }
-#endif
         }
 
       /* Test for duplicate logical sectors on the device */
@@ -1041,6 +1509,22 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
       return ret;
     }
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The checkpoint slots were erased too */
+
+  dev->cpclean = false;
+#endif
+
+  if (dev->sMap != NULL)
+    {
+      for (x = 0; x < dev->neraseblocks; x++)
+        {
+          dev->erasecounts[x]++;
+        }
+
+      dev->blockerases += dev->neraseblocks;
+    }
+
   /* Now construct a logical sector zero header to write to the device.
    * We fill it with zero so when we add sector aging, all the sector
    * ages will already be initialized to zero without needing special
@@ -1101,123 +1585,461 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
       return ret;
     }
 
-  dev->formatstatus = SMART_FMT_STAT_UNKNOWN;
-  dev->freesectors = dev->neraseblocks * dev->sectorsPerBlk - 1;
-  for (x = 0; x < dev->neraseblocks; x++)
-    {
-      /* Initialize the released and free counts */
+  dev->formatstatus = SMART_FMT_STAT_UNKNOWN;
+  dev->freesectors = dev->neraseblocks * dev->sectorsPerBlk - 1;
+  for (x = 0; x < dev->neraseblocks; x++)
+    {
+      /* Initialize the released and free counts */
+
+      dev->releasecount[x] = 0;
+      dev->freecount[x] = dev->sectorsPerBlk;
+    }
+
+  /* Account for the format sector */
+
+  dev->freecount[0]--;
+
+  /* Now initialize the logical to physical sector map */
+
+  dev->sMap[0] = 0;     /* Logical sector zero = physical sector 0 */
+
+  totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
+  for (x = 1; x < totalsectors; x++)
+    {
+      /* Mark all other logical sectors as non-existant */
+
+      dev->sMap[x] = -1;
+    }
+
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+
+  /* Un-register any extra directory device entries */
+
+  for (x = 2; x < 8; x++)
+    {
+      snprintf(dev->rwbuffer, 18, "/dev/smart%dd%d", dev->minor, x);
+      unregister_blockdriver(dev->rwbuffer);
+    }
+#endif
+
+  return OK;
+}
+#endif /* CONFIG_FS_WRITABLE */
+
+/****************************************************************************
+ * Name: smart_erase
+ *
+ * Description:  Erases an erase block and updates its erase count.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static int smart_erase(FAR struct smart_struct_s *dev, uint16_t block)
+{
+  int ret;
+
+  ret = MTD_ERASE(dev->mtd, block, 1);
+  if (ret >= 0)
+    {
+      dev->erasecounts[block]++;
+      dev->blockerases++;
+    }
+
+  return ret;
+}
+#endif /* CONFIG_FS_WRITABLE */
+
+/****************************************************************************
+ * Name: smart_findfreephyssector
+ *
+ * Description:  Finds a free physical sector based on free and released
+ *               count logic, taking into account reserved sectors.
+ *
+ *               Sectors are allocated from one erase block until it is
+ *               full.  Since the sectors of an erase block are allocated in
+ *               order, its free sectors are the last freecount sectors and
+ *               the next one is found without a search.
+ *
+ ****************************************************************************/
+
+static int smart_findfreephyssector(struct smart_struct_s *dev)
+{
+  uint16_t  allocfreecount;
+  uint16_t  allocblock;
+  uint16_t  physicalsector;
+  uint16_t  x;
+  uint32_t  readaddr;
+  struct    smart_sect_header_s header;
+  int       ret;
+
+  /* Determine which erase block we should allocate the new
+   * sector from. This is based on the number of free sectors
+   * available in each erase block.  Among erased blocks, the
+   * least worn one is used. */
+
+  if (dev->allocblock >= dev->neraseblocks ||
+      dev->freecount[dev->allocblock] == 0)
+    {
+      allocfreecount = 0;
+      allocblock = 0xFFFF;
+      for (x = 0; x < dev->neraseblocks; x++)
+        {
+          /* Test if this block has more free blocks than the
+           * currently selected block */
+
+          if (dev->freecount[x] > allocfreecount ||
+              (allocfreecount > 0 && dev->freecount[x] == allocfreecount &&
+               dev->erasecounts[x] < dev->erasecounts[allocblock]))
+            {
+              /* Assign this block to alloc from */
+
+              allocblock = x;
+              allocfreecount = dev->freecount[x];
+            }
+        }
+
+      /* Check if we found an allocblock. */
+
+      if (allocblock == 0xFFFF)
+        {
+          /* No free sectors found!  Bug? */
+          return -EIO;
+        }
+
+      dev->allocblock = allocblock;
+    }
+
+  allocblock = dev->allocblock;
+
+  /* Verify that the next sector in the block is really free.  This is
+   * only not the case if the counts don't match the media (e.g. after an
+   * interrupted write), then search the whole block.
+   */
+
+  physicalsector = (allocblock + 1) * dev->sectorsPerBlk -
+                   dev->freecount[allocblock];
+  x = physicalsector;
+
+  do
+    {
+      /* Check if this physical sector is available */
+
+      readaddr = x * dev->mtdBlksPerSector * dev->geo.blocksize;
+      ret = MTD_READ(dev->mtd, readaddr, sizeof(struct smart_sect_header_s),
+              (uint8_t *) &header);
+      if (ret != sizeof(struct smart_sect_header_s))
+        {
+          fvdbg("Error reading phys sector %d\n", x);
+          return -EIO;
+        }
+
+      if ((*((uint16_t *) header.logicalsector) == 0xFFFF) &&
+          (*((uint16_t *) header.seq) == 0xFFFF) &&
+          ((header.status & SMART_STATUS_COMMITTED) ==
+           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)))
+        {
+          return x;
+        }
+
+      if (x == physicalsector)
+        {
+          x = allocblock * dev->sectorsPerBlk;
+        }
+      else
+        {
+          x++;
+        }
+    }
+  while (x < (allocblock + 1) * dev->sectorsPerBlk);
+
+  return 0xFFFF;
+}
+
+/****************************************************************************
+ * Name: smart_relocateblock
+ *
+ * Description:  Moves all live sectors out of an erase block and erases
+ *               it.  The released sectors in the block become free.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static int smart_relocateblock(struct smart_struct_s *dev, uint16_t collectblock)
+{
+  uint16_t  newsector;
+  int       x;
+  int       ret;
+  size_t    offset;
+  struct    smart_sect_header_s *header;
+  uint8_t   newstatus;
+
+  fdbg("Collecting block %d, free=%d released=%d\n",
+      collectblock, dev->freecount[collectblock],
+      dev->releasecount[collectblock]);
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The relocation changes the sector map and erases the block.  This may
+   * run in the background after a checkpoint was written.
+   */
+
+  ret = smart_cpinvalidate(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
+#endif
+
+  /* First mark the block as having no free sectors so we don't
+   * try to move sectors into the block we are trying to erase.
+   */
+
+  dev->freecount[collectblock] = 0;
+
+  /* Next move all live data in the block to a new home. */
+
+  for (x = collectblock * dev->sectorsPerBlk; x <
+     (collectblock + 1) * dev->sectorsPerBlk; x++)
+    {
+      /* Read the next sector from this erase block */
+
+      ret = MTD_BREAD(dev->mtd, x * dev->mtdBlksPerSector,
+          dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
+      if (ret != dev->mtdBlksPerSector)
+        {
+          fdbg("Error reading sector %d\n", x);
+          return -EIO;
+        }
+
+      /* Test if if the block is in use */
+
+      header = (struct smart_sect_header_s *) dev->rwbuffer;
+      if (((header->status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)) ||
+          ((header->status & SMART_STATUS_RELEASED) !=
+           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED)))
+        {
+          /* This sector doesn't have live data (free or released).
+           * just continue to the next sector and don't move it.
+           */
+
+          continue;
+        }
+
+      /* Find a new sector where it can live, NOT in this erase block */
+
+      newsector = smart_findfreephyssector(dev);
+      if (newsector == 0xFFFF)
+        {
+          /* Unable to find a free sector!!! */
+
+          fdbg("Can't find a free sector for relocation\n");
+          return -EIO;
+        }
+
+      /* Increment the sequence number and clear the "commit" flag */
+
+      (*((uint16_t *) header->seq))++;
+      if (*((uint16_t *) header->seq) == 0xFFFF)
+        {
+          *((uint16_t *) header->seq) = 1;
+        }
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      header->status |= SMART_STATUS_COMMITTED;
+#else
+      header->status &= ~SMART_STATUS_COMMITTED;
+#endif
+
+      /* Write the data to the new physical sector location */
 
-      dev->releasecount[x] = 0;
-      dev->freecount[x] = dev->sectorsPerBlk;
-    }
+      ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector,
+                       dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
+      dev->flashwrites++;
 
-  /* Account for the format sector */
+      /* Commit the sector */
 
-  dev->freecount[0]--;
+      offset = newsector * dev->mtdBlksPerSector * dev->geo.blocksize +
+          offsetof(struct smart_sect_header_s, status);
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      newstatus = header->status & ~SMART_STATUS_COMMITTED;
+#else
+      newstatus = header->status | SMART_STATUS_COMMITTED;
+#endif
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d committing new sector %d\n", -ret, newsector);
+          return ret;
+        }
 
-  /* Now initialize the logical to physical sector map */
+      /* Release the old physical sector */
 
-  dev->sMap[0] = 0;     /* Logical sector zero = physical sector 0 */
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      newstatus = header->status & ~SMART_STATUS_RELEASED;
+#else
+      newstatus = header->status | SMART_STATUS_RELEASED;
+#endif
+      offset = x * dev->mtdBlksPerSector * dev->geo.blocksize +
+          offsetof(struct smart_sect_header_s, status);
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d releasing old sector %d\n", -ret, x);
+          return ret;
+        }
 
-  totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
-  for (x = 1; x < totalsectors; x++)
-    {
-      /* Mark all other logical sectors as non-existant */
+      /* Update the variables */
 
-      dev->sMap[x] = -1;
+      dev->sMap[*((uint16_t *) header->logicalsector)] = newsector;
+      dev->freecount[newsector / dev->sectorsPerBlk]--;
     }
 
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  /* Now erase the erase block */
 
-  /* Un-register any extra directory device entries */
+  smart_erase(dev, collectblock);
 
-  for (x = 2; x < 8; x++)
+  dev->freesectors += dev->releasecount[collectblock];
+  dev->freecount[collectblock] = dev->sectorsPerBlk;
+  dev->releasecount[collectblock] = 0;
+
+  /* If this is block zero, then be sure to write the sector size */
+
+  if (collectblock == 0)
     {
-      snprintf(dev->rwbuffer, 18, "/dev/smart%dd%d", dev->minor, x);
-      unregister_blockdriver(dev->rwbuffer);
-    }
+      /* Set the sector size in the 1st header */
+
+      uint8_t sectsize = dev->sectorsize >> 7;
+#if ( CONFIG_SMARTFS_ERASEDSTATE == 0xFF )
+      newstatus = (uint8_t) ~SMART_STATUS_SIZEBITS | sectsize;
+#else
+      newstatus = (uint8_t) sectsize;
 #endif
+      /* Write the sector size to the device */
+
+      offset = offsetof(struct smart_sect_header_s, status);
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d setting sector 0 size\n", -ret);
+        }
+    }
 
   return OK;
 }
 #endif /* CONFIG_FS_WRITABLE */
 
 /****************************************************************************
- * Name: smart_findfreephyssector
+ * Name: smart_findcollectblock
  *
- * Description:  Finds a free physical sector based on free and released
- *               count logic, taking into account reserved sectors.
+ * Description:  Returns the erase block with the most released sectors, or
+ *               0xFFFF if there are no released sectors.  The total number
+ *               of released sectors is returned in releasedsectors.
  *
  ****************************************************************************/
 
-static int smart_findfreephyssector(struct smart_struct_s *dev)
+#ifdef CONFIG_FS_WRITABLE
+static uint16_t smart_findcollectblock(struct smart_struct_s *dev,
+                                       FAR uint16_t *releasedsectors)
 {
-  uint16_t  allocfreecount;
-  uint16_t  allocblock;
-  uint16_t  physicalsector;
-  uint16_t  x;
-  uint32_t  readaddr;
-  struct    smart_sect_header_s header;
-  int       ret;
-
-  /* Determine which erase block we should allocate the new
-   * sector from. This is based on the number of free sectors
-   * available in each erase block. */
+  uint16_t  collectblock;
+  uint16_t  releasemax;
+  int       x;
 
-  allocfreecount = 0;
-  allocblock = 0xFFFF;
-  physicalsector = 0xFFFF;
+  *releasedsectors = 0;
+  collectblock = 0xFFFF;
+  releasemax = 0;
   for (x = 0; x < dev->neraseblocks; x++)
     {
-      /* Test if this block has more free blocks than the
-       * currently selected block */
-
-      if (dev->freecount[x] > allocfreecount)
+      *releasedsectors += dev->releasecount[x];
+      if (dev->releasecount[x] > releasemax)
         {
-          /* Assign this block to alloc from */
-
-          allocblock = x;
-          allocfreecount = dev->freecount[x];
+          releasemax = dev->releasecount[x];
+          collectblock = x;
         }
     }
 
-  /* Check if we found an allocblock. */
+  return collectblock;
+}
+#endif /* CONFIG_FS_WRITABLE */
+
+/****************************************************************************
+ * Name: smart_wearlevel
+ *
+ * Description:  Performs static wear leveling.  When the erase count of
+ *               the least worn erase block holding data falls too far
+ *               behind the most worn block, its (cold) data is moved out so
+ *               that the block is reused for new writes.  This is only
+ *               checked after an erase block was erased.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_FS_WRITABLE) && defined(CONFIG_MTD_SMART_WEAR_LEVEL)
+static int smart_wearlevel(struct smart_struct_s *dev)
+{
+  uint16_t  minblock;
+  uint16_t  maxerases;
+  uint16_t  live;
+  int       x;
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  int       ret;
+#endif
 
-  if (allocblock == 0xFFFF)
+  if (dev->wlerases == dev->blockerases)
     {
-      /* No free sectors found!  Bug? */
-      return -EIO;
+      return OK;
     }
 
-  /* Now find a free physical sector within this selected
-   * erase block to allocate. */
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The erase counts and possibly the sector map are about to change */
 
-  for (x = allocblock * dev->sectorsPerBlk;
-          x < (allocblock+1) * dev->sectorsPerBlk; x++)
+  ret = smart_cpinvalidate(dev);
+  if (ret < 0)
     {
-      /* Check if this physical sector is available */
+      return ret;
+    }
+#endif
 
-      readaddr = x * dev->mtdBlksPerSector * dev->geo.blocksize;
-      ret = MTD_READ(dev->mtd, readaddr, sizeof(struct smart_sect_header_s),
-              (uint8_t *) &header);
-      if (ret != sizeof(struct smart_sect_header_s))
+  dev->wlerases = dev->blockerases;
+
+  minblock = 0xFFFF;
+  maxerases = 0;
+  for (x = 0; x < dev->neraseblocks; x++)
+    {
+      if (dev->erasecounts[x] > maxerases)
         {
-          fvdbg("Error reading phys sector %d\n", physicalsector);
-          return -EIO;
+          maxerases = dev->erasecounts[x];
         }
 
-      if ((*((uint16_t *) header.logicalsector) == 0xFFFF) &&
-          (*((uint16_t *) header.seq) == 0xFFFF) &&
-          ((header.status & SMART_STATUS_COMMITTED) ==
-           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)))
+      if (x != dev->allocblock &&
+          dev->freecount[x] + dev->releasecount[x] < dev->sectorsPerBlk &&
+          (minblock == 0xFFFF ||
+           dev->erasecounts[x] < dev->erasecounts[minblock]))
         {
-          physicalsector = x;
-          break;
+          minblock = x;
         }
     }
 
-  return physicalsector;
+  if (minblock == 0xFFFF ||
+      maxerases - dev->erasecounts[minblock] <
+      CONFIG_MTD_SMART_WEAR_LEVEL_THRESHOLD)
+    {
+      return OK;
+    }
+
+  /* Make sure the live sectors fit without touching the reserve */
+
+  live = dev->sectorsPerBlk - dev->freecount[minblock] -
+         dev->releasecount[minblock];
+  if (dev->freesectors <= live + dev->sectorsPerBlk + 4)
+    {
+      return OK;
+    }
+
+  fvdbg("Wear leveling block %d, erases=%d max=%d\n", minblock,
+        dev->erasecounts[minblock], maxerases);
+
+  return smart_relocateblock(dev, minblock);
 }
+#endif
 
 /****************************************************************************
  * Name: smart_garbagecollect
@@ -1233,14 +2055,8 @@ static int smart_garbagecollect(struct smart_struct_s *dev)
 {
   uint16_t  releasedsectors;
   uint16_t  collectblock;
-  uint16_t  releasemax;
-  uint16_t  newsector;
   bool      collect = TRUE;
-  int       x;
   int       ret;
-  size_t    offset;
-  struct    smart_sect_header_s *header;
-  uint8_t   newstatus;
 
   while (collect)
     {
@@ -1248,18 +2064,7 @@ static int smart_garbagecollect(struct smart_struct_s *dev)
 
       /* Calculate the number of released sectors on the device */
 
-      releasedsectors = 0;
-      collectblock = 0xFFFF;
-      releasemax = 0;
-      for (x = 0; x < dev->neraseblocks; x++)
-        {
-          releasedsectors += dev->releasecount[x];
-          if (dev->releasecount[x] > releasemax)
-            {
-              releasemax = dev->releasecount[x];
-              collectblock = x;
-            }
-        }
+      collectblock = smart_findcollectblock(dev, &releasedsectors);
 
       /* Test if the released sectors count is greater than the
        * free sectors.  If it is, then we will do garbage collection.
@@ -1281,171 +2086,119 @@ static int smart_garbagecollect(struct smart_struct_s *dev)
             {
               /* Need to collect, but no sectors with released blocks! */
 
-              ret = -ENOSPC;
-              goto errout;
+              return -ENOSPC;
             }
 
-          fdbg("Collecting block %d, free=%d released=%d\n",
-              collectblock, dev->freecount[collectblock],
-              dev->releasecount[collectblock]);
+          /* Perform collection on block with the most released sectors. */
 
-          if (dev->freecount[collectblock] == 6)
+          ret = smart_relocateblock(dev, collectblock);
+          if (ret < 0)
             {
-              fdbg("here!\n");
+              return ret;
             }
 
-          /* Perform collection on block with the most released sectors.
-           * First mark the block as having no free sectors so we don't
-           * try to move sectors into the block we are trying to erase.
+          /* Update the block aging information in the format signature sector */
+        }
+      else
+        {
+          /* Test for aging sectors and push them to a new location
+           * so we wear evenly.  With background collection, this is
+           * done by the worker instead.
            */
 
-          dev->freecount[collectblock] = 0;
-
-          /* Next move all live data in the block to a new home. */
-
-          for (x = collectblock * dev->sectorsPerBlk; x <
-             (collectblock + 1) * dev->sectorsPerBlk; x++)
-            {
-              /* Read the next sector from this erase block */
-
-              ret = MTD_BREAD(dev->mtd, x * dev->mtdBlksPerSector,
-                  dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
-              if (ret != dev->mtdBlksPerSector)
-                {
-                  fdbg("Error reading sector %d\n", x);
-                  ret = -EIO;
-                  goto errout;
-                }
-
-              /* Test if if the block is in use */
-
-              header = (struct smart_sect_header_s *) dev->rwbuffer;
-              if (((header->status & SMART_STATUS_COMMITTED) ==
-                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)) ||
-                  ((header->status & SMART_STATUS_RELEASED) !=
-                   (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED)))
-                {
-                  /* This sector doesn't have live data (free or released).
-                   * just continue to the next sector and don't move it.
-                   */
-
-                  continue;
-                }
-
-              /* Find a new sector where it can live, NOT in this erase block */
-
-              newsector = smart_findfreephyssector(dev);
-              if (newsector == 0xFFFF)
-                {
-                  /* Unable to find a free sector!!! */
-
-                  fdbg("Can't find a free sector for relocation\n");
-                  ret = -EIO;
-                  goto errout;
-                }
-
-              /* Increment the sequence number and clear the "commit" flag */
-
-              (*((uint16_t *) header->seq))++;
-              if (*((uint16_t *) header->seq) == 0xFFFF)
-                {
-                  *((uint16_t *) header->seq) = 1;
-                }
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              header->status |= SMART_STATUS_COMMITTED;
-#else
-              header->status &= ~SMART_STATUS_COMMITTED;
+#if defined(CONFIG_MTD_SMART_WEAR_LEVEL) && !defined(CONFIG_MTD_SMART_BGGC)
+          (void)smart_wearlevel(dev);
 #endif
+        }
+    }
 
-              /* Write the data to the new physical sector location */
-
-              ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector,
-                               dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
-
-              /* Commit the sector */
+  return OK;
+}
+#endif /* CONFIG_FS_WRITABLE */
 
-              offset = newsector * dev->mtdBlksPerSector * dev->geo.blocksize +
-                  offsetof(struct smart_sect_header_s, status);
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              newstatus = header->status & ~SMART_STATUS_COMMITTED;
-#else
-              newstatus = header->status | SMART_STATUS_COMMITTED;
-#endif
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d committing new sector %d\n" -ret, newsector);
-                  goto errout;
-                }
+/****************************************************************************
+ * Name: smart_gcworker
+ *
+ * Description:  Performs garbage collection on the low priority work
+ *               queue.  One erase block is collected per run while the
+ *               free sectors are below the watermark, so that foreground
+ *               operations only wait for a single block relocation.
+ *
+ ****************************************************************************/
 
-              /* Release the old physical sector */
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_gcworker(FAR void *arg)
+{
+  FAR struct smart_struct_s *dev = (FAR struct smart_struct_s *)arg;
+  uint16_t  releasedsectors;
+  uint16_t  collectblock;
+  int       ret = OK;
 
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              newstatus = header->status & ~SMART_STATUS_RELEASED;
-#else
-              newstatus = header->status | SMART_STATUS_RELEASED;
-#endif
-              offset = x * dev->mtdBlksPerSector * dev->geo.blocksize +
-                  offsetof(struct smart_sect_header_s, status);
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d releasing old sector %d\n" -ret, x);
-                  goto errout;
-                }
+  smart_semtake(dev);
 
-              /* Update the variables */
+  if (SMART_NEEDGC(dev))
+    {
+      /* Don't move a mostly live block for a few released sectors.  The
+       * foreground collection still takes care of a full device.
+       */
 
-              dev->sMap[*((uint16_t *) header->logicalsector)] = newsector;
-              dev->freecount[newsector / dev->sectorsPerBlk]--;
-            }
+      collectblock = smart_findcollectblock(dev, &releasedsectors);
+      if (collectblock != 0xFFFF &&
+          dev->releasecount[collectblock] >= (dev->sectorsPerBlk + 3) >> 2)
+        {
+          ret = smart_relocateblock(dev, collectblock);
+        }
+      else
+        {
+          /* Nothing to collect until more sectors are released */
 
-          /* Now erase the erase block */
+          ret = -ENOSPC;
+        }
+    }
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  else
+    {
+      ret = smart_wearlevel(dev);
+    }
+#endif
 
-          MTD_ERASE(dev->mtd, collectblock, 1);
+  /* Continue in the next run if more collection is needed */
 
-          dev->freesectors += dev->releasecount[collectblock];
-          dev->freecount[collectblock] = dev->sectorsPerBlk;
-          dev->releasecount[collectblock] = 0;
+  if (ret == OK)
+    {
+      smart_schedgc(dev);
+    }
 
-          /* If this is block zero, then be sure to write the sector size */
+  smart_semgive(dev);
+}
 
-          if (collectblock == 0)
-            {
-              /* Set the sector size in the 1st header */
+/****************************************************************************
+ * Name: smart_schedgc
+ *
+ * Description:  Schedules background garbage collection if the free
+ *               sectors are below the watermark (or if wear leveling must be
+ *               checked).  The caller holds the device semaphore.
+ *
+ ****************************************************************************/
 
-              uint8_t sectsize = dev->sectorsize >> 7;
-#if ( CONFIG_SMARTFS_ERASEDSTATE == 0xFF )
-              newstatus = (uint8_t) ~SMART_STATUS_SIZEBITS | sectsize;
+static void smart_schedgc(FAR struct smart_struct_s *dev)
+{
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  if (!SMART_NEEDGC(dev) && dev->wlerases == dev->blockerases)
 #else
-              newstatus = (uint8_t) sectsize;
+  if (!SMART_NEEDGC(dev))
 #endif
-              /* Write the sector size to the device */
-
-              offset = offsetof(struct smart_sect_header_s, status);
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d setting sector 0 size\n", -ret);
-                }
-            }
-
-          /* Update the block aging information in the format signature sector */
-        }
-      else
-        {
-          /* Test for aging sectors and push them to a new location
-           * so we wear evenly.
-           */
-        }
+    {
+      return;
     }
 
-  return OK;
-
-errout:
-  return ret;
+  if (work_available(&dev->gcwork))
+    {
+      (void)work_queue(LPWORK, &dev->gcwork, smart_gcworker, dev,
+                       MSEC2TICK(CONFIG_MTD_SMART_BGGC_DELAY));
+    }
 }
-#endif /* CONFIG_FS_WRITABLE */
+#endif /* CONFIG_MTD_SMART_BGGC */
 
 /****************************************************************************
  * Name: smart_writesector
@@ -1494,6 +2247,20 @@ static inline int smart_writesector(struct smart_struct_s *dev, unsigned long ar
       goto errout;
     }
 
+  dev->hostwrites++;
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* The write may relocate the sector.  This must be done before the
+   * sector is read, since the invalidation may use our rwbuffer.
+   */
+
+  ret = smart_cpinvalidate(dev);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+#endif
+
   /* Read the sector data into our buffer */
 
   mtdblock = physsector * dev->mtdBlksPerSector;
@@ -1626,6 +2393,8 @@ static inline int smart_writesector(struct smart_struct_s *dev, unsigned long ar
       ret = smart_bytewrite(dev, offset, req->count, req->buffer);
     }
 
+  dev->flashwrites++;
+
   ret = OK;
 
 errout:
@@ -1804,6 +2573,14 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
       return -EIO;
     }
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  ret = smart_cpinvalidate(dev);
+  if (ret < 0)
+    {
+      return ret;
+    }
+#endif
+
   /* Check if we need to do garbage collection.  We have to
    * ensure we keep enough reserved free sectors to per garbage
    * collection as it involves moving sectors from blocks with
@@ -1851,6 +2628,9 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
       return -EIO;
     }
 
+  dev->hostwrites++;
+  dev->flashwrites++;
+
   /* Map the sector and update the free sector counts */
 
   dev->sMap[logsector] = physicalsector;
@@ -1897,6 +2677,14 @@ static inline int smart_freesector(struct smart_struct_s *dev, unsigned long
         }
     }
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  ret = smart_cpinvalidate(dev);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+#endif
+
   /* Okay to release the sector.  Read the sector header info */
 
   physsector = dev->sMap[logicalsector];
@@ -1952,7 +2740,7 @@ static inline int smart_freesector(struct smart_struct_s *dev, unsigned long
     {
       /* Erase the block */
 
-      MTD_ERASE(dev->mtd, block, 1);
+      smart_erase(dev, block);
 
       dev->freesectors += dev->releasecount[block];
       dev->releasecount[block] = 0;
@@ -1966,6 +2754,31 @@ errout:
 }
 #endif /* CONFIG_FS_WRITABLE */
 
+/****************************************************************************
+ * Name: smart_opdone
+ *
+ * Description: Records the duration of a sector operation that started at
+ *              the given system time and schedules background garbage
+ *              collection if needed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static void smart_opdone(FAR struct smart_struct_s *dev, uint32_t start)
+{
+  uint32_t elapsed = clock_systimer() - start;
+
+  if (elapsed > dev->maxoptime)
+    {
+      dev->maxoptime = elapsed;
+    }
+
+#ifdef CONFIG_MTD_SMART_BGGC
+  smart_schedgc(dev);
+#endif
+}
+#endif
+
 /****************************************************************************
  * Name: smart_ioctl
  *
@@ -1978,6 +2791,9 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
   struct smart_struct_s *dev ;
   int ret;
   uint32_t sector;
+#ifdef CONFIG_FS_WRITABLE
+  uint32_t start;
+#endif
   struct mtd_smart_procfs_data_s * procfs_data;
 
   fvdbg("Entry\n");
@@ -1993,6 +2809,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
    * to directly to the underlying MTD device.
    */
 
+  smart_semtake(dev);
   switch (cmd)
     {
     case BIOC_XIPBASE:
@@ -2044,22 +2861,42 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 
       /* Allocate a logical sector for the upper layer file system */
 
+      start = clock_systimer();
       ret = smart_allocsector(dev, arg);
+      smart_opdone(dev, start);
       goto ok_out;
 
     case BIOC_FREESECT:
 
       /* Free the specified logical sector */
 
+      start = clock_systimer();
       ret = smart_freesector(dev, arg);
+      smart_opdone(dev, start);
       goto ok_out;
 
     case BIOC_WRITESECT:
 
       /* Write to the sector */
 
+      start = clock_systimer();
       ret = smart_writesector(dev, arg);
+      smart_opdone(dev, start);
+      goto ok_out;
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+    case BIOC_FLUSH:
+
+      /* Checkpoint the sector map.  A pending background collection is
+       * cancelled; it is scheduled again by the next sector operation.
+       */
+
+#ifdef CONFIG_MTD_SMART_BGGC
+      (void)work_cancel(LPWORK, &dev->gcwork);
+#endif
+      ret = smart_cpwrite(dev);
       goto ok_out;
+#endif
 #endif /* CONFIG_FS_WRITABLE */
 
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
@@ -2080,8 +2917,25 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       procfs_data->namelen = dev->namesize;
       procfs_data->formatversion = dev->formatversion;
       procfs_data->unusedsectors = 0;
-      procfs_data->blockerases = 0;
+      procfs_data->blockerases = dev->blockerases;
       procfs_data->sectorsperblk = dev->sectorsPerBlk;
+      procfs_data->hostwrites = dev->hostwrites;
+      procfs_data->flashwrites = dev->flashwrites;
+      procfs_data->maxoptime = TICK2MSEC(dev->maxoptime);
+      procfs_data->minerases = 0xFFFF;
+      procfs_data->maxerases = 0;
+      for (sector = 0; sector < dev->neraseblocks; sector++)
+        {
+          if (dev->erasecounts[sector] < procfs_data->minerases)
+            {
+              procfs_data->minerases = dev->erasecounts[sector];
+            }
+
+          if (dev->erasecounts[sector] > procfs_data->maxerases)
+            {
+              procfs_data->maxerases = dev->erasecounts[sector];
+            }
+        }
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
       procfs_data->formatsector = dev->sMap[0];
@@ -2089,7 +2943,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 #endif
 
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
-      procfs_data->neraseblocks = dev->geo.neraseblocks;
+      procfs_data->neraseblocks = dev->neraseblocks;
       procfs_data->erasecounts = dev->erasecounts;
 #endif
 #ifdef CONFIG_MTD_SMART_ALLOC_DEBUG
@@ -2113,6 +2967,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
     }
 
 ok_out:
+  smart_semgive(dev);
   return ret;
 }
 
@@ -2153,12 +3008,15 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
 
   /* Allocate a SMART device structure */
 
-  dev = (struct smart_struct_s *)kmm_malloc(sizeof(struct smart_struct_s));
+  dev = (struct smart_struct_s *)kmm_zalloc(sizeof(struct smart_struct_s));
   if (dev)
     {
       /* Initialize the SMART device structure */
 
       dev->mtd = mtd;
+#ifdef CONFIG_MTD_SMART_BGGC
+      sem_init(&dev->exclsem, 0, 1);
+#endif
 
       /* Get the device geometry. (casting to uintptr_t first eliminates
        * complaints on some architectures where the sizeof long is different
@@ -2179,6 +3037,11 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
 
       dev->sMap = NULL;
       dev->rwbuffer = NULL;
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+      dev->cpslot = 1;
+      dev->cpclean = false;
+      dev->cpseq = 0;
+#endif
       ret = smart_setsectorsize(dev, CONFIG_MTD_SMART_SECTOR_SIZE);
       if (ret != OK)
         {
@@ -0,0 +1,224 @@
+/****************************************************************************
+ * fs/aio/aio.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __FS_AIO_AIO_H
+#define __FS_AIO_AIO_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <queue.h>
+#include <aio.h>
+
+#include <nuttx/fs/fs.h>
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS < 1
+#  error "Asynchronous I/O requires file descriptors"
+#endif
+
+#ifndef CONFIG_FS_NAIOC
+#  define CONFIG_FS_NAIOC 8
+#endif
+
+#ifndef CONFIG_FS_AIO_PRIORITY
+#  define CONFIG_FS_AIO_PRIORITY 100
+#endif
+
+#ifndef CONFIG_FS_AIO_STACKSIZE
+#  define CONFIG_FS_AIO_STACKSIZE 2048
+#endif
+
+/* Operations carried by an I/O container */
+
+#define AIO_OP_READ   0
+#define AIO_OP_WRITE  1
+#define AIO_OP_FSYNC  2
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Completion state shared by the requests of one lio_listio() call */
+
+struct aio_lio_s
+{
+  uint16_t pending;               /* Requests not yet completed (+1 while submitting) */
+  pid_t pid;                      /* Task to notify */
+  struct sigevent sig;            /* Notification when all complete */
+};
+
+/* One queued request.  Reads and writes are performed on a private dup
+ * of the caller's open file, so that they neither use nor move the file
+ * position of the caller's descriptor.
+ */
+
+struct aio_container_s
+{
+  dq_entry_t link;                /* Supports a doubly linked list */
+  FAR struct aiocb *aiocbp;       /* The caller's control block */
+  FAR struct file *filep;         /* The open file (in the caller's group) */
+  struct file file;               /* Private dup of filep (read and write) */
+  FAR struct aio_lio_s *lio;      /* Non-NULL if part of a lio_listio() */
+  pid_t pid;                      /* Task to notify */
+  uint8_t op;                     /* See AIO_OP_* definitions */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_semtake and aio_semgive
+ *
+ * Description:
+ *   Take and give the semaphore that protects the request queue, the
+ *   containers and the aio_result of every queued control block.
+ *
+ ****************************************************************************/
+
+void aio_semtake(void);
+void aio_semgive(void);
+
+/****************************************************************************
+ * Name: aio_getfilep
+ *
+ * Description:
+ *   Return the open file of descriptor 'fildes' of the calling task, or
+ *   NULL if the descriptor is not valid.
+ *
+ ****************************************************************************/
+
+FAR struct file *aio_getfilep(int fildes);
+
+/****************************************************************************
+ * Name: aio_submit
+ *
+ * Description:
+ *   Validate the control block, queue it for the worker and mark it in
+ *   progress.  lio is the lio_listio() group of the request, or NULL.
+ *   The semaphore must not be held.
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int aio_submit(FAR struct aiocb *aiocbp, uint8_t op,
+               FAR struct aio_lio_s *lio);
+
+/****************************************************************************
+ * Name: aio_signal
+ *
+ * Description:
+ *   Send the notification described by 'sig' to task 'pid', if any.
+ *
+ ****************************************************************************/
+
+void aio_signal(pid_t pid, FAR const struct sigevent *sig);
+
+/****************************************************************************
+ * Name: aio_cancelreq
+ *
+ * Description:
+ *   Remove the requests for the open file that the worker has not yet
+ *   started from the queue and move their containers to 'canceled'.  If
+ *   aiocbp is not NULL, only that request is considered.  Called with the
+ *   semaphore held.  The canceled containers must be passed to
+ *   aio_complete() after the semaphore is released.
+ *
+ * Returned Value:
+ *   AIO_CANCELED, AIO_NOTCANCELED or AIO_ALLDONE as for aio_cancel().
+ *
+ ****************************************************************************/
+
+int aio_cancelreq(FAR struct file *filep, FAR struct aiocb *aiocbp,
+                  FAR dq_queue_t *canceled);
+
+/****************************************************************************
+ * Name: aio_complete
+ *
+ * Description:
+ *   Post the result of a request, release its container and send the
+ *   notifications it asked for.  The semaphore must not be held.
+ *
+ ****************************************************************************/
+
+void aio_complete(FAR struct aio_container_s *aioc, ssize_t result);
+
+/****************************************************************************
+ * Name: aio_wait
+ *
+ * Description:
+ *   Wait for the next completion of any request.  Called with the
+ *   semaphore held; the semaphore is released during the wait and is
+ *   held again on return.
+ *
+ * Returned Value:
+ *   Zero when a request completed; -ETIMEDOUT if abstime (if not NULL)
+ *   passed first; -EINTR if the wait was interrupted by a signal.
+ *
+ ****************************************************************************/
+
+int aio_wait(FAR const struct timespec *abstime);
+
+/****************************************************************************
+ * Name: aio_close
+ *
+ * Description:
+ *   Called when an open file is closed, including the close of all files
+ *   of an exiting task group.  Cancels the queued requests for the file
+ *   and waits until the requests in progress have completed.
+ *
+ ****************************************************************************/
+
+void aio_close(FAR struct file *filep);
+
+#endif /* CONFIG_FS_AIO */
+#endif /* __FS_AIO_AIO_H */
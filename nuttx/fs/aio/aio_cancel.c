@@ -0,0 +1,103 @@
+/****************************************************************************
+ * fs/aio/aio_cancel.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <queue.h>
+#include <aio.h>
+#include <errno.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_cancel
+ *
+ * Description:
+ *   Cancel the asynchronous I/O request aiocbp, or all requests for the
+ *   file descriptor fildes if aiocbp is NULL.  Requests that the worker
+ *   has not yet started are canceled: their error status becomes
+ *   ECANCELED and their normal notification is sent.  Requests in
+ *   progress run to completion.
+ *
+ * Input Parameters:
+ *   fildes - The file descriptor of the request(s)
+ *   aiocbp - The request to cancel, or NULL for all requests of fildes
+ *
+ * Returned Value:
+ *   AIO_CANCELED if all requests were canceled; AIO_NOTCANCELED if at
+ *   least one could not be canceled; AIO_ALLDONE if all had completed.
+ *   On failure, -1 with errno set to EBADF if fildes is not valid.
+ *
+ ****************************************************************************/
+
+int aio_cancel(int fildes, FAR struct aiocb *aiocbp)
+{
+  FAR struct aio_container_s *aioc;
+  FAR struct file *filep;
+  dq_queue_t canceled;
+  int ret;
+
+  filep = aio_getfilep(fildes);
+  if (!filep || (aiocbp && aiocbp->aio_fildes != fildes))
+    {
+      set_errno(EBADF);
+      return ERROR;
+    }
+
+  dq_init(&canceled);
+
+  aio_semtake();
+  ret = aio_cancelreq(filep, aiocbp, &canceled);
+  aio_semgive();
+
+  while ((aioc = (FAR struct aio_container_s *)dq_remfirst(&canceled)) != NULL)
+    {
+      aio_complete(aioc, -ECANCELED);
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_FS_AIO */
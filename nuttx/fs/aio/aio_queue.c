@@ -0,0 +1,651 @@
+/****************************************************************************
+ * fs/aio/aio_queue.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <queue.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/kthread.h>
+#include <nuttx/fs/fs.h>
+
+#include "fs_internal.h"
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static sem_t g_aio_sem = SEM_INITIALIZER(1);   /* Protects all below */
+static sem_t g_aio_donesem = SEM_INITIALIZER(0); /* Posted on completion */
+static sem_t g_aio_worksem = SEM_INITIALIZER(0); /* Posted on submission */
+static uint16_t g_aio_nwaiters;                /* Tasks waiting on g_aio_donesem */
+static bool g_aio_initialized;                 /* Pool and worker set up */
+static dq_queue_t g_aio_free;                  /* Free containers */
+static dq_queue_t g_aio_pending;               /* Queued requests (FIFO) */
+static struct aio_container_s g_aioc[CONFIG_FS_NAIOC];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_closefile
+ *
+ * Description:
+ *   Close the private dup of the open file of a request.
+ *
+ ****************************************************************************/
+
+static void aio_closefile(FAR struct file *filep)
+{
+  FAR struct inode *inode = filep->f_inode;
+
+  if (inode->u.i_ops && inode->u.i_ops->close)
+    {
+      (void)inode->u.i_ops->close(filep);
+    }
+
+  inode_release(inode);
+  filep->f_inode = NULL;
+}
+
+/****************************************************************************
+ * Name: aio_execute
+ *
+ * Description:
+ *   Perform one request on the worker thread.  Reads and writes are
+ *   positioned at aio_offset (or at the end of the file for O_APPEND
+ *   writes).  The file position belongs to the private dup of the request,
+ *   so the seek and the transfer are not disturbed by other I/O on the
+ *   caller's descriptor.
+ *
+ ****************************************************************************/
+
+static ssize_t aio_execute(FAR struct aio_container_s *aioc)
+{
+  FAR struct aiocb *aiocbp = aioc->aiocbp;
+  FAR struct file *filep;
+  FAR struct inode *inode;
+  off_t offset;
+  int whence;
+  ssize_t ret;
+
+  if (aioc->op == AIO_OP_FSYNC)
+    {
+      /* The sync is done on the caller's open file, since a dup does not
+       * see the data buffered for that file.  The file cannot be closed
+       * meanwhile:  close() waits for the requests in progress.
+       */
+
+      filep = aioc->filep;
+      inode = filep->f_inode;
+      if (!INODE_IS_MOUNTPT(inode) || !inode->u.i_mops->sync)
+        {
+          return -EINVAL;
+        }
+
+      return inode->u.i_mops->sync(filep);
+    }
+
+  filep = &aioc->file;
+  inode = filep->f_inode;
+
+  if (aioc->op == AIO_OP_WRITE && (filep->f_oflags & O_APPEND) != 0)
+    {
+      offset = 0;
+      whence = SEEK_END;
+    }
+  else
+    {
+      offset = aiocbp->aio_offset;
+      whence = SEEK_SET;
+    }
+
+  if (inode->u.i_ops->seek)
+    {
+      ret = inode->u.i_ops->seek(filep, offset, whence);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+  else if (whence == SEEK_SET)
+    {
+      filep->f_pos = offset;
+    }
+
+  if (aioc->op == AIO_OP_READ)
+    {
+      return inode->u.i_ops->read(filep, (FAR char *)aiocbp->aio_buf,
+                                  aiocbp->aio_nbytes);
+    }
+  else
+    {
+      return inode->u.i_ops->write(filep, (FAR const char *)aiocbp->aio_buf,
+                                   aiocbp->aio_nbytes);
+    }
+}
+
+/****************************************************************************
+ * Name: aio_getbatch
+ *
+ * Description:
+ *   Move the oldest queued request and all later requests for the same
+ *   open file to 'batch', sorted by file offset.  An fsync request ends a
+ *   batch so that it still follows the writes queued before it.  Called
+ *   with the semaphore held.
+ *
+ ****************************************************************************/
+
+static void aio_getbatch(FAR dq_queue_t *batch)
+{
+  FAR struct aio_container_s *first;
+  FAR struct aio_container_s *aioc;
+  FAR struct aio_container_s *next;
+  FAR struct aio_container_s *pos;
+
+  first = (FAR struct aio_container_s *)dq_remfirst(&g_aio_pending);
+  first->aiocbp->aio_priv = NULL;
+  dq_addlast(&first->link, batch);
+
+  if (first->op == AIO_OP_FSYNC)
+    {
+      return;
+    }
+
+  for (aioc = (FAR struct aio_container_s *)dq_peek(&g_aio_pending);
+       aioc;
+       aioc = next)
+    {
+      next = (FAR struct aio_container_s *)dq_next(&aioc->link);
+      if (aioc->filep != first->filep)
+        {
+          continue;
+        }
+
+      if (aioc->op == AIO_OP_FSYNC)
+        {
+          break;
+        }
+
+      dq_rem(&aioc->link, &g_aio_pending);
+      aioc->aiocbp->aio_priv = NULL;
+
+      /* Insert after the last request at a lower or equal offset */
+
+      for (pos = (FAR struct aio_container_s *)batch->tail;
+           pos && pos->aiocbp->aio_offset > aioc->aiocbp->aio_offset;
+           pos = (FAR struct aio_container_s *)dq_prev(&pos->link));
+
+      if (pos)
+        {
+          dq_addafter(&pos->link, &aioc->link, batch);
+        }
+      else
+        {
+          dq_addfirst(&aioc->link, batch);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: aio_worker
+ *
+ * Description:
+ *   The I/O worker thread.  Whenever requests are submitted, it runs the
+ *   queued requests until the queue is empty, one batch of requests for
+ *   the same file at a time.  A dedicated thread is used so that requests
+ *   that block (on a pipe or a serial device, for example) do not stall
+ *   the work queues.
+ *
+ ****************************************************************************/
+
+static int aio_worker(int argc, FAR char *argv[])
+{
+  FAR struct aio_container_s *aioc;
+  dq_queue_t batch;
+  ssize_t ret;
+
+  for (; ; )
+    {
+      dq_init(&batch);
+
+      aio_semtake();
+      if (dq_empty(&g_aio_pending))
+        {
+          aio_semgive();
+
+          while (sem_wait(&g_aio_worksem) != 0)
+            {
+              ASSERT(get_errno() == EINTR);
+            }
+
+          continue;
+        }
+
+      aio_getbatch(&batch);
+      aio_semgive();
+
+      while ((aioc = (FAR struct aio_container_s *)dq_remfirst(&batch)) != NULL)
+        {
+          ret = aio_execute(aioc);
+          aio_complete(aioc, ret);
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_semtake and aio_semgive
+ ****************************************************************************/
+
+void aio_semtake(void)
+{
+  while (sem_wait(&g_aio_sem) != 0)
+    {
+      ASSERT(get_errno() == EINTR);
+    }
+}
+
+void aio_semgive(void)
+{
+  sem_post(&g_aio_sem);
+}
+
+/****************************************************************************
+ * Name: aio_getfilep
+ ****************************************************************************/
+
+FAR struct file *aio_getfilep(int fildes)
+{
+  FAR struct filelist *list;
+  FAR struct file *filep;
+
+  if ((unsigned int)fildes >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return NULL;
+    }
+
+  list = sched_getfiles();
+  DEBUGASSERT(list);
+
+  filep = &list->fl_files[fildes];
+  if (!filep->f_inode || !filep->f_inode->u.i_ops)
+    {
+      return NULL;
+    }
+
+  return filep;
+}
+
+/****************************************************************************
+ * Name: aio_submit
+ ****************************************************************************/
+
+int aio_submit(FAR struct aiocb *aiocbp, uint8_t op,
+               FAR struct aio_lio_s *lio)
+{
+  FAR struct aio_container_s *aioc;
+  FAR struct file *filep;
+  FAR struct inode *inode;
+  pid_t pid;
+  int ret;
+  int i;
+
+  if (!aiocbp)
+    {
+      return -EINVAL;
+    }
+
+  /* Look up the open file in the caller's task group now; the worker runs
+   * in a different one.
+   */
+
+  filep = aio_getfilep(aiocbp->aio_fildes);
+  if (!filep)
+    {
+      return -EBADF;
+    }
+
+  inode = filep->f_inode;
+
+  switch (op)
+    {
+      case AIO_OP_READ:
+        if ((filep->f_oflags & O_RDOK) == 0 || !inode->u.i_ops->read)
+          {
+            return -EBADF;
+          }
+        break;
+
+      case AIO_OP_WRITE:
+      case AIO_OP_FSYNC:
+        if ((filep->f_oflags & O_WROK) == 0 ||
+            (op == AIO_OP_WRITE && !inode->u.i_ops->write))
+          {
+            return -EBADF;
+          }
+        break;
+
+      default:
+        return -EINVAL;
+    }
+
+  if (op != AIO_OP_FSYNC && aiocbp->aio_offset < 0)
+    {
+      return -EINVAL;
+    }
+
+  aio_semtake();
+
+  if (!g_aio_initialized)
+    {
+      pid = kernel_thread("aio", CONFIG_FS_AIO_PRIORITY,
+                          CONFIG_FS_AIO_STACKSIZE, (main_t)aio_worker,
+                          (FAR char * const *)NULL);
+      if (pid < 0)
+        {
+          ret = -get_errno();
+          fdbg("ERROR: Failed to start the I/O worker: %d\n", ret);
+          aio_semgive();
+          return ret;
+        }
+
+      for (i = 0; i < CONFIG_FS_NAIOC; i++)
+        {
+          dq_addlast(&g_aioc[i].link, &g_aio_free);
+        }
+
+      g_aio_initialized = true;
+    }
+
+  aioc = (FAR struct aio_container_s *)dq_remfirst(&g_aio_free);
+  aio_semgive();
+
+  if (!aioc)
+    {
+      return -EAGAIN;
+    }
+
+  /* Reads and writes use a private dup of the open file.  The container is
+   * not yet visible to aio_cancelreq() since its aiocbp is still NULL.
+   */
+
+  memset(&aioc->file, 0, sizeof(struct file));
+  if (op != AIO_OP_FSYNC && files_dup(filep, &aioc->file) < 0)
+    {
+      ret = -get_errno();
+
+      aio_semtake();
+      dq_addlast(&aioc->link, &g_aio_free);
+      aio_semgive();
+      return ret;
+    }
+
+  aio_semtake();
+
+  aioc->aiocbp       = aiocbp;
+  aioc->filep        = filep;
+  aioc->lio          = lio;
+  aioc->pid          = getpid();
+  aioc->op           = op;
+  aiocbp->aio_priv   = aioc;
+  aiocbp->aio_result = -EINPROGRESS;
+
+  if (lio)
+    {
+      lio->pending++;
+    }
+
+  dq_addlast(&aioc->link, &g_aio_pending);
+  sem_post(&g_aio_worksem);
+
+  aio_semgive();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: aio_signal
+ ****************************************************************************/
+
+void aio_signal(pid_t pid, FAR const struct sigevent *sig)
+{
+  if (sig->sigev_notify == SIGEV_SIGNAL)
+    {
+#ifdef CONFIG_CAN_PASS_STRUCTS
+      (void)sigqueue(pid, sig->sigev_signo, sig->sigev_value);
+#else
+      (void)sigqueue(pid, sig->sigev_signo, sig->sigev_value.sival_ptr);
+#endif
+    }
+}
+
+/****************************************************************************
+ * Name: aio_cancelreq
+ ****************************************************************************/
+
+int aio_cancelreq(FAR struct file *filep, FAR struct aiocb *aiocbp,
+                  FAR dq_queue_t *canceled)
+{
+  FAR struct aio_container_s *aioc;
+  int ret = AIO_ALLDONE;
+  int i;
+
+  for (i = 0; i < CONFIG_FS_NAIOC; i++)
+    {
+      aioc = &g_aioc[i];
+      if (!aioc->aiocbp || aioc->filep != filep ||
+          (aiocbp && aioc->aiocbp != aiocbp))
+        {
+          continue;
+        }
+
+      if (aioc->aiocbp->aio_priv == aioc)
+        {
+          /* Still queued */
+
+          dq_rem(&aioc->link, &g_aio_pending);
+          aioc->aiocbp->aio_priv = NULL;
+          dq_addlast(&aioc->link, canceled);
+
+          if (ret == AIO_ALLDONE)
+            {
+              ret = AIO_CANCELED;
+            }
+        }
+      else
+        {
+          /* Being performed by the worker */
+
+          ret = AIO_NOTCANCELED;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: aio_complete
+ ****************************************************************************/
+
+void aio_complete(FAR struct aio_container_s *aioc, ssize_t result)
+{
+  FAR struct aiocb *aiocbp = aioc->aiocbp;
+  FAR struct aio_lio_s *lio = aioc->lio;
+  struct sigevent sig = aiocbp->aio_sigevent;
+  pid_t pid = aioc->pid;
+  bool liodone = false;
+
+  /* Close the private dup first.  This flushes any data that it buffered
+   * before the request is reported complete.
+   */
+
+  if (aioc->file.f_inode)
+    {
+      aio_closefile(&aioc->file);
+    }
+
+  /* The control block belongs to the caller again as soon as the result
+   * is posted, so the notification is copied first.
+   */
+
+  aio_semtake();
+
+  aiocbp->aio_result = result;
+  aioc->aiocbp       = NULL;
+  dq_addlast(&aioc->link, &g_aio_free);
+
+  if (lio && --lio->pending == 0)
+    {
+      liodone = true;
+    }
+
+  /* Wake up everyone in aio_suspend() or lio_listio(); each will check
+   * whether this was a request it waits for.
+   */
+
+  while (g_aio_nwaiters > 0)
+    {
+      g_aio_nwaiters--;
+      sem_post(&g_aio_donesem);
+    }
+
+  aio_semgive();
+
+  /* Send the notifications last: a handler running in this context may
+   * submit new requests.
+   */
+
+  aio_signal(pid, &sig);
+
+  if (liodone)
+    {
+      aio_signal(lio->pid, &lio->sig);
+      kmm_free(lio);
+    }
+}
+
+/****************************************************************************
+ * Name: aio_wait
+ ****************************************************************************/
+
+int aio_wait(FAR const struct timespec *abstime)
+{
+  int ret;
+
+  g_aio_nwaiters++;
+  aio_semgive();
+
+  if (abstime)
+    {
+      ret = sem_timedwait(&g_aio_donesem, abstime);
+    }
+  else
+    {
+      ret = sem_wait(&g_aio_donesem);
+    }
+
+  if (ret < 0)
+    {
+      ret = -get_errno();
+    }
+
+  aio_semtake();
+
+  /* If the wait failed, no completion has consumed our count yet */
+
+  if (ret < 0 && g_aio_nwaiters > 0)
+    {
+      g_aio_nwaiters--;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: aio_close
+ ****************************************************************************/
+
+void aio_close(FAR struct file *filep)
+{
+  FAR struct aio_container_s *aioc;
+  dq_queue_t canceled;
+
+  if (!g_aio_initialized)
+    {
+      return;
+    }
+
+  dq_init(&canceled);
+
+  /* Cancel the queued requests and wait for those in progress: they may
+   * still access the caller's buffers and, for aio_fsync(), the open file.
+   */
+
+  aio_semtake();
+  while (aio_cancelreq(filep, NULL, &canceled) == AIO_NOTCANCELED)
+    {
+      (void)aio_wait(NULL);
+    }
+
+  aio_semgive();
+
+  while ((aioc = (FAR struct aio_container_s *)dq_remfirst(&canceled)) != NULL)
+    {
+      aio_complete(aioc, -ECANCELED);
+    }
+}
+
+#endif /* CONFIG_FS_AIO */
@@ -0,0 +1,93 @@
+/****************************************************************************
+ * fs/aio/aio_read.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <aio.h>
+#include <errno.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_read
+ *
+ * Description:
+ *   Queue a read of aiocbp->aio_nbytes from the file aiocbp->aio_fildes at
+ *   offset aiocbp->aio_offset into the buffer aiocbp->aio_buf.  The call
+ *   returns as soon as the request is queued.  When it completes, the
+ *   notification in aiocbp->aio_sigevent is sent to the calling task.
+ *
+ *   The file offset after the read is unspecified.  The control block and
+ *   the buffer must not be modified or released before the read completes.
+ *
+ * Input Parameters:
+ *   aiocbp - The asynchronous I/O control block
+ *
+ * Returned Value:
+ *   Zero if the request was queued; -1 with errno set otherwise:
+ *
+ *   EAGAIN - No I/O container is available (see CONFIG_FS_NAIOC)
+ *   EBADF  - aio_fildes is not a valid descriptor open for reading
+ *   EINVAL - aio_offset is invalid
+ *
+ *   Errors of the read itself are reported through aio_error().
+ *
+ ****************************************************************************/
+
+int aio_read(FAR struct aiocb *aiocbp)
+{
+  int ret;
+
+  ret = aio_submit(aiocbp, AIO_OP_READ, NULL);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_FS_AIO */
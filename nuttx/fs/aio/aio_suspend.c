@@ -0,0 +1,120 @@
+/****************************************************************************
+ * fs/aio/aio_suspend.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <time.h>
+#include <aio.h>
+#include <errno.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: aio_suspend
+ *
+ * Description:
+ *   Suspend the calling task until at least one of the asynchronous I/O
+ *   requests in 'list' has completed, a signal interrupts the wait, or
+ *   the time interval 'timeout' has passed.  NULL entries in the list are
+ *   ignored.
+ *
+ * Input Parameters:
+ *   list    - The control blocks of the requests to wait for
+ *   nent    - The number of entries in list
+ *   timeout - The maximum relative time to wait, or NULL to wait forever
+ *
+ * Returned Value:
+ *   Zero if a request in the list has completed; -1 with errno set
+ *   otherwise:
+ *
+ *   EAGAIN - No request completed within the timeout
+ *   EINTR  - The wait was interrupted by a signal
+ *
+ ****************************************************************************/
+
+int aio_suspend(FAR const struct aiocb *const list[], int nent,
+                FAR const struct timespec *timeout)
+{
+  struct timespec abstime;
+  int ret;
+  int i;
+
+  if (timeout)
+    {
+      (void)clock_gettime(CLOCK_REALTIME, &abstime);
+      abstime.tv_sec  += timeout->tv_sec;
+      abstime.tv_nsec += timeout->tv_nsec;
+      if (abstime.tv_nsec >= 1000000000)
+        {
+          abstime.tv_sec++;
+          abstime.tv_nsec -= 1000000000;
+        }
+    }
+
+  aio_semtake();
+
+  for (; ; )
+    {
+      for (i = 0; i < nent; i++)
+        {
+          if (list[i] && list[i]->aio_result != -EINPROGRESS)
+            {
+              aio_semgive();
+              return OK;
+            }
+        }
+
+      ret = aio_wait(timeout ? &abstime : NULL);
+      if (ret < 0)
+        {
+          aio_semgive();
+          set_errno(ret == -ETIMEDOUT ? EAGAIN : -ret);
+          return ERROR;
+        }
+    }
+}
+
+#endif /* CONFIG_FS_AIO */
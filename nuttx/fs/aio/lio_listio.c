@@ -0,0 +1,242 @@
+/****************************************************************************
+ * fs/aio/lio_listio.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <unistd.h>
+#include <string.h>
+#include <aio.h>
+#include <errno.h>
+
+#include <nuttx/kmalloc.h>
+
+#include "aio/aio.h"
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lio_waitall
+ *
+ * Description:
+ *   Wait until none of the requests in the list is in progress.
+ *
+ * Returned Value:
+ *   Zero if every request completed successfully; -EIO if any failed;
+ *   -EINTR if the wait was interrupted by a signal.
+ *
+ ****************************************************************************/
+
+static int lio_waitall(FAR struct aiocb *const list[], int nent)
+{
+  bool failed;
+  int ret;
+  int i;
+
+  aio_semtake();
+
+  for (; ; )
+    {
+      failed = false;
+      for (i = 0; i < nent; i++)
+        {
+          if (!list[i] || list[i]->aio_lio_opcode == LIO_NOP)
+            {
+              continue;
+            }
+
+          if (list[i]->aio_result == -EINPROGRESS)
+            {
+              break;
+            }
+
+          if (list[i]->aio_result < 0)
+            {
+              failed = true;
+            }
+        }
+
+      if (i >= nent)
+        {
+          aio_semgive();
+          return failed ? -EIO : OK;
+        }
+
+      ret = aio_wait(NULL);
+      if (ret < 0)
+        {
+          aio_semgive();
+          return ret;
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lio_listio
+ *
+ * Description:
+ *   Queue a list of asynchronous read and write requests with one call.
+ *   Requests for the same file are passed to the file system back to
+ *   back, in file offset order.
+ *
+ * Input Parameters:
+ *   mode - LIO_WAIT to return only when all requests have completed, or
+ *          LIO_NOWAIT to return as soon as they are queued
+ *   list - The control blocks of the requests.  aio_lio_opcode selects
+ *          LIO_READ, LIO_WRITE or LIO_NOP for each.  NULL entries are
+ *          ignored.
+ *   nent - The number of entries in list
+ *   sig  - For LIO_NOWAIT, the notification to send when all requests
+ *          have completed, or NULL.  Ignored for LIO_WAIT.
+ *
+ * Returned Value:
+ *   Zero on success; -1 with errno set otherwise:
+ *
+ *   EAGAIN - Not all requests could be queued
+ *   EINVAL - mode is not valid
+ *   EINTR  - A signal interrupted an LIO_WAIT wait
+ *   EIO    - At least one request failed (its status tells why)
+ *
+ ****************************************************************************/
+
+int lio_listio(int mode, FAR struct aiocb *const list[], int nent,
+               FAR struct sigevent *sig)
+{
+  FAR struct aio_lio_s *lio = NULL;
+  bool liodone = false;
+  int errcode = OK;
+  uint8_t op;
+  int ret;
+  int i;
+
+  if (mode != LIO_WAIT && mode != LIO_NOWAIT)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  /* A group is needed to send one notification for the whole list */
+
+  if (mode == LIO_NOWAIT && sig && sig->sigev_notify != SIGEV_NONE)
+    {
+      lio = (FAR struct aio_lio_s *)kmm_malloc(sizeof(struct aio_lio_s));
+      if (!lio)
+        {
+          set_errno(EAGAIN);
+          return ERROR;
+        }
+
+      /* Hold a reference while submitting so the notification cannot be
+       * sent before all requests are queued.
+       */
+
+      lio->pending = 1;
+      lio->pid     = getpid();
+      memcpy(&lio->sig, sig, sizeof(struct sigevent));
+    }
+
+  for (i = 0; i < nent; i++)
+    {
+      if (!list[i])
+        {
+          continue;
+        }
+
+      switch (list[i]->aio_lio_opcode)
+        {
+          case LIO_READ:
+            op = AIO_OP_READ;
+            break;
+
+          case LIO_WRITE:
+            op = AIO_OP_WRITE;
+            break;
+
+          default:
+            continue;
+        }
+
+      ret = aio_submit(list[i], op, lio);
+      if (ret < 0)
+        {
+          list[i]->aio_result = ret;
+          errcode = EAGAIN;
+        }
+    }
+
+  if (lio)
+    {
+      aio_semtake();
+      liodone = --lio->pending == 0;
+      aio_semgive();
+
+      if (liodone)
+        {
+          aio_signal(lio->pid, &lio->sig);
+          kmm_free(lio);
+        }
+    }
+
+  if (mode == LIO_WAIT)
+    {
+      ret = lio_waitall(list, nent);
+      if (ret < 0 && errcode == OK)
+        {
+          errcode = -ret;
+        }
+    }
+
+  if (errcode != OK)
+    {
+      set_errno(errcode);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_FS_AIO */
@@ -61,6 +61,7 @@
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/fat.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/fs/dirent.h>
 
 #include "fs_internal.h"
@@ -442,6 +443,9 @@ static ssize_t fat_read(FAR struct file *filep, char *buffer, size_t buflen)
   unsigned int          bytesread;
   unsigned int          readsize;
   unsigned int          nsectors;
+#ifdef CONFIG_FAT_EXTENTS
+  unsigned int          maxsectors;
+#endif
   size_t                bytesleft;
   int32_t               cluster;
   uint8_t               *userbuffer = (uint8_t*)buffer;
@@ -526,11 +530,21 @@ static ssize_t fat_read(FAR struct file *filep, char *buffer, size_t buflen)
         {
           /* Find the next cluster in the FAT. */
 
-          cluster = fat_getcluster(fs, ff->ff_currentcluster);
-          if (cluster < 2 || cluster >= fs->fs_nclusters)
+#ifdef CONFIG_FAT_EXTENTS
+          cluster = fat_extentnext(ff, ff->ff_currentcluster);
+          if (cluster == 0)
+#endif
             {
-              ret = -EINVAL; /* Not the right error */
-              goto errout_with_semaphore;
+              cluster = fat_getcluster(fs, ff->ff_currentcluster);
+              if (cluster < 2 || cluster >= fs->fs_nclusters)
+                {
+                  ret = -EINVAL; /* Not the right error */
+                  goto errout_with_semaphore;
+                }
+
+#ifdef CONFIG_FAT_EXTENTS
+              fat_extentadd(ff, ff->ff_currentcluster, cluster);
+#endif
             }
 
           /* Setup to read the first sector from the new cluster */
@@ -562,7 +576,22 @@ fat_read_restart:
 
           if (nsectors > ff->ff_sectorsincluster)
             {
+#ifdef CONFIG_FAT_EXTENTS
+              /* The read may continue into the following clusters if the
+               * extent map shows that they are contiguous on the media.
+               */
+
+              maxsectors = ff->ff_sectorsincluster +
+                           fat_extentcontig(ff, ff->ff_currentcluster) *
+                           fs->fs_fatsecperclus;
+
+              if (nsectors > maxsectors)
+                {
+                  nsectors = maxsectors;
+                }
+#else
               nsectors = ff->ff_sectorsincluster;
+#endif
             }
 
           /* We are not sure of the state of the file buffer so
@@ -595,7 +624,26 @@ fat_read_restart:
               goto errout_with_semaphore;
             }
 
-          ff->ff_sectorsincluster -= nsectors;
+#ifdef CONFIG_FAT_EXTENTS
+          if (nsectors > ff->ff_sectorsincluster)
+            {
+              /* We read into following clusters.  Move to the cluster that
+               * holds the last sector read.
+               */
+
+              unsigned int extra     = nsectors - ff->ff_sectorsincluster;
+              unsigned int nclusters = (extra + fs->fs_fatsecperclus - 1) /
+                                       fs->fs_fatsecperclus;
+
+              ff->ff_currentcluster  += nclusters;
+              ff->ff_sectorsincluster = nclusters * fs->fs_fatsecperclus - extra;
+            }
+          else
+#endif
+            {
+              ff->ff_sectorsincluster -= nsectors;
+            }
+
           ff->ff_currentsector    += nsectors;
           bytesread                = nsectors * fs->fs_hwsectorsize;
         }
@@ -764,19 +812,29 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
            * move the file position back from the end of the file)
            */
 
-          cluster = fat_extendchain(fs, ff->ff_currentcluster);
+#ifdef CONFIG_FAT_EXTENTS
+          cluster = fat_extentnext(ff, ff->ff_currentcluster);
+          if (cluster == 0)
+#endif
+            {
+              cluster = fat_extendchain(fs, ff->ff_currentcluster);
 
-          /* Verify the cluster number */
+              /* Verify the cluster number */
 
-          if (cluster < 0)
-            {
-              ret = cluster;
-              goto errout_with_semaphore;
-            }
-          else if (cluster < 2 || cluster >= fs->fs_nclusters)
-            {
-              ret = -ENOSPC;
-              goto errout_with_semaphore;
+              if (cluster < 0)
+                {
+                  ret = cluster;
+                  goto errout_with_semaphore;
+                }
+              else if (cluster < 2 || cluster >= fs->fs_nclusters)
+                {
+                  ret = -ENOSPC;
+                  goto errout_with_semaphore;
+                }
+
+#ifdef CONFIG_FAT_EXTENTS
+              fat_extentadd(ff, ff->ff_currentcluster, cluster);
+#endif
             }
 
           /* Setup to write the first sector from the new cluster */
@@ -955,6 +1013,9 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
   int32_t               cluster;
   off_t                 position;
   unsigned int          clustersize;
+#ifdef CONFIG_FAT_EXTENTS
+  uint32_t              index;
+#endif
   int                   ret;
 
   /* Sanity checks */
@@ -1057,6 +1118,18 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
        */
 
       clustersize = fs->fs_fatsecperclus * fs->fs_hwsectorsize;
+
+#ifdef CONFIG_FAT_EXTENTS
+      /* Go directly to the requested cluster, or as close to it as the
+       * extent map allows, instead of following the chain from the start.
+       */
+
+      index        = position / clustersize;
+      cluster      = fat_extentlookup(ff, &index);
+      filep->f_pos = (off_t)index * clustersize;
+      position    -= filep->f_pos;
+#endif
+
       for (;;)
         {
           /* Skip over clusters prior to the one containing
@@ -1123,6 +1196,10 @@ static off_t fat_seek(FAR struct file *filep, off_t offset, int whence)
               goto errout_with_semaphore;
             }
 
+#ifdef CONFIG_FAT_EXTENTS
+          fat_extentadd(ff, ff->ff_currentcluster, cluster);
+#endif
+
           /* Otherwise, update the position and continue looking */
 
           filep->f_pos += clustersize;
@@ -1202,6 +1279,29 @@ static int fat_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       return ret;
     }
 
+#ifdef CONFIG_FAT_SECTCACHE
+  /* Return the sector cache statistics for this mountpoint */
+
+  if (cmd == FIOC_CACHESTATS)
+    {
+      FAR struct fat_cachestats_s *stats =
+        (FAR struct fat_cachestats_s *)((uintptr_t)arg);
+
+      if (stats == NULL)
+        {
+          ret = -EINVAL;
+        }
+      else
+        {
+          memcpy(stats, &fs->fs_cachestats, sizeof(struct fat_cachestats_s));
+          ret = OK;
+        }
+
+      fat_semgive(fs);
+      return ret;
+    }
+#endif
+
   /* ioctl calls are just passed through to the contained block driver */
 
   fat_semgive(fs);
@@ -1301,6 +1401,20 @@ static int fat_sync(FAR struct file *filep)
       ret          = fat_updatefsinfo(fs);
     }
 
+#ifdef CONFIG_DRVR_BLKCACHE
+  /* Make sure that nothing is left in the block cache either */
+
+  if (ret == OK && fs->fs_blkdriver->u.i_bops->ioctl)
+    {
+      ret = fs->fs_blkdriver->u.i_bops->ioctl(fs->fs_blkdriver,
+                                              BIOC_FLUSH, 0);
+      if (ret == -ENOTTY || ret == -ENOSYS)
+        {
+          ret = OK;
+        }
+    }
+#endif
+
 errout_with_semaphore:
   fat_semgive(fs);
   return ret;
@@ -1395,6 +1509,11 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
   newff->ff_startcluster     = oldff->ff_startcluster;     /* Start cluster of file on media */
   newff->ff_currentsector    = oldff->ff_currentsector;    /* Current sector */
   newff->ff_cachesector      = 0;                          /* Sector in file buffer */
+#ifdef CONFIG_FAT_EXTENTS
+  newff->ff_nextents         = oldff->ff_nextents;         /* Cluster chain extent map */
+  memcpy(newff->ff_extents, oldff->ff_extents,
+         oldff->ff_nextents * sizeof(struct fat_extent_s));
+#endif
 
   /* Attach the private date to the struct file instance */
 
@@ -1817,6 +1936,20 @@ static int fat_unbind(void *handle, FAR struct inode **blkdriver)
     }
   else
     {
+#ifdef CONFIG_FAT_SECTCACHE
+      /* Write back anything still held in the sector cache */
+
+      if (fs->fs_mounted && fat_fscacheflush(fs) == OK)
+        {
+          (void)fat_cachesync(fs);
+        }
+
+      fat_cacheuninitialize(fs);
+#endif
+#ifdef CONFIG_FAT_FREEMAP
+      fat_freemaprelease(fs);
+#endif
+
        /* Unmount ... close the block driver */
 
       if (fs->fs_blkdriver)
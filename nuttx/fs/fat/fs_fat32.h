@@ -50,6 +50,7 @@
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/dirent.h>
+#include <nuttx/fs/fat.h>
 
 /****************************************************************************
  * Definitions
@@ -277,6 +278,36 @@
 #define FFBUFF_DIRTY        2
 #define FFBUFF_MODIFIED     4
 
+/* Sector cache configuration */
+
+#ifdef CONFIG_FAT_SECTCACHE
+#  ifndef CONFIG_FAT_SECTCACHE_NSECTORS
+#    define CONFIG_FAT_SECTCACHE_NSECTORS 8
+#  endif
+#  ifndef CONFIG_FAT_SECTCACHE_NFATSECTORS
+#    define CONFIG_FAT_SECTCACHE_NFATSECTORS 2
+#  endif
+#  if CONFIG_FAT_SECTCACHE_NFATSECTORS >= CONFIG_FAT_SECTCACHE_NSECTORS
+#    error CONFIG_FAT_SECTCACHE_NFATSECTORS must be less than CONFIG_FAT_SECTCACHE_NSECTORS
+#  endif
+#endif
+
+/* Cluster chain extent map configuration */
+
+#ifdef CONFIG_FAT_EXTENTS
+#  ifndef CONFIG_FAT_NEXTENTS
+#    define CONFIG_FAT_NEXTENTS 16
+#  endif
+#  if CONFIG_FAT_NEXTENTS < 1 || CONFIG_FAT_NEXTENTS > 255
+#    error CONFIG_FAT_NEXTENTS must be in the range 1-255
+#  endif
+#endif
+
+/* True if the sector lies in the first FAT */
+
+#define FAT_ISFATSECTOR(f,s) \
+  ((s) >= (f)->fs_fatbase && (s) < (f)->fs_fatbase + (f)->fs_nfatsects)
+
 /****************************************************************************
  * These offset describe the FSINFO sector
  */
@@ -714,6 +745,19 @@
  * mounted with a fat32 filesystem.
  */
 
+#ifdef CONFIG_FAT_SECTCACHE
+/* This structure describes one entry in the per-mountpoint sector cache */
+
+struct fat_cachesect_s
+{
+  off_t    cs_sector;              /* The sector number held in cs_buffer */
+  uint32_t cs_stamp;               /* Time of last access (for LRU replacement) */
+  bool     cs_valid;               /* true: cs_buffer holds cs_sector */
+  bool     cs_dirty;               /* true: cs_buffer must be written to disk */
+  uint8_t *cs_buffer;              /* One sector of data */
+};
+#endif
+
 struct fat_file_s;
 struct fat_mountpt_s
 {
@@ -743,8 +787,32 @@ struct fat_mountpt_s
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
   uint8_t *fs_buffer;              /* This is an allocated buffer to hold one sector
                                     * from the device */
+#ifdef CONFIG_FAT_SECTCACHE
+  uint32_t fs_cachestamp;          /* Incremented on each sector cache access */
+  struct fat_cachestats_s fs_cachestats; /* Sector cache hit/miss counters */
+  uint8_t *fs_cachemem;            /* Memory backing all sector cache entries */
+  struct fat_cachesect_s fs_cache[CONFIG_FAT_SECTCACHE_NSECTORS];
+#endif
+#ifdef CONFIG_FAT_FREEMAP
+  uint32_t *fs_freemap;            /* Free cluster bitmap (1=free), NULL until built */
+  uint32_t fs_nfreemap;            /* Number of free clusters in fs_freemap */
+  bool     fs_freemapnorun;        /* true: No run of free clusters was found */
+#endif
 };
 
+#ifdef CONFIG_FAT_EXTENTS
+/* This structure describes a run of contiguous clusters in the cluster
+ * chain of an open file.
+ */
+
+struct fat_extent_s
+{
+  uint32_t fe_index;               /* Index of the first cluster of the run in the file */
+  uint32_t fe_cluster;             /* First cluster of the run */
+  uint32_t fe_nclusters;           /* Number of contiguous clusters in the run */
+};
+#endif
+
 /* This structure represents on open file under the mountpoint.  An instance
  * of this structure is retained as struct file specific information on each
  * opened file.
@@ -764,6 +832,10 @@ struct fat_file_s
   off_t    ff_currentsector;       /* Current sector being operated on */
   off_t    ff_cachesector;         /* Current sector in the file buffer */
   uint8_t *ff_buffer;              /* File buffer (for partial sector accesses) */
+#ifdef CONFIG_FAT_EXTENTS
+  uint8_t  ff_nextents;            /* Number of valid entries in ff_extents */
+  struct fat_extent_s ff_extents[CONFIG_FAT_NEXTENTS]; /* Mapped prefix of the chain */
+#endif
 };
 
 /* This structure holds the sequency of directory entries used by one
@@ -924,6 +996,39 @@ EXTERN int    fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff);
 EXTERN int    fat_ffcacheread(struct fat_mountpt_s *fs, struct fat_file_s *ff, off_t sector);
 EXTERN int    fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s *ff);
 
+/* Multi-sector LRU cache behind fs_buffer (see fs_fat32cache.c) */
+
+#ifdef CONFIG_FAT_SECTCACHE
+EXTERN int    fat_cacheinitialize(struct fat_mountpt_s *fs);
+EXTERN void   fat_cacheuninitialize(struct fat_mountpt_s *fs);
+EXTERN int    fat_cacheread(struct fat_mountpt_s *fs, uint8_t *buffer, off_t sector);
+EXTERN int    fat_cachewrite(struct fat_mountpt_s *fs, const uint8_t *buffer,
+                             off_t sector);
+EXTERN int    fat_cachesync(struct fat_mountpt_s *fs);
+EXTERN void   fat_cacheinvalidate(struct fat_mountpt_s *fs, const uint8_t *buffer,
+                                  off_t sector, unsigned int nsectors);
+#endif
+
+/* Per-file cluster chain extent map (see fs_fat32extent.c) */
+
+#ifdef CONFIG_FAT_EXTENTS
+EXTERN void   fat_extentadd(struct fat_file_s *ff, uint32_t prev, uint32_t next);
+EXTERN uint32_t fat_extentlookup(struct fat_file_s *ff, uint32_t *index);
+EXTERN uint32_t fat_extentnext(struct fat_file_s *ff, uint32_t cluster);
+EXTERN uint32_t fat_extentcontig(struct fat_file_s *ff, uint32_t cluster);
+#endif
+
+/* Free cluster bitmap (see fs_fat32freemap.c) */
+
+#ifdef CONFIG_FAT_FREEMAP
+EXTERN int32_t fat_freemapfind(struct fat_mountpt_s *fs, uint32_t startcluster,
+                               bool extending);
+EXTERN void   fat_freemapupdate(struct fat_mountpt_s *fs, uint32_t cluster,
+                                bool isfree);
+EXTERN int    fat_freemapcount(struct fat_mountpt_s *fs, off_t *pfreeclusters);
+EXTERN void   fat_freemaprelease(struct fat_mountpt_s *fs);
+#endif
+
 /* FSINFO sector support */
 
 EXTERN int    fat_updatefsinfo(struct fat_mountpt_s *fs);
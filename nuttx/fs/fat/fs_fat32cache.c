@@ -0,0 +1,410 @@
+/****************************************************************************
+ * fs/fat/fs_fat32cache.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/fat.h>
+
+#include "fs_internal.h"
+#include "fs_fat32.h"
+
+#ifdef CONFIG_FAT_SECTCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Sectors of the first FAT are only cached in the first
+ * CONFIG_FAT_SECTCACHE_NFATSECTORS entries; all other sectors use the
+ * remaining entries.  Directory scans can then never push the FAT sectors
+ * out of the cache (and vice versa).
+ */
+
+#define FAT_CACHE_NFAT  CONFIG_FAT_SECTCACHE_NFATSECTORS
+#define FAT_CACHE_NALL  CONFIG_FAT_SECTCACHE_NSECTORS
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_cachefind
+ *
+ * Desciption: Return the cache entry holding the specified sector or NULL
+ *   if the sector is not cached.
+ *
+ ****************************************************************************/
+
+static struct fat_cachesect_s *fat_cachefind(struct fat_mountpt_s *fs,
+                                             off_t sector)
+{
+  struct fat_cachesect_s *cs;
+  int start;
+  int end;
+  int i;
+
+  if (FAT_CACHE_NFAT > 0 && FAT_ISFATSECTOR(fs, sector))
+    {
+      start = 0;
+      end   = FAT_CACHE_NFAT;
+    }
+  else
+    {
+      start = FAT_CACHE_NFAT;
+      end   = FAT_CACHE_NALL;
+    }
+
+  for (i = start; i < end; i++)
+    {
+      cs = &fs->fs_cache[i];
+      if (cs->cs_valid && cs->cs_sector == sector)
+        {
+          return cs;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: fat_cachewriteback
+ *
+ * Desciption: Write one dirty cache entry to the media, updating the
+ *   FAT copies as well if the sector lies in the FAT region.
+ *
+ ****************************************************************************/
+
+static int fat_cachewriteback(struct fat_mountpt_s *fs,
+                              struct fat_cachesect_s *cs)
+{
+  off_t sector;
+  int ret;
+  int i;
+
+  sector = cs->cs_sector;
+  ret    = fat_hwwrite(fs, cs->cs_buffer, sector, 1);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (FAT_ISFATSECTOR(fs, sector))
+    {
+      for (i = fs->fs_fatnumfats; i >= 2; i--)
+        {
+          sector += fs->fs_nfatsects;
+          ret = fat_hwwrite(fs, cs->cs_buffer, sector, 1);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  cs->cs_dirty = false;
+  fs->fs_cachestats.cs_writebacks++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cacheinsert
+ *
+ * Desciption: Copy one sector into the cache.  If the sector is not already
+ *   cached, then the least recently used entry of the sector's partition is
+ *   replaced (after writing it back if it is dirty).
+ *
+ ****************************************************************************/
+
+static int fat_cacheinsert(struct fat_mountpt_s *fs, const uint8_t *buffer,
+                           off_t sector, bool dirty)
+{
+  struct fat_cachesect_s *cs;
+  struct fat_cachesect_s *victim;
+  uint32_t age;
+  int start;
+  int end;
+  int ret;
+  int i;
+
+  cs = fat_cachefind(fs, sector);
+  if (!cs)
+    {
+      if (FAT_CACHE_NFAT > 0 && FAT_ISFATSECTOR(fs, sector))
+        {
+          start = 0;
+          end   = FAT_CACHE_NFAT;
+        }
+      else
+        {
+          start = FAT_CACHE_NFAT;
+          end   = FAT_CACHE_NALL;
+        }
+
+      /* Prefer an unused entry, otherwise take the oldest one.  The age is
+       * computed with unsigned arithmetic so that wrap-around of the
+       * access stamp is harmless.
+       */
+
+      victim = NULL;
+      age    = 0;
+
+      for (i = start; i < end; i++)
+        {
+          cs = &fs->fs_cache[i];
+          if (!cs->cs_valid)
+            {
+              victim = cs;
+              break;
+            }
+
+          if (!victim || (uint32_t)(fs->fs_cachestamp - cs->cs_stamp) > age)
+            {
+              victim = cs;
+              age    = fs->fs_cachestamp - cs->cs_stamp;
+            }
+        }
+
+      DEBUGASSERT(victim != NULL);
+      cs = victim;
+
+      if (cs->cs_valid)
+        {
+          if (cs->cs_dirty)
+            {
+              ret = fat_cachewriteback(fs, cs);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+
+          fs->fs_cachestats.cs_evictions++;
+        }
+
+      cs->cs_sector = sector;
+      cs->cs_valid  = true;
+      cs->cs_dirty  = false;
+    }
+
+  memcpy(cs->cs_buffer, buffer, fs->fs_hwsectorsize);
+  cs->cs_dirty |= dirty;
+  cs->cs_stamp  = ++fs->fs_cachestamp;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_cacheinitialize
+ *
+ * Desciption: Allocate the sector cache for a mountpoint.  Called from
+ *   fat_mount() once the hardware sector size is known.
+ *
+ ****************************************************************************/
+
+int fat_cacheinitialize(struct fat_mountpt_s *fs)
+{
+  int i;
+
+  fs->fs_cachemem = (uint8_t*)fat_io_alloc(FAT_CACHE_NALL * fs->fs_hwsectorsize);
+  if (!fs->fs_cachemem)
+    {
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < FAT_CACHE_NALL; i++)
+    {
+      fs->fs_cache[i].cs_buffer = &fs->fs_cachemem[i * fs->fs_hwsectorsize];
+      fs->fs_cache[i].cs_valid  = false;
+      fs->fs_cache[i].cs_dirty  = false;
+    }
+
+  fs->fs_cachestamp = 0;
+  memset(&fs->fs_cachestats, 0, sizeof(struct fat_cachestats_s));
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cacheuninitialize
+ *
+ * Desciption: Release the sector cache.  Any dirty sectors are discarded;
+ *   the caller should call fat_cachesync() first if they are to be kept.
+ *
+ ****************************************************************************/
+
+void fat_cacheuninitialize(struct fat_mountpt_s *fs)
+{
+  int i;
+
+  fvdbg("hits: %u misses: %u writebacks: %u evictions: %u\n",
+        fs->fs_cachestats.cs_hits, fs->fs_cachestats.cs_misses,
+        fs->fs_cachestats.cs_writebacks, fs->fs_cachestats.cs_evictions);
+
+  if (fs->fs_cachemem)
+    {
+      fat_io_free(fs->fs_cachemem, FAT_CACHE_NALL * fs->fs_hwsectorsize);
+      fs->fs_cachemem = NULL;
+    }
+
+  for (i = 0; i < FAT_CACHE_NALL; i++)
+    {
+      fs->fs_cache[i].cs_buffer = NULL;
+      fs->fs_cache[i].cs_valid  = false;
+      fs->fs_cache[i].cs_dirty  = false;
+    }
+}
+
+/****************************************************************************
+ * Name: fat_cacheread
+ *
+ * Desciption: Copy the specified sector into the caller's buffer, reading
+ *   it from the media (and adding it to the cache) only if it is not
+ *   already cached.
+ *
+ ****************************************************************************/
+
+int fat_cacheread(struct fat_mountpt_s *fs, uint8_t *buffer, off_t sector)
+{
+  struct fat_cachesect_s *cs;
+  int ret;
+
+  cs = fat_cachefind(fs, sector);
+  if (cs)
+    {
+      memcpy(buffer, cs->cs_buffer, fs->fs_hwsectorsize);
+      cs->cs_stamp = ++fs->fs_cachestamp;
+      fs->fs_cachestats.cs_hits++;
+      return OK;
+    }
+
+  fs->fs_cachestats.cs_misses++;
+
+  ret = fat_hwread(fs, buffer, sector, 1);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return fat_cacheinsert(fs, buffer, sector, false);
+}
+
+/****************************************************************************
+ * Name: fat_cachewrite
+ *
+ * Desciption: Copy a modified sector into the cache.  The sector is not
+ *   written to the media until it is evicted or fat_cachesync() is called.
+ *
+ ****************************************************************************/
+
+int fat_cachewrite(struct fat_mountpt_s *fs, const uint8_t *buffer,
+                   off_t sector)
+{
+  return fat_cacheinsert(fs, buffer, sector, true);
+}
+
+/****************************************************************************
+ * Name: fat_cachesync
+ *
+ * Desciption: Write all dirty cached sectors to the media.
+ *
+ ****************************************************************************/
+
+int fat_cachesync(struct fat_mountpt_s *fs)
+{
+  struct fat_cachesect_s *cs;
+  int ret;
+  int i;
+
+  for (i = 0; i < FAT_CACHE_NALL; i++)
+    {
+      cs = &fs->fs_cache[i];
+      if (cs->cs_valid && cs->cs_dirty)
+        {
+          ret = fat_cachewriteback(fs, cs);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_cacheinvalidate
+ *
+ * Desciption: Discard any cached copies of sectors that are about to be
+ *   written directly to the media.  Called from fat_hwwrite().  The entry
+ *   whose own buffer is being written (i.e., a cache write-back) is kept.
+ *
+ ****************************************************************************/
+
+void fat_cacheinvalidate(struct fat_mountpt_s *fs, const uint8_t *buffer,
+                         off_t sector, unsigned int nsectors)
+{
+  struct fat_cachesect_s *cs;
+  int i;
+
+  for (i = 0; i < FAT_CACHE_NALL; i++)
+    {
+      cs = &fs->fs_cache[i];
+      if (cs->cs_valid && cs->cs_buffer != buffer &&
+          cs->cs_sector >= sector && cs->cs_sector < sector + nsectors)
+        {
+          cs->cs_valid = false;
+          cs->cs_dirty = false;
+        }
+    }
+}
+
+#endif /* CONFIG_FAT_SECTCACHE */
@@ -0,0 +1,242 @@
+/****************************************************************************
+ * fs/fat/fs_fat32extent.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/fat.h>
+
+#include "fs_internal.h"
+#include "fs_fat32.h"
+
+#ifdef CONFIG_FAT_EXTENTS
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_extentfind
+ *
+ * Desciption: Return the extent that contains 'cluster' or NULL if the
+ *   cluster has not been mapped yet.
+ *
+ ****************************************************************************/
+
+static struct fat_extent_s *fat_extentfind(struct fat_file_s *ff,
+                                           uint32_t cluster)
+{
+  struct fat_extent_s *fe;
+  int i;
+
+  for (i = ff->ff_nextents - 1; i >= 0; i--)
+    {
+      fe = &ff->ff_extents[i];
+      if (cluster >= fe->fe_cluster &&
+          cluster < fe->fe_cluster + fe->fe_nclusters)
+        {
+          return fe;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_extentadd
+ *
+ * Desciption: Record that 'next' follows 'prev' in the file's cluster
+ *   chain.  The map only ever describes a prefix of the chain, so the link
+ *   is recorded only if 'prev' is the last mapped cluster.  A link to the
+ *   adjacent cluster grows the last extent; any other link starts a new
+ *   extent while there is room for one.
+ *
+ ****************************************************************************/
+
+void fat_extentadd(struct fat_file_s *ff, uint32_t prev, uint32_t next)
+{
+  struct fat_extent_s *fe;
+
+  if (ff->ff_nextents == 0)
+    {
+      /* The map starts with the first cluster of the file */
+
+      if (prev != ff->ff_startcluster)
+        {
+          return;
+        }
+
+      fe               = &ff->ff_extents[0];
+      fe->fe_index     = 0;
+      fe->fe_cluster   = prev;
+      fe->fe_nclusters = 1;
+      ff->ff_nextents  = 1;
+    }
+
+  fe = &ff->ff_extents[ff->ff_nextents - 1];
+  if (prev != fe->fe_cluster + fe->fe_nclusters - 1)
+    {
+      return;
+    }
+
+  if (next == prev + 1)
+    {
+      fe->fe_nclusters++;
+    }
+  else if (ff->ff_nextents < CONFIG_FAT_NEXTENTS)
+    {
+      fe[1].fe_index     = fe->fe_index + fe->fe_nclusters;
+      fe[1].fe_cluster   = next;
+      fe[1].fe_nclusters = 1;
+      ff->ff_nextents++;
+    }
+}
+
+/****************************************************************************
+ * Name: fat_extentlookup
+ *
+ * Desciption: Map a cluster index within the file to a cluster number.
+ *   On input, *index is the wanted cluster index.  If that part of the
+ *   chain is not mapped yet, the last mapped cluster is returned instead
+ *   and *index is updated to its index; the caller then continues to
+ *   follow the chain from there.
+ *
+ ****************************************************************************/
+
+uint32_t fat_extentlookup(struct fat_file_s *ff, uint32_t *index)
+{
+  struct fat_extent_s *fe;
+  int lo;
+  int hi;
+  int mid;
+
+  if (ff->ff_nextents == 0)
+    {
+      *index = 0;
+      return ff->ff_startcluster;
+    }
+
+  /* Binary search for the last extent that starts at or before *index */
+
+  lo = 0;
+  hi = ff->ff_nextents - 1;
+  while (lo < hi)
+    {
+      mid = (lo + hi + 1) >> 1;
+      if (ff->ff_extents[mid].fe_index <= *index)
+        {
+          lo = mid;
+        }
+      else
+        {
+          hi = mid - 1;
+        }
+    }
+
+  fe = &ff->ff_extents[lo];
+  if (*index >= fe->fe_index + fe->fe_nclusters)
+    {
+      /* Beyond the mapped part of the chain */
+
+      DEBUGASSERT(lo == ff->ff_nextents - 1);
+      *index = fe->fe_index + fe->fe_nclusters - 1;
+    }
+
+  return fe->fe_cluster + (*index - fe->fe_index);
+}
+
+/****************************************************************************
+ * Name: fat_extentnext
+ *
+ * Desciption: Return the cluster that follows 'cluster' in the chain if it
+ *   is known from the map, or zero if the FAT must be consulted.
+ *
+ ****************************************************************************/
+
+uint32_t fat_extentnext(struct fat_file_s *ff, uint32_t cluster)
+{
+  struct fat_extent_s *fe = fat_extentfind(ff, cluster);
+
+  if (fe)
+    {
+      if (cluster + 1 < fe->fe_cluster + fe->fe_nclusters)
+        {
+          return cluster + 1;
+        }
+      else if (fe < &ff->ff_extents[ff->ff_nextents - 1])
+        {
+          return fe[1].fe_cluster;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: fat_extentcontig
+ *
+ * Desciption: Return the number of clusters known to follow 'cluster'
+ *   contiguously on the media.
+ *
+ ****************************************************************************/
+
+uint32_t fat_extentcontig(struct fat_file_s *ff, uint32_t cluster)
+{
+  struct fat_extent_s *fe = fat_extentfind(ff, cluster);
+
+  if (fe)
+    {
+      return fe->fe_cluster + fe->fe_nclusters - 1 - cluster;
+    }
+
+  return 0;
+}
+
+#endif /* CONFIG_FAT_EXTENTS */
@@ -0,0 +1,427 @@
+/****************************************************************************
+ * fs/fat/fs_fat32freemap.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/fat.h>
+
+#include "fs_internal.h"
+#include "fs_fat32.h"
+
+#ifdef CONFIG_FAT_FREEMAP
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_FAT_FREEMAP_MINRUN
+#  define CONFIG_FAT_FREEMAP_MINRUN 8
+#endif
+
+/* One bit per cluster, set if the cluster is free */
+
+#define FREEMAP_NWORDS(f)     (((f)->fs_nclusters + 31) >> 5)
+#define FREEMAP_ISFREE(f,c)   (((f)->fs_freemap[(c) >> 5] & (1u << ((c) & 31))) != 0)
+#define FREEMAP_SETFREE(f,c)  ((f)->fs_freemap[(c) >> 5] |= (1u << ((c) & 31)))
+#define FREEMAP_SETUSED(f,c)  ((f)->fs_freemap[(c) >> 5] &= ~(1u << ((c) & 31)))
+
+/* Index of the least significant set bit of a non-zero word */
+
+#ifdef __GNUC__
+#  define freemap_ctz(w) __builtin_ctz(w)
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifndef freemap_ctz
+static inline int freemap_ctz(uint32_t word)
+{
+  int bit = 0;
+
+  while ((word & 1) == 0)
+    {
+      word >>= 1;
+      bit++;
+    }
+
+  return bit;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_freemapbuild
+ *
+ * Desciption: Allocate the free cluster bitmap and fill it from the FAT.
+ *   The FAT is read through fs_buffer so that FAT sectors that are still
+ *   dirty in memory are seen as they will be written.
+ *
+ ****************************************************************************/
+
+static int fat_freemapbuild(struct fat_mountpt_s *fs)
+{
+  uint32_t cluster;
+  uint32_t nfree;
+  int ret;
+
+  fs->fs_freemap = (uint32_t *)kmm_zalloc(FREEMAP_NWORDS(fs) * sizeof(uint32_t));
+  if (!fs->fs_freemap)
+    {
+      return -ENOMEM;
+    }
+
+  nfree = 0;
+  if (fs->fs_type == FSTYPE_FAT12)
+    {
+      off_t next;
+
+      for (cluster = 2; cluster < fs->fs_nclusters; cluster++)
+        {
+          next = fat_getcluster(fs, cluster);
+          if (next < 0)
+            {
+              ret = next;
+              goto errout_with_freemap;
+            }
+          else if (next == 0)
+            {
+              FREEMAP_SETFREE(fs, cluster);
+              nfree++;
+            }
+        }
+    }
+  else
+    {
+      unsigned int entsize = fs->fs_type == FSTYPE_FAT16 ? 2 : 4;
+      unsigned int offset  = fs->fs_hwsectorsize;
+      off_t        fatsector = fs->fs_fatbase;
+      uint32_t     value;
+
+      for (cluster = 0; cluster < fs->fs_nclusters; cluster++)
+        {
+          if (offset >= fs->fs_hwsectorsize)
+            {
+              ret = fat_fscacheread(fs, fatsector++);
+              if (ret < 0)
+                {
+                  goto errout_with_freemap;
+                }
+
+              offset = 0;
+            }
+
+          if (entsize == 2)
+            {
+              value = FAT_GETFAT16(fs->fs_buffer, offset);
+            }
+          else
+            {
+              value = FAT_GETFAT32(fs->fs_buffer, offset) & 0x0fffffff;
+            }
+
+          offset += entsize;
+
+          if (value == 0 && cluster >= 2)
+            {
+              FREEMAP_SETFREE(fs, cluster);
+              nfree++;
+            }
+        }
+    }
+
+  fs->fs_nfreemap = nfree;
+  fs->fs_freemapnorun = false;
+
+  /* The bitmap is exact; correct the (advisory) FSINFO free count */
+
+  if (fs->fs_fsifreecount != nfree)
+    {
+      fs->fs_fsifreecount = nfree;
+      if (fs->fs_type == FSTYPE_FAT32)
+        {
+          fs->fs_fsidirty = true;
+        }
+    }
+
+  fvdbg("%u of %u clusters free\n", nfree, fs->fs_nclusters - 2);
+  return OK;
+
+errout_with_freemap:
+  kmm_free(fs->fs_freemap);
+  fs->fs_freemap = NULL;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: fat_freemapnext
+ *
+ * Desciption: Return the first free cluster in the range [start, end) or
+ *   zero if there is none.
+ *
+ ****************************************************************************/
+
+static uint32_t fat_freemapnext(struct fat_mountpt_s *fs, uint32_t start,
+                                uint32_t end)
+{
+  uint32_t ndx;
+  uint32_t word;
+  uint32_t cluster;
+
+  while (start < end)
+    {
+      ndx  = start >> 5;
+      word = fs->fs_freemap[ndx] & (0xffffffff << (start & 31));
+      if (word != 0)
+        {
+          cluster = (ndx << 5) + freemap_ctz(word);
+          return cluster < end ? cluster : 0;
+        }
+
+      start = (ndx + 1) << 5;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: fat_freemaprun
+ *
+ * Desciption: Return the first cluster at or after 'start' that begins a
+ *   run of at least CONFIG_FAT_FREEMAP_MINRUN free clusters, wrapping
+ *   around once.  Returns zero if there is no such run.
+ *
+ ****************************************************************************/
+
+static uint32_t fat_freemaprun(struct fat_mountpt_s *fs, uint32_t start)
+{
+  uint32_t first;
+  uint32_t cluster;
+  uint32_t end;
+  int pass;
+
+  end = fs->fs_nclusters;
+  for (pass = 0; pass < 2; pass++)
+    {
+      cluster = start;
+      while ((first = fat_freemapnext(fs, cluster, end)) != 0)
+        {
+          /* Count the free clusters following 'first' */
+
+          for (cluster = first + 1;
+               cluster < fs->fs_nclusters && FREEMAP_ISFREE(fs, cluster) &&
+               cluster - first < CONFIG_FAT_FREEMAP_MINRUN;
+               cluster++);
+
+          if (cluster - first >= CONFIG_FAT_FREEMAP_MINRUN)
+            {
+              return first;
+            }
+        }
+
+      /* Then search from the beginning up to the start cluster */
+
+      end   = start;
+      start = 2;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: fat_freemapfind
+ *
+ * Desciption: Find a free cluster for fat_extendchain().  'startcluster'
+ *   is the last cluster of the chain being extended or, for a new chain,
+ *   the FSINFO next free hint.  The free cluster bitmap is built on first
+ *   use.
+ *
+ *   When extending a chain (extending == true), the cluster immediately
+ *   following the chain is preferred.  If that one is in use, the start
+ *   of the next run of at least CONFIG_FAT_FREEMAP_MINRUN free clusters
+ *   is preferred over isolated free clusters so that large files stay
+ *   mostly contiguous.
+ *
+ * Return: <0:error, 0: no free cluster, >=2: free cluster number
+ *
+ ****************************************************************************/
+
+int32_t fat_freemapfind(struct fat_mountpt_s *fs, uint32_t startcluster,
+                        bool extending)
+{
+  uint32_t first;
+  uint32_t cluster;
+  int ret;
+
+  if (!fs->fs_freemap)
+    {
+      ret = fat_freemapbuild(fs);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  if (fs->fs_nfreemap == 0)
+    {
+      return 0;
+    }
+
+  first = startcluster + 1;
+  if (first < 2 || first >= fs->fs_nclusters)
+    {
+      first = 2;
+    }
+
+  if (extending)
+    {
+      if (FREEMAP_ISFREE(fs, first))
+        {
+          return first;
+        }
+
+      if (!fs->fs_freemapnorun)
+        {
+          cluster = fat_freemaprun(fs, first);
+          if (cluster != 0)
+            {
+              return cluster;
+            }
+
+          /* Don't search again until some cluster is freed */
+
+          fs->fs_freemapnorun = true;
+        }
+    }
+
+  cluster = fat_freemapnext(fs, first, fs->fs_nclusters);
+  if (cluster == 0)
+    {
+      cluster = fat_freemapnext(fs, 2, first);
+    }
+
+  return cluster;
+}
+
+/****************************************************************************
+ * Name: fat_freemapupdate
+ *
+ * Desciption: Keep the bitmap in sync with a FAT entry change.  Called from
+ *   fat_putcluster().
+ *
+ ****************************************************************************/
+
+void fat_freemapupdate(struct fat_mountpt_s *fs, uint32_t cluster,
+                       bool isfree)
+{
+  if (!fs->fs_freemap || cluster < 2 || cluster >= fs->fs_nclusters)
+    {
+      return;
+    }
+
+  if (isfree && !FREEMAP_ISFREE(fs, cluster))
+    {
+      FREEMAP_SETFREE(fs, cluster);
+      fs->fs_nfreemap++;
+      fs->fs_freemapnorun = false;
+    }
+  else if (!isfree && FREEMAP_ISFREE(fs, cluster))
+    {
+      FREEMAP_SETUSED(fs, cluster);
+      fs->fs_nfreemap--;
+    }
+}
+
+/****************************************************************************
+ * Name: fat_freemapcount
+ *
+ * Desciption: Return the number of free clusters from the bitmap, building
+ *   it if necessary.
+ *
+ ****************************************************************************/
+
+int fat_freemapcount(struct fat_mountpt_s *fs, off_t *pfreeclusters)
+{
+  int ret;
+
+  if (!fs->fs_freemap)
+    {
+      ret = fat_freemapbuild(fs);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  *pfreeclusters = fs->fs_nfreemap;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_freemaprelease
+ *
+ * Desciption: Free the bitmap when the volume is unmounted.
+ *
+ ****************************************************************************/
+
+void fat_freemaprelease(struct fat_mountpt_s *fs)
+{
+  if (fs->fs_freemap)
+    {
+      kmm_free(fs->fs_freemap);
+      fs->fs_freemap = NULL;
+    }
+}
+
+#endif /* CONFIG_FAT_FREEMAP */
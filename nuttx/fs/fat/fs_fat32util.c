@@ -284,6 +284,81 @@ static int fat_checkbootrecord(struct fat_mountpt_s *fs)
   return OK;
 }
 
+/****************************************************************************
+ * Name: fat_findfreecluster
+ *
+ * Desciption: Search the FAT entry by entry for a free cluster, starting
+ *   after 'startcluster' and wrapping around at the end of the FAT.
+ *
+ * Return: <0:error, 0: no free cluster, >=2: free cluster number
+ *
+ ****************************************************************************/
+
+static int32_t fat_findfreecluster(struct fat_mountpt_s *fs,
+                                   uint32_t startcluster)
+{
+  off_t    startsector;
+  uint32_t newcluster;
+
+  /* Loop until (1) we discover that there are not free clusters
+   * (return 0), an errors occurs (return -errno), or (3) we find
+   * the next cluster (return the new cluster number).
+   */
+
+  newcluster = startcluster;
+  for (;;)
+    {
+      /* Examine the next cluster in the FAT */
+
+      newcluster++;
+      if (newcluster >= fs->fs_nclusters)
+        {
+          /* If we hit the end of the available clusters, then
+           * wrap back to the beginning because we might have
+           * started at a non-optimal place.  But don't continue
+           * past the start cluster.
+           */
+
+          newcluster = 2;
+          if (newcluster > startcluster)
+            {
+              /* We are back past the starting cluster, then there
+               * is no free cluster.
+               */
+
+              return 0;
+            }
+        }
+
+      /* We have a candidate cluster.  Check if the cluster number is
+       * mapped to a group of sectors.
+       */
+
+      startsector = fat_getcluster(fs, newcluster);
+      if (startsector == 0)
+        {
+          /* Found have found a free cluster */
+
+          return newcluster;
+        }
+      else if (startsector < 0)
+        {
+          /* Some error occurred, return the error number */
+
+          return startsector;
+        }
+
+      /* We wrap all the back to the starting cluster?  If so, then
+       * there are no free clusters.
+       */
+
+      if (newcluster == startcluster)
+        {
+          return 0;
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -550,6 +625,16 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
       goto errout;
     }
 
+#ifdef CONFIG_FAT_SECTCACHE
+  /* Allocate the sector cache that sits behind fs_buffer */
+
+  ret = fat_cacheinitialize(fs);
+  if (ret < 0)
+    {
+      goto errout_with_buffer;
+    }
+#endif
+
   /* Search FAT boot record on the drive.  First check at sector zero.  This
    * could be either the boot record or a partition that refers to the boot
    * record.
@@ -673,6 +758,9 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   return OK;
 
  errout_with_buffer:
+#ifdef CONFIG_FAT_SECTCACHE
+  fat_cacheuninitialize(fs);
+#endif
   fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
   fs->fs_buffer = 0;
 
@@ -766,6 +854,16 @@ int fat_hwwrite(struct fat_mountpt_s *fs, uint8_t *buffer, off_t sector,
                 unsigned int nsectors)
 {
   int ret = -ENODEV;
+
+#ifdef CONFIG_FAT_SECTCACHE
+  /* Any cached copy of these sectors is now stale */
+
+  if (fs)
+    {
+      fat_cacheinvalidate(fs, buffer, sector, nsectors);
+    }
+#endif
+
   if (fs && fs->fs_blkdriver )
     {
       struct inode *inode = fs->fs_blkdriver;
@@ -1091,6 +1189,10 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno, off_t nextclust
       /* Mark the modified sector as "dirty" and return success */
 
       fs->fs_dirty = true;
+
+#ifdef CONFIG_FAT_FREEMAP
+      fat_freemapupdate(fs, clusterno, nextcluster == 0);
+#endif
       return OK;
     }
 
@@ -1159,7 +1261,7 @@ int fat_removechain(struct fat_mountpt_s *fs, uint32_t cluster)
 int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
 {
   off_t    startsector;
-  uint32_t newcluster;
+  int32_t  newcluster;
   uint32_t startcluster;
   int      ret;
 
@@ -1209,62 +1311,23 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
       startcluster = cluster;
     }
 
-  /* Loop until (1) we discover that there are not free clusters
-   * (return 0), an errors occurs (return -errno), or (3) we find
-   * the next cluster (return the new cluster number).
+  /* Find a free cluster, using the free cluster bitmap if we have the
+   * memory for it.
    */
 
-  newcluster = startcluster;
-  for (;;)
+#ifdef CONFIG_FAT_FREEMAP
+  newcluster = fat_freemapfind(fs, startcluster, cluster != 0);
+  if (newcluster == -ENOMEM)
+#endif
     {
-      /* Examine the next cluster in the FAT */
-
-      newcluster++;
-      if (newcluster >= fs->fs_nclusters)
-        {
-          /* If we hit the end of the available clusters, then
-           * wrap back to the beginning because we might have
-           * started at a non-optimal place.  But don't continue
-           * past the start cluster.
-           */
-
-          newcluster = 2;
-          if (newcluster > startcluster)
-            {
-              /* We are back past the starting cluster, then there
-               * is no free cluster.
-               */
-
-              return 0;
-            }
-        }
-
-      /* We have a candidate cluster.  Check if the cluster number is
-       * mapped to a group of sectors.
-       */
-
-      startsector = fat_getcluster(fs, newcluster);
-      if (startsector == 0)
-        {
-          /* Found have found a free cluster break out */
-
-          break;
-        }
-      else if (startsector < 0)
-        {
-          /* Some error occurred, return the error number */
-
-          return startsector;
-        }
+      newcluster = fat_findfreecluster(fs, startcluster);
+    }
 
-      /* We wrap all the back to the starting cluster?  If so, then
-       * there are no free clusters.
-       */
+  if (newcluster <= 0)
+    {
+      /* No free cluster (0) or an error (<0) */
 
-      if (newcluster == startcluster)
-        {
-          return 0;
-        }
+      return newcluster;
     }
 
   /* We get here only if we break out with an available cluster
@@ -1468,7 +1531,9 @@ int  fat_dirtruncate(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo)
 /****************************************************************************
  * Name: fat_fscacheflush
  *
- * Desciption: Flush any dirty sector if fs_buffer as necessary
+ * Desciption: Flush any dirty sector if fs_buffer as necessary.  If the
+ *   sector cache is enabled, the sector is only copied into the cache; it
+ *   reaches the media when it is evicted or when fat_cachesync() is called.
  *
  ****************************************************************************/
 
@@ -1482,6 +1547,13 @@ int fat_fscacheflush(struct fat_mountpt_s *fs)
 
   if (fs->fs_dirty)
     {
+#ifdef CONFIG_FAT_SECTCACHE
+      ret = fat_cachewrite(fs, fs->fs_buffer, fs->fs_currentsector);
+      if (ret < 0)
+        {
+          return ret;
+        }
+#else
       /* Write the dirty sector */
 
       ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
@@ -1492,22 +1564,27 @@ int fat_fscacheflush(struct fat_mountpt_s *fs)
 
       /* Does the sector lie in the FAT region? */
 
-      if (fs->fs_currentsector >= fs->fs_fatbase &&
-          fs->fs_currentsector < fs->fs_fatbase + fs->fs_nfatsects)
+      if (FAT_ISFATSECTOR(fs, fs->fs_currentsector))
         {
-          /* Yes, then make the change in the FAT copy as well */
+          /* Yes, then make the change in the FAT copy as well.  Note that
+           * fs_currentsector must not be changed: fs_buffer still holds
+           * the sector in the first FAT.
+           */
+
+          off_t sector = fs->fs_currentsector;
           int i;
 
           for (i = fs->fs_fatnumfats; i >= 2; i--)
             {
-              fs->fs_currentsector += fs->fs_nfatsects;
-              ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
+              sector += fs->fs_nfatsects;
+              ret = fat_hwwrite(fs, fs->fs_buffer, sector, 1);
               if (ret < 0)
                 {
                   return ret;
                 }
             }
         }
+#endif
 
       /* No longer dirty */
 
@@ -1547,7 +1624,11 @@ int fat_fscacheread(struct fat_mountpt_s *fs, off_t sector)
 
         /* Then read the specified sector into the cache */
 
+#ifdef CONFIG_FAT_SECTCACHE
+        ret = fat_cacheread(fs, fs->fs_buffer, sector);
+#else
         ret = fat_hwread(fs, fs->fs_buffer, sector, 1);
+#endif
         if (ret < 0)
           {
             return ret;
@@ -1719,6 +1800,15 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
         }
     }
 
+#ifdef CONFIG_FAT_SECTCACHE
+  /* Write back everything held in the sector cache */
+
+  if (ret == OK)
+    {
+      ret = fat_cachesync(fs);
+    }
+#endif
+
   return ret;
 }
 
@@ -1733,6 +1823,18 @@ int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
 {
   uint32_t nfreeclusters;
 
+#ifdef CONFIG_FAT_FREEMAP
+  /* The free cluster bitmap keeps an exact count.  Building it costs the
+   * same single pass over the FAT as counting below, and it then serves
+   * all later queries and allocations.
+   */
+
+  if (fat_freemapcount(fs, pfreeclusters) == OK)
+    {
+      return OK;
+    }
+#endif
+
   /* If number of the first free cluster is valid, then just return that value. */
 
   if (fs->fs_fsifreecount <= fs->fs_nclusters - 2)
@@ -1785,12 +1887,11 @@ int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
                   return ret;
                 }
 
-              /* Reset the offset to the next FAT entry.
-               * Increment the sector number to read next time around.
+              /* Reset the offset to the next FAT entry.  The sector number
+               * was already incremented above.
                */
 
               offset = 0;
-              fatsector++;
             }
 
           /* FAT16 and FAT32 differ only on the size of each cluster start
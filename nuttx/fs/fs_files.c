@@ -50,6 +50,9 @@
 #include <nuttx/kmalloc.h>
 
 #include "fs_internal.h"
+#ifdef CONFIG_FS_AIO
+#  include "aio/aio.h"
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -115,6 +118,12 @@ static int _files_close(FAR struct file *filep)
 
   if (inode)
     {
+#ifdef CONFIG_FS_AIO
+      /* Cancel or wait for the asynchronous I/O requests on the file */
+
+      aio_close(filep);
+#endif
+
       /* Close the file, driver, or mountpoint. */
 
       if (inode->u.i_ops && inode->u.i_ops->close)
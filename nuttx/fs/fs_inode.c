@@ -39,12 +39,17 @@
 
 #include <nuttx/config.h>
 
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
 #include <assert.h>
 #include <semaphore.h>
 #include <errno.h>
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
+#include <nuttx/blkcache.h>
 
 #include "fs_internal.h"
 
@@ -63,13 +68,23 @@
  * removed.  In that case umount() hold the inode semaphore, but the block
  * driver may callback to unregister_blockdriver() after the un-mount,
  * requiring the seamphore again.
+ *
+ * Path lookups that do not modify the tree may instead share access as
+ * readers (see inode_rdtake()).  A reader holds the semaphore only while
+ * registering itself; the exclusive holder then waits on rdsem until all
+ * readers are gone.
  */
 
 struct inode_sem_s
 {
-  sem_t   sem;     /* The semaphore */
-  pid_t   holder;  /* The current holder of the semaphore */
-  int16_t count;   /* Number of counts held */
+  sem_t   sem;      /* The semaphore */
+  pid_t   holder;   /* The current holder of the semaphore */
+  int16_t count;    /* Number of counts held */
+#ifdef CONFIG_FS_INODECACHE
+  int16_t nreaders; /* Number of readers */
+  bool    rdwait;   /* The holder waits for the readers to leave */
+  sem_t   rdsem;    /* Posted when the last reader leaves */
+#endif
 };
 
 /****************************************************************************
@@ -165,6 +180,95 @@ static int _inode_compare(FAR const char *fname,
     }
 }
 
+/****************************************************************************
+ * Name: inode_cachesearch
+ *
+ * Description:
+ *   inode_search() for callers that need neither the peer nor the parent
+ *   node.  The whole path is first looked up in the path cache; failing
+ *   that, each path segment is looked up in the child cache before the
+ *   list of peers is searched.  Successful lookups are added to the
+ *   caches.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODECACHE
+static FAR struct inode *inode_cachesearch(FAR const char **path,
+                                           FAR const char **relpath)
+{
+  FAR const char   *name  = *path + 1; /* Skip over leading '/' */
+  FAR struct inode *above = NULL;
+  FAR struct inode *node;
+  int result = 1;
+
+  node = inode_cachepath(*path);
+  if (node)
+    {
+      name = *path + strlen(*path);
+      if (relpath)
+        {
+          *relpath = name;
+        }
+
+      *path = name;
+      return node;
+    }
+
+  for (;;)
+    {
+      node = inode_cachechild(above, name);
+      if (!node)
+        {
+          /* Not cached.  Search the ordered list of peers */
+
+          for (node = above ? above->i_child : root_inode;
+               node;
+               node = node->i_peer)
+            {
+              result = _inode_compare(name, node);
+              if (result <= 0)
+                {
+                  break;
+                }
+            }
+
+          if (!node || result != 0)
+            {
+              node = NULL;
+              break;
+            }
+
+          inode_cacheaddchild(above, name, node);
+        }
+
+      /* As in inode_search(), stop at the end of the path or at a
+       * mountpoint that handles the rest of it.
+       */
+
+      name = inode_nextname(name);
+      if (!*name || INODE_IS_MOUNTPT(node))
+        {
+          if (relpath)
+            {
+              *relpath = name;
+            }
+
+          if (!*name)
+            {
+              inode_cacheaddpath(*path, node);
+            }
+
+          break;
+        }
+
+      above = node;
+    }
+
+  *path = name;
+  return node;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -187,6 +291,9 @@ void fs_initialize(void)
   (void)sem_init(&g_inode_sem.sem, 0, 1);
   g_inode_sem.holder = NO_HOLDER;
   g_inode_sem.count  = 0;
+#ifdef CONFIG_FS_INODECACHE
+  (void)sem_init(&g_inode_sem.rdsem, 0, 0);
+#endif
 
   /* Initialize files array (if it is used) */
 
@@ -238,9 +345,84 @@ void inode_semtake(void)
 
       g_inode_sem.holder = me;
       g_inode_sem.count  = 1;
+
+#ifdef CONFIG_FS_INODECACHE
+      /* No new readers can enter now.  Wait for the current ones to leave */
+
+      sched_lock();
+      while (g_inode_sem.nreaders > 0)
+        {
+          g_inode_sem.rdwait = true;
+          while (sem_wait(&g_inode_sem.rdsem) != 0)
+            {
+              ASSERT(get_errno() == EINTR);
+            }
+        }
+
+      sched_unlock();
+#endif
+    }
+}
+
+#ifdef CONFIG_FS_INODECACHE
+/****************************************************************************
+ * Name: inode_rdtake
+ *
+ * Description:
+ *   Get shared access to the in-memory inode tree for a lookup that does
+ *   not modify it.  If the caller already holds exclusive access, this is
+ *   the same as inode_semtake().  A reader must not call inode_semtake().
+ *
+ ****************************************************************************/
+
+void inode_rdtake(void)
+{
+  if (getpid() == g_inode_sem.holder)
+    {
+      inode_semtake();
+      return;
+    }
+
+  while (sem_wait(&g_inode_sem.sem) != 0)
+    {
+      ASSERT(get_errno() == EINTR);
     }
+
+  sched_lock();
+  g_inode_sem.nreaders++;
+  sched_unlock();
+
+  sem_post(&g_inode_sem.sem);
 }
 
+/****************************************************************************
+ * Name: inode_rdgive
+ *
+ * Description:
+ *   Relinquish the access obtained with inode_rdtake().
+ *
+ ****************************************************************************/
+
+void inode_rdgive(void)
+{
+  if (getpid() == g_inode_sem.holder)
+    {
+      inode_semgive();
+      return;
+    }
+
+  sched_lock();
+  DEBUGASSERT(g_inode_sem.nreaders > 0);
+  if (--g_inode_sem.nreaders == 0 && g_inode_sem.rdwait)
+    {
+      g_inode_sem.rdwait = false;
+      sem_post(&g_inode_sem.rdsem);
+    }
+
+  sched_unlock();
+}
+#endif
+
 /****************************************************************************
  * Name: inode_semgive
  *
@@ -294,6 +476,13 @@ FAR struct inode *inode_search(FAR const char **path,
   FAR struct inode *left  = NULL;
   FAR struct inode *above = NULL;
 
+#ifdef CONFIG_FS_INODECACHE
+  if (!peer && !parent)
+    {
+      return inode_cachesearch(path, relpath);
+    }
+#endif
+
   while (node)
     {
       int result = _inode_compare(name, node);
@@ -400,6 +589,12 @@ void inode_free(FAR struct inode *node)
     {
       inode_free(node->i_peer);
       inode_free(node->i_child);
+#ifdef CONFIG_DRVR_BLKCACHE
+      if (INODE_IS_BLOCK(node))
+        {
+          blkcache_detach(node);
+        }
+#endif
       kmm_free(node);
     }
 }
@@ -0,0 +1,306 @@
+/****************************************************************************
+ * fs/fs_inodecache.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+
+#include <nuttx/fs/fs.h>
+
+#include "fs_internal.h"
+
+#ifdef CONFIG_FS_INODECACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_FS_INODECACHE_NCHILD
+#  define CONFIG_FS_INODECACHE_NCHILD 64
+#endif
+
+#ifndef CONFIG_FS_INODECACHE_NPATHS
+#  define CONFIG_FS_INODECACHE_NPATHS 16
+#endif
+
+#ifndef CONFIG_FS_INODECACHE_PATHLEN
+#  define CONFIG_FS_INODECACHE_PATHLEN 32
+#endif
+
+/* FNV-1a hash */
+
+#define FNV_OFFSET 2166136261u
+#define FNV_PRIME  16777619u
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Caches the result of looking up one path segment under a directory */
+
+struct inode_child_s
+{
+  uint32_t gen;                             /* Valid if equal to g_inode_gen */
+  FAR struct inode *parent;                 /* Directory (NULL: root level) */
+  FAR struct inode *node;                   /* The child node */
+};
+
+/* Caches the result of looking up a whole path */
+
+struct inode_path_s
+{
+  uint32_t gen;                             /* Valid if equal to g_inode_gen */
+  uint32_t hash;                            /* Hash of path */
+  FAR struct inode *node;                   /* The node the path refers to */
+  char path[CONFIG_FS_INODECACHE_PATHLEN];  /* The NUL terminated path */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Every change to the shape of the inode tree increments the generation,
+ * which invalidates all cached entries at once.  Zero is never used so that
+ * the zeroed tables start out empty.
+ */
+
+static uint32_t g_inode_gen = 1;
+
+static struct inode_child_s g_inode_child[CONFIG_FS_INODECACHE_NCHILD];
+static struct inode_path_s g_inode_path[CONFIG_FS_INODECACHE_NPATHS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_childhash
+ *
+ * Description:
+ *   Hash the path segment 'name' (terminated by '/' or NUL) together with
+ *   the directory it is looked up in.
+ *
+ ****************************************************************************/
+
+static uint32_t inode_childhash(FAR struct inode *parent,
+                                FAR const char *name)
+{
+  uint32_t hash = FNV_OFFSET ^ (uint32_t)(uintptr_t)parent;
+
+  for (; *name && *name != '/'; name++)
+    {
+      hash = (hash ^ (uint8_t)*name) * FNV_PRIME;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: inode_pathhash
+ ****************************************************************************/
+
+static uint32_t inode_pathhash(FAR const char *path, FAR size_t *len)
+{
+  FAR const char *ptr;
+  uint32_t hash = FNV_OFFSET;
+
+  for (ptr = path; *ptr; ptr++)
+    {
+      hash = (hash ^ (uint8_t)*ptr) * FNV_PRIME;
+    }
+
+  *len = ptr - path;
+  return hash;
+}
+
+/****************************************************************************
+ * Name: inode_namematch
+ *
+ * Description:
+ *   Return true if the path segment 'name' is the name of 'node'.
+ *
+ ****************************************************************************/
+
+static bool inode_namematch(FAR const char *name, FAR struct inode *node)
+{
+  FAR const char *nname = node->i_name;
+
+  while (*nname && *nname == *name)
+    {
+      nname++;
+      name++;
+    }
+
+  return !*nname && (!*name || *name == '/');
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cacheinvalidate
+ ****************************************************************************/
+
+void inode_cacheinvalidate(void)
+{
+  sched_lock();
+  if (++g_inode_gen == 0)
+    {
+      /* On wrap-around, entries of old generations could become valid
+       * again.  Clear everything.
+       */
+
+      memset(g_inode_child, 0, sizeof(g_inode_child));
+      memset(g_inode_path, 0, sizeof(g_inode_path));
+      g_inode_gen = 1;
+    }
+
+  sched_unlock();
+}
+
+/****************************************************************************
+ * Name: inode_cachechild
+ ****************************************************************************/
+
+FAR struct inode *inode_cachechild(FAR struct inode *parent,
+                                   FAR const char *name)
+{
+  FAR struct inode_child_s *entry;
+  FAR struct inode *node = NULL;
+
+  entry = &g_inode_child[inode_childhash(parent, name) %
+                         CONFIG_FS_INODECACHE_NCHILD];
+
+  /* Lookups run concurrently under the read lock; sched_lock() keeps the
+   * entry consistent while it is read or written.
+   */
+
+  sched_lock();
+  if (entry->gen == g_inode_gen && entry->parent == parent &&
+      inode_namematch(name, entry->node))
+    {
+      node = entry->node;
+    }
+
+  sched_unlock();
+  return node;
+}
+
+/****************************************************************************
+ * Name: inode_cacheaddchild
+ ****************************************************************************/
+
+void inode_cacheaddchild(FAR struct inode *parent, FAR const char *name,
+                         FAR struct inode *node)
+{
+  FAR struct inode_child_s *entry;
+
+  entry = &g_inode_child[inode_childhash(parent, name) %
+                         CONFIG_FS_INODECACHE_NCHILD];
+
+  sched_lock();
+  entry->gen    = g_inode_gen;
+  entry->parent = parent;
+  entry->node   = node;
+  sched_unlock();
+}
+
+/****************************************************************************
+ * Name: inode_cachepath
+ ****************************************************************************/
+
+FAR struct inode *inode_cachepath(FAR const char *path)
+{
+  FAR struct inode_path_s *entry;
+  FAR struct inode *node = NULL;
+  uint32_t hash;
+  size_t len;
+
+  hash = inode_pathhash(path, &len);
+  if (len >= CONFIG_FS_INODECACHE_PATHLEN)
+    {
+      return NULL;
+    }
+
+  entry = &g_inode_path[hash % CONFIG_FS_INODECACHE_NPATHS];
+
+  sched_lock();
+  if (entry->gen == g_inode_gen && entry->hash == hash &&
+      strcmp(entry->path, path) == 0)
+    {
+      node = entry->node;
+    }
+
+  sched_unlock();
+  return node;
+}
+
+/****************************************************************************
+ * Name: inode_cacheaddpath
+ ****************************************************************************/
+
+void inode_cacheaddpath(FAR const char *path, FAR struct inode *node)
+{
+  FAR struct inode_path_s *entry;
+  uint32_t hash;
+  size_t len;
+
+  hash = inode_pathhash(path, &len);
+  if (len >= CONFIG_FS_INODECACHE_PATHLEN)
+    {
+      return;
+    }
+
+  entry = &g_inode_path[hash % CONFIG_FS_INODECACHE_NPATHS];
+
+  sched_lock();
+  entry->gen  = g_inode_gen;
+  entry->hash = hash;
+  entry->node = node;
+  memcpy(entry->path, path, len + 1);
+  sched_unlock();
+}
+
+#endif /* CONFIG_FS_INODECACHE */
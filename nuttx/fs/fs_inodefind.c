@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <sched.h>
 #include <errno.h>
 #include <nuttx/fs/fs.h>
 
@@ -86,6 +87,22 @@ FAR struct inode *inode_find(FAR const char *path, FAR const char **relpath)
    * references on the node.
    */
 
+#ifdef CONFIG_FS_INODECACHE
+  /* Lookups may run concurrently, so the reference count is incremented
+   * with the scheduler locked.
+   */
+
+  inode_rdtake();
+  node = inode_search(&path, (FAR struct inode**)NULL, (FAR struct inode**)NULL, relpath);
+  if (node)
+    {
+      sched_lock();
+      node->i_crefs++;
+      sched_unlock();
+    }
+
+  inode_rdgive();
+#else
   inode_semtake();
   node = inode_search(&path, (FAR struct inode**)NULL, (FAR struct inode**)NULL, relpath);
   if (node)
@@ -94,6 +111,7 @@ FAR struct inode *inode_find(FAR const char *path, FAR const char **relpath)
     }
 
   inode_semgive();
+#endif
   return node;
 }
 
@@ -124,6 +124,12 @@ FAR struct inode *inode_unlink(FAR const char *path)
         }
 
       node->i_peer = NULL;
+
+#ifdef CONFIG_FS_INODECACHE
+      /* Cached lookups may refer to the node or to its children */
+
+      inode_cacheinvalidate();
+#endif
     }
 
   return node;
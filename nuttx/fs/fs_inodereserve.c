@@ -135,6 +135,10 @@ static void inode_insert(FAR struct inode *node,
       node->i_peer = root_inode;
       root_inode   = node;
     }
+
+#ifdef CONFIG_FS_INODECACHE
+  inode_cacheinvalidate();
+#endif
 }
 
 /****************************************************************************
@@ -131,6 +131,29 @@ void inode_semtake(void);
 
 void inode_semgive(void);
 
+#ifdef CONFIG_FS_INODECACHE
+/****************************************************************************
+ * Name: inode_rdtake
+ *
+ * Description:
+ *   Get shared access to the in-memory inode tree for a lookup that does
+ *   not modify the tree.
+ *
+ ****************************************************************************/
+
+void inode_rdtake(void);
+
+/****************************************************************************
+ * Name: inode_rdgive
+ *
+ * Description:
+ *   Relinquish the access obtained with inode_rdtake().
+ *
+ ****************************************************************************/
+
+void inode_rdgive(void);
+#endif
+
 /****************************************************************************
  * Name: inode_search
  *
@@ -169,6 +192,48 @@ void inode_free(FAR struct inode *node);
 
 const char *inode_nextname(FAR const char *name);
 
+/* fs_inodecache.c **********************************************************/
+
+#ifdef CONFIG_FS_INODECACHE
+/****************************************************************************
+ * Name: inode_cacheinvalidate
+ *
+ * Description:
+ *   Discard all cached lookups.  Called whenever an inode is linked into
+ *   or unlinked from the tree.
+ *
+ ****************************************************************************/
+
+void inode_cacheinvalidate(void);
+
+/****************************************************************************
+ * Name: inode_cachechild and inode_cacheaddchild
+ *
+ * Description:
+ *   Look up or remember the child of directory 'parent' (NULL for the top
+ *   level) named by the path segment 'name'.
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_cachechild(FAR struct inode *parent,
+                                   FAR const char *name);
+void inode_cacheaddchild(FAR struct inode *parent, FAR const char *name,
+                         FAR struct inode *node);
+
+/****************************************************************************
+ * Name: inode_cachepath and inode_cacheaddpath
+ *
+ * Description:
+ *   Look up or remember the inode that a whole absolute path refers to.
+ *   Paths of CONFIG_FS_INODECACHE_PATHLEN or more characters are not
+ *   cached.
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_cachepath(FAR const char *path);
+void inode_cacheaddpath(FAR const char *path, FAR struct inode *node);
+#endif
+
 /* fs_inodereserver.c *******************************************************/
 /****************************************************************************
  * Name: inode_reserve
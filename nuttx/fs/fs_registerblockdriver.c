@@ -43,6 +43,7 @@
 #include <errno.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/blkcache.h>
 
 #include "fs_internal.h"
 
@@ -116,6 +117,14 @@ int register_blockdriver(FAR const char *path,
 #endif
       node->i_private = priv;
       ret             = OK;
+
+#ifdef CONFIG_DRVR_BLKCACHE
+      /* Put the shared block cache in front of the driver.  If that is not
+       * possible, the driver is simply used uncached.
+       */
+
+      (void)blkcache_attach(node);
+#endif
     }
 
   inode_semgive();
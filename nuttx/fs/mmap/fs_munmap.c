@@ -93,7 +93,9 @@
  *   2. If CONFIG_FS_RAMMAP is defined in the configuration, then mmap() will
  *      support simulation of memory mapped files by copying files whole
  *      into RAM.  munmap() is required in this case to free the allocated
- *      memory holding the shared copy of the file.
+ *      memory holding the shared copy of the file.  If the copy is shared
+ *      by several mmap() callers, it is freed when the last of them
+ *      unmaps it.
  *
  * Parameters:
  *   start   The start address of the mapping to delete.  For this
@@ -156,6 +158,38 @@ int munmap(FAR void *start, size_t length)
    */
 
   offset = start - curr->addr;
+
+#ifdef CONFIG_FS_RAMMAP_SHARED
+  /* A region that may be shared is found by any mmap() of the same file
+   * that is no longer than the region, so each caller may have mapped a
+   * different length.  Unmapping from the start of such a region drops
+   * this caller's reference whatever the length; the region is freed
+   * when the last reference is dropped.  A region that other callers
+   * still use cannot be partially unmapped.
+   */
+
+  if (curr->inode)
+    {
+      if (offset == 0)
+        {
+          if (curr->crefs > 1)
+            {
+              curr->crefs--;
+              sem_post(&g_rammaps.exclsem);
+              return OK;
+            }
+
+          length = curr->length;
+        }
+      else if (curr->crefs > 1)
+        {
+          fdbg("Cannot partially unmap a shared region\n");
+          err = EINVAL;
+          goto errout_with_semaphore;
+        }
+    }
+#endif
+
   if (offset + length < curr->length)
     {
       fdbg("Cannot umap without unmapping to the end\n");
@@ -184,6 +218,15 @@ int munmap(FAR void *start, size_t length)
           g_rammaps.head = curr->flink;
         }
 
+#ifdef CONFIG_FS_RAMMAP_SHARED
+      /* Release the inode that keyed the region */
+
+      if (curr->inode)
+        {
+          inode_release(curr->inode);
+        }
+#endif
+
       /* Then free the region */
 
       kumm_free(curr);
@@ -195,9 +238,24 @@ int munmap(FAR void *start, size_t length)
 
   else
     {
-      newaddr = kumm_realloc(curr->addr, sizeof(struct fs_rammap_s) + length);
-      DEBUGASSERT(newaddr == (FAR void*)(curr->addr));
-      curr->length = length;
+#ifdef CONFIG_FS_RAMMAP_SHARED
+      /* The file name is held after the mapped data and the truncated
+       * region no longer maps the file as requested.  Stop sharing it.
+       */
+
+      if (curr->inode)
+        {
+          inode_release(curr->inode);
+          curr->inode = NULL;
+          curr->name  = NULL;
+        }
+#endif
+
+      /* Keep the first 'offset' bytes of the region */
+
+      newaddr = kumm_realloc(curr, sizeof(struct fs_rammap_s) + offset);
+      DEBUGASSERT(newaddr == (FAR void*)curr);
+      curr->length = offset;
     }
 
   sem_post(&g_rammaps.exclsem);
@@ -41,13 +41,20 @@
 
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <sys/ioctl.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <assert.h>
 #include <errno.h>
 #include <debug.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/sched.h>
+#include <nuttx/fs/ioctl.h>
 
 #include "fs_internal.h"
 #include "fs_rammap.h"
@@ -62,6 +69,90 @@
 
 struct fs_allmaps_s g_rammaps;
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rammap_identify
+ *
+ * Description:
+ *   Get the inode and, for a file on a mountpoint, the file name that
+ *   identify the file opened as 'fd'.  Returns false if mappings of the
+ *   file cannot be shared:  The file is open for writing or the file
+ *   system cannot report the name of the file.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_RAMMAP_SHARED
+static bool rammap_identify(int fd, FAR struct inode **inode,
+                            FAR const char **name)
+{
+  FAR struct filelist *list;
+  FAR struct file *filep;
+
+  if ((unsigned int)fd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return false;
+    }
+
+  list = sched_getfiles();
+  DEBUGASSERT(list);
+
+  filep = &list->fl_files[fd];
+  if (!filep->f_inode || (filep->f_oflags & O_WROK) != 0)
+    {
+      return false;
+    }
+
+  *inode = filep->f_inode;
+  *name  = NULL;
+
+  /* All files on a mountpoint share the mountpoint inode */
+
+  if (INODE_IS_MOUNTPT(filep->f_inode) &&
+      ioctl(fd, FIOC_FILENAME, (unsigned long)((uintptr_t)name)) < 0)
+    {
+      fvdbg("File name not available, mapping is not shared\n");
+      return false;
+    }
+
+  return true;
+}
+#endif
+
+/****************************************************************************
+ * Name: rammap_find
+ *
+ * Description:
+ *   Find a region that maps at least 'length' bytes of the file from
+ *   'offset'.  A region that already has the maximum number of references
+ *   is not returned; the caller then maps its own copy of the file.  The
+ *   caller must hold g_rammaps.exclsem.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_RAMMAP_SHARED
+static FAR struct fs_rammap_s *rammap_find(FAR struct inode *inode,
+                                           FAR const char *name,
+                                           size_t length, off_t offset)
+{
+  FAR struct fs_rammap_s *map;
+
+  for (map = g_rammaps.head; map; map = map->flink)
+    {
+      if (map->inode == inode && map->offset == offset &&
+          map->length >= length && map->crefs < UINT16_MAX &&
+          (name ? (map->name && strcmp(map->name, name) == 0) : !map->name))
+        {
+          return map;
+        }
+    }
+
+  return NULL;
+}
+#endif
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -119,27 +210,55 @@ FAR void *rammap(int fd, size_t length, off_t offset)
   FAR struct fs_rammap_s *map;
   FAR uint8_t *alloc;
   FAR uint8_t *rdbuffer;
+  size_t namelen = 0;
   ssize_t nread;
   off_t fpos;
   int err;
   int ret;
-
-  /* There is a major design flaw that I have not yet thought of fix for:
-   * The goal is to have a single region of memory that represents a single
-   * file and can be shared by many threads.  That is, given a filename a
-   * thread should be able to open the file, get a file descriptor, and
-   * call mmap() to get a memory region.  Different file descriptors opened
-   * with the same file path should get the same memory region when mapped.
-   *
-   * The design flaw is that I don't have sufficient knowledge to know that
-   * these different file descriptors map to the same file.  So, for the time
-   * being, a new memory region is created each time that rammap() is called.
-   * Not very useful!
+#ifdef CONFIG_FS_RAMMAP_SHARED
+  FAR struct fs_rammap_s *other;
+  FAR struct inode *inode = NULL;
+  FAR const char *name = NULL;
+  bool shared;
+
+  /* Different file descriptors opened on the same file should get the same
+   * memory region.  If the file can be identified and is already mapped,
+   * just take another reference to that region.
    */
 
+  shared = rammap_identify(fd, &inode, &name);
+  if (shared)
+    {
+      rammap_initialize();
+      ret = sem_wait(&g_rammaps.exclsem);
+      if (ret < 0)
+        {
+          return MAP_FAILED;
+        }
+
+      map = rammap_find(inode, name, length, offset);
+      if (map)
+        {
+          map->crefs++;
+          sem_post(&g_rammaps.exclsem);
+          return map->addr;
+        }
+
+      sem_post(&g_rammaps.exclsem);
+
+      /* The name is copied after the mapped data */
+
+      if (name)
+        {
+          namelen = strlen(name) + 1;
+        }
+    }
+#endif
+
   /* Allocate a region of memory of the specified size */
 
-  alloc = (FAR uint8_t *)kumm_malloc(sizeof(struct fs_rammap_s) + length);
+  alloc = (FAR uint8_t *)kumm_malloc(sizeof(struct fs_rammap_s) + length +
+                                     namelen);
   if (!alloc)
     {
       fdbg("Region allocation failed, length: %d\n", (int)length);
@@ -154,6 +273,9 @@ FAR void *rammap(int fd, size_t length, off_t offset)
   map->addr   = alloc + sizeof(struct fs_rammap_s);
   map->length = length;
   map->offset = offset;
+#ifdef CONFIG_FS_RAMMAP_SHARED
+  map->crefs  = 1;
+#endif
 
   /* Seek to the specified file offset */
 
@@ -225,6 +347,36 @@ FAR void *rammap(int fd, size_t length, off_t offset)
       goto errout_with_errno;
     }
 
+#ifdef CONFIG_FS_RAMMAP_SHARED
+  if (shared)
+    {
+      /* Another thread may have mapped the same file while the file was
+       * being read.  If so, use that region and discard this one.
+       */
+
+      other = rammap_find(inode, name, map->length, offset);
+      if (other)
+        {
+          other->crefs++;
+          sem_post(&g_rammaps.exclsem);
+          kumm_free(alloc);
+          return other->addr;
+        }
+
+      /* Keep a reference to the inode so that it cannot be reused while
+       * it is the key of this region.
+       */
+
+      if (name)
+        {
+          map->name = strcpy((FAR char *)map->addr + map->length, name);
+        }
+
+      map->inode = inode;
+      inode_addref(inode);
+    }
+#endif
+
   map->flink  = g_rammaps.head;
   g_rammaps.head = map;
 
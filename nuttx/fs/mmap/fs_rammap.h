@@ -45,6 +45,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <semaphore.h>
 
 #ifdef CONFIG_FS_RAMMAP
@@ -72,6 +73,11 @@
  * - All mapped files are read-only.  You can write to the in-memory image,
  *   but the file contents will not change.
  * - There are not access privileges.
+ *
+ * With CONFIG_FS_RAMMAP_SHARED, a region is keyed by the inode and offset
+ * of the mapped file (and, for a file on a mountpoint, by the file name
+ * returned by FIOC_FILENAME).  Further mappings of the same file share the
+ * region and it is freed when the last of them is unmapped.
  */
 
 struct fs_rammap_s
@@ -80,6 +86,11 @@ struct fs_rammap_s
   FAR void           *addr;        /* Start of allocated memory */
   size_t              length;      /* Length of region */
   off_t               offset;      /* File offset */
+#ifdef CONFIG_FS_RAMMAP_SHARED
+  FAR struct inode   *inode;       /* Inode of the mapped file (NULL: private) */
+  FAR const char     *name;        /* Relative name of a file on a mountpoint */
+  uint16_t            crefs;       /* Number of mmap() callers sharing the region */
+#endif
 };
 
 /* This structure defines all "mapped" files */
@@ -255,6 +255,20 @@ struct nxffs_blkentry_s
   uint16_t                  foffset;  /* Offset to start of data */
 };
 
+#ifdef CONFIG_NXFFS_INDEX
+/* This structure describes one slot in the RAM inode index.  The index is
+ * a hash table of the valid inodes on the volume, keyed by the CRC of the
+ * inode name.  Only the hash and the FLASH offset are kept; the name is
+ * always verified against the inode header in FLASH.
+ */
+
+struct nxffs_index_s
+{
+  uint32_t                  hash;      /* CRC32 of the inode name */
+  off_t                     hoffset;   /* FLASH offset to the inode header (0=empty) */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -301,6 +315,12 @@ struct nxffs_volume_s
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
   FAR uint8_t              *cache;     /* On cached erase block for general I/O */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+#ifdef CONFIG_NXFFS_INDEX
+  FAR struct nxffs_index_s *index;     /* RAM inode index (hash table) */
+  size_t                    idxsize;   /* Number of slots in the index (power of 2) */
+  size_t                    idxcount;  /* Number of valid inodes in the index */
+  bool                      idxvalid;  /* True: The index describes every valid inode */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -1041,6 +1061,76 @@ int nxffs_rdblkhdr(FAR struct nxffs_volume_s *volume, off_t offset,
 
 int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name);
 
+/****************************************************************************
+ * Name: nxffs_idxreset, nxffs_idxadd, nxffs_idxremove, nxffs_idxmove,
+ *       nxffs_idxinvalidate
+ *
+ * Description:
+ *   Maintain the RAM inode index.  nxffs_idxreset() empties the index (as
+ *   at the beginning of the mount-time scan or after the volume is re-
+ *   formatted).  nxffs_idxadd() and nxffs_idxremove() record an inode
+ *   header that was written or deleted.  nxffs_idxmove() records an inode
+ *   header that was relocated by the packing logic.  nxffs_idxinvalidate()
+ *   discards the index when it can no longer be trusted; it will be rebuilt
+ *   on the next look-up.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume.
+ *   name    - The name of the inode.
+ *   hoffset - FLASH offset to the inode header.
+ *   newoffset - The new FLASH offset to the inode header (nxffs_idxmove).
+ *
+ * Returned Value:
+ *   None.  A failure to allocate memory for the index will simply
+ *   invalidate the index.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+void nxffs_idxreset(FAR struct nxffs_volume_s *volume);
+void nxffs_idxadd(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                  off_t hoffset);
+void nxffs_idxremove(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                     off_t hoffset);
+void nxffs_idxmove(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                   off_t hoffset, off_t newoffset);
+void nxffs_idxinvalidate(FAR struct nxffs_volume_s *volume);
+#else
+#  define nxffs_idxreset(v)
+#  define nxffs_idxadd(v,n,o)
+#  define nxffs_idxremove(v,n,o)
+#  define nxffs_idxmove(v,n,o,p)
+#  define nxffs_idxinvalidate(v)
+#endif
+
+/****************************************************************************
+ * Name: nxffs_idxfind
+ *
+ * Description:
+ *   Use the RAM inode index to find the inode with the provided name.  The
+ *   index is rebuilt first if it was invalidated.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success and -ENOENT is returned if there is no
+ *   inode with this name.  -ESTALE is returned if the index is not usable;
+ *   the caller must then search the FLASH for the inode.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+int nxffs_idxfind(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                  FAR struct nxffs_entry_s *entry);
+#endif
+
 /****************************************************************************
  * Name: nxffs_pack
  *
@@ -0,0 +1,466 @@
+/****************************************************************************
+ * fs/nxffs/nxffs_index.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <crc32.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+
+#include "nxffs.h"
+
+#ifdef CONFIG_NXFFS_INDEX
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The initial number of slots in the index.  The index is doubled in size
+ * whenever it becomes more than 3/4 full.
+ */
+
+#define NXFFS_IDX_INITSIZE  16
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_idxhash
+ *
+ * Description:
+ *   Return the hash of an inode name.
+ *
+ ****************************************************************************/
+
+static inline uint32_t nxffs_idxhash(FAR const char *name)
+{
+  return crc32((FAR const uint8_t *)name, strlen(name));
+}
+
+/****************************************************************************
+ * Name: nxffs_idxslot
+ *
+ * Description:
+ *   Return the index slot that holds the inode header at this FLASH offset
+ *   or NULL if there is no such slot.
+ *
+ ****************************************************************************/
+
+static FAR struct nxffs_index_s *
+nxffs_idxslot(FAR struct nxffs_volume_s *volume, uint32_t hash,
+              off_t hoffset)
+{
+  size_t mask;
+  size_t i;
+
+  if (volume->idxsize == 0)
+    {
+      return NULL;
+    }
+
+  mask = volume->idxsize - 1;
+  for (i = hash & mask; volume->index[i].hoffset != 0; i = (i + 1) & mask)
+    {
+      if (volume->index[i].hash == hash && volume->index[i].hoffset == hoffset)
+        {
+          return &volume->index[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxffs_idxinsert
+ *
+ * Description:
+ *   Insert an entry into the index.  There must be a free slot.
+ *
+ ****************************************************************************/
+
+static void nxffs_idxinsert(FAR struct nxffs_index_s *index, size_t size,
+                            uint32_t hash, off_t hoffset)
+{
+  size_t mask = size - 1;
+  size_t i;
+
+  for (i = hash & mask; index[i].hoffset != 0; i = (i + 1) & mask);
+
+  index[i].hash    = hash;
+  index[i].hoffset = hoffset;
+}
+
+/****************************************************************************
+ * Name: nxffs_idxgrow
+ *
+ * Description:
+ *   Double the size of the index.
+ *
+ ****************************************************************************/
+
+static int nxffs_idxgrow(FAR struct nxffs_volume_s *volume)
+{
+  FAR struct nxffs_index_s *index;
+  size_t newsize;
+  size_t i;
+
+  newsize = volume->idxsize ? 2 * volume->idxsize : NXFFS_IDX_INITSIZE;
+  index   = (FAR struct nxffs_index_s *)
+    kmm_zalloc(newsize * sizeof(struct nxffs_index_s));
+
+  if (!index)
+    {
+      fdbg("ERROR: Failed to allocate an index of %d slots\n", newsize);
+      return -ENOMEM;
+    }
+
+  /* Re-hash the existing entries into the new index */
+
+  for (i = 0; i < volume->idxsize; i++)
+    {
+      if (volume->index[i].hoffset != 0)
+        {
+          nxffs_idxinsert(index, newsize, volume->index[i].hash,
+                          volume->index[i].hoffset);
+        }
+    }
+
+  if (volume->index)
+    {
+      kmm_free(volume->index);
+    }
+
+  volume->index   = index;
+  volume->idxsize = newsize;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxffs_idxbuild
+ *
+ * Description:
+ *   Rebuild the index by walking every valid inode on the volume.
+ *
+ ****************************************************************************/
+
+static int nxffs_idxbuild(FAR struct nxffs_volume_s *volume)
+{
+  struct nxffs_entry_s entry;
+  off_t offset;
+  int ret;
+
+  fvdbg("Rebuilding the inode index\n");
+  nxffs_idxreset(volume);
+
+  offset = volume->inoffset;
+  while ((ret = nxffs_nextentry(volume, offset, &entry)) == OK)
+    {
+      nxffs_idxadd(volume, entry.name, entry.hoffset);
+      offset = nxffs_inodeend(volume, &entry);
+      nxffs_freeentry(&entry);
+    }
+
+  /* -ENOENT simply means that the end of the valid data was reached */
+
+  if (ret != -ENOENT)
+    {
+      nxffs_idxinvalidate(volume);
+      return ret;
+    }
+
+  return volume->idxvalid ? OK : -ENOMEM;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_idxreset
+ *
+ * Description:
+ *   Empty the index.  The index then describes a volume with no inodes.
+ *
+ ****************************************************************************/
+
+void nxffs_idxreset(FAR struct nxffs_volume_s *volume)
+{
+  if (volume->index)
+    {
+      memset(volume->index, 0, volume->idxsize * sizeof(struct nxffs_index_s));
+    }
+
+  volume->idxcount = 0;
+  volume->idxvalid = true;
+}
+
+/****************************************************************************
+ * Name: nxffs_idxadd
+ *
+ * Description:
+ *   Record a new inode header in the index.
+ *
+ ****************************************************************************/
+
+void nxffs_idxadd(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                  off_t hoffset)
+{
+  DEBUGASSERT(hoffset != 0);
+
+  if (!volume->idxvalid)
+    {
+      return;
+    }
+
+  /* Keep the index no more than 3/4 full so that the probe sequences stay
+   * short.
+   */
+
+  if (4 * (volume->idxcount + 1) > 3 * volume->idxsize &&
+      nxffs_idxgrow(volume) < 0)
+    {
+      nxffs_idxinvalidate(volume);
+      return;
+    }
+
+  nxffs_idxinsert(volume->index, volume->idxsize, nxffs_idxhash(name),
+                  hoffset);
+  volume->idxcount++;
+}
+
+/****************************************************************************
+ * Name: nxffs_idxremove
+ *
+ * Description:
+ *   Remove a deleted inode header from the index.
+ *
+ ****************************************************************************/
+
+void nxffs_idxremove(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                     off_t hoffset)
+{
+  FAR struct nxffs_index_s *slot;
+  size_t mask;
+  size_t home;
+  size_t i;
+  size_t j;
+
+  if (!volume->idxvalid)
+    {
+      return;
+    }
+
+  slot = nxffs_idxslot(volume, nxffs_idxhash(name), hoffset);
+  if (!slot)
+    {
+      return;
+    }
+
+  /* Remove the entry, then move any following entries of the same probe
+   * sequence back so that no look-up will stop early at the hole.
+   */
+
+  mask = volume->idxsize - 1;
+  i    = slot - volume->index;
+  j    = i;
+
+  for (;;)
+    {
+      j = (j + 1) & mask;
+      if (volume->index[j].hoffset == 0)
+        {
+          break;
+        }
+
+      /* Can the entry at j be moved back to the hole at i?  Only if its
+       * home slot does not lie cyclically in (i, j].
+       */
+
+      home = volume->index[j].hash & mask;
+      if ((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+        {
+          continue;
+        }
+
+      volume->index[i] = volume->index[j];
+      i = j;
+    }
+
+  volume->index[i].hash    = 0;
+  volume->index[i].hoffset = 0;
+  volume->idxcount--;
+}
+
+/****************************************************************************
+ * Name: nxffs_idxmove
+ *
+ * Description:
+ *   Record that the packing logic relocated an inode header.
+ *
+ ****************************************************************************/
+
+void nxffs_idxmove(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                   off_t hoffset, off_t newoffset)
+{
+  FAR struct nxffs_index_s *slot;
+
+  if (volume->idxvalid)
+    {
+      slot = nxffs_idxslot(volume, nxffs_idxhash(name), hoffset);
+      if (slot)
+        {
+          slot->hoffset = newoffset;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_idxinvalidate
+ *
+ * Description:
+ *   Discard the index.  It will be rebuilt on the next look-up.
+ *
+ ****************************************************************************/
+
+void nxffs_idxinvalidate(FAR struct nxffs_volume_s *volume)
+{
+  fvdbg("Inode index invalidated\n");
+  volume->idxvalid = false;
+}
+
+/****************************************************************************
+ * Name: nxffs_idxfind
+ *
+ * Description:
+ *   Use the RAM inode index to find the inode with the provided name.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success and -ENOENT is returned if there is no
+ *   inode with this name.  -ESTALE is returned if the index is not usable.
+ *
+ ****************************************************************************/
+
+int nxffs_idxfind(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                  FAR struct nxffs_entry_s *entry)
+{
+  struct nxffs_entry_s tmp;
+  uint32_t hash;
+  off_t hoffset;
+  bool found;
+  size_t mask;
+  size_t i;
+  int ret;
+
+  if (!volume->idxvalid && nxffs_idxbuild(volume) < 0)
+    {
+      return -ESTALE;
+    }
+
+  if (volume->idxcount == 0)
+    {
+      return -ENOENT;
+    }
+
+  /* Check each inode with a matching hash.  If there is more than one inode
+   * with the name (as can happen if power was lost while a file was being
+   * replaced), return the first one in FLASH just as a linear search would.
+   */
+
+  hash  = nxffs_idxhash(name);
+  mask  = volume->idxsize - 1;
+  found = false;
+
+  for (i = hash & mask; volume->index[i].hoffset != 0; i = (i + 1) & mask)
+    {
+      hoffset = volume->index[i].hoffset;
+      if (volume->index[i].hash != hash ||
+          (found && hoffset > entry->hoffset))
+        {
+          continue;
+        }
+
+      /* Read and verify the inode header */
+
+      ret = nxffs_nextentry(volume, hoffset, &tmp);
+      if (ret < 0 || tmp.hoffset != hoffset)
+        {
+          fdbg("ERROR: No inode at indexed offset %d\n", hoffset);
+          if (ret == OK)
+            {
+              nxffs_freeentry(&tmp);
+            }
+
+          if (found)
+            {
+              nxffs_freeentry(entry);
+            }
+
+          nxffs_idxinvalidate(volume);
+          return -ESTALE;
+        }
+
+      if (strcmp(name, tmp.name) != 0)
+        {
+          nxffs_freeentry(&tmp);
+          continue;
+        }
+
+      if (found)
+        {
+          nxffs_freeentry(entry);
+        }
+
+      memcpy(entry, &tmp, sizeof(struct nxffs_entry_s));
+      found = true;
+    }
+
+  return found ? OK : -ENOENT;
+}
+
+#endif /* CONFIG_NXFFS_INDEX */
@@ -313,6 +313,15 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
   fdbg("ERROR: Failed to calculate file system limits: %d\n", -ret);
 
 errout_with_buffer:
+#ifdef CONFIG_NXFFS_INDEX
+  if (volume->index)
+    {
+      kmm_free(volume->index);
+      volume->index   = NULL;
+      volume->idxsize = 0;
+    }
+
+#endif
   kmm_free(volume->pack);
 errout_with_cache:
   kmm_free(volume->cache);
@@ -357,6 +366,10 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
   int nerased;
   int ret;
 
+  /* The inode index is rebuilt as the inodes are found */
+
+  nxffs_idxreset(volume);
+
   /* Get the offset to the first valid block on the FLASH */
 
   block = 0;
@@ -402,6 +415,7 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
 
       /* Discard this entry and set the next offset. */
 
+      nxffs_idxadd(volume, entry.name, entry.hoffset);
       offset = nxffs_inodeend(volume, &entry);
       nxffs_freeentry(&entry);
     }
@@ -414,6 +428,7 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
         {
           /* Discard the entry and guess the next offset. */
 
+          nxffs_idxadd(volume, entry.name, entry.hoffset);
           offset = nxffs_inodeend(volume, &entry);
           nxffs_freeentry(&entry);
         }
@@ -390,6 +390,18 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
   off_t offset;
   int ret;
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* Use the RAM inode index if possible.  Fall back to searching FLASH only
+   * if the index cannot be trusted.
+   */
+
+  ret = nxffs_idxfind(volume, name, entry);
+  if (ret != -ESTALE)
+    {
+      return ret;
+    }
+#endif
+
   /* Start with the first valid inode that was discovered when the volume
    * was created (or modified after the last file system re-packing).
    */
@@ -41,6 +41,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 #include <assert.h>
 #include <errno.h>
@@ -108,7 +109,7 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       goto errout;
     }
 
-  /* Only a reformat and optimize commands are supported */
+  /* Only the reformat, optimize and file name commands are supported */
 
   if (cmd == FIOC_REFORMAT)
     {
@@ -136,6 +137,27 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
       ret = nxffs_pack(volume);
     }
+
+  else if (cmd == FIOC_FILENAME)
+    {
+      FAR struct nxffs_ofile_s *ofile;
+      FAR const char **ptr = (FAR const char **)((uintptr_t)arg);
+
+      /* Return the name held in the open file structure.  It persists
+       * while the file is open.
+       */
+
+      ofile = (FAR struct nxffs_ofile_s *)filep->f_priv;
+      if (ptr == NULL)
+        {
+          ret = -EINVAL;
+        }
+      else
+        {
+          *ptr = ofile->entry.name;
+          ret = OK;
+        }
+    }
   else
     {
       /* No other commands supported */
@@ -917,6 +917,11 @@ static inline int nxffs_wrclose(FAR struct nxffs_volume_s *volume,
   /* Write the inode header to FLASH */
 
   ret = nxffs_wrinode(volume, &wrfile->ofile.entry);
+  if (ret == OK)
+    {
+      nxffs_idxadd(volume, wrfile->ofile.entry.name,
+                   wrfile->ofile.entry.hoffset);
+    }
 
   /* The volume is now available for other writers */
 
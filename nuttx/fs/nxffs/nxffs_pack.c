@@ -182,6 +182,50 @@ static inline bool nxffs_packvalid(FAR struct nxffs_pack_s *pack)
           blkhdr->state == BLOCK_STATE_GOOD);
 }
 
+/****************************************************************************
+ * Name: nxffs_packclean
+ *
+ * Description:
+ *   Check if the erase block in the pack buffer is already in the state
+ *   that packing would leave it in once all valid inodes have been
+ *   relocated:  Every I/O block holds only its block header followed by
+ *   erased FLASH.  There is no need to erase and re-write such a block.
+ *
+ * Input Parameters:
+ *   volume - The volume being packed.  The erase block has been read into
+ *     volume->pack.
+ *
+ * Returned Values:
+ *   True if the erase block need not be re-written.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NXFFS_NAND
+static inline bool nxffs_packclean(FAR struct nxffs_volume_s *volume)
+{
+  FAR const uint8_t *iobuffer;
+  uint16_t offset;
+  int i;
+
+  for (i = 0, iobuffer = volume->pack;
+       i < volume->blkper;
+       i++, iobuffer += volume->geo.blocksize)
+    {
+      for (offset = SIZEOF_NXFFS_BLOCK_HDR;
+           offset < volume->geo.blocksize;
+           offset++)
+        {
+          if (iobuffer[offset] != CONFIG_NXFFS_ERASEDSTATE)
+            {
+              return false;
+            }
+        }
+    }
+
+  return true;
+}
+#endif
+
 /****************************************************************************
  * Name: nxffs_mediacheck
  *
@@ -486,6 +530,8 @@ static int nxffs_destsetup(FAR struct nxffs_volume_s *volume,
        */
 
       pack->dest.entry.hoffset = nxffs_packtell(volume, pack);
+      nxffs_idxmove(volume, pack->dest.entry.name, pack->src.entry.hoffset,
+                    pack->dest.entry.hoffset);
 
       /* Make sure that the initialize state of the inode header memory is
        * erased.  This is important because we may not write to inode header
@@ -955,9 +1001,18 @@ static inline int nxffs_packblock(FAR struct nxffs_volume_s *volume,
           nxffs_wrdathdr(volume, pack);
           nxffs_wrinodehdr(volume, pack);
 
-          /* Find the next valid source inode */
+          /* Find the next valid source inode.  A zero length file has no
+           * data blocks; resume the search just after its inode header.
+           */
 
-          offset = pack->src.blkoffset + pack->src.blklen;
+          if (pack->src.blkoffset > 0)
+            {
+              offset = pack->src.blkoffset + pack->src.blklen;
+            }
+          else
+            {
+              offset = pack->src.entry.hoffset + SIZEOF_NXFFS_INODE_HDR;
+            }
           memset(&pack->src, 0, sizeof(struct nxffs_packstream_s));
 
           ret = nxffs_nextentry(volume, offset, &pack->src.entry);
@@ -1247,6 +1302,44 @@ static inline int nxffs_packwriter(FAR struct nxffs_volume_s *volume,
   return -ENOSYS;
 }
 
+/****************************************************************************
+ * Name: nxffs_firstinode
+ *
+ * Description:
+ *   Packing moves the valid inodes toward the beginning of FLASH.  Find the
+ *   new offset to the first valid inode header so that searches that begin
+ *   at volume->inoffset do not skip over the relocated inodes.
+ *
+ * Input Parameters:
+ *   volume - The volume that was packed
+ *
+ * Returned Values:
+ *   None.
+ *
+ ****************************************************************************/
+
+static void nxffs_firstinode(FAR struct nxffs_volume_s *volume)
+{
+  struct nxffs_entry_s entry;
+  off_t block;
+
+  block = 0;
+  if (nxffs_validblock(volume, &block) == OK &&
+      nxffs_nextentry(volume, block * volume->geo.blocksize, &entry) == OK)
+    {
+      volume->inoffset = entry.hoffset;
+      nxffs_freeentry(&entry);
+    }
+  else
+    {
+      /* There are no valid inodes on the volume */
+
+      volume->inoffset = volume->froffset;
+    }
+
+  fvdbg("First inode at offset %d\n", volume->inoffset);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -1331,6 +1424,7 @@ int nxffs_pack(FAR struct nxffs_volume_s *volume)
 
                   volume->froffset =
                     block * volume->geo.blocksize + SIZEOF_NXFFS_BLOCK_HDR;
+                  volume->inoffset = volume->froffset;
                 }
             }
 
@@ -1426,6 +1520,19 @@ start_pack:
           goto errout_with_pack;
         }
 
+      /* Only the erase blocks that hold live data or stale data need to be
+       * re-written.  Once all of the valid inodes have been relocated, the
+       * remaining erase blocks are only reset to the erased state; skip the
+       * erase and the write for those that are already erased (normally,
+       * everything beyond the old end of the free FLASH region).
+       */
+
+      if (packed && wrfile == NULL && pack.ioblock < pack.block0 &&
+          nxffs_packclean(volume))
+        {
+          continue;
+        }
+
 #else
       /* Read the entire erase block into the pack buffer, one-block-at-a-
        * time.  We need to do this even if we are overwriting the entire
@@ -1601,6 +1708,14 @@ start_pack:
     }
 
 errout_with_pack:
+  nxffs_firstinode(volume);
+  if (ret < 0)
+    {
+      /* The inodes may have been left anywhere */
+
+      nxffs_idxinvalidate(volume);
+    }
+
   nxffs_freeentry(&pack.src.entry);
   nxffs_freeentry(&pack.dest.entry);
   return ret;
@@ -296,9 +296,14 @@ int nxffs_reformat(FAR struct nxffs_volume_s *volume)
   if (ret < 0)
     {
       fdbg("ERROR: Failed to reformat the volume: %d\n", -ret);
+      nxffs_idxinvalidate(volume);
       return ret;
     }
 
+  /* There are no inodes on the re-formatted volume */
+
+  nxffs_idxreset(volume);
+
   /* Check for bad blocks */
 
   ret = nxffs_badblocks(volume);
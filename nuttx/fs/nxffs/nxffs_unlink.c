@@ -145,6 +145,10 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name)
       fdbg("ERROR: Failed to write block %d: %d\n",
            volume->ioblock, ret);
     }
+  else
+    {
+      nxffs_idxremove(volume, name, entry.hoffset);
+    }
 
 errout_with_entry:
   nxffs_freeentry(&entry);
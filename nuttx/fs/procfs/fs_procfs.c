@@ -78,6 +78,10 @@
 extern const struct procfs_operations proc_operations;
 extern const struct procfs_operations cpuload_operations;
 extern const struct procfs_operations uptime_operations;
+extern const struct procfs_operations trace_operations;
+extern const struct procfs_operations workq_operations;
+extern const struct procfs_operations slabinfo_operations;
+extern const struct procfs_operations heapprof_operations;
 
 /* This is not good.  These are implemented in drivers/mtd.  Having to
  * deal with them here is not a good coupling.
@@ -117,6 +121,10 @@ static const struct procfs_entry_s g_procfsentries[] =
   { "fs/smartfs**",     &smartfs_procfsoperations },
 #endif
 
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_HEAPPROF)
+  { "heapprof",         &heapprof_operations },
+#endif
+
 #if defined(CONFIG_MTD) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MTD)
   { "mtd",              &mtd_procfsoperations },
 #endif
@@ -125,10 +133,23 @@ static const struct procfs_entry_s g_procfsentries[] =
   { "partitions",       &part_procfsoperations },
 #endif
 
+#if defined(CONFIG_MM_SLAB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SLABINFO)
+  { "slabinfo",         &slabinfo_operations },
+#endif
+
+#if defined(CONFIG_SCHED_TRACE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_TRACE)
+  { "trace",            &trace_operations },
+#endif
+
 #if !defined(CONFIG_FS_PROCFS_EXCLUDE_UPTIME)
   { "uptime",           &uptime_operations },
 #endif
 
+#if defined(CONFIG_SCHED_WORKQUEUE) && defined(CONFIG_SCHED_WORKSTATS) && \
+   !defined(CONFIG_FS_PROCFS_EXCLUDE_WORKQ)
+  { "workq",            &workq_operations },
+#endif
+
 #if defined(CONFIG_STM32_CCM_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_CCM)
   { "ccm",             &ccm_procfsoperations },
 #endif
@@ -0,0 +1,416 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsheapprof.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/statfs.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_HEAPPROF)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The text of the whole file is a header line and one line for each
+ * allocation site, then a header line and one line for each size class.
+ */
+
+#define HEAPPROF_LINELEN  80
+#define HEAPPROF_NLINES   (CONFIG_MM_PROFILE_NSITES + MM_NNODES + 2)
+
+/* The size of the open file structure holding 'n' lines of text */
+
+#define SIZEOF_HEAPPROF_FILE_S(n) \
+  (sizeof(struct heapprof_file_s) + (n) * HEAPPROF_LINELEN - 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file".  The statistics are formatted
+ * when the file is opened so that all reads see a consistent snapshot.
+ */
+
+struct heapprof_file_s
+{
+  struct procfs_file_s  base;        /* Base open file structure */
+  size_t alloc;                      /* Size of this structure */
+  size_t size;                       /* Number of valid characters in text[] */
+  char text[1];                      /* The formatted statistics */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     heapprof_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     heapprof_close(FAR struct file *filep);
+static ssize_t heapprof_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     heapprof_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     heapprof_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations heapprof_operations =
+{
+  heapprof_open,        /* open */
+  heapprof_close,       /* close */
+  heapprof_read,        /* read */
+  NULL,              /* write */
+
+  heapprof_dup,         /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  heapprof_stat         /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapprof_sort
+ *
+ * Description:
+ *   Sort the sites by decreasing number of live bytes.  There are only a
+ *   few dozen sites so an insertion sort is good enough.
+ *
+ ****************************************************************************/
+
+static void heapprof_sort(FAR struct mm_prsite_s *sites, int nsites)
+{
+  struct mm_prsite_s tmp;
+  int i;
+  int j;
+
+  for (i = 1; i < nsites; i++)
+    {
+      tmp = sites[i];
+      for (j = i; j > 0 && sites[j - 1].ps_live < tmp.ps_live; j--)
+        {
+          sites[j] = sites[j - 1];
+        }
+
+      sites[j] = tmp;
+    }
+}
+
+/****************************************************************************
+ * Name: heapprof_format
+ *
+ * Description:
+ *   Format the site table, followed by the allocation count and free chunk
+ *   histogram of each size class.
+ *
+ ****************************************************************************/
+
+static void heapprof_format(FAR struct heapprof_file_s *attr,
+                            FAR struct mm_prsite_s *sites)
+{
+  uint32_t nclass[MM_NNODES];
+  uint32_t nchunks[MM_NNODES];
+  size_t   nbytes[MM_NNODES];
+  uint32_t elapsed;
+  uint32_t rate;
+  int nsites;
+  int i;
+
+  nsites = mm_profile_snapshot(&g_mmheap, sites, CONFIG_MM_PROFILE_NSITES,
+                               nclass, &elapsed);
+  heapprof_sort(sites, nsites);
+  mm_freehist(&g_mmheap, nchunks, nbytes);
+
+  /* Allocation sites.  Sizes are in bytes and include the chunk headers;
+   * the rate is in allocations per second since the previous snapshot.
+   */
+
+  attr->size = snprintf(attr->text, HEAPPROF_LINELEN,
+                        "%-10s %8s %6s %8s %8s %6s\n",
+                        "CALLER", "LIVE", "NLIVE", "PEAK", "ALLOCS",
+                        "RATE");
+
+  for (i = 0; i < nsites; i++)
+    {
+      rate = 0;
+      if (elapsed > 0)
+        {
+          rate = (uint32_t)(((uint64_t)(sites[i].ps_nallocs -
+                                        sites[i].ps_lastallocs) * 1000) /
+                            elapsed);
+        }
+
+      attr->size += snprintf(&attr->text[attr->size], HEAPPROF_LINELEN,
+                             "0x%08lx %8lu %6lu %8lu %8lu %6lu\n",
+                             (unsigned long)(uintptr_t)sites[i].ps_caller,
+                             (unsigned long)sites[i].ps_live,
+                             (unsigned long)sites[i].ps_nlive,
+                             (unsigned long)sites[i].ps_peak,
+                             (unsigned long)sites[i].ps_nallocs,
+                             (unsigned long)rate);
+    }
+
+  /* Size classes.  Class n holds chunks of CHUNK up to 2*CHUNK-1 bytes. */
+
+  attr->size += snprintf(&attr->text[attr->size], HEAPPROF_LINELEN,
+                         "\n%-10s %8s %6s %8s\n",
+                         "CHUNK", "ALLOCS", "NFREE", "FREE");
+
+  for (i = 0; i < MM_NNODES; i++)
+    {
+      attr->size += snprintf(&attr->text[attr->size], HEAPPROF_LINELEN,
+                             "%-10lu %8lu %6lu %8lu\n",
+                             (unsigned long)MM_MIN_CHUNK << i,
+                             (unsigned long)nclass[i],
+                             (unsigned long)nchunks[i],
+                             (unsigned long)nbytes[i]);
+    }
+}
+
+/****************************************************************************
+ * Name: heapprof_open
+ ****************************************************************************/
+
+static int heapprof_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct heapprof_file_s *attr;
+  FAR struct mm_prsite_s *sites;
+  size_t alloc;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      fdbg("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* "heapprof" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "heapprof") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes and the text, and a
+   * temporary copy of the site table.
+   */
+
+  alloc = SIZEOF_HEAPPROF_FILE_S(HEAPPROF_NLINES);
+  attr  = (FAR struct heapprof_file_s *)kmm_zalloc(alloc);
+  sites = (FAR struct mm_prsite_s *)
+    kmm_malloc(CONFIG_MM_PROFILE_NSITES * sizeof(struct mm_prsite_s));
+
+  if (!attr || !sites)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      kmm_free(attr);
+      kmm_free(sites);
+      return -ENOMEM;
+    }
+
+  attr->alloc = alloc;
+  heapprof_format(attr, sites);
+  kmm_free(sites);
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapprof_close
+ ****************************************************************************/
+
+static int heapprof_close(FAR struct file *filep)
+{
+  FAR struct heapprof_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct heapprof_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapprof_read
+ ****************************************************************************/
+
+static ssize_t heapprof_read(FAR struct file *filep, FAR char *buffer,
+                          size_t buflen)
+{
+  FAR struct heapprof_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct heapprof_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Transfer the formatted statistics to the user receive buffer */
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->text, attr->size, buffer, buflen, &offset);
+
+  /* Update the file offset */
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: heapprof_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int heapprof_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct heapprof_file_s *oldattr;
+  FAR struct heapprof_file_s *newattr;
+
+  fvdbg("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct heapprof_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the file attributes */
+
+  newattr = (FAR struct heapprof_file_s *)kmm_malloc(oldattr->alloc);
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, oldattr->alloc);
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapprof_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int heapprof_stat(const char *relpath, struct stat *buf)
+{
+  /* "heapprof" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "heapprof") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* "heapprof" is the name for a read-only file */
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_MM_PROFILE && !CONFIG_FS_PROCFS_EXCLUDE_HEAPPROF */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -60,7 +60,7 @@
 #include <nuttx/fs/procfs.h>
 #include <nuttx/fs/dirent.h>
 
-#ifdef CONFIG_SCHED_CPULOAD
+#if defined(CONFIG_SCHED_CPULOAD) || defined(CONFIG_SCHED_CPUTIME)
 #  include <nuttx/clock.h>
 #endif
 
@@ -92,6 +92,9 @@ enum proc_node_e
   PROC_CMDLINE,                       /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   PROC_LOADAVG,                       /* Average CPU utilization */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  PROC_CPUTIME,                       /* Accumulated CPU time */
 #endif
   PROC_STACK,                         /* Task stack info */
   PROC_GROUP,                         /* Group directory */
@@ -148,6 +151,11 @@ static ssize_t proc_loadavg(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
 #endif
+#ifdef CONFIG_SCHED_CPUTIME
+static ssize_t proc_cputime(FAR struct proc_file_s *procfile,
+                 FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
+                 off_t offset);
+#endif
 static ssize_t proc_stack(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
@@ -230,6 +238,13 @@ static const struct proc_node_s g_loadavg =
 };
 #endif
 
+#ifdef CONFIG_SCHED_CPUTIME
+static const struct proc_node_s g_cputime =
+{
+  "cputime",      "cputime", (uint8_t)PROC_CPUTIME,      DTYPE_FILE        /* Accumulated CPU time */
+};
+#endif
+
 static const struct proc_node_s g_stack =
 {
   "stack",        "stack",   (uint8_t)PROC_STACK,        DTYPE_FILE        /* Task stack info */
@@ -258,6 +273,9 @@ static FAR const struct proc_node_s * const g_nodeinfo[] =
   &g_cmdline,      /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   &g_loadavg,      /* Average CPU utilization */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  &g_cputime,      /* Accumulated CPU time */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -274,6 +292,9 @@ static const struct proc_node_s * const g_level0info[] =
   &g_cmdline,      /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   &g_loadavg,      /* Average CPU utilization */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  &g_cputime,      /* Accumulated CPU time */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -590,6 +611,66 @@ static ssize_t proc_loadavg(FAR struct proc_file_s *procfile,
 }
 #endif
 
+/****************************************************************************
+ * Name: proc_cputime
+ *
+ * Description:
+ *   Show the time that the thread has run, the time spent in interrupt
+ *   handlers and the total time, in seconds.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUTIME
+static ssize_t proc_cputime(FAR struct proc_file_s *procfile,
+                            FAR struct tcb_s *tcb, FAR char *buffer,
+                            size_t buflen, off_t offset)
+{
+  static FAR const char * const labels[3] =
+  {
+    "Active:", "Interrupt:", "Total:"
+  };
+
+  struct cputime_s cputime;
+  uint64_t usec[3];
+  size_t remaining;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  int i;
+
+  /* clock_cputime should only fail if the thread exited sometime after the
+   * procfs entry was opened.
+   */
+
+  if (clock_cputime(procfile->pid, &cputime) < 0)
+    {
+      return 0;
+    }
+
+  usec[0]   = cputime.active;
+  usec[1]   = cputime.irq;
+  usec[2]   = cputime.total;
+
+  remaining = buflen;
+  totalsize = 0;
+
+  for (i = 0; i < 3 && totalsize < buflen; i++)
+    {
+      linesize   = snprintf(procfile->line, STATUS_LINELEN, "%-12s%lu.%06lu\n",
+                            labels[i], (unsigned long)(usec[i] / USEC_PER_SEC),
+                            (unsigned long)(usec[i] % USEC_PER_SEC));
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining,
+                                 &offset);
+
+      totalsize += copysize;
+      buffer    += copysize;
+      remaining -= copysize;
+    }
+
+  return totalsize;
+}
+#endif
+
 /****************************************************************************
  * Name: proc_stack
  ****************************************************************************/
@@ -1063,6 +1144,11 @@ static ssize_t proc_read(FAR struct file *filep, FAR char *buffer,
     case PROC_LOADAVG: /* Average CPU utilization */
       ret = proc_loadavg(procfile, tcb, buffer, buflen, filep->f_pos);
       break;
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+    case PROC_CPUTIME: /* Accumulated CPU time */
+      ret = proc_cputime(procfile, tcb, buffer, buflen, filep->f_pos);
+      break;
 #endif
     case PROC_STACK: /* Task stack info */
       ret = proc_stack(procfile, tcb, buffer, buflen, filep->f_pos);
@@ -0,0 +1,364 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsslab.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/statfs.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/slab.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_MM_SLAB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SLABINFO)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The text of the whole file is a header line and one line for each
+ * object cache.
+ */
+
+#define SLABINFO_LINELEN  80
+
+/* The size of the open file structure holding 'n' lines of text */
+
+#define SIZEOF_SLABINFO_FILE_S(n) \
+  (sizeof(struct slabinfo_file_s) + (n) * SLABINFO_LINELEN - 1)
+
+/* The capacity of the text[] buffer of an open file */
+
+#define SLABINFO_TEXTLEN(a) \
+  ((a)->alloc - sizeof(struct slabinfo_file_s) + 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file".  The statistics are formatted
+ * when the file is opened so that all reads see a consistent snapshot.
+ */
+
+struct slabinfo_file_s
+{
+  struct procfs_file_s  base;        /* Base open file structure */
+  size_t alloc;                      /* Size of this structure */
+  size_t size;                       /* Number of valid characters in text[] */
+  char text[1];                      /* The formatted statistics */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     slabinfo_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     slabinfo_close(FAR struct file *filep);
+static ssize_t slabinfo_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     slabinfo_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     slabinfo_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations slabinfo_operations =
+{
+  slabinfo_open,        /* open */
+  slabinfo_close,       /* close */
+  slabinfo_read,        /* read */
+  NULL,              /* write */
+
+  slabinfo_dup,         /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  slabinfo_stat         /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slabinfo_count
+ ****************************************************************************/
+
+static int slabinfo_count(FAR struct slab_cache_s *cache, FAR void *arg)
+{
+  (*(FAR int *)arg)++;
+  return 0;
+}
+
+/****************************************************************************
+ * Name: slabinfo_line
+ ****************************************************************************/
+
+static int slabinfo_line(FAR struct slab_cache_s *cache, FAR void *arg)
+{
+  FAR struct slabinfo_file_s *attr = (FAR struct slabinfo_file_s *)arg;
+  struct slab_info_s info;
+
+  /* Stop if a cache was created after the buffer was sized */
+
+  if (attr->size + SLABINFO_LINELEN > SLABINFO_TEXTLEN(attr))
+    {
+      return 1;
+    }
+
+  slab_info(cache, &info);
+  attr->size += snprintf(&attr->text[attr->size], SLABINFO_LINELEN,
+                         "%-12s %6lu %5u %6lu %6lu %6lu %8lu %5lu\n",
+                         info.name, (unsigned long)info.objsize,
+                         info.nslabs, (unsigned long)info.nobjs,
+                         (unsigned long)info.ninuse,
+                         (unsigned long)info.npeak,
+                         (unsigned long)info.nallocs,
+                         (unsigned long)info.nfails);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: slabinfo_open
+ ****************************************************************************/
+
+static int slabinfo_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct slabinfo_file_s *attr;
+  size_t alloc;
+  int ncaches = 0;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      fdbg("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* "slabinfo" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "slabinfo") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes and one line of text
+   * for the header and for each cache.
+   */
+
+  (void)slab_foreach(slabinfo_count, &ncaches);
+
+  alloc = SIZEOF_SLABINFO_FILE_S(ncaches + 1);
+  attr  = (FAR struct slabinfo_file_s *)kmm_zalloc(alloc);
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  attr->alloc = alloc;
+
+  /* Format the statistics of each cache.  Sizes are in bytes. */
+
+  attr->size = snprintf(attr->text, SLABINFO_LINELEN,
+                        "%-12s %6s %5s %6s %6s %6s %8s %5s\n",
+                        "CACHE", "SIZE", "SLABS", "OBJS", "INUSE", "PEAK",
+                        "ALLOCS", "FAILS");
+
+  (void)slab_foreach(slabinfo_line, attr);
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: slabinfo_close
+ ****************************************************************************/
+
+static int slabinfo_close(FAR struct file *filep)
+{
+  FAR struct slabinfo_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct slabinfo_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: slabinfo_read
+ ****************************************************************************/
+
+static ssize_t slabinfo_read(FAR struct file *filep, FAR char *buffer,
+                          size_t buflen)
+{
+  FAR struct slabinfo_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct slabinfo_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Transfer the formatted statistics to the user receive buffer */
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->text, attr->size, buffer, buflen, &offset);
+
+  /* Update the file offset */
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: slabinfo_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int slabinfo_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct slabinfo_file_s *oldattr;
+  FAR struct slabinfo_file_s *newattr;
+
+  fvdbg("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct slabinfo_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the file attributes */
+
+  newattr = (FAR struct slabinfo_file_s *)kmm_malloc(oldattr->alloc);
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, oldattr->alloc);
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: slabinfo_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int slabinfo_stat(const char *relpath, struct stat *buf)
+{
+  /* "slabinfo" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "slabinfo") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* "slabinfo" is the name for a read-only file */
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_MM_SLAB && !CONFIG_FS_PROCFS_EXCLUDE_SLABINFO */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -0,0 +1,370 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsworkq.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/statfs.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_SCHED_WORKQUEUE) && defined(CONFIG_SCHED_WORKSTATS) && \
+   !defined(CONFIG_FS_PROCFS_EXCLUDE_WORKQ)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The size of the buffer that holds the text of the whole file:  A header
+ * line and one line for each work queue.
+ */
+
+#define WORKQ_LINELEN  64
+#define WORKQ_TEXTLEN  ((NWORKERS + 1) * WORKQ_LINELEN)
+
+/* snprintf() returns the length that the line would have had.  A line that
+ * was truncated holds WORKQ_LINELEN - 1 characters.
+ */
+
+#define WORKQ_CLAMP(n) ((n) < WORKQ_LINELEN ? (n) : WORKQ_LINELEN - 1)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file".  The statistics are formatted
+ * when the file is opened so that all reads see a consistent snapshot.
+ */
+
+struct workq_file_s
+{
+  struct procfs_file_s  base;        /* Base open file structure */
+  size_t size;                       /* Number of valid characters in text[] */
+  char text[WORKQ_TEXTLEN];          /* The formatted statistics */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     workq_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     workq_close(FAR struct file *filep);
+static ssize_t workq_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     workq_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     workq_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The names and thread counts of the work queues, indexed by queue ID */
+
+static FAR const char * const g_workq_names[NWORKERS] =
+{
+#ifdef CONFIG_SCHED_LPWORK
+  "hpwork", "lpwork"
+#else
+  "work"
+#endif
+};
+
+static const uint8_t g_workq_nthreads[NWORKERS] =
+{
+#ifdef CONFIG_SCHED_LPWORK
+  CONFIG_SCHED_WORKNTHREADS, CONFIG_SCHED_LPWORKNTHREADS
+#else
+  CONFIG_SCHED_WORKNTHREADS
+#endif
+};
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_mount.c -- this structure is explicitly externed there.
+ * We use the old-fashioned kind of initializers so that this will compile
+ * with any compiler.
+ */
+
+const struct procfs_operations workq_operations =
+{
+  workq_open,        /* open */
+  workq_close,       /* close */
+  workq_read,        /* read */
+  NULL,              /* write */
+
+  workq_dup,         /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  workq_stat         /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: workq_open
+ ****************************************************************************/
+
+static int workq_open(FAR struct file *filep, FAR const char *relpath,
+                      int oflags, mode_t mode)
+{
+  FAR struct workq_file_s *attr;
+  struct work_stats_s stats;
+  uint32_t avgwait;
+  uint32_t avgexec;
+  size_t size;
+  int linesize;
+  int qid;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* PROCFS is read-only.  Any attempt to open with any kind of write
+   * access is not permitted.
+   */
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+    {
+      fdbg("ERROR: Only O_RDONLY supported\n");
+      return -EACCES;
+    }
+
+  /* "workq" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "workq") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = (FAR struct workq_file_s *)kmm_zalloc(sizeof(struct workq_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Format the statistics of each work queue.  All times are in
+   * microseconds.
+   */
+
+  linesize = snprintf(attr->text, WORKQ_LINELEN,
+                      "%-8s %2s %10s %8s %8s %8s %8s\n",
+                      "QUEUE", "NT", "COUNT", "AVGWAIT", "MAXWAIT",
+                      "AVGEXEC", "MAXEXEC");
+  size = WORKQ_CLAMP(linesize);
+
+  for (qid = 0; qid < NWORKERS; qid++)
+    {
+      (void)work_stats(qid, &stats);
+
+      avgwait = 0;
+      avgexec = 0;
+
+      if (stats.count > 0)
+        {
+          avgwait = (uint32_t)(stats.totwait / stats.count);
+          avgexec = (uint32_t)(stats.totexec / stats.count);
+        }
+
+      linesize = snprintf(&attr->text[size], WORKQ_LINELEN,
+                          "%-8s %2d %10lu %8lu %8lu %8lu %8lu\n",
+                          g_workq_names[qid], g_workq_nthreads[qid],
+                          (unsigned long)stats.count, (unsigned long)avgwait,
+                          (unsigned long)stats.maxwait,
+                          (unsigned long)avgexec,
+                          (unsigned long)stats.maxexec);
+      size += WORKQ_CLAMP(linesize);
+    }
+
+  attr->size = size;
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: workq_close
+ ****************************************************************************/
+
+static int workq_close(FAR struct file *filep)
+{
+  FAR struct workq_file_s *attr;
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct workq_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Release the file attributes structure */
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: workq_read
+ ****************************************************************************/
+
+static ssize_t workq_read(FAR struct file *filep, FAR char *buffer,
+                          size_t buflen)
+{
+  FAR struct workq_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  attr = (FAR struct workq_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Transfer the formatted statistics to the user receive buffer */
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->text, attr->size, buffer, buflen, &offset);
+
+  /* Update the file offset */
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: workq_dup
+ *
+ * Description:
+ *   Duplicate open file data in the new file structure.
+ *
+ ****************************************************************************/
+
+static int workq_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct workq_file_s *oldattr;
+  FAR struct workq_file_s *newattr;
+
+  fvdbg("Dup %p->%p\n", oldp, newp);
+
+  /* Recover our private data from the old struct file instance */
+
+  oldattr = (FAR struct workq_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  /* Allocate a new container to hold the file attributes */
+
+  newattr = (FAR struct workq_file_s *)kmm_malloc(sizeof(struct workq_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* The copy the file attributes from the old attributes to the new */
+
+  memcpy(newattr, oldattr, sizeof(struct workq_file_s));
+
+  /* Save the new attributes in the new file structure */
+
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: workq_stat
+ *
+ * Description: Return information about a file or directory
+ *
+ ****************************************************************************/
+
+static int workq_stat(const char *relpath, struct stat *buf)
+{
+  /* "workq" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "workq") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* "workq" is the name for a read-only file */
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_SCHED_WORKQUEUE && CONFIG_SCHED_WORKSTATS && !CONFIG_FS_PROCFS_EXCLUDE_WORKQ */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -710,6 +710,8 @@ static size_t smartfs_status_read(FAR struct file *filep, FAR char *buffer,
   int       ret;
   size_t    len;
   int       utilization;
+  uint32_t  host;
+  uint32_t  flash;
 
   priv = (FAR struct smartfs_file_s *) filep->f_priv;
 
@@ -758,6 +760,32 @@ static size_t smartfs_status_read(FAR struct file *filep, FAR char *buffer,
                   procfs_data.sectorsperblk);
                   //procfs_data.unusedsectors, procfs_data.blockerases,
                   //procfs_data.sectorsperblk, utilization);
+
+          /* Write amplification is the number of sectors written to the
+           * device per sector allocated or written by the file system.
+           * Scale the counts down so that the fraction cannot overflow.
+           */
+
+          host  = procfs_data.hostwrites;
+          flash = procfs_data.flashwrites;
+          while (host > 0x00ffffff)
+            {
+              host  >>= 1;
+              flash >>= 1;
+            }
+
+          if (host == 0)
+            {
+              host  = 1;
+              flash = 1;
+            }
+
+          len += snprintf(&buffer[len], buflen - len,
+                          "Block Erases:      %d\nErase Counts:      %d - %d\n"
+                          "Write Amplif.:     %d.%02d\nMax Op Time:       %d ms\n",
+                          procfs_data.blockerases, procfs_data.minerases,
+                          procfs_data.maxerases, flash / host,
+                          (flash % host) * 100 / host, procfs_data.maxoptime);
         }
 
       /* Indicate we have already provided all the data */
@@ -898,7 +926,8 @@ static size_t   smartfs_erasemap_read(FAR struct file *filep, FAR char *buffer,
 
               if (copylen >= priv->offset)
                 {
-                  buffer[len++] = procfs_data.erasecounts[y*cols+x] + 'A';
+                  buffer[len++] = procfs_data.erasecounts[y*cols+x] < 26 ?
+                    procfs_data.erasecounts[y*cols+x] + 'A' : 'Z';
                   priv->offset++;
 
                   if (len >= buflen)
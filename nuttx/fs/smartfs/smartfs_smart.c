@@ -1062,6 +1062,15 @@ static int smartfs_sync(FAR struct file *filep)
 
   ret = smartfs_sync_internal(fs, sf);
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Also checkpoint the sector map so that it survives a power loss */
+
+  if (ret == OK)
+    {
+      ret = FS_IOCTL(fs, BIOC_FLUSH, 0);
+    }
+#endif
+
   smartfs_semgive(fs);
   return ret;
 }
@@ -0,0 +1,127 @@
+/****************************************************************************
+ * include/aio.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_AIO_H
+#define __INCLUDE_AIO_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+
+#ifdef CONFIG_FS_AIO
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Return values of aio_cancel() */
+
+#define AIO_CANCELED    0 /* The requested operations were canceled */
+#define AIO_NOTCANCELED 1 /* At least one operation is in progress */
+#define AIO_ALLDONE     2 /* All operations had already completed */
+
+/* Values of aio_lio_opcode */
+
+#define LIO_NOP         0 /* No transfer is requested */
+#define LIO_READ        1 /* Request a read() */
+#define LIO_WRITE       2 /* Request a write() */
+
+/* Values of the lio_listio() mode argument */
+
+#define LIO_NOWAIT      0 /* Return immediately */
+#define LIO_WAIT        1 /* Suspend until all requests complete */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* The asynchronous I/O control block */
+
+struct aiocb
+{
+  struct sigevent aio_sigevent;  /* Signal number and value */
+  FAR volatile void *aio_buf;    /* Location of buffer */
+  off_t aio_offset;              /* File offset */
+  size_t aio_nbytes;             /* Length of transfer */
+  int16_t aio_fildes;            /* File descriptor */
+  int8_t aio_reqprio;            /* Request priority offset (not used) */
+  uint8_t aio_lio_opcode;        /* Operation to be performed */
+
+  /* Non-standard, implementation-dependent data.  The result is
+   * -EINPROGRESS until the operation completes, then the byte count or
+   * a negated errno value.
+   */
+
+  volatile ssize_t aio_result;   /* Return value of the operation */
+  FAR void *aio_priv;            /* Used internally while queued */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+EXTERN int     aio_cancel(int fildes, FAR struct aiocb *aiocbp);
+EXTERN int     aio_error(FAR const struct aiocb *aiocbp);
+EXTERN int     aio_fsync(int op, FAR struct aiocb *aiocbp);
+EXTERN int     aio_read(FAR struct aiocb *aiocbp);
+EXTERN ssize_t aio_return(FAR struct aiocb *aiocbp);
+EXTERN int     aio_suspend(FAR const struct aiocb *const list[], int nent,
+                           FAR const struct timespec *timeout);
+EXTERN int     aio_write(FAR struct aiocb *aiocbp);
+EXTERN int     lio_listio(int mode, FAR struct aiocb *const list[], int nent,
+                          FAR struct sigevent *sig);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_FS_AIO */
+#endif /* __INCLUDE_AIO_H */
@@ -1539,6 +1539,46 @@ int up_timer_cancel(FAR struct timespec *ts);
 int up_timer_start(FAR const struct timespec *ts);
 #endif
 
+/****************************************************************************
+ * Name: up_trace_clock
+ *
+ * Description:
+ *   Return a free-running time in microseconds for the timestamps of the
+ *   scheduler trace and for the per-thread CPU time accounting.  The value
+ *   may wrap around at 2**32.  If the architecture does not provide this
+ *   function (CONFIG_ARCH_HAVE_TRACECLOCK is not selected), the trace is
+ *   time-stamped with the system timer and has only the resolution of one
+ *   tick; CPU time accounting is not available.
+ *
+ * Assumptions:
+ *   May be called from interrupt handlers and with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+uint32_t up_trace_clock(void);
+#endif
+
+/****************************************************************************
+ * Name: up_cmpxchg16
+ *
+ * Description:
+ *   Atomically compare the 16-bit value at 'addr' with 'oldval' and, only
+ *   if they are equal, replace it with 'newval'.  This must be atomic with
+ *   respect to interrupt handlers without disabling interrupts (e.g., using
+ *   load/store exclusive instructions).  Used by the semaphore fast path
+ *   (CONFIG_SCHED_FASTSEM).
+ *
+ * Returned Value:
+ *   true if the value was replaced; false if it did not match 'oldval'.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_HAVE_CMPXCHG
+bool up_cmpxchg16(FAR volatile int16_t *addr, int16_t oldval,
+                  int16_t newval);
+#endif
+
 /****************************************************************************
  * Name: up_romgetc
  *
@@ -177,6 +177,19 @@ struct cpuload_s
 };
 #endif
 
+#ifdef CONFIG_SCHED_CPUTIME
+/* This structure is returned by clock_cputime().  All times are in
+ * microseconds.
+ */
+
+struct cputime_s
+{
+  uint64_t active;           /* Time that this thread has run */
+  uint64_t irq;              /* Time spent in interrupt handlers */
+  uint64_t total;            /* Time since CPU time accounting started */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -339,6 +352,27 @@ int clock_systimespec(FAR struct timespec *ts);
 int clock_cpuload(int pid, FAR struct cpuload_s *cpuload);
 #endif
 
+/****************************************************************************
+ * Function:  clock_cputime
+ *
+ * Description:
+ *   Return the CPU time measurements for the select PID.
+ *
+ * Parameters:
+ *   pid - The task ID of the thread of interest.  pid == 0 is the IDLE thread.
+ *   cputime - The location to return the CPU times
+ *
+ * Return Value:
+ *   OK (0) on success; a negated errno value on failure.  The only reason
+ *   that this function can fail is if 'pid' no longer refers to a valid
+ *   thread.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPUTIME
+int clock_cputime(int pid, FAR struct cputime_s *cputime);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -65,6 +65,18 @@
 
 typedef uint8_t fat_attrib_t;
 
+/* Sector cache statistics returned by the FIOC_CACHESTATS ioctl command
+ * (CONFIG_FAT_SECTCACHE only).
+ */
+
+struct fat_cachestats_s
+{
+  uint32_t cs_hits;        /* Sector reads satisfied from the cache */
+  uint32_t cs_misses;      /* Sector reads that had to access the media */
+  uint32_t cs_writebacks;  /* Dirty sectors written back to the media */
+  uint32_t cs_evictions;   /* Cached sectors replaced to make room */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -127,6 +127,11 @@
 #define FIONWRITE       _FIOC(0x0006)     /* IN:  Location to return value (int *)
                                            * OUT: Bytes writable to this fd
                                            */
+#define FIOC_CACHESTATS _FIOC(0x0007)     /* IN:  Location to return statistics
+                                           *      (e.g., struct fat_cachestats_s *)
+                                           * OUT: Sector cache counters of the
+                                           *      file system holding this fd
+                                           */
 
 /* NuttX file system ioctl definitions **************************************/
 
@@ -203,6 +208,11 @@
                                            *      ProcFS data.
                                            * OUT: None (ioctl return value provides
                                            *      success/failure indication). */
+#define BIOC_FLUSH      _BIOC(0x000B)     /* Write back any data buffered for
+                                           * the block device.
+                                           * IN:  None
+                                           * OUT: None (ioctl return value provides
+                                           *      success/failure indication). */
 
 /* NuttX MTD driver ioctl definitions ***************************************/
 
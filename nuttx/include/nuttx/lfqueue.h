@@ -0,0 +1,213 @@
+/****************************************************************************
+ * include/nuttx/lfqueue.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_LFQUEUE_H
+#define __INCLUDE_NUTTX_LFQUEUE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#include <nuttx/arch.h>
+#include <arch/irq.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* lfq_init() flags.  By default any number of interrupt handlers and tasks
+ * may push and pop concurrently.  If only one context ever pushes (or
+ * pops), the corresponding flag removes the compare-and-swap from that
+ * side of the queue.
+ */
+
+#define LFQ_SINGLE_PRODUCER (1 << 0) /* Only one context calls lfq_push() */
+#define LFQ_SINGLE_CONSUMER (1 << 1) /* Only one context calls lfq_pop() */
+
+/* The number of cells must be a power of two no greater than this */
+
+#define LFQ_MAXCELLS        32768
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One slot of the ring.  'seq' tells which lap of the ring the cell
+ * belongs to:  a producer may fill the cell when seq equals its reserved
+ * position and a consumer may drain it when seq equals that position + 1.
+ */
+
+struct lfq_cell_s
+{
+  volatile uint16_t seq;
+  FAR void * volatile data;
+};
+
+/* A bounded, allocation-free queue of pointers that may be used between
+ * interrupt handlers and tasks without disabling interrupts (when the
+ * architecture provides up_cmpxchg16()).  The cell array is supplied by
+ * the caller.
+ */
+
+struct lfqueue_s
+{
+  volatile uint16_t head;          /* Next position to be filled */
+  volatile uint16_t tail;          /* Next position to be drained */
+  uint16_t mask;                   /* Number of cells - 1 */
+  uint8_t flags;                   /* See LFQ_* definitions */
+  FAR struct lfq_cell_s *cells;    /* Caller-provided ring storage */
+  sem_t wait;                      /* Wakes a consumer blocked in lfq_wait() */
+};
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lfq_cmpxchg
+ *
+ * Description:
+ *   Internal helper for the lfq_* functions:  atomically replace *addr
+ *   with newval if it still holds oldval.
+ *
+ ****************************************************************************/
+
+static inline bool lfq_cmpxchg(FAR volatile uint16_t *addr, uint16_t oldval,
+                               uint16_t newval)
+{
+#ifdef CONFIG_ARCH_HAVE_CMPXCHG
+  return up_cmpxchg16((FAR volatile int16_t *)addr, (int16_t)oldval,
+                      (int16_t)newval);
+#else
+  irqstate_t flags;
+  bool ret = false;
+
+  flags = irqsave();
+  if (*addr == oldval)
+    {
+      *addr = newval;
+      ret   = true;
+    }
+
+  irqrestore(flags);
+  return ret;
+#endif
+}
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: lfq_init
+ *
+ * Description:
+ *   Initialize a queue over 'ncells' caller-provided cells.  'ncells' must
+ *   be a power of two between 2 and LFQ_MAXCELLS.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -EINVAL if 'ncells' is not acceptable.
+ *
+ ****************************************************************************/
+
+int lfq_init(FAR struct lfqueue_s *queue, FAR struct lfq_cell_s *cells,
+             uint16_t ncells, uint8_t flags);
+
+/****************************************************************************
+ * Name: lfq_push
+ *
+ * Description:
+ *   Append 'data' (which must not be NULL) to the queue and wake any
+ *   consumer waiting in lfq_wait().  May be called from interrupt
+ *   handlers.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -EAGAIN if the queue is full.
+ *
+ ****************************************************************************/
+
+int lfq_push(FAR struct lfqueue_s *queue, FAR void *data);
+
+/****************************************************************************
+ * Name: lfq_pop
+ *
+ * Description:
+ *   Remove the oldest entry from the queue without waiting.  May be called
+ *   from interrupt handlers.  If a producer was preempted between reserving
+ *   and filling the oldest cell, the queue is reported empty until that
+ *   producer resumes.
+ *
+ * Returned Value:
+ *   The oldest entry, or NULL if the queue is empty.
+ *
+ ****************************************************************************/
+
+FAR void *lfq_pop(FAR struct lfqueue_s *queue);
+
+/****************************************************************************
+ * Name: lfq_wait
+ *
+ * Description:
+ *   Remove the oldest entry from the queue, waiting for one to be pushed
+ *   if the queue is empty.  Must not be called from interrupt handlers.
+ *
+ * Returned Value:
+ *   Zero (OK) with the entry in *data; -EINTR if the wait was interrupted
+ *   by a signal.
+ *
+ ****************************************************************************/
+
+int lfq_wait(FAR struct lfqueue_s *queue, FAR void **data);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_NUTTX_LFQUEUE_H */
@@ -167,6 +167,21 @@
 #define MM_MAX_CHUNK     (1 << MM_MAX_SHIFT)
 #define MM_NNODES        (MM_MAX_SHIFT - MM_MIN_SHIFT + 1)
 
+/* The TLSF allocator indexes free chunks in a two-level table:  The first
+ * level selects a power of two range of sizes; the second level divides
+ * that range into MM_TLSF_SLCOUNT equal parts.  Chunks smaller than
+ * (1 << MM_TLSF_FLSHIFT) all go in the first row of the table.
+ */
+
+#ifdef CONFIG_MM_TLSF
+#  ifndef CONFIG_MM_TLSF_SLI
+#    define CONFIG_MM_TLSF_SLI 3
+#  endif
+#  define MM_TLSF_SLCOUNT  (1 << CONFIG_MM_TLSF_SLI)
+#  define MM_TLSF_FLSHIFT  (MM_MIN_SHIFT + CONFIG_MM_TLSF_SLI)
+#  define MM_TLSF_FLCOUNT  (MM_MAX_SHIFT - MM_TLSF_FLSHIFT + 2)
+#endif
+
 #define MM_GRAN_MASK     (MM_MIN_CHUNK-1)
 #define MM_ALIGN_UP(a)   (((a) + MM_GRAN_MASK) & ~MM_GRAN_MASK)
 #define MM_ALIGN_DOWN(a) ((a) & ~MM_GRAN_MASK)
@@ -183,6 +198,29 @@
 #define MM_IS_ALLOCATED(n) \
   ((int)((struct mm_allocnode_s*)(n)->preceding) < 0))
 
+/* The allocation profiler keeps the allocation site of each chunk in its
+ * header.  Site zero collects allocations from call sites that do not fit
+ * in the site table.  MM_PROFILE_NOSITE marks a chunk that is not
+ * accounted to any site (e.g., one held in a per-thread cache).
+ */
+
+#ifdef CONFIG_MM_PROFILE
+#  ifndef CONFIG_MM_PROFILE_NSITES
+#    define CONFIG_MM_PROFILE_NSITES 64
+#  endif
+#  define MM_PROFILE_NOSITE 0xffff
+#  define MM_RETADDR()      __builtin_return_address(0)
+
+/* Called by the public allocation interfaces to attribute the allocation
+ * to their own caller.
+ */
+
+#  define MM_PROFILE_CALLER(heap, mem) \
+     mm_profile_caller(heap, mem, MM_RETADDR())
+#else
+#  define MM_PROFILE_CALLER(heap, mem)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -206,12 +244,20 @@ struct mm_allocnode_s
 {
   mmsize_t size;           /* Size of this chunk */
   mmsize_t preceding;      /* Size of the preceding chunk */
+#ifdef CONFIG_MM_PROFILE
+  FAR void *caller;        /* Return address of the allocating call */
+  uint16_t site;           /* Index of the caller in mm_prsites[] */
+  uint8_t  sclass;         /* Size class of the chunk */
+  uint8_t  reserved;
+#endif
 };
 
 /* What is the size of the allocnode? */
 
 #ifdef CONFIG_MM_SMALL
 # define SIZEOF_MM_ALLOCNODE   4
+#elif defined(CONFIG_MM_PROFILE)
+# define SIZEOF_MM_ALLOCNODE   16
 #else
 # define SIZEOF_MM_ALLOCNODE   8
 #endif
@@ -244,6 +290,20 @@ struct mm_freenode_s
 #define CHECK_FREENODE_SIZE \
   DEBUGASSERT(sizeof(struct mm_freenode_s) == SIZEOF_MM_FREENODE)
 
+/* Allocation profiler counters for one allocation site */
+
+#ifdef CONFIG_MM_PROFILE
+struct mm_prsite_s
+{
+  FAR void *ps_caller;     /* Return address of the allocating call */
+  size_t   ps_live;        /* Bytes currently allocated by this site */
+  size_t   ps_peak;        /* Largest value of ps_live */
+  uint32_t ps_nlive;       /* Number of chunks currently allocated */
+  uint32_t ps_nallocs;     /* Total number of allocations */
+  uint32_t ps_lastallocs;  /* ps_nallocs at the previous snapshot */
+};
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s
@@ -271,14 +331,54 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_TLSF
+  /* Free nodes are kept in segregated, doubly linked lists.  A bit is set
+   * in the bitmaps for each list that is not empty.
+   */
+
+  uint32_t mm_flbitmap;
+  uint32_t mm_slbitmap[MM_TLSF_FLCOUNT];
+  FAR struct mm_freenode_s *mm_freelist[MM_TLSF_FLCOUNT][MM_TLSF_SLCOUNT];
+#else
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed searches for free nodes.
    */
 
   struct mm_freenode_s mm_nodelist[MM_NNODES];
+#endif
+
+#ifdef CONFIG_MM_PROFILE
+  /* Allocation profiler state:  A hash table of allocation sites and the
+   * number of allocations made in each size class.
+   */
+
+  uint32_t mm_prstamp;     /* System time of the previous snapshot */
+  uint32_t mm_prclass[MM_NNODES];
+  struct mm_prsite_s mm_prsites[CONFIG_MM_PROFILE_NSITES];
+#endif
 };
 
+/* Per-thread small allocation cache.  Each thread may hold a few free
+ * chunks of each small size class so that most small allocations and
+ * frees can be satisfied without taking the heap semaphore.  Cached chunks
+ * remain marked as allocated in the heap; they are simply linked through
+ * their payload.
+ */
+
+#ifdef CONFIG_MM_TCACHE
+#  define MM_TCACHE_NCLASSES \
+     (MM_ALIGN_UP(CONFIG_MM_TCACHE_MAXSIZE + SIZEOF_MM_ALLOCNODE) >> MM_MIN_SHIFT)
+
+struct mm_tcache_s
+{
+  FAR struct mm_heap_s *tc_heap;            /* Heap that owns the chunks */
+  size_t tc_bytes;                          /* Size of all cached chunks */
+  FAR void *tc_free[MM_TCACHE_NCLASSES];    /* Free chunks per size class */
+  uint8_t tc_count[MM_TCACHE_NCLASSES];     /* Number of chunks per class */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -503,14 +603,47 @@ int kmm_mallinfo(struct mallinfo *info);
 void mm_shrinkchunk(FAR struct mm_heap_s *heap,
                     FAR struct mm_allocnode_s *node, size_t size);
 
-/* Functions contained in mm_addfreechunk.c *********************************/
+/* Functions contained in mm_addfreechunk.c or mm_tlsf.c ******************/
 
 void mm_addfreechunk(FAR struct mm_heap_s *heap,
                      FAR struct mm_freenode_s *node);
+void mm_delfreechunk(FAR struct mm_heap_s *heap,
+                     FAR struct mm_freenode_s *node);
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap,
+                                           size_t size);
 
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
+#ifndef CONFIG_MM_TLSF
 int mm_size2ndx(size_t size);
+#endif
+
+/* Functions contained in mm_tcache.c ***************************************/
+
+#ifdef CONFIG_MM_TCACHE
+struct tcb_s; /* Forward reference */
+FAR void *mm_tcache_malloc(FAR struct mm_heap_s *heap, size_t size);
+bool mm_tcache_free(FAR struct mm_heap_s *heap, FAR void *mem);
+size_t mm_tcache_cached(FAR struct mm_heap_s *heap);
+void mm_tcache_release(FAR struct tcb_s *tcb);
+FAR void *mm_tcache_take(FAR struct tcb_s *tcb);
+#endif
+
+/* Functions contained in mm_profile.c **************************************/
+
+#ifdef CONFIG_MM_PROFILE
+int  mm_profile_class(size_t size);
+void mm_profile_alloc(FAR struct mm_heap_s *heap, FAR void *mem,
+                      FAR void *caller);
+void mm_profile_free(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_profile_caller(FAR struct mm_heap_s *heap, FAR void *mem,
+                       FAR void *caller);
+int  mm_profile_snapshot(FAR struct mm_heap_s *heap,
+                         FAR struct mm_prsite_s *sites, int nsites,
+                         FAR uint32_t *nclass, FAR uint32_t *elapsed);
+void mm_freehist(FAR struct mm_heap_s *heap, FAR uint32_t *nchunks,
+                 FAR size_t *nbytes);
+#endif
 
 #undef EXTERN
 #ifdef __cplusplus
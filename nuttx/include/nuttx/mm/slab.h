@@ -0,0 +1,186 @@
+/****************************************************************************
+ * include/nuttx/mm/slab.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_SLAB_H
+#define __INCLUDE_NUTTX_MM_SLAB_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+/* CONFIG_MM_SLAB - Enable the object cache (slab) allocator.  Each cache
+ *   hands out objects of one fixed size, carved from slabs that are
+ *   allocated from the kernel heap as the cache grows.
+ * CONFIG_MM_SLAB_NOBJECTS - The default number of objects per slab.
+ */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Optional object constructor.  It is called once for each object when
+ * its slab is allocated, not on every slab_alloc().  Objects must be
+ * returned to their constructed state before they are passed to
+ * slab_free().
+ */
+
+typedef CODE void (*slab_ctor_t)(FAR void *obj);
+
+/* Snapshot of the state of one cache */
+
+struct slab_info_s
+{
+  FAR const char *name;       /* Name given to slab_create() */
+  size_t   objsize;           /* Size of each object */
+  uint16_t nslabs;            /* Number of slabs currently allocated */
+  uint32_t nobjs;             /* Objects in all slabs */
+  uint32_t ninuse;            /* Objects currently allocated */
+  uint32_t npeak;             /* Maximum value of ninuse */
+  uint32_t nallocs;           /* Number of successful slab_alloc() calls */
+  uint32_t nfails;            /* Number of failed slab_alloc() calls */
+};
+
+/* slab_foreach() callback.  A non-zero return value stops the traversal. */
+
+struct slab_cache_s;
+typedef CODE int (*slab_handler_t)(FAR struct slab_cache_s *cache,
+                                   FAR void *arg);
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: slab_create
+ *
+ * Description:
+ *   Create a cache of objects of 'objsize' bytes.  Slabs holding
+ *   'nobjects' objects each (CONFIG_MM_SLAB_NOBJECTS if zero) are taken
+ *   from the kernel heap when the cache is empty and returned to it when
+ *   they are no longer used.  Caches are never destroyed.
+ *
+ *   Objects are aligned to the size of a pointer and carry one pointer of
+ *   overhead, versus a full chunk header for a heap allocation.
+ *
+ * Input Parameters:
+ *   name     - Name reported by procfs.  The string is not copied.
+ *   objsize  - Size of each object in bytes
+ *   nobjects - Number of objects per slab
+ *   ctor     - Optional object constructor (may be NULL)
+ *
+ * Returned Value:
+ *   The new cache, or NULL if it could not be allocated.
+ *
+ ****************************************************************************/
+
+FAR struct slab_cache_s *slab_create(FAR const char *name, size_t objsize,
+                                     uint16_t nobjects, slab_ctor_t ctor);
+
+/****************************************************************************
+ * Name: slab_alloc
+ *
+ * Description:
+ *   Allocate one object from the cache.  May be called from interrupt
+ *   handlers, but then only objects in slabs that are already allocated
+ *   are available; the cache never grows from interrupt level.
+ *
+ * Returned Value:
+ *   The object, or NULL if none is available.
+ *
+ ****************************************************************************/
+
+FAR void *slab_alloc(FAR struct slab_cache_s *cache);
+
+/****************************************************************************
+ * Name: slab_free
+ *
+ * Description:
+ *   Return an object to the cache it was allocated from.  May be called
+ *   from interrupt handlers.
+ *
+ ****************************************************************************/
+
+void slab_free(FAR struct slab_cache_s *cache, FAR void *obj);
+
+/****************************************************************************
+ * Name: slab_info
+ *
+ * Description:
+ *   Return a snapshot of the state of the cache.
+ *
+ ****************************************************************************/
+
+void slab_info(FAR struct slab_cache_s *cache, FAR struct slab_info_s *info);
+
+/****************************************************************************
+ * Name: slab_foreach
+ *
+ * Description:
+ *   Call 'handler' for each cache in order of creation.
+ *
+ * Returned Value:
+ *   Zero if every cache was visited, otherwise the non-zero value returned
+ *   by 'handler'.
+ *
+ ****************************************************************************/
+
+int slab_foreach(slab_handler_t handler, FAR void *arg);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_SLAB */
+#endif /* __INCLUDE_NUTTX_MM_SLAB_H */
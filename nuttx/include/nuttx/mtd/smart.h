@@ -82,9 +82,14 @@ struct mtd_smart_procfs_data_s
   uint8_t             formatversion;    /* Version of the volume format */
   uint32_t            unusedsectors;    /* Number of unused sectors (free when erased) */
   uint32_t            blockerases;      /* Number block erase operations */
+  uint32_t            hostwrites;       /* Sector allocations and writes requested */
+  uint32_t            flashwrites;      /* Sector writes performed on the device */
+  uint32_t            maxoptime;        /* Longest sector operation (msec) */
+  uint16_t            minerases;        /* Lowest erase count of an erase block */
+  uint16_t            maxerases;        /* Highest erase count of an erase block */
 
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
-  FAR const uint8_t*  erasecounts;      /* Array of erase counts per erase block */
+  FAR const uint16_t* erasecounts;      /* Array of erase counts per erase block */
   size_t              neraseblocks;     /* Number of erase blocks */
 #endif
 #ifdef CONFIG_MTD_SMART_ALLOC_DEBUG
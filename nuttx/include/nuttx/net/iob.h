@@ -341,6 +341,27 @@ FAR struct iob_s *iob_trimhead_queue(FAR struct iob_queue_s *qhead,
                                      unsigned int trimlen);
 #endif
 
+/****************************************************************************
+ * Name: iob_splithead_queue
+ *
+ * Description:
+ *   Remove up to 'len' bytes from the I/O buffer chain at the head of the
+ *   queue without copying any data.  Only whole I/O buffers are removed;
+ *   the remainder of a partially removed chain stays at the head of the
+ *   queue.
+ *
+ * Returned Value:
+ *   The detached I/O buffer chain is returned.  NULL is returned if the
+ *   queue is empty or if the first I/O buffer in the chain holds more than
+ *   'len' bytes.
+ *
+ ****************************************************************************/
+
+#if CONFIG_IOB_NCHAINS > 0
+FAR struct iob_s *iob_splithead_queue(FAR struct iob_queue_s *qhead,
+                                      unsigned int len);
+#endif
+
 /****************************************************************************
  * Name: iob_trimtail
  *
@@ -698,6 +698,57 @@ ssize_t psock_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
 #define psock_recv(psock,buf,len,flags) \
   psock_recvfrom(psock,buf,len,flags,NULL,0)
 
+/****************************************************************************
+ * Function: psock_recviob, recviob, and recviob_release
+ *
+ * Description:
+ *   Zero-copy TCP receive.  psock_recviob() and recviob() loan the I/O
+ *   buffer chains from the TCP read-ahead queue directly to the caller
+ *   instead of copying the data into a user buffer.  On success, '*iobp'
+ *   refers to a chain of at most 'len' bytes ('len' must be at least
+ *   CONFIG_IOB_BUFSIZE).  The chain belongs to the caller until it is
+ *   returned with recviob_release().
+ *
+ * Returned Value:
+ *   On success, returns the number of bytes in the loaned chain or zero
+ *   if the peer has performed an orderly shutdown.  On errors, -1 is
+ *   returned, and errno is set as for recvfrom().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_RECVIOB
+struct iob_s; /* Forward reference */
+
+ssize_t psock_recviob(FAR struct socket *psock, FAR struct iob_s **iobp,
+                      size_t len, int flags);
+ssize_t recviob(int sockfd, FAR struct iob_s **iobp, size_t len, int flags);
+void recviob_release(FAR struct iob_s *iob);
+#endif
+
+/****************************************************************************
+ * Function: psock_sendmmsg and psock_recvmmsg
+ *
+ * Description:
+ *   Send or receive several datagrams on a UDP socket in a single
+ *   operation.  See sendmmsg() and recvmmsg().
+ *
+ * Returned Value:
+ *   On success, the number of datagrams sent or received.  On errors, -1
+ *   is returned, and errno is set appropriately.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_MMSG
+struct mmsghdr;  /* Forward reference */
+struct timespec; /* Forward reference */
+
+int psock_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags);
+int psock_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags,
+                   FAR struct timespec *timeout);
+#endif
+
 /****************************************************************************
  * Function: psock_getsockopt
  *
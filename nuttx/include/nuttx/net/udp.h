@@ -121,6 +121,14 @@ struct udp_stats_s
   net_stats_t recv;         /* Number of recived UDP segments */
   net_stats_t sent;         /* Number of sent UDP segments */
   net_stats_t chkerr;       /* Number of UDP segments with a bad checksum */
+#ifdef CONFIG_NET_UDP_MMSG
+  net_stats_t sndbatch;     /* Number of sendmmsg() operations */
+  net_stats_t sndmsgs;      /* Number of datagrams sent by sendmmsg() */
+  net_stats_t rcvbatch;     /* Number of recvmmsg() operations */
+  net_stats_t rcvmsgs;      /* Number of datagrams received by recvmmsg() */
+  net_stats_t pollbatch;    /* Number of datagrams sent after the first in
+                             * one poll of a UDP connection */
+#endif
 };
 #endif
 
@@ -56,6 +56,10 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 
+#ifdef CONFIG_MM_TCACHE
+#  include <nuttx/mm/mm.h>
+#endif
+
 #include <arch/arch.h>
 
 /********************************************************************************
@@ -486,6 +490,9 @@ struct tcb_s
 
 #if CONFIG_RR_INTERVAL > 0
   int      timeslice;                    /* RR timeslice interval remaining     */
+#endif
+#ifdef CONFIG_SCHED_CPUTIME
+  uint64_t cputime;                      /* Microseconds this thread has run    */
 #endif
   FAR struct wdog_s *waitdog;            /* All timed waits used this wdog      */
 
@@ -530,6 +537,10 @@ struct tcb_s
 
   int pterrno;                           /* Current per-thread errno            */
 
+#ifdef CONFIG_MM_TCACHE
+  struct mm_tcache_s tcache;             /* Per-thread small allocation cache   */
+#endif
+
   /* State save areas ***********************************************************/
   /* The form and content of these fields are platform-specific.                */
 
@@ -0,0 +1,190 @@
+/****************************************************************************
+ * include/nuttx/sched_trace.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_SCHED_TRACE_H
+#define __INCLUDE_NUTTX_SCHED_TRACE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <semaphore.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The trace data read from /proc/trace begins with a struct trace_header_s
+ * followed by an array of struct trace_record_s in chronological order.
+ * All fields are in the byte order of the target.  A host tool can detect
+ * the byte order from the magic number (see tools/tracecvt.c).
+ */
+
+#define TRACE_MAGIC    0x5254584e  /* "NXTR" in little-endian order */
+#define TRACE_VERSION  1
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct tcb_s; /* Forward reference */
+
+/* Trace event types */
+
+enum trace_type_e
+{
+  TRACE_START = 0,   /* Task started.  pid = new task */
+  TRACE_STOP,        /* Task stopped.  pid = stopped task */
+  TRACE_SWITCH,      /* Context switch.  pid = new task, arg = old task */
+  TRACE_IRQENTER,    /* Interrupt entry.  pid = interrupted task, arg = IRQ */
+  TRACE_IRQLEAVE,    /* Interrupt exit.  pid = interrupted task, arg = IRQ */
+  TRACE_SEMBLOCK,    /* Task blocks in sem_wait().  arg = semaphore */
+  TRACE_SEMWAKE,     /* sem_post() wakes a task.  pid = woken task,
+                      * arg = semaphore */
+  TRACE_NTYPES
+};
+
+/* The header of the trace data */
+
+struct trace_header_s
+{
+  uint32_t th_magic;     /* TRACE_MAGIC */
+  uint16_t th_version;   /* TRACE_VERSION */
+  uint16_t th_recsize;   /* sizeof(struct trace_record_s) */
+  uint32_t th_first;     /* Sequence number of the first record */
+  uint32_t th_count;     /* Number of records that follow */
+};
+
+/* One trace record.  tr_time is in microseconds and wraps every 71
+ * minutes.
+ */
+
+struct trace_record_s
+{
+  uint32_t tr_time;      /* Timestamp in microseconds */
+  uint8_t  tr_type;      /* See enum trace_type_e */
+  uint8_t  tr_priority;  /* Priority of the task identified by tr_pid */
+  int16_t  tr_pid;       /* Task ID */
+  uint32_t tr_arg;       /* Event-specific argument */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+#ifdef CONFIG_SCHED_TRACE
+
+/****************************************************************************
+ * Name: sched_trace_irqenter, sched_trace_irqleave
+ *
+ * Description:
+ *   Record the entry into and the exit from the handler of an interrupt.
+ *   Called from irq_dispatch().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TRACE_IRQ
+void sched_trace_irqenter(int irq);
+void sched_trace_irqleave(int irq);
+#else
+#  define sched_trace_irqenter(irq)
+#  define sched_trace_irqleave(irq)
+#endif
+
+/****************************************************************************
+ * Name: sched_trace_semblock, sched_trace_semwake
+ *
+ * Description:
+ *   Record that the running task blocks on a semaphore or that a task that
+ *   was waiting for a semaphore is awakened.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TRACE_SEM
+void sched_trace_semblock(FAR sem_t *sem);
+void sched_trace_semwake(FAR sem_t *sem, FAR struct tcb_s *tcb);
+#else
+#  define sched_trace_semblock(sem)
+#  define sched_trace_semwake(sem, tcb)
+#endif
+
+/****************************************************************************
+ * Name: sched_trace_snapshot
+ *
+ * Description:
+ *   Copy the most recent trace records, oldest first.  Events are not
+ *   blocked while the records are copied.  Records that are overwritten
+ *   during the copy are discarded from the result.
+ *
+ * Input Parameters:
+ *   buffer   - Location to return the records
+ *   nrecords - The capacity of the buffer in records
+ *   first    - Location to return the sequence number of the first record
+ *              returned.  This is also the number of records lost since
+ *              boot-up.
+ *
+ * Returned Value:
+ *   The number of records copied.
+ *
+ ****************************************************************************/
+
+size_t sched_trace_snapshot(FAR struct trace_record_s *buffer,
+                            size_t nrecords, FAR uint32_t *first);
+
+#else
+#  define sched_trace_irqenter(irq)
+#  define sched_trace_irqleave(irq)
+#  define sched_trace_semblock(sem)
+#  define sched_trace_semwake(sem, tcb)
+#endif /* CONFIG_SCHED_TRACE */
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_NUTTX_SCHED_TRACE_H */
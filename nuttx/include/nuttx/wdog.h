@@ -139,6 +139,10 @@ struct wdog_s
   uint8_t            flags;      /* See WDOGF_* definitions above */
   uint8_t            argc;       /* The number of parameters to pass */
   uint32_t           parm[CONFIG_MAX_WDOGPARMS];
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  FAR struct wdog_s **pprev;     /* Link to this watchdog in its wheel slot */
+  uint32_t           expires;    /* Absolute expiration time (wheel ticks) */
+#endif
 };
 
 /* Watchdog 'handle' */
@@ -71,6 +71,8 @@
  *   work in units of microseconds.  Default: 50*1000 (50 MS).
  * CONFIG_SCHED_WORKSTACKSIZE - The stack size allocated for the worker
  *   thread.  Default: CONFIG_IDLETHREAD_STACKSIZE.
+ * CONFIG_SCHED_WORKNTHREADS - The number of worker threads that service
+ *   the high priority work queue.  Default: 1
  * CONFIG_SIG_SIGWORK - The signal number that will be used to wake-up
  *   the worker thread.  Default: 17
  *
@@ -85,6 +87,15 @@
  *  checks for work in units of microseconds.  Default: 50*1000 (50 MS).
  * CONFIG_SCHED_LPWORKSTACKSIZE - The stack size allocated for the lower
  *   priority worker thread.  Default: CONFIG_IDLETHREAD_STACKSIZE.
+ * CONFIG_SCHED_LPWORKNTHREADS - The number of worker threads that service
+ *   the lower priority work queue.  Default: 1
+ *
+ * CONFIG_SCHED_WORKSTATS - Collect queueing delay and execution time
+ *   statistics for each work queue.
+ *
+ * If a work queue is serviced by more than one thread, work items that
+ * share data must be given the same serialization key with work_setkey().
+ * Work items with the same non-zero key never run concurrently.
  */
 
 /* Is this a protected build (CONFIG_BUILD_PROTECTED=y) */
@@ -167,6 +178,10 @@
 #    define CONFIG_SCHED_WORKSTACKSIZE CONFIG_IDLETHREAD_STACKSIZE
 #  endif
 
+#  ifndef CONFIG_SCHED_WORKNTHREADS
+#    define CONFIG_SCHED_WORKNTHREADS 1
+#  endif
+
 /* Low priority kernel work queue configuration *****************************/
 
 #ifdef CONFIG_SCHED_LPWORK
@@ -183,6 +198,10 @@
 #    define CONFIG_SCHED_LPWORKSTACKSIZE CONFIG_IDLETHREAD_STACKSIZE
 #  endif
 
+#  ifndef CONFIG_SCHED_LPWORKNTHREADS
+#    define CONFIG_SCHED_LPWORKNTHREADS 1
+#  endif
+
 /* The high priority worker thread should be higher priority than the low
  * priority worker thread.
  */
@@ -210,6 +229,10 @@
 #    define CONFIG_SCHED_USRWORKSTACKSIZE CONFIG_IDLETHREAD_STACKSIZE
 #  endif
 
+#  ifndef CONFIG_SCHED_USRWORKNTHREADS
+#    define CONFIG_SCHED_USRWORKNTHREADS 1
+#  endif
+
 #endif /* CONFIG_SCHED_USRWORK */
 
 /* How many worker threads are there?  In the user-space phase of a kernel
@@ -265,6 +288,25 @@
 
 #endif /* CONFIG_BUILD_PROTECTED && !__KERNEL__ */
 
+/* What is the largest number of threads that service one work queue?  The
+ * idle threads of a queue are kept in an 8-bit set.
+ */
+
+#if defined(CONFIG_BUILD_PROTECTED) && !defined(__KERNEL__)
+#  define WORK_MAXTHREADS CONFIG_SCHED_USRWORKNTHREADS
+#elif defined(CONFIG_SCHED_LPWORK) && \
+      CONFIG_SCHED_LPWORKNTHREADS > CONFIG_SCHED_WORKNTHREADS
+#  define WORK_MAXTHREADS CONFIG_SCHED_LPWORKNTHREADS
+#elif defined(CONFIG_SCHED_HPWORK)
+#  define WORK_MAXTHREADS CONFIG_SCHED_WORKNTHREADS
+#else
+#  define WORK_MAXTHREADS 1
+#endif
+
+#if WORK_MAXTHREADS < 1 || WORK_MAXTHREADS > 8
+#  error "A work queue must be serviced by 1 to 8 threads"
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -276,10 +318,39 @@
  * accessed by application logic.
  */
 
+struct work_s;
+
+struct wqueue_thread_s
+{
+  pid_t             pid;  /* The task ID of the worker thread */
+  uint16_t          key;  /* Serialization key of the work being performed */
+  FAR struct work_s *work; /* The work being performed (NULL if none) */
+};
+
+#ifdef CONFIG_SCHED_WORKSTATS
+/* Statistics of one work queue.  All times are in microseconds.  The
+ * queueing delay is the time from when the work became ready (its delay
+ * elapsed) until a worker thread started it.
+ */
+
+struct work_stats_s
+{
+  uint32_t          count;    /* Number of work items performed */
+  uint32_t          maxwait;  /* Longest queueing delay */
+  uint32_t          maxexec;  /* Longest execution time */
+  uint64_t          totwait;  /* Sum of all queueing delays */
+  uint64_t          totexec;  /* Sum of all execution times */
+};
+#endif
+
 struct wqueue_s
 {
-  pid_t             pid; /* The task ID of the worker thread */
-  struct dq_queue_s q;   /* The queue of pending work */
+  struct dq_queue_s q;    /* The queue of pending work */
+  volatile uint8_t  idle; /* Set of threads waiting for work */
+  struct wqueue_thread_s thread[WORK_MAXTHREADS];
+#ifdef CONFIG_SCHED_WORKSTATS
+  struct work_stats_s stats;
+#endif
 };
 
 /* Defines the work callback */
@@ -298,6 +369,7 @@ struct work_s
   FAR void *arg;         /* Callback argument */
   uint32_t  qtime;       /* Time work queued */
   uint32_t  delay;       /* Delay until work performed */
+  uint16_t  key;         /* Serialization key (0: none) */
 };
 
 /****************************************************************************
@@ -486,6 +558,43 @@ int work_signal(int qid);
 
 #define work_available(work) ((work)->worker == NULL)
 
+/****************************************************************************
+ * Name: work_setkey
+ *
+ * Description:
+ *   Set the serialization key of the work structure.  Work with the same
+ *   non-zero key is never performed concurrently by the threads of a work
+ *   queue.  The same work structure is never performed concurrently with
+ *   itself, regardless of the key.
+ *
+ * Input parameters:
+ *   work - The work structure.  It must not be queued.
+ *   key  - The serialization key (0: none)
+ *
+ ****************************************************************************/
+
+#define work_setkey(work,k) ((work)->key = (uint16_t)(k))
+
+/****************************************************************************
+ * Name: work_stats
+ *
+ * Description:
+ *   Return the queueing delay and execution time statistics of a work
+ *   queue.
+ *
+ * Input parameters:
+ *   qid   - The work queue ID
+ *   stats - The location to return the statistics
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKSTATS
+int work_stats(int qid, FAR struct work_stats_s *stats);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
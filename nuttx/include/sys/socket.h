@@ -41,6 +41,7 @@
  ****************************************************************************/
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 /****************************************************************************
  * Definitions
@@ -115,6 +116,7 @@
 #define MSG_ERRQUEUE   0x2000 /* Fetch message from error queue.  */
 #define MSG_NOSIGNAL   0x4000 /* Do not generate SIGPIPE.  */
 #define MSG_MORE       0x8000 /* Sender will send more.  */
+#define MSG_WAITFORONE 0x10000 /* recvmmsg(): Block only for the first message. */
 
 /* Socket options */
 
@@ -199,6 +201,27 @@ struct linger
   int  l_linger;  /* Linger time, in seconds. */
 };
 
+/* Used with sendmmsg() and recvmmsg() to describe one datagram.  Ancillary
+ * data (msg_control) is not supported.
+ */
+
+struct msghdr
+{
+  FAR void         *msg_name;       /* Optional address */
+  socklen_t         msg_namelen;    /* Size of address */
+  FAR struct iovec *msg_iov;        /* Scatter/gather array */
+  int               msg_iovlen;     /* Number of elements in msg_iov */
+  FAR void         *msg_control;    /* Ancillary data (not used) */
+  socklen_t         msg_controllen; /* Ancillary data buffer length */
+  int               msg_flags;      /* Flags on received message */
+};
+
+struct mmsghdr
+{
+  struct msghdr     msg_hdr;        /* Message header */
+  unsigned int      msg_len;        /* Number of bytes transmitted */
+};
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -227,6 +250,12 @@ ssize_t recv(int sockfd, FAR void *buf, size_t len, int flags);
 ssize_t recvfrom(int sockfd, FAR void *buf, size_t len, int flags,
                  FAR struct sockaddr *from, FAR socklen_t *fromlen);
 
+struct timespec; /* Forward reference */
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags);
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout);
+
 int setsockopt(int sockfd, int level, int option,
                FAR const void *value, socklen_t value_len);
 int getsockopt(int sockfd, int level, int option,
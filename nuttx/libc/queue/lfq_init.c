@@ -0,0 +1,89 @@
+/****************************************************************************
+ * libc/queue/lfq_init.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/lfqueue.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lfq_init
+ *
+ * Description:
+ *   Initialize a queue over 'ncells' caller-provided cells.  'ncells' must
+ *   be a power of two between 2 and LFQ_MAXCELLS.
+ *
+ ****************************************************************************/
+
+int lfq_init(FAR struct lfqueue_s *queue, FAR struct lfq_cell_s *cells,
+             uint16_t ncells, uint8_t flags)
+{
+  uint16_t i;
+
+  DEBUGASSERT(queue != NULL && cells != NULL);
+
+  if (ncells < 2 || ncells > LFQ_MAXCELLS || (ncells & (ncells - 1)) != 0)
+    {
+      return -EINVAL;
+    }
+
+  /* Each cell starts out free for the first lap of the ring */
+
+  for (i = 0; i < ncells; i++)
+    {
+      cells[i].seq  = i;
+      cells[i].data = NULL;
+    }
+
+  queue->head  = 0;
+  queue->tail  = 0;
+  queue->mask  = ncells - 1;
+  queue->flags = flags;
+  queue->cells = cells;
+
+  sem_init(&queue->wait, 0, 0);
+  return OK;
+}
@@ -0,0 +1,110 @@
+/****************************************************************************
+ * libc/queue/lfq_pop.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+
+#include <nuttx/lfqueue.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lfq_pop
+ *
+ * Description:
+ *   Remove the oldest entry from the queue without waiting.  May be called
+ *   from interrupt handlers.
+ *
+ ****************************************************************************/
+
+FAR void *lfq_pop(FAR struct lfqueue_s *queue)
+{
+  FAR struct lfq_cell_s *cell;
+  FAR void *data;
+  uint16_t pos;
+  int16_t diff;
+
+  DEBUGASSERT(queue != NULL);
+
+  /* Reserve the cell at the tail of the queue */
+
+  pos = queue->tail;
+  for (; ; )
+    {
+      cell = &queue->cells[pos & queue->mask];
+      diff = (int16_t)(cell->seq - (uint16_t)(pos + 1));
+
+      if (diff == 0)
+        {
+          /* The cell has been published on this lap.  Claim it, unless
+           * another consumer got there first.
+           */
+
+          if ((queue->flags & LFQ_SINGLE_CONSUMER) != 0)
+            {
+              queue->tail = pos + 1;
+              break;
+            }
+
+          if (lfq_cmpxchg(&queue->tail, pos, pos + 1))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          /* Nothing has been published in this cell yet */
+
+          return NULL;
+        }
+
+      pos = queue->tail;
+    }
+
+  /* Take the entry and hand the cell back to the producers for the next
+   * lap of the ring.
+   */
+
+  data      = cell->data;
+  cell->seq = pos + queue->mask + 1;
+  return data;
+}
@@ -0,0 +1,120 @@
+/****************************************************************************
+ * libc/queue/lfq_push.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <nuttx/lfqueue.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: lfq_push
+ *
+ * Description:
+ *   Append 'data' (which must not be NULL) to the queue and wake any
+ *   consumer waiting in lfq_wait().  May be called from interrupt
+ *   handlers.
+ *
+ ****************************************************************************/
+
+int lfq_push(FAR struct lfqueue_s *queue, FAR void *data)
+{
+  FAR struct lfq_cell_s *cell;
+  uint16_t pos;
+  int16_t diff;
+
+  DEBUGASSERT(queue != NULL && data != NULL);
+
+  /* Reserve the cell at the head of the queue */
+
+  pos = queue->head;
+  for (; ; )
+    {
+      cell = &queue->cells[pos & queue->mask];
+      diff = (int16_t)(cell->seq - pos);
+
+      if (diff == 0)
+        {
+          /* The cell is free on this lap of the ring.  Claim it, unless
+           * another producer got there first.
+           */
+
+          if ((queue->flags & LFQ_SINGLE_PRODUCER) != 0)
+            {
+              queue->head = pos + 1;
+              break;
+            }
+
+          if (lfq_cmpxchg(&queue->head, pos, pos + 1))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          /* The cell still holds an entry from the previous lap */
+
+          return -EAGAIN;
+        }
+
+      pos = queue->head;
+    }
+
+  /* Fill the cell, then publish it to the consumers */
+
+  cell->data = data;
+  cell->seq  = pos + 1;
+
+  /* The semaphore only records that something was pushed since the
+   * consumer last looked, so it never needs to count above one.
+   */
+
+  if (queue->wait.semcount <= 0)
+    {
+      sem_post(&queue->wait);
+    }
+
+  return OK;
+}
@@ -197,7 +197,8 @@ static const struct errno_strmap_s g_errnomap[] =
   { EREMOTEIO,           EREMOTEIO_STR       },
   { EDQUOT,              EDQUOT_STR          },
   { ENOMEDIUM,           ENOMEDIUM_STR       },
-  { EMEDIUMTYPE,         EMEDIUMTYPE_STR     }
+  { EMEDIUMTYPE,         EMEDIUMTYPE_STR     },
+  { ECANCELED,           ECANCELED_STR       }
 };
 
 #else /* CONFIG_LIBC_STRERROR_SHORT */
@@ -325,7 +326,8 @@ static const struct errno_strmap_s g_errnomap[] =
   { EREMOTEIO,           "EREMOTEIO"         },
   { EDQUOT,              "EDQUOT"            },
   { ENOMEDIUM,           "ENOMEDIUM"         },
-  { EMEDIUMTYPE,         "EMEDIUMTYPE"     }
+  { EMEDIUMTYPE,         "EMEDIUMTYPE"     },
+  { ECANCELED,           "ECANCELED"         }
 };
 
 #endif /* CONFIG_LIBC_STRERROR_SHORT */
@@ -127,7 +127,7 @@ int work_queue(int qid, FAR struct work_s *work, worker_t worker,
   work->qtime  = clock_systimer(); /* Time work queued */
 
   dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
-  kill(wqueue->pid, SIGWORK);      /* Wake up the worker thread */
+  work_signal(qid);                /* Wake up a worker thread */
 
   irqrestore(flags);
   return OK;
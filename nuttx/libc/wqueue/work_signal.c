@@ -42,6 +42,7 @@
 #include <signal.h>
 #include <assert.h>
 
+#include <arch/irq.h>
 #include <nuttx/wqueue.h>
 
 #ifdef CONFIG_SCHED_WORKQUEUE
@@ -77,6 +78,11 @@
  *   is used internally by the work logic but could also be used by the
  *   user to force an immediate re-assessment of pending work.
  *
+ *   If the work queue is serviced by several threads, one thread that is
+ *   waiting for work is woken up.  If all threads are busy, nothing needs
+ *   to be done:  Each thread checks the work list again when it finishes
+ *   its current work.
+ *
  * Input parameters:
  *   qid    - The work queue ID
  *
@@ -87,8 +93,28 @@
 
 int work_signal(int qid)
 {
+  FAR struct wqueue_s *wqueue = &g_work[qid];
+  irqstate_t flags;
+  int wndx;
+  int ret = OK;
+
   DEBUGASSERT((unsigned)qid < NWORKERS);
-  return kill(g_work[qid].pid, SIGWORK);
+
+  flags = irqsave();
+  if (wqueue->idle != 0)
+    {
+      for (wndx = 0; (wqueue->idle & (1 << wndx)) == 0; wndx++);
+
+      /* Remove the thread from the idle set now so that the next signal
+       * wakes up a different thread.
+       */
+
+      wqueue->idle &= ~(1 << wndx);
+      ret = kill(wqueue->thread[wndx].pid, SIGWORK);
+    }
+
+  irqrestore(flags);
+  return ret;
 }
 
 #endif /* CONFIG_SCHED_WORKQUEUE */
@@ -40,6 +40,8 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <queue.h>
 #include <assert.h>
@@ -57,6 +59,17 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* The clock used to measure the execution time of work, in microseconds */
+
+#ifdef CONFIG_SCHED_WORKSTATS
+#  if defined(CONFIG_ARCH_HAVE_TRACECLOCK) && \
+     (!defined(CONFIG_BUILD_PROTECTED) || defined(__KERNEL__))
+#    define work_clock() up_trace_clock()
+#  else
+#    define work_clock() (clock_systimer() * USEC_PER_TICK)
+#  endif
+#endif
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -97,22 +110,54 @@ struct wqueue_s g_work[NWORKERS];
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_busy
+ *
+ * Description:
+ *   Check if the work may not be started now because another thread of
+ *   the work queue is performing the same work or work with the same
+ *   serialization key.
+ *
+ ****************************************************************************/
+
+static inline bool work_busy(FAR struct wqueue_s *wqueue,
+                             FAR struct work_s *work)
+{
+  int i;
+
+  for (i = 0; i < WORK_MAXTHREADS; i++)
+    {
+      if (wqueue->thread[i].work == work ||
+          (work->key != 0 && wqueue->thread[i].key == work->key))
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
 /****************************************************************************
  * Name: work_process
  *
  * Description:
- *   This is the logic that performs actions placed on any work list.
+ *   This is the logic that performs actions placed on any work list.  It
+ *   is run by every thread of the work queue.
  *
  * Input parameters:
  *   wqueue - Describes the work queue to be processed
+ *   wndx   - The index of the calling thread in the work queue
+ *   period - How often to check for work in microseconds
  *
  * Returned Value:
  *   None
  *
  ****************************************************************************/
 
-static void work_process(FAR struct wqueue_s *wqueue)
+static void work_process(FAR struct wqueue_s *wqueue, int wndx,
+                         uint32_t period)
 {
+  FAR struct wqueue_thread_s *self = &wqueue->thread[wndx];
   volatile FAR struct work_s *work;
   worker_t  worker;
   irqstate_t flags;
@@ -120,12 +165,16 @@ static void work_process(FAR struct wqueue_s *wqueue)
   uint32_t elapsed;
   uint32_t remaining;
   uint32_t next;
+#ifdef CONFIG_SCHED_WORKSTATS
+  uint32_t wait;
+  uint32_t start;
+#endif
 
   /* Then process queued work.  We need to keep interrupts disabled while
    * we process items in the work list.
    */
 
-  next  = CONFIG_SCHED_WORKPERIOD / USEC_PER_TICK;
+  next  = period / USEC_PER_TICK;
   flags = irqsave();
   work  = (FAR struct work_s *)wqueue->q.head;
   while (work)
@@ -137,7 +186,8 @@ static void work_process(FAR struct wqueue_s *wqueue)
        */
 
       elapsed = clock_systimer() - work->qtime;
-      if (elapsed >= work->delay)
+      if (elapsed >= work->delay &&
+          !work_busy(wqueue, (FAR struct work_s *)work))
         {
           /* Remove the ready-to-execute work from the list */
 
@@ -159,9 +209,18 @@ static void work_process(FAR struct wqueue_s *wqueue)
 
               arg = work->arg;
 
-              /* Mark the work as no longer being queued */
+              /* Mark the work as no longer being queued but as being
+               * performed by this thread.
+               */
 
               work->worker = NULL;
+              self->work   = (FAR struct work_s *)work;
+              self->key    = work->key;
+
+#ifdef CONFIG_SCHED_WORKSTATS
+              wait         = (elapsed - work->delay) * USEC_PER_TICK;
+              start        = work_clock();
+#endif
 
               /* Do the work.  Re-enable interrupts while the work is being
                * performed... we don't have any idea how long that will take!
@@ -172,11 +231,34 @@ static void work_process(FAR struct wqueue_s *wqueue)
 
               /* Now, unfortunately, since we re-enabled interrupts we don't
                * know the state of the work list and we will have to start
-               * back at the head of the list.
+               * back at the head of the list.  This also picks up any work
+               * that other threads skipped because it was serialized with
+               * the work just performed.
                */
 
-              flags = irqsave();
-              work  = (FAR struct work_s *)wqueue->q.head;
+              flags      = irqsave();
+              self->work = NULL;
+              self->key  = 0;
+
+#ifdef CONFIG_SCHED_WORKSTATS
+              start = work_clock() - start;
+
+              wqueue->stats.count++;
+              wqueue->stats.totwait += wait;
+              wqueue->stats.totexec += start;
+
+              if (wait > wqueue->stats.maxwait)
+                {
+                  wqueue->stats.maxwait = wait;
+                }
+
+              if (start > wqueue->stats.maxexec)
+                {
+                  wqueue->stats.maxexec = start;
+                }
+#endif
+
+              work = (FAR struct work_s *)wqueue->q.head;
             }
           else
             {
@@ -189,16 +271,20 @@ static void work_process(FAR struct wqueue_s *wqueue)
         }
       else
         {
-          /* This one is not ready.. will it be ready before the next
+          /* This one is not ready (or is serialized with work that another
+           * thread is performing).  Will it be ready before the next
            * scheduled wakeup interval?
            */
 
-          remaining = elapsed - work->delay;
-          if (remaining < next)
+          if (elapsed < work->delay)
             {
-              /* Yes.. Then schedule to wake up when the work is ready */
+              remaining = work->delay - elapsed;
+              if (remaining < next)
+                {
+                  /* Yes.. Then schedule to wake up when the work is ready */
 
-              next = remaining;
+                  next = remaining;
+                }
             }
 
           /* Then try the next in the list. */
@@ -208,13 +294,41 @@ static void work_process(FAR struct wqueue_s *wqueue)
     }
 
   /* Wait awhile to check the work list.  We will wait here until either
-   * the time elapses or until we are awakened by a signal.
+   * the time elapses or until we are awakened by a signal.  While waiting,
+   * this thread is in the set of idle threads that work_signal() may wake
+   * up.
    */
 
+  wqueue->idle |= (1 << wndx);
   usleep(next * USEC_PER_TICK);
+  wqueue->idle &= ~(1 << wndx);
   irqrestore(flags);
 }
 
+/****************************************************************************
+ * Name: work_start
+ *
+ * Description:
+ *   Return the index of a worker thread within its work queue from the
+ *   argument list of the thread.  Also record the thread's task ID so that
+ *   it can be signalled as soon as it first waits for work.
+ *
+ ****************************************************************************/
+
+static int work_start(FAR struct wqueue_s *wqueue, int argc, char *argv[])
+{
+  int wndx = 0;
+
+  if (argc > 1)
+    {
+      wndx = atoi(argv[1]);
+    }
+
+  DEBUGASSERT(wndx >= 0 && wndx < WORK_MAXTHREADS);
+  wqueue->thread[wndx].pid = getpid();
+  return wndx;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -238,11 +352,13 @@ static void work_process(FAR struct wqueue_s *wqueue)
  *     boots by calling through the pointer found in the header on the user
  *     space blob.
  *
+ *   Each work queue may be serviced by several threads.
+ *
  *   All of these entrypoints are referenced by OS internally and should not
  *   not be accessed by application logic.
  *
  * Input parameters:
- *   argc, argv (not used)
+ *   argc, argv - argv[1] is the index of the thread within the work queue.
  *
  * Returned Value:
  *   Does not return
@@ -253,6 +369,8 @@ static void work_process(FAR struct wqueue_s *wqueue)
 
 int work_hpthread(int argc, char *argv[])
 {
+  int wndx = work_start(&g_work[HPWORK], argc, argv);
+
   /* Loop forever */
 
   for (;;)
@@ -265,14 +383,17 @@ int work_hpthread(int argc, char *argv[])
        */
 
 #ifndef CONFIG_SCHED_LPWORK
-      sched_garbagecollection();
+      if (wndx == 0)
+        {
+          sched_garbagecollection();
+        }
 #endif
 
       /* Then process queued work.  We need to keep interrupts disabled while
        * we process items in the work list.
        */
 
-      work_process(&g_work[HPWORK]);
+      work_process(&g_work[HPWORK], wndx, CONFIG_SCHED_WORKPERIOD);
     }
 
   return OK; /* To keep some compilers happy */
@@ -282,6 +403,8 @@ int work_hpthread(int argc, char *argv[])
 
 int work_lpthread(int argc, char *argv[])
 {
+  int wndx = work_start(&g_work[LPWORK], argc, argv);
+
   /* Loop forever */
 
   for (;;)
@@ -293,13 +416,16 @@ int work_lpthread(int argc, char *argv[])
        * the IDLE thread (at a very, very low priority).
        */
 
-      sched_garbagecollection();
+      if (wndx == 0)
+        {
+          sched_garbagecollection();
+        }
 
       /* Then process queued work.  We need to keep interrupts disabled while
        * we process items in the work list.
        */
 
-      work_process(&g_work[LPWORK]);
+      work_process(&g_work[LPWORK], wndx, CONFIG_SCHED_LPWORKPERIOD);
     }
 
   return OK; /* To keep some compilers happy */
@@ -312,6 +438,8 @@ int work_lpthread(int argc, char *argv[])
 
 int work_usrthread(int argc, char *argv[])
 {
+  int wndx = work_start(&g_work[USRWORK], argc, argv);
+
   /* Loop forever */
 
   for (;;)
@@ -320,7 +448,7 @@ int work_usrthread(int argc, char *argv[])
        * we process items in the work list.
        */
 
-      work_process(&g_work[USRWORK]);
+      work_process(&g_work[USRWORK], wndx, CONFIG_SCHED_USRWORKPERIOD);
     }
 
   return OK; /* To keep some compilers happy */
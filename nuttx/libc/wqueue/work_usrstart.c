@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdio.h>
 #include <sched.h>
 #include <errno.h>
 #include <assert.h>
@@ -82,34 +83,50 @@
  *   None
  *
  * Returned Value:
- *   The task ID of the worker thread is returned on success.  A negated
- *   errno value is returned on failure.
+ *   The task ID of the first worker thread is returned on success.  A
+ *   negated errno value is returned on failure.
  *
  ****************************************************************************/
 
 int work_usrstart(void)
 {
+  FAR char *argv[2];
+  char arg[4];
+  pid_t pid;
+  int wndx;
+
   /* Start a user-mode worker thread for use by applications. */
 
   svdbg("Starting user-mode worker thread\n");
 
-  g_usrwork[USRWORK].pid = task_create("usrwork",
-                                       CONFIG_SCHED_USRWORKPRIORITY,
-                                       CONFIG_SCHED_USRWORKSTACKSIZE,
-                                       (main_t)work_usrthread,
-                                       (FAR char * const *)NULL);
+  /* Each thread receives its index within the work queue as its only
+   * argument.
+   */
 
-  DEBUGASSERT(g_usrwork[USRWORK].pid > 0);
-  if (g_usrwork[USRWORK].pid < 0)
-    {
-      int errcode = errno;
-      DEBUGASSERT(errcode > 0);
+  argv[0] = arg;
+  argv[1] = NULL;
 
-      sdbg("task_create failed: %d\n", errcode);
-      return -errcode;
+  for (wndx = 0; wndx < CONFIG_SCHED_USRWORKNTHREADS; wndx++)
+    {
+      snprintf(arg, sizeof(arg), "%d", wndx);
+      pid = task_create("usrwork", CONFIG_SCHED_USRWORKPRIORITY,
+                        CONFIG_SCHED_USRWORKSTACKSIZE,
+                        (main_t)work_usrthread, (FAR char * const *)argv);
+
+      DEBUGASSERT(pid > 0);
+      if (pid < 0)
+        {
+          int errcode = errno;
+          DEBUGASSERT(errcode > 0);
+
+          sdbg("task_create failed: %d\n", errcode);
+          return -errcode;
+        }
+
+      g_usrwork[USRWORK].thread[wndx].pid = pid;
     }
 
-  return g_usrwork[USRWORK].pid;
+  return g_usrwork[USRWORK].thread[0].pid;
 }
 
 #endif /* CONFIG_BUILD_PROTECTED && !__KERNEL__ CONFIG_SCHED_WORKQUEUE && CONFIG_SCHED_USRWORK */
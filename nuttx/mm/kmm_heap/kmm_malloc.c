@@ -83,7 +83,10 @@
 
 FAR void *kmm_malloc(size_t size)
 {
-  return mm_malloc(&g_kmmheap, size);
+  FAR void *mem = mm_malloc(&g_kmmheap, size);
+
+  MM_PROFILE_CALLER(&g_kmmheap, mem);
+  return mem;
 }
 
 #endif /* CONFIG_MM_KERNEL_HEAP */
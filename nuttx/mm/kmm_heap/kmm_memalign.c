@@ -74,7 +74,10 @@
 
 FAR void *kmm_memalign(size_t alignment, size_t size)
 {
-  return mm_memalign(&g_kmmheap, alignment, size);
+  FAR void *mem = mm_memalign(&g_kmmheap, alignment, size);
+
+  MM_PROFILE_CALLER(&g_kmmheap, mem);
+  return mem;
 }
 
 #endif /* CONFIG_MM_KERNEL_HEAP */
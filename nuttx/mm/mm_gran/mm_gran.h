@@ -56,8 +56,19 @@
 
 #define SIZEOF_GAT(n) \
   ((n + 31) >> 5)
+#define SIZEOF_FULL(n) \
+  ((SIZEOF_GAT(n) + 31) >> 5)
 #define SIZEOF_GRAN_S(n) \
-  (sizeof(struct gran_s) + sizeof(uint32_t) * (SIZEOF_GAT(n) - 1))
+  (sizeof(struct gran_s) + \
+   sizeof(uint32_t) * (SIZEOF_GAT(n) - 1 + SIZEOF_FULL(n)))
+
+/* Index of the least significant set bit of a non-zero word.  This is a
+ * single RBIT/CLZ pair on ARMv7-M.
+ */
+
+#ifdef __GNUC__
+#  define gran_ctz(w) __builtin_ctz(w)
+#endif
 
 /* Debug */
 
@@ -83,21 +94,49 @@
  * Public Types
  ****************************************************************************/
 
-/* This structure represents the state of one granule allocation */
+/* This structure represents the state of one granule allocation.
+ *
+ * Each bit of the granule allocation table (GAT) is set if the
+ * corresponding granule is allocated.  The 'full' summary has one bit per
+ * GAT entry, set if all 32 granules of the entry are allocated, so that the
+ * search for free granules can skip 1024 granules per summary word.  Bits
+ * past the end of the heap are always set in both tables.
+ */
 
 struct gran_s
 {
   uint8_t    log2gran;  /* Log base 2 of the size of one granule */
   uint16_t   ngranules; /* The total number of (aligned) granules in the heap */
+  uint16_t   ngat;      /* The number of entries in the GAT */
 #ifdef CONFIG_GRAN_INTR
   irqstate_t irqstate;  /* For exclusive access to the GAT */
 #else
   sem_t      exclsem;   /* For exclusive access to the GAT */
 #endif
   uintptr_t  heapstart; /* The aligned start of the granule heap */
+  FAR uint32_t *full;   /* Summary of full GAT entries (follows the GAT) */
   uint32_t   gat[1];    /* Start of the granule allocation table */
 };
 
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+#ifndef gran_ctz
+static inline int gran_ctz(uint32_t word)
+{
+  int bit = 0;
+
+  while ((word & 1) == 0)
+    {
+      word >>= 1;
+      bit++;
+    }
+
+  return bit;
+}
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -148,4 +187,23 @@ void gran_leave_critical(FAR struct gran_s *priv);
 void gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
                          unsigned int ngranules);
 
+/****************************************************************************
+ * Name: gran_mark_free
+ *
+ * Description:
+ *   Mark a range of granules as free.
+ *
+ * Input Parameters:
+ *   priv  - The granule heap state structure.
+ *   alloc - The address of the allocation.
+ *   ngranules - The number of granules allocated
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void gran_mark_free(FAR struct gran_s *priv, uintptr_t alloc,
+                    unsigned int ngranules);
+
 #endif /* __MM_MM_GRAN_MM_GRAN_H */
@@ -55,6 +55,105 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: gran_find_free
+ *
+ * Description:
+ *   Find the first free granule at or after 'granno'.  Full GAT entries are
+ *   skipped using the summary table so that a search over a mostly
+ *   allocated heap costs one count-trailing-zeros per 1024 granules.
+ *
+ * Input Parameters:
+ *   priv   - The granule heap state structure.
+ *   granno - The granule number at which to start the search.
+ *
+ * Returned Value:
+ *   The number of the first free granule or -1 if there is none.
+ *
+ ****************************************************************************/
+
+static int gran_find_free(FAR struct gran_s *priv, unsigned int granno)
+{
+  unsigned int gatidx;
+  unsigned int fullidx;
+  uint32_t     word;
+
+  gatidx = granno >> 5;
+  if (gatidx >= priv->ngat)
+    {
+      return -1;
+    }
+
+  /* Check the remainder of the current GAT entry first */
+
+  word = ~priv->gat[gatidx] & (0xffffffff << (granno & 31));
+  if (word != 0)
+    {
+      return (gatidx << 5) + gran_ctz(word);
+    }
+
+  /* Then use the summary to find the next entry that is not full */
+
+  for (gatidx++; gatidx < priv->ngat; gatidx = (fullidx + 1) << 5)
+    {
+      fullidx = gatidx >> 5;
+      word    = ~priv->full[fullidx] & (0xffffffff << (gatidx & 31));
+      if (word != 0)
+        {
+          gatidx = (fullidx << 5) + gran_ctz(word);
+          if (gatidx >= priv->ngat)
+            {
+              break;
+            }
+
+          return (gatidx << 5) + gran_ctz(~priv->gat[gatidx]);
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: gran_find_used
+ *
+ * Description:
+ *   Find the first allocated granule in the range 'granno' up to (but not
+ *   including) 'limit'.  This gives the end of a run of free granules.
+ *
+ * Input Parameters:
+ *   priv   - The granule heap state structure.
+ *   granno - The granule number at which to start the search.
+ *   limit  - The granule number at which to stop the search.  Must not be
+ *            greater than the number of granules in the heap.
+ *
+ * Returned Value:
+ *   The number of the first allocated granule or 'limit' if all granules in
+ *   the range are free.
+ *
+ ****************************************************************************/
+
+static unsigned int gran_find_used(FAR struct gran_s *priv,
+                                   unsigned int granno, unsigned int limit)
+{
+  unsigned int gatidx;
+  uint32_t     word;
+
+  while (granno < limit)
+    {
+      gatidx = granno >> 5;
+      word   = priv->gat[gatidx] & (0xffffffff << (granno & 31));
+      if (word != 0)
+        {
+          granno = (gatidx << 5) + gran_ctz(word);
+          return granno < limit ? granno : limit;
+        }
+
+      granno = (gatidx + 1) << 5;
+    }
+
+  return limit;
+}
+
 /****************************************************************************
  * Name: gran_common_alloc
  *
@@ -73,177 +172,56 @@
 static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
 {
   unsigned int ngranules;
+  unsigned int granno;
+  unsigned int end;
   size_t       tmpmask;
   uintptr_t    alloc;
-  uint32_t     curr;
-  uint32_t     next;
-  uint32_t     mask;
-  int          granidx;
-  int          gatidx;
-  int          bitidx;
-  int          shift;
+  int          start;
 
-  DEBUGASSERT(priv && size <= 32 * (1 << priv->log2gran));
+  DEBUGASSERT(priv);
 
-  if (priv && size > 0)
+  if (priv == NULL || size == 0 ||
+      size > ((size_t)priv->ngranules << priv->log2gran))
     {
-      /* Get exclusive access to the GAT */
-
-      gran_enter_critical(priv);
-
-      /* How many contiguous granules we we need to find? */
+      return NULL;
+    }
 
-      tmpmask   = (1 << priv->log2gran) - 1;
-      ngranules = (size + tmpmask) >> priv->log2gran;
+  /* How many contiguous granules we we need to find? */
 
-      /* Then create mask for that number of granules */
+  tmpmask   = (1 << priv->log2gran) - 1;
+  ngranules = (size + tmpmask) >> priv->log2gran;
 
-      DEBUGASSERT(ngranules <= 32);
-      mask = 0xffffffff >> (32 - ngranules);
+  /* Get exclusive access to the GAT */
 
-      /* Now search the granule allocation table for that number of contiguous */
+  gran_enter_critical(priv);
 
-      alloc = priv->heapstart;
+  /* Search for a run of free granules that is long enough.  Each pass
+   * finds the start of the next free run and then its end; if the run is
+   * too short the search resumes after the allocated granule that ended it.
+   * A single granule request (the page allocator case) is satisfied by the
+   * first free granule found.
+   */
 
-      for (granidx = 0; granidx < priv->ngranules; granidx += 32)
+  for (granno = 0; ; granno = end)
+    {
+      start = gran_find_free(priv, granno);
+      if (start < 0 || start + ngranules > priv->ngranules)
         {
-          /* Get the GAT index associated with the granule table entry */
-
-          gatidx = granidx >> 5;
-          curr = priv->gat[gatidx];
-
-          /* Handle the case where there are no free granules in the entry */
-
-          if (curr == 0xffffffff)
-            {
-              alloc += (32 << priv->log2gran);
-              continue;
-            }
-
-          /* Get the next entry from the GAT to support a 64 bit shift */
+          break;
+        }
 
-          if (granidx < priv->ngranules)
-            {
-              next = priv->gat[gatidx + 1];
-            }
+      end = gran_find_used(priv, start + 1, start + ngranules);
+      if (end == start + ngranules)
+        {
+          /* Found it.. mark these granules allocated */
 
-          /* Use all ones when are at the last entry in the GAT (meaning
-           * nothing can be allocated.
-           */
+          alloc = priv->heapstart + ((uintptr_t)start << priv->log2gran);
+          gran_mark_allocated(priv, alloc, ngranules);
 
-          else
-            {
-              next = 0xffffffff;
-            }
+          /* And return the allocation address */
 
-          /* Search through the allocations in the 'curr' GAT entry
-           * to see if we can satisfy the allocation starting in that
-           * entry.
-           *
-           * This loop continues until either all of the bits have been
-           * examined (bitidx >= 32), or until there are insufficient
-           * granules left to satisfy the allocation.
-           */
-
-          for (bitidx = 0;
-               bitidx < 32 && (granidx + bitidx + ngranules) <= priv->ngranules;
-              )
-            {
-              /* Break out if there are no further free bits in 'curr'.
-               * All of the zero bits might have gotten shifted out.
-               */
-
-              if (curr == 0xffffffff)
-                {
-                  break;
-                }
-
-              /* Check for the first zero bit in the lower or upper 16-bits.
-               * From the test above, we know that at least one of the 32-
-               * bits in 'curr' is zero.
-               */
-
-              else if ((curr & 0x0000ffff) == 0x0000ffff)
-                {
-                  /* Not in the lower 16 bits.  The first free bit must be
-                   * in the upper 16 bits.
-                   */
-
-                  shift = 16;
-                }
-
-              /* We know that the first free bit is now within the lower 16
-               * bits of 'curr'.  Is it in the upper or lower byte?
-               */
-
-              else if ((curr & 0x0000ff) == 0x000000ff)
-                {
-                  /* Not in the lower 8 bits.  The first free bit must be in
-                   * the upper 8 bits.
-                   */
-
-                  shift = 8;
-                }
-
-              /* We know that the first free bit is now within the lower 4
-               * bits of 'curr'.  Is it in the upper or lower nibble?
-               */
-
-              else if ((curr & 0x00000f) == 0x0000000f)
-                {
-                  /* Not in the lower 4 bits.  The first free bit must be in
-                   * the upper 4 bits.
-                   */
-
-                  shift = 4;
-                }
-
-              /* We know that the first free bit is now within the lower 4 bits
-               * of 'curr'.  Is it in the upper or lower pair?
-               */
-
-              else if ((curr & 0x000003) == 0x00000003)
-                {
-                  /* Not in the lower 2 bits.  The first free bit must be in
-                   * the upper 2 bits.
-                   */
-
-                  shift = 2;
-                }
-
-              /* We know that the first free bit is now within the lower 4 bits
-               * of 'curr'.  Check if we have the allocation at this bit position.
-               */
-
-              else if ((curr & mask) == 0)
-                {
-                  /* Yes.. mark these granules allocated */
-
-                  gran_mark_allocated(priv, alloc, ngranules);
-
-                  /* And return the allocation address */
-
-                  gran_leave_critical(priv);
-                  return (FAR void *)alloc;
-                }
-
-              /* The free allocation does not start at this position */
-
-              else
-                {
-                  shift = 1;
-                }
-
-              /* Set up for the next time through the loop.  Perform a 64
-               * bit shift to move to the next gran position andi ncrement
-               * to the next candidate allocation address.
-               */
-
-              alloc  += (shift << priv->log2gran);
-              curr    = (curr >> shift) | (next << (32 - shift));
-              next  >>= shift;
-              bitidx += shift;
-            }
+          gran_leave_critical(priv);
+          return (FAR void *)alloc;
         }
     }
 
@@ -261,10 +239,6 @@ static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
  * Description:
  *   Allocate memory from the granule heap.
  *
- *   NOTE: The current implementation also restricts the maximum allocation
- *   size to 32 granules.  That restriction could be eliminated with some
- *   additional coding effort.
- *
  * Input Parameters:
  *   handle - The handle previously returned by gran_initialize
  *   size   - The size of the memory region to allocate.
@@ -101,6 +101,7 @@ gran_common_initialize(FAR void *heapstart, size_t heapsize, uint8_t log2gran,
   unsigned int       mask;
   unsigned int       alignedsize;
   unsigned int       ngranules;
+  unsigned int       ngat;
 
   /* Check parameters if debug is on.  Note the size of a granule is
    * limited to 2**31 bytes and that the size of the granule must be greater
@@ -132,9 +133,27 @@ gran_common_initialize(FAR void *heapstart, size_t heapsize, uint8_t log2gran,
     {
       /* Initialize non-zero elements of the granules heap info structure */
 
+      ngat            = SIZEOF_GAT(ngranules);
       priv->log2gran  = log2gran;
       priv->ngranules = ngranules;
+      priv->ngat      = ngat;
       priv->heapstart = alignedstart;
+      priv->full      = &priv->gat[ngat];
+
+      /* Granules past the end of the heap, and summary bits past the end
+       * of the GAT, are permanently marked as allocated so that the search
+       * logic never needs to check for the end of a partial entry.
+       */
+
+      if ((ngranules & 31) != 0)
+        {
+          priv->gat[ngat - 1] = 0xffffffff << (ngranules & 31);
+        }
+
+      if ((ngat & 31) != 0)
+        {
+          priv->full[SIZEOF_FULL(ngranules) - 1] = 0xffffffff << (ngat & 31);
+        }
 
       /* Initialize mutual exclusion support */
 
@@ -182,10 +201,6 @@ gran_common_initialize(FAR void *heapstart, size_t heapsize, uint8_t log2gran,
  *   The actual memory allocates will be 64 byte (wasting 17 bytes) and
  *   will be aligned at least to (1 << log2align).
  *
- *   NOTE: The current implementation also restricts the maximum allocation
- *   size to 32 granules.  That restriction could be eliminated with some
- *   additional coding effort.
- *
  * Input Parameters:
  *   heapstart - Start of the granule allocation heap
  *   heapsize  - Size of heap in bytes
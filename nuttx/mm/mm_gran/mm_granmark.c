@@ -81,51 +81,98 @@ void gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
   unsigned int granno;
   unsigned int gatidx;
   unsigned int gatbit;
-  unsigned int avail;
+  unsigned int nbits;
   uint32_t     gatmask;
 
   /* Determine the granule number of the allocation */
 
   granno = (alloc - priv->heapstart) >> priv->log2gran;
 
-  /* Determine the GAT table index associated with the allocation */
+  /* Mark bits in each GAT entry spanned by the allocation */
 
-  gatidx = granno >> 5;
-  gatbit = granno & 31;
-
-  /* Mark bits in the GAT entry or entries */
-
-  avail = 32 - gatbit;
-  if (ngranules > avail)
+  while (ngranules > 0)
     {
-      /* Mark bits in the first GAT entry */
+      gatidx = granno >> 5;
+      gatbit = granno & 31;
+
+      nbits = 32 - gatbit;
+      if (nbits > ngranules)
+        {
+          nbits = ngranules;
+        }
 
-      gatmask =0xffffffff << gatbit;
+      gatmask = (nbits < 32) ? (((uint32_t)1 << nbits) - 1) << gatbit :
+                0xffffffff;
       DEBUGASSERT((priv->gat[gatidx] & gatmask) == 0);
 
       priv->gat[gatidx] |= gatmask;
-      ngranules -= avail;
 
-      /* Mark bits in the second GAT entry */
+      /* Update the summary if there are no free granules left in the entry */
 
-      gatmask = 0xffffffff >> (32 - ngranules);
-      DEBUGASSERT((priv->gat[gatidx+1] & gatmask) == 0);
+      if (priv->gat[gatidx] == 0xffffffff)
+        {
+          priv->full[gatidx >> 5] |= (uint32_t)1 << (gatidx & 31);
+        }
 
-      priv->gat[gatidx+1] |= gatmask;
+      granno    += nbits;
+      ngranules -= nbits;
     }
+}
+
+/****************************************************************************
+ * Name: gran_mark_free
+ *
+ * Description:
+ *   Mark a range of granules as free.
+ *
+ * Input Parameters:
+ *   priv  - The granule heap state structure.
+ *   alloc - The address of the allocation.
+ *   ngranules - The number of granules allocated
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
 
-  /* Handle the case where where all of the granules come from one entry */
+void gran_mark_free(FAR struct gran_s *priv, uintptr_t alloc,
+                    unsigned int ngranules)
+{
+  unsigned int granno;
+  unsigned int gatidx;
+  unsigned int gatbit;
+  unsigned int nbits;
+  uint32_t     gatmask;
+
+  /* Determine the granule number of the allocation */
 
-  else
+  granno = (alloc - priv->heapstart) >> priv->log2gran;
+
+  /* Clear bits in each GAT entry spanned by the allocation */
+
+  while (ngranules > 0)
     {
-      /* Mark bits in a single GAT entry */
+      gatidx = granno >> 5;
+      gatbit = granno & 31;
 
-      gatmask   = 0xffffffff >> (32 - ngranules);
-      gatmask <<= gatbit;
-      DEBUGASSERT((priv->gat[gatidx] & gatmask) == 0);
+      nbits = 32 - gatbit;
+      if (nbits > ngranules)
+        {
+          nbits = ngranules;
+        }
 
-      priv->gat[gatidx] |= gatmask;
-      return;
+      gatmask = (nbits < 32) ? (((uint32_t)1 << nbits) - 1) << gatbit :
+                0xffffffff;
+      DEBUGASSERT((priv->gat[gatidx] & gatmask) == gatmask);
+
+      priv->gat[gatidx] &= ~gatmask;
+
+      /* The entry now has at least one free granule */
+
+      priv->full[gatidx >> 5] &= ~((uint32_t)1 << (gatidx & 31));
+
+      granno    += nbits;
+      ngranules -= nbits;
     }
 }
 
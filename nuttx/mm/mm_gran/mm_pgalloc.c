@@ -128,7 +128,7 @@ void mm_pginitialize(FAR void *heap_start, size_t heap_size)
 
 #else
   g_pgalloc = gran_initialize(heap_start, heap_size, MM_PGSHIFT, MM_PGSHIFT);
-  DEBUGASSERT(pg_alloc != NULL);
+  DEBUGASSERT(g_pgalloc != NULL);
 
 #endif
 }
@@ -182,9 +182,9 @@ void mm_pgreserve(uintptr_t start, size_t size)
 uintptr_t mm_pgalloc(unsigned int npages)
 {
 #ifdef CONFIG_GRAN_SINGLE
-  return (uintptr_t)gran_alloc((size_t)1 << MM_PGSHIFT);
+  return (uintptr_t)gran_alloc((size_t)npages << MM_PGSHIFT);
 #else
-  return (uintptr_t)gran_alloc(g_pgalloc, (size_t)1 << MM_PGSHIFT);
+  return (uintptr_t)gran_alloc(g_pgalloc, (size_t)npages << MM_PGSHIFT);
 #endif
 }
 
@@ -131,6 +131,19 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
 
   DEBUGASSERT(uordblks + fordblks == heap->mm_heapsize);
 
+#ifdef CONFIG_MM_TCACHE
+  /* Chunks held in the per-thread caches are allocated as far as the heap
+   * is concerned, but they are really available memory.
+   */
+
+  {
+    size_t cached = mm_tcache_cached(heap);
+
+    uordblks -= cached;
+    fordblks += cached;
+  }
+#endif
+
   info->arena    = heap->mm_heapsize;
   info->ordblks  = ordblks;
   info->mxordblk = mxordblk;
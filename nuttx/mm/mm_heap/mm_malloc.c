@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <unistd.h>
 #include <assert.h>
 #include <debug.h>
 
@@ -87,7 +88,6 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 {
   FAR struct mm_freenode_s *node;
   void *ret = NULL;
-  int ndx;
 
   /* Handle bad sizes */
 
@@ -96,6 +96,21 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       return NULL;
     }
 
+#ifdef CONFIG_MM_TCACHE
+  /* Small allocations are normally satisfied from the per-thread cache
+   * without taking the MM semaphore.
+   */
+
+  ret = mm_tcache_malloc(heap, size);
+  if (ret)
+    {
+#ifdef CONFIG_MM_PROFILE
+      mm_profile_alloc(heap, ret, MM_RETADDR());
+#endif
+      return ret;
+    }
+#endif
+
   /* Adjust the size to account for (1) the size of the allocated node and
    * (2) to make sure that it is an even multiple of our granule size.
    */
@@ -106,34 +121,11 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   mm_takesemaphore(heap);
 
-  /* Get the location in the node list to start the search. Special case
-   * really big allocations
-   */
-
-  if (size >= MM_MAX_CHUNK)
-    {
-      ndx = MM_NNODES-1;
-    }
-  else
-    {
-      /* Convert the request size into a nodelist index */
-
-      ndx = mm_size2ndx(size);
-    }
+  /* Find the free chunk that best satisfies the request */
 
-  /* Search for a large enough chunk in the list of nodes. This list is
-   * ordered by size, but will have occasional zero sized nodes as we visit
-   * other mm_nodelist[] entries.
-   */
+  node = mm_findfreechunk(heap, size);
 
-  for (node = heap->mm_nodelist[ndx].flink;
-       node && node->size < size;
-       node = node->flink);
-
-  /* If we found a node with non-zero size, then this is one to use. Since
-   * the list is ordered, we know that is must be best fitting chunk
-   * available.
-   */
+  /* If we found a node, then this is the one to use */
 
   if (node)
     {
@@ -141,16 +133,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct mm_freenode_s *next;
       size_t remaining;
 
-      /* Remove the node.  There must be a predecessor, but there may not be
-       * a successor node.
-       */
+      /* Remove the node from the free list */
 
-      DEBUGASSERT(node->blink);
-      node->blink->flink = node->flink;
-      if (node->flink)
-        {
-          node->flink->blink = node->blink;
-        }
+      mm_delfreechunk(heap, node);
 
       /* Check if we have to split the free node into one of the allocated
        * size and another smaller freenode.  In some cases, the remaining
@@ -195,6 +180,26 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   mm_givesemaphore(heap);
 
+#ifdef CONFIG_MM_PROFILE
+  /* Record the allocation site.  Allocations made while this thread still
+   * holds the semaphore are internal to the heap (e.g., the raw chunk of
+   * mm_memalign() or a per-thread cache refill) and are not accounted.
+   */
+
+  if (ret)
+    {
+      if (heap->mm_holder == getpid())
+        {
+          ((FAR struct mm_allocnode_s *)
+            ((FAR char *)ret - SIZEOF_MM_ALLOCNODE))->site = MM_PROFILE_NOSITE;
+        }
+      else
+        {
+          mm_profile_alloc(heap, ret, MM_RETADDR());
+        }
+    }
+#endif
+
   /* If CONFIG_DEBUG_MM is defined, then output the result of the allocation
    * to the SYSLOG.
    */
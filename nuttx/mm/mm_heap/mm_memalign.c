@@ -101,20 +101,23 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
   size      = MM_ALIGN_UP(size);   /* Make multiples of our granule size */
   allocsize = size + 2*alignment;  /* Add double full alignment size */
 
+  /* We need to hold the MM semaphore while we muck with the chunks and
+   * nodelist.  It is taken before the allocation so that the chunk comes
+   * directly from the heap (and not from a per-thread cache) and so its
+   * preceding chunk is known to be in use.
+   */
+
+  mm_takesemaphore(heap);
+
   /* Then malloc that size */
 
   rawchunk = (size_t)mm_malloc(heap, allocsize);
   if (rawchunk == 0)
     {
+      mm_givesemaphore(heap);
       return NULL;
     }
 
-  /* We need to hold the MM semaphore while we muck with the chunks and
-   * nodelist.
-   */
-
-  mm_takesemaphore(heap);
-
   /* Get the node associated with the allocation and the next node after
    * the allocation.
    */
@@ -209,6 +212,10 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
       mm_shrinkchunk(heap, node, size + SIZEOF_MM_ALLOCNODE);
     }
 
+#ifdef CONFIG_MM_PROFILE
+  mm_profile_alloc(heap, (FAR void *)alignedchunk, MM_RETADDR());
+#endif
+
   mm_givesemaphore(heap);
   return (FAR void*)alignedchunk;
 }
@@ -0,0 +1,388 @@
+/****************************************************************************
+ * mm/mm_heap/mm_profile.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include <arch/irq.h>
+#include <nuttx/clock.h>
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_PROFILE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if CONFIG_MM_PROFILE_NSITES < 2 || CONFIG_MM_PROFILE_NSITES >= MM_PROFILE_NOSITE
+#  error CONFIG_MM_PROFILE_NSITES out of range
+#endif
+
+/* Site zero is the overflow site; the others are a hash table */
+
+#define MM_PROFILE_NHASH (CONFIG_MM_PROFILE_NSITES - 1)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_profile_site
+ *
+ * Description:
+ *   Return the index of the site table entry for 'caller', creating the
+ *   entry if necessary.  Returns the overflow site (zero) if the table is
+ *   full.  Interrupts must be disabled.
+ *
+ ****************************************************************************/
+
+static int mm_profile_site(FAR struct mm_heap_s *heap, FAR void *caller)
+{
+  FAR struct mm_prsite_s *site;
+  unsigned int hash;
+  int i;
+
+  /* Return addresses are at least 2-byte aligned (Thumb code) */
+
+  hash = (unsigned int)(((uintptr_t)caller >> 1) % MM_PROFILE_NHASH);
+
+  for (i = 0; i < MM_PROFILE_NHASH; i++)
+    {
+      site = &heap->mm_prsites[hash + 1];
+      if (site->ps_caller == caller)
+        {
+          return hash + 1;
+        }
+      else if (site->ps_caller == NULL)
+        {
+          site->ps_caller = caller;
+          return hash + 1;
+        }
+
+      if (++hash >= MM_PROFILE_NHASH)
+        {
+          hash = 0;
+        }
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: mm_profile_add/remove
+ *
+ * Description:
+ *   Account a chunk to, or remove a chunk from, a site.  Interrupts must be
+ *   disabled.
+ *
+ ****************************************************************************/
+
+static inline void mm_profile_add(FAR struct mm_heap_s *heap,
+                                  FAR struct mm_allocnode_s *node, int ndx)
+{
+  FAR struct mm_prsite_s *site = &heap->mm_prsites[ndx];
+
+  node->site      = ndx;
+  site->ps_live  += node->size;
+  site->ps_nlive++;
+  site->ps_nallocs++;
+
+  if (site->ps_live > site->ps_peak)
+    {
+      site->ps_peak = site->ps_live;
+    }
+}
+
+static inline void mm_profile_remove(FAR struct mm_heap_s *heap,
+                                     FAR struct mm_allocnode_s *node)
+{
+  FAR struct mm_prsite_s *site = &heap->mm_prsites[node->site];
+
+  DEBUGASSERT(site->ps_live >= node->size && site->ps_nlive > 0);
+
+  site->ps_live  -= node->size;
+  site->ps_nlive--;
+  node->site      = MM_PROFILE_NOSITE;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_profile_class
+ *
+ * Description:
+ *   Return the size class of a chunk.  Class n holds chunks of
+ *   (MM_MIN_CHUNK << n) up to (MM_MIN_CHUNK << (n + 1)) - 1 bytes.
+ *
+ ****************************************************************************/
+
+int mm_profile_class(size_t size)
+{
+  int ndx;
+
+  size >>= MM_MIN_SHIFT;
+  for (ndx = 0; size > 1 && ndx < MM_NNODES - 1; ndx++)
+    {
+      size >>= 1;
+    }
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: mm_profile_alloc
+ *
+ * Description:
+ *   Record a new allocation:  Save the caller and size class in the chunk
+ *   header and account the chunk to the caller's site.
+ *
+ ****************************************************************************/
+
+void mm_profile_alloc(FAR struct mm_heap_s *heap, FAR void *mem,
+                      FAR void *caller)
+{
+  FAR struct mm_allocnode_s *node;
+  irqstate_t flags;
+
+  node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+
+  flags        = irqsave();
+  node->caller = caller;
+  node->sclass = mm_profile_class(node->size);
+  mm_profile_add(heap, node, mm_profile_site(heap, caller));
+  heap->mm_prclass[node->sclass]++;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: mm_profile_free
+ *
+ * Description:
+ *   Remove a chunk that is being freed from its site.  Chunks that are not
+ *   accounted to any site are ignored.
+ *
+ ****************************************************************************/
+
+void mm_profile_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_allocnode_s *node;
+  irqstate_t flags;
+
+  node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+
+  flags = irqsave();
+  if (node->site != MM_PROFILE_NOSITE)
+    {
+      mm_profile_remove(heap, node);
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: mm_profile_caller
+ *
+ * Description:
+ *   Move an allocation to the site of a different caller.  mm_malloc() and
+ *   friends can only see the address of the umm_ or kmm_ interface that
+ *   called them; those interfaces use this to attribute the allocation to
+ *   their own caller.
+ *
+ ****************************************************************************/
+
+void mm_profile_caller(FAR struct mm_heap_s *heap, FAR void *mem,
+                       FAR void *caller)
+{
+  FAR struct mm_allocnode_s *node;
+  irqstate_t flags;
+
+  if (mem == NULL)
+    {
+      return;
+    }
+
+  node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+
+  flags = irqsave();
+  if (node->site != MM_PROFILE_NOSITE && node->caller != caller)
+    {
+      heap->mm_prsites[node->site].ps_nallocs--;
+      mm_profile_remove(heap, node);
+
+      node->caller = caller;
+      mm_profile_add(heap, node, mm_profile_site(heap, caller));
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: mm_profile_snapshot
+ *
+ * Description:
+ *   Copy the profiler counters of a heap.
+ *
+ * Input Parameters:
+ *   heap    - The heap to examine
+ *   sites   - Receives up to 'nsites' sites that have made allocations
+ *   nsites  - The size of the 'sites' array
+ *   nclass  - If non-NULL, receives the number of allocations made in each
+ *             of the MM_NNODES size classes
+ *   elapsed - If non-NULL, receives the time in milliseconds since the
+ *             previous snapshot.  (ps_nallocs - ps_lastallocs) / elapsed is
+ *             the allocation rate of a site since the previous snapshot.
+ *
+ * Returned Value:
+ *   The number of sites returned.
+ *
+ ****************************************************************************/
+
+int mm_profile_snapshot(FAR struct mm_heap_s *heap,
+                        FAR struct mm_prsite_s *sites, int nsites,
+                        FAR uint32_t *nclass, FAR uint32_t *elapsed)
+{
+  FAR struct mm_prsite_s *site;
+  irqstate_t flags;
+  uint32_t now;
+  int nret = 0;
+  int ndx;
+
+  flags = irqsave();
+  for (ndx = 0; ndx < CONFIG_MM_PROFILE_NSITES; ndx++)
+    {
+      site = &heap->mm_prsites[ndx];
+      if (site->ps_nallocs == 0)
+        {
+          continue;
+        }
+
+      if (nret < nsites)
+        {
+          sites[nret++] = *site;
+        }
+
+      site->ps_lastallocs = site->ps_nallocs;
+    }
+
+  if (nclass)
+    {
+      memcpy(nclass, heap->mm_prclass, sizeof(heap->mm_prclass));
+    }
+
+  now = clock_systimer();
+  if (elapsed)
+    {
+      *elapsed = TICK2MSEC(now - heap->mm_prstamp);
+    }
+
+  heap->mm_prstamp = now;
+  irqrestore(flags);
+
+  return nret;
+}
+
+/****************************************************************************
+ * Name: mm_freehist
+ *
+ * Description:
+ *   Walk the heap and count the free chunks in each of the MM_NNODES size
+ *   classes.  Chunks held in per-thread caches are allocated as far as the
+ *   heap is concerned and are not counted.
+ *
+ * Input Parameters:
+ *   heap    - The heap to examine
+ *   nchunks - Receives the number of free chunks in each size class
+ *   nbytes  - If non-NULL, receives the size of the free chunks in each
+ *             size class
+ *
+ ****************************************************************************/
+
+void mm_freehist(FAR struct mm_heap_s *heap, FAR uint32_t *nchunks,
+                 FAR size_t *nbytes)
+{
+  FAR struct mm_allocnode_s *node;
+  int ndx;
+#if CONFIG_MM_REGIONS > 1
+  int region;
+#else
+# define region 0
+#endif
+
+  memset(nchunks, 0, MM_NNODES * sizeof(uint32_t));
+  if (nbytes)
+    {
+      memset(nbytes, 0, MM_NNODES * sizeof(size_t));
+    }
+
+  /* Visit each region.  Retake the semaphore for each region to reduce
+   * latencies.
+   */
+
+#if CONFIG_MM_REGIONS > 1
+  for (region = 0; region < heap->mm_nregions; region++)
+#endif
+    {
+      mm_takesemaphore(heap);
+
+      for (node = heap->mm_heapstart[region];
+           node < heap->mm_heapend[region];
+           node = (FAR struct mm_allocnode_s *)((FAR char *)node + node->size))
+        {
+          if ((node->preceding & MM_ALLOC_BIT) == 0)
+            {
+              ndx = mm_profile_class(node->size);
+              nchunks[ndx]++;
+              if (nbytes)
+                {
+                  nbytes[ndx] += node->size;
+                }
+            }
+        }
+
+      mm_givesemaphore(heap);
+    }
+#undef region
+}
+
+#endif /* CONFIG_MM_PROFILE */
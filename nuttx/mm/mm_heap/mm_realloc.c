@@ -91,6 +91,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
   size_t prevsize = 0;
   size_t nextsize = 0;
   FAR void *newmem;
+#ifdef CONFIG_MM_PROFILE
+  FAR void *caller;
+#endif
 
   /* If oldmem is NULL, then realloc is equivalent to malloc */
 
@@ -132,7 +135,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
       if (size < oldsize)
         {
+#ifdef CONFIG_MM_PROFILE
+          /* Account the resized chunk as a new allocation */
+
+          caller = oldnode->caller;
+          mm_profile_free(heap, oldmem);
+#endif
           mm_shrinkchunk(heap, oldnode, size);
+#ifdef CONFIG_MM_PROFILE
+          mm_profile_alloc(heap, oldmem, caller);
+#endif
         }
 
       /* Then return the original address */
@@ -166,6 +178,15 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
       size_t takeprev = 0;
       size_t takenext = 0;
 
+#ifdef CONFIG_MM_PROFILE
+      /* The chunk header may move; account the extended chunk as a new
+       * allocation.
+       */
+
+      caller = oldnode->caller;
+      mm_profile_free(heap, oldmem);
+#endif
+
       /* Check if we can extend into the previous chunk and if the
        * previous chunk is smaller than the next chunk.
        */
@@ -220,6 +241,21 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
             }
         }
 
+      /* Chunks trimmed by mm_memalign() are not necessarily a multiple of
+       * the granule size.  Never leave a remainder that is too small to
+       * hold a free node; absorb it into the allocation instead.
+       */
+
+      if (takeprev > 0 && prevsize - takeprev < SIZEOF_MM_FREENODE)
+        {
+          takeprev = prevsize;
+        }
+
+      if (takenext > 0 && nextsize - takenext < SIZEOF_MM_FREENODE)
+        {
+          takenext = nextsize;
+        }
+
       /* Extend into the previous free chunk */
 
       newmem = oldmem;
@@ -227,16 +263,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
         {
           FAR struct mm_allocnode_s *newnode;
 
-          /* Remove the previous node.  There must be a predecessor, but
-           * there may not be a successor node.
-           */
+          /* Remove the previous node from the free list */
 
-          DEBUGASSERT(prev->blink);
-          prev->blink->flink = prev->flink;
-          if (prev->flink)
-            {
-              prev->flink->blink = prev->blink;
-            }
+          mm_delfreechunk(heap, prev);
 
           /* Extend the node into the previous free chunk */
 
@@ -272,15 +301,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
               next->preceding     = newnode->size | (next->preceding & MM_ALLOC_BIT);
             }
 
-          oldnode = newnode;
-          oldsize = newnode->size;
-
-          /* Now we have to move the user contents 'down' in memory.  memcpy should
-           * should be save for this.
+          /* Now we have to move the user contents 'down' in memory.  Only
+           * the old payload is valid and the source and destination regions
+           * overlap, so this must be a memmove() of the original size.
            */
 
           newmem = (FAR void*)((FAR char*)newnode + SIZEOF_MM_ALLOCNODE);
-          memcpy(newmem, oldmem, oldsize - SIZEOF_MM_ALLOCNODE);
+          memmove(newmem, oldmem, oldsize - SIZEOF_MM_ALLOCNODE);
+
+          oldnode = newnode;
+          oldsize = newnode->size;
         }
 
       /* Extend into the next free chunk */
@@ -296,16 +326,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
           andbeyond = (FAR struct mm_allocnode_s*)((char*)next + nextsize);
 
-          /* Remove the next node.  There must be a predecessor, but there
-           * may not be a successor node.
-           */
+          /* Remove the next node from the free list */
 
-          DEBUGASSERT(next->blink);
-          next->blink->flink = next->flink;
-          if (next->flink)
-            {
-              next->flink->blink = next->blink;
-            }
+          mm_delfreechunk(heap, next);
 
           /* Extend the node into the next chunk */
 
@@ -336,6 +359,10 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
             }
         }
 
+#ifdef CONFIG_MM_PROFILE
+      mm_profile_alloc(heap, newmem, caller);
+#endif
+
       mm_givesemaphore(heap);
       return newmem;
     }
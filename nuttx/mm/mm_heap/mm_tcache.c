@@ -0,0 +1,414 @@
+/****************************************************************************
+ * mm/mm_heap/mm_tcache.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <unistd.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_TCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MM_TCACHE_DEPTH
+#  define CONFIG_MM_TCACHE_DEPTH 8
+#endif
+
+#ifndef CONFIG_MM_TCACHE_BATCH
+#  define CONFIG_MM_TCACHE_BATCH 4
+#endif
+
+#if CONFIG_MM_TCACHE_BATCH > CONFIG_MM_TCACHE_DEPTH
+#  error CONFIG_MM_TCACHE_BATCH must not exceed CONFIG_MM_TCACHE_DEPTH
+#endif
+
+#if CONFIG_MM_TCACHE_DEPTH > 255
+#  error CONFIG_MM_TCACHE_DEPTH must not exceed 255
+#endif
+
+/* Map a chunk size (including the allocation node) to a size class */
+
+#define MM_TCACHE_CLASS(s)   (((s) >> MM_MIN_SHIFT) - 1)
+#define MM_TCACHE_CHUNK(c)   (((c) + 1) << MM_MIN_SHIFT)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A cached chunk is linked through the first word of its payload */
+
+struct mm_tcnode_s
+{
+  FAR struct mm_tcnode_s *flink;
+};
+
+struct mm_tccount_s
+{
+  FAR struct mm_heap_s *heap;
+  size_t bytes;
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tcache
+ *
+ * Description:
+ *   Return the cache of the calling thread if it may be used for the
+ *   heap.  The caches are never used from interrupt handlers or while the
+ *   calling thread holds the heap semaphore.  The latter is the case when
+ *   the cache itself is being refilled or drained.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_tcache_s *mm_tcache(FAR struct mm_heap_s *heap)
+{
+  FAR struct tcb_s *rtcb;
+  FAR struct mm_tcache_s *tcache;
+
+  if (up_interrupt_context() || heap->mm_holder == getpid())
+    {
+      return NULL;
+    }
+
+  /* The ready-to-run list may be empty very early in the boot sequence */
+
+  rtcb = sched_self();
+  if (rtcb == NULL)
+    {
+      return NULL;
+    }
+
+  /* A thread caches chunks from only one heap:  The first heap that it
+   * allocates from or frees to.
+   */
+
+  tcache = &rtcb->tcache;
+  if (tcache->tc_heap != heap)
+    {
+      if (tcache->tc_heap != NULL)
+        {
+          return NULL;
+        }
+
+      tcache->tc_heap = heap;
+    }
+
+  return tcache;
+}
+
+/****************************************************************************
+ * Name: mm_tcache_push/pop
+ *
+ * Description:
+ *   Add a chunk to, or remove a chunk from, one size class of a cache.
+ *
+ ****************************************************************************/
+
+static inline void mm_tcache_push(FAR struct mm_tcache_s *tcache, int ndx,
+                                  FAR void *mem)
+{
+  FAR struct mm_tcnode_s *node = (FAR struct mm_tcnode_s *)mem;
+
+  node->flink         = (FAR struct mm_tcnode_s *)tcache->tc_free[ndx];
+  tcache->tc_free[ndx] = node;
+  tcache->tc_count[ndx]++;
+  tcache->tc_bytes    += MM_TCACHE_CHUNK(ndx);
+}
+
+static inline FAR void *mm_tcache_pop(FAR struct mm_tcache_s *tcache,
+                                      int ndx)
+{
+  FAR struct mm_tcnode_s *node;
+
+  node = (FAR struct mm_tcnode_s *)tcache->tc_free[ndx];
+  tcache->tc_free[ndx] = node->flink;
+  tcache->tc_count[ndx]--;
+  tcache->tc_bytes    -= MM_TCACHE_CHUNK(ndx);
+  return node;
+}
+
+/****************************************************************************
+ * Name: mm_tcache_drain
+ *
+ * Description:
+ *   Return up to 'nchunks' chunks of one size class to the heap.
+ *
+ ****************************************************************************/
+
+static void mm_tcache_drain(FAR struct mm_tcache_s *tcache, int ndx,
+                            int nchunks)
+{
+  FAR struct mm_heap_s *heap = tcache->tc_heap;
+
+  mm_takesemaphore(heap);
+  while (nchunks-- > 0 && tcache->tc_count[ndx] > 0)
+    {
+      mm_free(heap, mm_tcache_pop(tcache, ndx));
+    }
+
+  mm_givesemaphore(heap);
+}
+
+/****************************************************************************
+ * Name: mm_tcache_count
+ *
+ * Description:
+ *   sched_foreach() callback that totals the cached bytes of one heap.
+ *
+ ****************************************************************************/
+
+static void mm_tcache_count(FAR struct tcb_s *tcb, FAR void *arg)
+{
+  FAR struct mm_tccount_s *count = (FAR struct mm_tccount_s *)arg;
+
+  if (tcb->tcache.tc_heap == count->heap)
+    {
+      count->bytes += tcb->tcache.tc_bytes;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tcache_malloc
+ *
+ * Description:
+ *   Try to satisfy a small allocation from the calling thread's cache.  If
+ *   the size class is empty, the cache is refilled with a batch of chunks
+ *   taken from the heap under a single acquisition of the heap semaphore.
+ *
+ * Returned Value:
+ *   The allocated memory; NULL if the request must be handled by the heap.
+ *
+ ****************************************************************************/
+
+FAR void *mm_tcache_malloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_allocnode_s *node;
+  FAR struct mm_tcache_s *tcache;
+  FAR void *mem;
+  int ndx;
+  int i;
+
+  if (size > CONFIG_MM_TCACHE_MAXSIZE || (tcache = mm_tcache(heap)) == NULL)
+    {
+      return NULL;
+    }
+
+  ndx = MM_TCACHE_CLASS(MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE));
+  if (tcache->tc_count[ndx] == 0)
+    {
+      /* Refill the size class.  mm_malloc() will not recurse into the cache
+       * because we hold the heap semaphore.  A chunk that the heap returns
+       * with a few extra bytes does not belong to the size class; it is
+       * not cached but is given to the caller.
+       */
+
+      mm_takesemaphore(heap);
+      for (i = 0; i < CONFIG_MM_TCACHE_BATCH; i++)
+        {
+          mem = mm_malloc(heap, MM_TCACHE_CHUNK(ndx) - SIZEOF_MM_ALLOCNODE);
+          if (mem == NULL)
+            {
+              break;
+            }
+
+          node = (FAR struct mm_allocnode_s *)
+            ((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+
+          if (node->size != MM_TCACHE_CHUNK(ndx))
+            {
+              mm_givesemaphore(heap);
+              return mem;
+            }
+
+          mm_tcache_push(tcache, ndx, mem);
+        }
+
+      mm_givesemaphore(heap);
+      if (tcache->tc_count[ndx] == 0)
+        {
+          return NULL;
+        }
+    }
+
+  return mm_tcache_pop(tcache, ndx);
+}
+
+/****************************************************************************
+ * Name: mm_tcache_free
+ *
+ * Description:
+ *   Try to keep a freed chunk in the calling thread's cache.  If the size
+ *   class is full, a batch of chunks is first returned to the heap under a
+ *   single acquisition of the heap semaphore.
+ *
+ * Returned Value:
+ *   true if the chunk was cached; false if it must be freed to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_tcache_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_allocnode_s *node;
+  FAR struct mm_tcache_s *tcache;
+  int ndx;
+
+  node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+  if (node->size > MM_TCACHE_CHUNK(MM_TCACHE_NCLASSES - 1))
+    {
+      return false;
+    }
+
+  tcache = mm_tcache(heap);
+  if (tcache == NULL)
+    {
+      return false;
+    }
+
+  /* Chunks trimmed by mm_memalign() are not necessarily a multiple of the
+   * granule size.  Such a chunk does not belong to any size class and is
+   * freed to the heap.
+   */
+
+  ndx = MM_TCACHE_CLASS(node->size);
+  if (node->size != MM_TCACHE_CHUNK(ndx))
+    {
+      return false;
+    }
+
+  if (tcache->tc_count[ndx] >= CONFIG_MM_TCACHE_DEPTH)
+    {
+      mm_tcache_drain(tcache, ndx, CONFIG_MM_TCACHE_BATCH);
+    }
+
+  mm_tcache_push(tcache, ndx, mem);
+  return true;
+}
+
+/****************************************************************************
+ * Name: mm_tcache_cached
+ *
+ * Description:
+ *   Return the total size of the chunks from the heap that are held in
+ *   the caches of all threads.  These chunks are allocated as far as the
+ *   heap is concerned but are available for allocation.
+ *
+ ****************************************************************************/
+
+size_t mm_tcache_cached(FAR struct mm_heap_s *heap)
+{
+  struct mm_tccount_s count;
+
+  count.heap  = heap;
+  count.bytes = 0;
+
+  sched_foreach(mm_tcache_count, &count);
+  return count.bytes;
+}
+
+/****************************************************************************
+ * Name: mm_tcache_release
+ *
+ * Description:
+ *   Return all chunks held in the cache of an exiting thread to the heap.
+ *   This may block on the heap semaphore and so must be called from
+ *   task_exithook() while a thread context is still available, never from
+ *   the non-blocking exit path.
+ *
+ ****************************************************************************/
+
+void mm_tcache_release(FAR struct tcb_s *tcb)
+{
+  FAR struct mm_tcache_s *tcache = &tcb->tcache;
+  int ndx;
+
+  if (tcache->tc_heap != NULL)
+    {
+      for (ndx = 0; ndx < MM_TCACHE_NCLASSES; ndx++)
+        {
+          mm_tcache_drain(tcache, ndx, CONFIG_MM_TCACHE_DEPTH);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: mm_tcache_take
+ *
+ * Description:
+ *   Remove one chunk from the cache of a thread without accessing the
+ *   heap.  This is used by sched_releasetcb() to hand any chunks that are
+ *   still cached when the TCB is released to the deferred deallocation
+ *   logic; the heap semaphore cannot be taken in that context.
+ *
+ * Returned Value:
+ *   A cached chunk; NULL if the cache is empty.
+ *
+ ****************************************************************************/
+
+FAR void *mm_tcache_take(FAR struct tcb_s *tcb)
+{
+  FAR struct mm_tcache_s *tcache = &tcb->tcache;
+  int ndx;
+
+  for (ndx = 0; ndx < MM_TCACHE_NCLASSES; ndx++)
+    {
+      if (tcache->tc_count[ndx] > 0)
+        {
+          return mm_tcache_pop(tcache, ndx);
+        }
+    }
+
+  return NULL;
+}
+
+#endif /* CONFIG_MM_TCACHE */
@@ -0,0 +1,295 @@
+/****************************************************************************
+ * mm/mm_heap/mm_tlsf.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_TLSF
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if CONFIG_MM_TLSF_SLI < 1 || CONFIG_MM_TLSF_SLI > 5
+#  error CONFIG_MM_TLSF_SLI must be in the range 1-5
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fls and mm_ffs
+ *
+ * Description:
+ *   Return the bit number of the most (fls) or least (ffs) significant bit
+ *   set in a non-zero word.
+ *
+ ****************************************************************************/
+
+static inline int mm_fls(uint32_t word)
+{
+#ifdef __GNUC__
+  return 31 - __builtin_clz(word);
+#else
+  int bit = 0;
+
+  while (word >>= 1)
+    {
+      bit++;
+    }
+
+  return bit;
+#endif
+}
+
+static inline int mm_ffs(uint32_t word)
+{
+#ifdef __GNUC__
+  return __builtin_ctz(word);
+#else
+  int bit = 0;
+
+  while ((word & 1) == 0)
+    {
+      word >>= 1;
+      bit++;
+    }
+
+  return bit;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_mapping
+ *
+ * Description:
+ *   Map a chunk size to its first and second level list indices.  Chunks
+ *   larger than the table covers all go into the very last list.
+ *
+ ****************************************************************************/
+
+static void mm_mapping(size_t size, FAR int *fl, FAR int *sl)
+{
+  int bit;
+
+  if (size < (1 << MM_TLSF_FLSHIFT))
+    {
+      *fl = 0;
+      *sl = (int)(size >> MM_MIN_SHIFT);
+    }
+  else
+    {
+      bit = mm_fls((uint32_t)size);
+      *fl = bit - MM_TLSF_FLSHIFT + 1;
+      *sl = (int)(size >> (bit - CONFIG_MM_TLSF_SLI)) ^ MM_TLSF_SLCOUNT;
+
+      if (*fl >= MM_TLSF_FLCOUNT)
+        {
+          *fl = MM_TLSF_FLCOUNT - 1;
+          *sl = MM_TLSF_SLCOUNT - 1;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: mm_firstfit
+ *
+ * Description:
+ *   Return the first chunk of at least 'size' bytes in one list.
+ *
+ ****************************************************************************/
+
+static FAR struct mm_freenode_s *mm_firstfit(FAR struct mm_freenode_s *node,
+                                             size_t size)
+{
+  while (node && node->size < size)
+    {
+      node = node->flink;
+    }
+
+  return node;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_addfreechunk
+ *
+ * Description:
+ *   Add a free chunk to the head of its segregated list.  It is assumed
+ *   that the caller holds the mm semaphore
+ *
+ ****************************************************************************/
+
+void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_freenode_s **head;
+  int fl;
+  int sl;
+
+  mm_mapping(node->size, &fl, &sl);
+  head = &heap->mm_freelist[fl][sl];
+
+  node->blink = NULL;
+  node->flink = *head;
+  if (*head)
+    {
+      (*head)->blink = node;
+    }
+
+  *head = node;
+
+  heap->mm_flbitmap     |= (1 << fl);
+  heap->mm_slbitmap[fl] |= (1 << sl);
+}
+
+/****************************************************************************
+ * Name: mm_delfreechunk
+ *
+ * Description:
+ *   Remove a free chunk from its segregated list.  The size of the chunk
+ *   must not have changed since it was added.
+ *
+ ****************************************************************************/
+
+void mm_delfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  int fl;
+  int sl;
+
+  mm_mapping(node->size, &fl, &sl);
+
+  if (node->flink)
+    {
+      node->flink->blink = node->blink;
+    }
+
+  if (node->blink)
+    {
+      node->blink->flink = node->flink;
+    }
+  else
+    {
+      DEBUGASSERT(heap->mm_freelist[fl][sl] == node);
+      heap->mm_freelist[fl][sl] = node->flink;
+
+      /* Clear the bitmaps if the list is now empty */
+
+      if (node->flink == NULL)
+        {
+          heap->mm_slbitmap[fl] &= ~(1 << sl);
+          if (heap->mm_slbitmap[fl] == 0)
+            {
+              heap->mm_flbitmap &= ~(1 << fl);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: mm_findfreechunk
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes.  The chunk is not removed
+ *   from its list.
+ *
+ *   The request is rounded up to the next list boundary so that every
+ *   chunk in the list selected by the bitmaps is large enough:  The search
+ *   takes constant time and never walks a list.  Only if that fails (or if
+ *   the chunk is in the unbounded last list) are the lists that may hold a
+ *   chunk of the exact size searched.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap,
+                                           size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  uint32_t map;
+  size_t rounded;
+  int fl;
+  int sl;
+
+  rounded = size;
+  if (size >= (1 << MM_TLSF_FLSHIFT))
+    {
+      rounded += (1 << (mm_fls((uint32_t)size) - CONFIG_MM_TLSF_SLI)) - 1;
+    }
+
+  mm_mapping(rounded, &fl, &sl);
+
+  /* Look for a non-empty list in the same row, then in the larger rows */
+
+  map = heap->mm_slbitmap[fl] & (~(uint32_t)0 << sl);
+  if (map == 0)
+    {
+      map = heap->mm_flbitmap & (~(uint32_t)0 << (fl + 1));
+      if (map != 0)
+        {
+          fl  = mm_ffs(map);
+          map = heap->mm_slbitmap[fl];
+        }
+    }
+
+  if (map != 0)
+    {
+      sl   = mm_ffs(map);
+      node = mm_firstfit(heap->mm_freelist[fl][sl], size);
+      if (node)
+        {
+          return node;
+        }
+    }
+
+  /* Nothing was found above the rounded size.  Try the list for the exact
+   * size:  It may still contain a large enough chunk.
+   */
+
+  mm_mapping(size, &fl, &sl);
+  return mm_firstfit(heap->mm_freelist[fl][sl], size);
+}
+
+#endif /* CONFIG_MM_TLSF */
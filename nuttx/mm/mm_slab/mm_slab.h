@@ -0,0 +1,134 @@
+/****************************************************************************
+ * mm/mm_slab/mm_slab.h
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __MM_MM_SLAB_MM_SLAB_H
+#define __MM_MM_SLAB_MM_SLAB_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <queue.h>
+
+#include <nuttx/mm/slab.h>
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_MM_SLAB_NOBJECTS
+#  define CONFIG_MM_SLAB_NOBJECTS 8
+#endif
+
+/* Every object is preceded by one header word and the size of each object
+ * is rounded up to a multiple of the header size so that all objects are
+ * pointer aligned.
+ */
+
+#define SIZEOF_SLAB_OBJHDR  sizeof(union slab_objhdr_u)
+#define SLAB_ALIGN_UP(n) \
+  (((n) + SIZEOF_SLAB_OBJHDR - 1) & ~(SIZEOF_SLAB_OBJHDR - 1))
+
+/* Convert between an object and its header */
+
+#define SLAB_OBJ2HDR(o)     ((FAR union slab_objhdr_u *)(o) - 1)
+#define SLAB_HDR2OBJ(h)     ((FAR void *)((FAR union slab_objhdr_u *)(h) + 1))
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct slab_s;
+
+/* The header word preceding each object.  While the object is allocated
+ * it points back to its slab so that slab_free() can find it; while it is
+ * free it links the object into the slab's free list.  The object itself
+ * is never written by the allocator, which preserves constructed state.
+ */
+
+union slab_objhdr_u
+{
+  FAR struct slab_s *slab;
+  FAR union slab_objhdr_u *next;
+};
+
+/* One slab:  this header followed by 'nobjects' objects */
+
+struct slab_s
+{
+  dq_entry_t link;                      /* Must be first: Cache slab lists */
+  FAR struct slab_cache_s *cache;       /* The cache this slab belongs to */
+  FAR union slab_objhdr_u *freelist;    /* Free objects in this slab */
+  uint16_t ninuse;                      /* Number of allocated objects */
+};
+
+/* One object cache.  Slabs with free objects are kept in 'partial', those
+ * with the most allocated objects first; slabs with no free objects are
+ * kept in 'full'.  At most one completely empty slab is retained.
+ */
+
+struct slab_cache_s
+{
+  sq_entry_t link;                      /* Must be first: g_slabcaches */
+  FAR const char *name;                 /* Name reported by procfs */
+  slab_ctor_t ctor;                     /* Optional object constructor */
+  size_t objsize;                       /* Requested object size */
+  size_t stride;                        /* Object size plus header, aligned */
+  uint16_t nobjects;                    /* Objects per slab */
+  uint16_t nslabs;                      /* Number of allocated slabs */
+  uint16_t nempty;                      /* Number of slabs with ninuse == 0 */
+  dq_queue_t partial;                   /* Slabs with free objects */
+  dq_queue_t full;                      /* Slabs with no free objects */
+  uint32_t ninuse;                      /* Statistics, see struct slab_info_s */
+  uint32_t npeak;
+  uint32_t nallocs;
+  uint32_t nfails;
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* All caches in order of creation */
+
+extern sq_queue_t g_slabcaches;
+
+#endif /* CONFIG_MM_SLAB */
+#endif /* __MM_MM_SLAB_MM_SLAB_H */
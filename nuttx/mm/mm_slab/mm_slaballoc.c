@@ -0,0 +1,190 @@
+/****************************************************************************
+ * mm/mm_slab/mm_slaballoc.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/slab.h>
+#include <arch/irq.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_grow
+ *
+ * Description:
+ *   Allocate a new slab from the kernel heap, construct its objects and
+ *   add it to the cache.  Must not be called from interrupt level.
+ *
+ ****************************************************************************/
+
+static FAR struct slab_s *slab_grow(FAR struct slab_cache_s *cache)
+{
+  FAR union slab_objhdr_u *hdr;
+  FAR struct slab_s *slab;
+  FAR uint8_t *objects;
+  irqstate_t flags;
+  int i;
+
+  slab = (FAR struct slab_s *)
+    kmm_malloc(sizeof(struct slab_s) + cache->nobjects * cache->stride);
+
+  if (!slab)
+    {
+      return NULL;
+    }
+
+  /* Link all of the objects into the slab's free list */
+
+  slab->cache    = cache;
+  slab->freelist = NULL;
+  slab->ninuse   = 0;
+
+  objects = (FAR uint8_t *)(slab + 1) + cache->nobjects * cache->stride;
+  for (i = 0; i < cache->nobjects; i++)
+    {
+      objects -= cache->stride;
+      hdr      = (FAR union slab_objhdr_u *)objects;
+
+      if (cache->ctor)
+        {
+          cache->ctor(SLAB_HDR2OBJ(hdr));
+        }
+
+      hdr->next      = slab->freelist;
+      slab->freelist = hdr;
+    }
+
+  /* Empty slabs go at the end of the partial list so that allocations are
+   * satisfied from slabs that are already in use.
+   */
+
+  flags = irqsave();
+  dq_addlast(&slab->link, &cache->partial);
+  cache->nslabs++;
+  cache->nempty++;
+  irqrestore(flags);
+
+  return slab;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_alloc
+ *
+ * Description:
+ *   Allocate one object from the cache.
+ *
+ * Returned Value:
+ *   The object, or NULL if none is available.
+ *
+ ****************************************************************************/
+
+FAR void *slab_alloc(FAR struct slab_cache_s *cache)
+{
+  FAR union slab_objhdr_u *hdr;
+  FAR struct slab_s *slab;
+  irqstate_t flags;
+
+  DEBUGASSERT(cache != NULL);
+
+  flags = irqsave();
+  slab  = (FAR struct slab_s *)cache->partial.head;
+
+  if (!slab && !up_interrupt_context())
+    {
+      /* The cache is exhausted.  Grow it with interrupts enabled. */
+
+      irqrestore(flags);
+      (void)slab_grow(cache);
+
+      /* Another thread may have taken objects in the meantime */
+
+      flags = irqsave();
+      slab  = (FAR struct slab_s *)cache->partial.head;
+    }
+
+  if (!slab)
+    {
+      cache->nfails++;
+      irqrestore(flags);
+      return NULL;
+    }
+
+  /* Take the first free object */
+
+  hdr            = slab->freelist;
+  slab->freelist = hdr->next;
+
+  if (slab->ninuse++ == 0)
+    {
+      cache->nempty--;
+    }
+
+  if (!slab->freelist)
+    {
+      dq_rem(&slab->link, &cache->partial);
+      dq_addlast(&slab->link, &cache->full);
+    }
+
+  if (++cache->ninuse > cache->npeak)
+    {
+      cache->npeak = cache->ninuse;
+    }
+
+  cache->nallocs++;
+  irqrestore(flags);
+
+  hdr->slab = slab;
+  return SLAB_HDR2OBJ(hdr);
+}
+
+#endif /* CONFIG_MM_SLAB */
@@ -0,0 +1,109 @@
+/****************************************************************************
+ * mm/mm_slab/mm_slabcreate.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/slab.h>
+#include <arch/irq.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* All caches in order of creation */
+
+sq_queue_t g_slabcaches;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_create
+ *
+ * Description:
+ *   Create a cache of objects of 'objsize' bytes.
+ *
+ * Input Parameters:
+ *   name     - Name reported by procfs.  The string is not copied.
+ *   objsize  - Size of each object in bytes
+ *   nobjects - Number of objects per slab
+ *   ctor     - Optional object constructor (may be NULL)
+ *
+ * Returned Value:
+ *   The new cache, or NULL if it could not be allocated.
+ *
+ ****************************************************************************/
+
+FAR struct slab_cache_s *slab_create(FAR const char *name, size_t objsize,
+                                     uint16_t nobjects, slab_ctor_t ctor)
+{
+  FAR struct slab_cache_s *cache;
+  irqstate_t flags;
+
+  DEBUGASSERT(name != NULL && objsize > 0);
+
+  cache = (FAR struct slab_cache_s *)kmm_zalloc(sizeof(struct slab_cache_s));
+  if (cache)
+    {
+      cache->name     = name;
+      cache->ctor     = ctor;
+      cache->objsize  = objsize;
+      cache->stride   = SIZEOF_SLAB_OBJHDR + SLAB_ALIGN_UP(objsize);
+      cache->nobjects = nobjects > 0 ? nobjects : CONFIG_MM_SLAB_NOBJECTS;
+
+      dq_init(&cache->partial);
+      dq_init(&cache->full);
+
+      flags = irqsave();
+      sq_addlast((FAR sq_entry_t *)cache, &g_slabcaches);
+      irqrestore(flags);
+    }
+
+  return cache;
+}
+
+#endif /* CONFIG_MM_SLAB */
@@ -0,0 +1,125 @@
+/****************************************************************************
+ * mm/mm_slab/mm_slabfree.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <assert.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/slab.h>
+#include <arch/irq.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_free
+ *
+ * Description:
+ *   Return an object to the cache it was allocated from.
+ *
+ ****************************************************************************/
+
+void slab_free(FAR struct slab_cache_s *cache, FAR void *obj)
+{
+  FAR union slab_objhdr_u *hdr;
+  FAR struct slab_s *slab;
+  irqstate_t flags;
+  bool release = false;
+
+  DEBUGASSERT(cache != NULL && obj != NULL);
+
+  hdr  = SLAB_OBJ2HDR(obj);
+  slab = hdr->slab;
+  DEBUGASSERT(slab->cache == cache && slab->ninuse > 0);
+
+  flags = irqsave();
+
+  /* A full slab becomes the fullest slab with a free object */
+
+  if (!slab->freelist)
+    {
+      dq_rem(&slab->link, &cache->full);
+      dq_addfirst(&slab->link, &cache->partial);
+    }
+
+  hdr->next      = slab->freelist;
+  slab->freelist = hdr;
+  cache->ninuse--;
+
+  if (--slab->ninuse == 0)
+    {
+      /* The slab is now empty.  Keep one empty slab to absorb alloc/free
+       * cycles; release any others to the heap.
+       */
+
+      dq_rem(&slab->link, &cache->partial);
+
+      if (cache->nempty > 0)
+        {
+          cache->nslabs--;
+          release = true;
+        }
+      else
+        {
+          dq_addlast(&slab->link, &cache->partial);
+          cache->nempty++;
+        }
+    }
+
+  irqrestore(flags);
+
+  /* Objects are freed from interrupt handlers and with interrupts disabled
+   * on the task exit path (e.g. by sig_cleanup()) where we may not wait for
+   * the heap semaphore.  sched_kfree() defers the deallocation if needed.
+   */
+
+  if (release)
+    {
+      sched_kfree(slab);
+    }
+}
+
+#endif /* CONFIG_MM_SLAB */
@@ -0,0 +1,109 @@
+/****************************************************************************
+ * mm/mm_slab/mm_slabinfo.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+
+#include <nuttx/mm/slab.h>
+#include <arch/irq.h>
+
+#include "mm_slab/mm_slab.h"
+
+#ifdef CONFIG_MM_SLAB
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: slab_info
+ *
+ * Description:
+ *   Return a snapshot of the state of the cache.
+ *
+ ****************************************************************************/
+
+void slab_info(FAR struct slab_cache_s *cache, FAR struct slab_info_s *info)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(cache != NULL && info != NULL);
+
+  flags = irqsave();
+  info->name    = cache->name;
+  info->objsize = cache->objsize;
+  info->nslabs  = cache->nslabs;
+  info->nobjs   = (uint32_t)cache->nslabs * cache->nobjects;
+  info->ninuse  = cache->ninuse;
+  info->npeak   = cache->npeak;
+  info->nallocs = cache->nallocs;
+  info->nfails  = cache->nfails;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: slab_foreach
+ *
+ * Description:
+ *   Call 'handler' for each cache in order of creation.  Caches are never
+ *   destroyed, so the list can be traversed without locking.
+ *
+ ****************************************************************************/
+
+int slab_foreach(slab_handler_t handler, FAR void *arg)
+{
+  FAR sq_entry_t *entry;
+  int ret;
+
+  DEBUGASSERT(handler != NULL);
+
+  for (entry = sq_peek(&g_slabcaches); entry; entry = sq_next(entry))
+    {
+      ret = handler((FAR struct slab_cache_s *)entry, arg);
+      if (ret != 0)
+        {
+          return ret;
+        }
+    }
+
+  return 0;
+}
+
+#endif /* CONFIG_MM_SLAB */
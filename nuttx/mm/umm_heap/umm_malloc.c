@@ -132,9 +132,13 @@ FAR void *malloc(size_t size)
     }
   while (mem == NULL);
 
+  MM_PROFILE_CALLER(USR_HEAP, mem);
   return mem;
 #else
-  return mm_malloc(USR_HEAP, size);
+  FAR void *mem = mm_malloc(USR_HEAP, size);
+
+  MM_PROFILE_CALLER(USR_HEAP, mem);
+  return mem;
 #endif
 }
 
@@ -89,7 +89,10 @@
 
 FAR void *memalign(size_t alignment, size_t size)
 {
-  return mm_memalign(USR_HEAP, alignment, size);
+  FAR void *mem = mm_memalign(USR_HEAP, alignment, size);
+
+  MM_PROFILE_CALLER(USR_HEAP, mem);
+  return mem;
 }
 
 #endif /* !CONFIG_BUILD_PROTECTED || !__KERNEL__ */
@@ -403,19 +403,11 @@ FAR struct arp_entry *arp_find(in_addr_t ipaddr);
  *   ipaddr - Refers to an IP address in network order
  *
  * Assumptions
- *   Interrupts are disabled to assure exclusive access to the ARP table
- *   (and because arp_find() is called).
+ *   Interrupts are disabled to assure exclusive access to the ARP table.
  *
  ****************************************************************************/
 
-#define arp_delete(ipaddr) \
-{ \
-  struct arp_entry *tabptr = arp_find(ipaddr); \
-  if (tabptr) \
-    { \
-      tabptr->at_ipaddr = 0; \
-    } \
-}
+void arp_delete(in_addr_t ipaddr);
 
 /****************************************************************************
  * Name: arp_update
@@ -48,6 +48,7 @@
 #include <sys/ioctl.h>
 #include <stdint.h>
 #include <string.h>
+#include <assert.h>
 #include <debug.h>
 
 #include <netinet/in.h>
@@ -66,10 +67,29 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* The ARP table is organized as a hash table with one bucket per table
+ * entry.  Entries are linked into the hash chains (or into the free list)
+ * by table index rather than by pointer to keep the links small.
+ */
+
+#define ARP_HASH_SIZE   CONFIG_NET_ARPTAB_SIZE
+
+#if CONFIG_NET_ARPTAB_SIZE < 255
+#  define ARP_NONE      0xff
+#else
+#  define ARP_NONE      0xffff
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#if CONFIG_NET_ARPTAB_SIZE < 255
+typedef uint8_t arpndx_t;
+#else
+typedef uint16_t arpndx_t;
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -79,10 +99,114 @@
 static struct arp_entry g_arptable[CONFIG_NET_ARPTAB_SIZE];
 static uint8_t g_arptime;
 
+/* The heads of the hash chains, the link to the next entry of each table
+ * entry, and the head of the list of unused table entries.
+ */
+
+static arpndx_t g_arphash[ARP_HASH_SIZE];
+static arpndx_t g_arplink[CONFIG_NET_ARPTAB_SIZE];
+static arpndx_t g_arpfree;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: arp_hash
+ *
+ * Description:
+ *   Return the hash chain for an IP address.  All four octets of the
+ *   address are folded into the hash so that the result does not depend
+ *   on the host byte order.
+ *
+ ****************************************************************************/
+
+static inline FAR arpndx_t *arp_hash(in_addr_t ipaddr)
+{
+  uint32_t hash = (uint32_t)ipaddr;
+
+  hash ^= hash >> 16;
+  hash ^= hash >> 8;
+  return &g_arphash[hash % ARP_HASH_SIZE];
+}
+
+/****************************************************************************
+ * Name: arp_unlink
+ *
+ * Description:
+ *   Remove the entry that follows the link 'plink' from its hash chain and
+ *   return it to the free list.
+ *
+ ****************************************************************************/
+
+static void arp_unlink(FAR arpndx_t *plink)
+{
+  arpndx_t ndx = *plink;
+
+  *plink         = g_arplink[ndx];
+  g_arplink[ndx] = g_arpfree;
+  g_arpfree      = ndx;
+
+  g_arptable[ndx].at_ipaddr = 0;
+}
+
+/****************************************************************************
+ * Name: arp_lookup
+ *
+ * Description:
+ *   Find the link that refers to the entry holding ipaddr.  Returns NULL
+ *   if there is no entry for ipaddr.
+ *
+ ****************************************************************************/
+
+static FAR arpndx_t *arp_lookup(in_addr_t ipaddr)
+{
+  FAR arpndx_t *plink;
+
+  for (plink = arp_hash(ipaddr);
+       *plink != ARP_NONE;
+       plink = &g_arplink[*plink])
+    {
+      if (net_ipaddr_cmp(ipaddr, g_arptable[*plink].at_ipaddr))
+        {
+          return plink;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: arp_evict
+ *
+ * Description:
+ *   The ARP table is full.  Throw away the oldest entry.
+ *
+ ****************************************************************************/
+
+static void arp_evict(void)
+{
+  FAR struct arp_entry *tabptr;
+  FAR arpndx_t *plink;
+  uint8_t tmpage = 0;
+  int i;
+  int j = 0;
+
+  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+    {
+      tabptr = &g_arptable[i];
+      if ((uint8_t)(g_arptime - tabptr->at_time) > tmpage)
+        {
+          tmpage = g_arptime - tabptr->at_time;
+          j = i;
+        }
+    }
+
+  plink = arp_lookup(g_arptable[j].at_ipaddr);
+  DEBUGASSERT(plink != NULL);
+  arp_unlink(plink);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -99,10 +223,20 @@ void arp_reset(void)
 {
   int i;
 
+  for (i = 0; i < ARP_HASH_SIZE; ++i)
+    {
+      g_arphash[i] = ARP_NONE;
+    }
+
+  /* Put all of the table entries in the free list */
+
   for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
     {
       memset(&g_arptable[i].at_ipaddr, 0, sizeof(in_addr_t));
+      g_arplink[i] = (i + 1 < CONFIG_NET_ARPTAB_SIZE) ? i + 1 : ARP_NONE;
     }
+
+  g_arpfree = 0;
 }
 
 /****************************************************************************
@@ -118,18 +252,27 @@ void arp_reset(void)
 
 void arp_timer(void)
 {
-  FAR struct arp_entry *tabptr;
+  FAR arpndx_t *plink;
   int i;
 
   ++g_arptime;
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
-    {
-      tabptr = &g_arptable[i];
 
-      if (tabptr->at_ipaddr != 0 &&
-          g_arptime - tabptr->at_time >= CONFIG_NET_ARP_MAXAGE)
+  /* Walk each hash chain, returning expired entries to the free list */
+
+  for (i = 0; i < ARP_HASH_SIZE; ++i)
+    {
+      plink = &g_arphash[i];
+      while (*plink != ARP_NONE)
         {
-          tabptr->at_ipaddr = 0;
+          if ((uint8_t)(g_arptime - g_arptable[*plink].at_time) >=
+              CONFIG_NET_ARP_MAXAGE)
+            {
+              arp_unlink(plink);
+            }
+          else
+            {
+              plink = &g_arplink[*plink];
+            }
         }
     }
 }
@@ -152,81 +295,53 @@ void arp_timer(void)
 
 void arp_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
 {
-  struct arp_entry *tabptr = NULL;
-  in_addr_t         ipaddr = net_ip4addr_conv32(pipaddr);
-  int               i;
+  FAR struct arp_entry *tabptr;
+  FAR arpndx_t         *plink;
+  in_addr_t             ipaddr = net_ip4addr_conv32(pipaddr);
+  arpndx_t              ndx;
 
-  /* Walk through the ARP mapping table and try to find an entry to
-   * update. If none is found, the IP -> MAC address mapping is
-   * inserted in the ARP table.
+  /* Try to find an existing entry to update.  If none is found, the
+   * IP -> MAC address mapping is inserted in the ARP table.
    */
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  plink = arp_lookup(ipaddr);
+  if (plink != NULL)
     {
-      tabptr = &g_arptable[i];
-
-      /* Only check those entries that are actually in use. */
+      /* An old entry found, update this and return. */
 
-      if (tabptr->at_ipaddr != 0)
-        {
-          /* Check if the source IP address of the incoming packet matches
-           * the IP address in this ARP table entry.
-           */
-
-          if (net_ipaddr_cmp(ipaddr, tabptr->at_ipaddr))
-            {
-              /* An old entry found, update this and return. */
-
-              memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
-              tabptr->at_time = g_arptime;
-              return;
-            }
-        }
-    }
-
-  /* If we get here, no existing ARP table entry was found, so we create one. */
-
-  /* First, we try to find an unused entry in the ARP table. */
-
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
-    {
-      tabptr = &g_arptable[i];
-      if (tabptr->at_ipaddr == 0)
-        {
-          break;
-        }
+      tabptr = &g_arptable[*plink];
+      memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
+      tabptr->at_time = g_arptime;
+      return;
     }
 
-  /* If no unused entry is found, we try to find the oldest entry and
-   * throw it away.
+  /* If we get here, no existing ARP table entry was found, so we create one.
+   * If there is no unused entry in the ARP table, we throw away the oldest
+   * entry.
    */
 
-  if (i == CONFIG_NET_ARPTAB_SIZE)
+  if (g_arpfree == ARP_NONE)
     {
-      uint8_t tmpage = 0;
-      int j = 0;
-
-      for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
-        {
-          tabptr = &g_arptable[i];
-          if (g_arptime - tabptr->at_time > tmpage)
-            {
-              tmpage = g_arptime - tabptr->at_time;
-              j = i;
-            }
-        }
-
-      i = j;
-      tabptr = &g_arptable[i];
+      arp_evict();
     }
 
-  /* Now, i is the ARP table entry which we will fill with the new
+  /* Take the entry at the head of the free list and fill it with the new
    * information.
    */
 
+  ndx       = g_arpfree;
+  g_arpfree = g_arplink[ndx];
+
+  tabptr = &g_arptable[ndx];
   tabptr->at_ipaddr = ipaddr;
   memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
   tabptr->at_time = g_arptime;
+
+  /* And add it to the head of its hash chain */
+
+  plink          = arp_hash(ipaddr);
+  g_arplink[ndx] = *plink;
+  *plink         = ndx;
 }
 
 /****************************************************************************
@@ -246,19 +361,33 @@ void arp_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
 
 FAR struct arp_entry *arp_find(in_addr_t ipaddr)
 {
-  FAR struct arp_entry *tabptr;
-  int i;
+  FAR arpndx_t *plink = arp_lookup(ipaddr);
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
+  return plink ? &g_arptable[*plink] : NULL;
+}
+
+/****************************************************************************
+ * Name: arp_delete
+ *
+ * Description:
+ *   Remove an IP association from the ARP table
+ *
+ * Input parameters:
+ *   ipaddr - Refers to an IP address in network order
+ *
+ * Assumptions
+ *   Interrupts are disabled to assure exclusive access to the ARP table.
+ *
+ ****************************************************************************/
+
+void arp_delete(in_addr_t ipaddr)
+{
+  FAR arpndx_t *plink = arp_lookup(ipaddr);
+
+  if (plink != NULL)
     {
-      tabptr = &g_arptable[i];
-      if (net_ipaddr_cmp(ipaddr, tabptr->at_ipaddr))
-        {
-          return tabptr;
-        }
+      arp_unlink(plink);
     }
-
-  return NULL;
 }
 
 #endif /* CONFIG_NET_ARP */
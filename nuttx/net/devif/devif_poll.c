@@ -40,10 +40,12 @@
 #include <nuttx/config.h>
 #ifdef CONFIG_NET
 
+#include <stdbool.h>
 #include <debug.h>
 
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
 
 #include "devif/devif.h"
 #include "arp/arp.h"
@@ -168,10 +170,41 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
   FAR struct udp_conn_s *conn = NULL;
   int bstop = 0;
 
+#ifdef CONFIG_NET_UDP_MMSG
+  int nbatch;
+  bool sent;
+#endif
+
   /* Traverse all of the allocated UDP connections and perform the poll action */
 
   while (!bstop && (conn = udp_nextconn(conn)))
     {
+#ifdef CONFIG_NET_UDP_MMSG
+      /* Keep polling the same connection while it produces datagrams (as
+       * when a sendmmsg() is in progress) and the driver can accept them.
+       */
+
+      nbatch = 0;
+      do
+        {
+          /* Perform the UDP TX poll */
+
+          udp_poll(dev, conn);
+          sent = (dev->d_len > 0);
+
+          /* Call back into the driver */
+
+          bstop = callback(dev);
+
+#ifdef CONFIG_NET_STATISTICS
+          if (sent && nbatch > 0)
+            {
+              g_netstats.udp.pollbatch++;
+            }
+#endif
+        }
+      while (!bstop && sent && ++nbatch < CONFIG_NET_UDP_POLLBATCH);
+#else
       /* Perform the UDP TX poll */
 
       udp_poll(dev, conn);
@@ -179,6 +212,7 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
       /* Call back into the driver */
 
       bstop = callback(dev);
+#endif
     }
 
   return bstop;
@@ -82,18 +82,23 @@
 
 void iob_concat(FAR struct iob_s *iob1, FAR struct iob_s *iob2)
 {
+  FAR struct iob_s *tail;
+
   /* Find the last buffer in the iob1 buffer chain */
- 
-  while (iob1->io_flink)
+
+  tail = iob1;
+  while (tail->io_flink)
     {
-      iob1 = iob1->io_flink;
+      tail = tail->io_flink;
     }
 
   /* Then connect iob2 buffer chain to the end of the iob1 chain */
 
-  iob1->io_flink = iob2;
+  tail->io_flink = iob2;
 
-  /* Combine the total packet size */
+  /* Combine the total packet size.  The packet length is only valid in the
+   * I/O buffer at the head of the chain.
+   */
 
   iob1->io_pktlen += iob2->io_pktlen;
 }
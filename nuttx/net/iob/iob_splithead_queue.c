@@ -0,0 +1,149 @@
+/****************************************************************************
+ * net/iob/iob_splithead_queue.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#if defined(CONFIG_DEBUG) && defined(CONFIG_IOB_DEBUG)
+/* Force debug output (from this file only) */
+
+#  undef  CONFIG_DEBUG_NET
+#  define CONFIG_DEBUG_NET 1
+#endif
+
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/net/iob.h>
+
+#include "iob.h"
+
+#if CONFIG_IOB_NCHAINS > 0
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef NULL
+#  define NULL ((FAR void *)0)
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_splithead_queue
+ *
+ * Description:
+ *   Remove up to 'len' bytes from the I/O buffer chain at the head of the
+ *   queue without copying any data.  Only whole I/O buffers are removed:
+ *   If the entire chain fits, it is removed from the queue just as with
+ *   iob_remove_queue().  Otherwise, the leading I/O buffers that fit are
+ *   unlinked and returned as a new chain and the remainder of the chain
+ *   stays at the head of the queue.
+ *
+ * Returned Value:
+ *   The detached I/O buffer chain is returned.  NULL is returned if the
+ *   queue is empty or if the first I/O buffer in the chain holds more than
+ *   'len' bytes.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_splithead_queue(FAR struct iob_queue_s *qhead,
+                                      unsigned int len)
+{
+  FAR struct iob_qentry_s *qentry;
+  FAR struct iob_s *head;
+  FAR struct iob_s *tail;
+  FAR struct iob_s *next;
+  unsigned int splitlen;
+
+  /* Peek at the I/O buffer chain container at the head of the queue */
+
+  qentry = qhead->qh_head;
+  if (qentry == NULL || qentry->qe_head == NULL)
+    {
+      return NULL;
+    }
+
+  /* If the whole chain fits, then just remove it from the queue */
+
+  head = qentry->qe_head;
+  if (head->io_pktlen <= len)
+    {
+      return iob_remove_queue(qhead);
+    }
+
+  /* Otherwise, find the last whole I/O buffer that still fits */
+
+  if (head->io_len > len)
+    {
+      return NULL;
+    }
+
+  tail     = head;
+  splitlen = head->io_len;
+
+  for (next = head->io_flink;
+       next != NULL && splitlen + next->io_len <= len;
+       next = next->io_flink)
+    {
+      splitlen += next->io_len;
+      tail      = next;
+    }
+
+  /* 'next' cannot be NULL here because the entire chain did not fit */
+
+  DEBUGASSERT(next != NULL);
+  nllvdbg("iob=%p len=%u splitlen=%u pktlen=%u\n",
+          head, len, splitlen, head->io_pktlen);
+
+  /* Unlink the leading I/O buffers and leave the remainder of the chain
+   * at the head of the queue.
+   */
+
+  next->io_pktlen = head->io_pktlen - splitlen;
+  qentry->qe_head = next;
+
+  tail->io_flink  = NULL;
+  head->io_pktlen = splitlen;
+  return head;
+}
+
+#endif /* CONFIG_IOB_NCHAINS > 0 */
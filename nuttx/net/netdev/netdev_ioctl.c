@@ -265,6 +265,9 @@ static int netdev_ifrioctl(FAR struct socket *psock, int cmd,
               ioctl_ifdown(dev);
               ioctl_setipaddr(&dev->d_ipaddr, &req->ifr_addr);
               ioctl_ifup(dev);
+#ifdef CONFIG_NET_ROUTE
+              net_routecache_flush();
+#endif
               ret = OK;
             }
         }
@@ -309,6 +312,9 @@ static int netdev_ifrioctl(FAR struct socket *psock, int cmd,
           if (dev)
             {
               ioctl_setipaddr(&dev->d_netmask, &req->ifr_addr);
+#ifdef CONFIG_NET_ROUTE
+              net_routecache_flush();
+#endif
               ret = OK;
             }
         }
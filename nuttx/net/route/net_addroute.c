@@ -61,6 +61,32 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Function: net_prefixlen
+ *
+ * Description:
+ *   Return the number of bits set in a network mask.
+ *
+ ****************************************************************************/
+
+static uint8_t net_prefixlen(FAR const net_ipaddr_t *netmask)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)netmask;
+  uint8_t prefixlen = 0;
+  uint8_t value;
+  int i;
+
+  for (i = 0; i < sizeof(net_ipaddr_t); i++)
+    {
+      for (value = ptr[i]; value; value &= value - 1)
+        {
+          prefixlen++;
+        }
+    }
+
+  return prefixlen;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -82,6 +108,8 @@ int net_addroute(net_ipaddr_t target, net_ipaddr_t netmask,
                  net_ipaddr_t router)
 {
   FAR struct net_route_s *route;
+  FAR struct net_route_s *prev;
+  FAR struct net_route_s *next;
   net_lock_t save;
 
   /* Allocate a route entry */
@@ -98,14 +126,35 @@ int net_addroute(net_ipaddr_t target, net_ipaddr_t netmask,
   net_ipaddr_copy(route->target, target);
   net_ipaddr_copy(route->netmask, netmask);
   net_ipaddr_copy(route->router, router);
+  route->prefixlen = net_prefixlen(&route->netmask);
 
   /* Get exclusive address to the networking data structures */
 
   save = net_lock();
 
-  /* Then add the new entry to the table */
+  /* Then add the new entry to the table.  The table is kept sorted by
+   * decreasing prefix length so that the first match found by a traversal
+   * of the table is the longest prefix match.  Routes with equal prefix
+   * lengths are kept in the order that they were added.
+   */
+
+  for (prev = NULL, next = (FAR struct net_route_s *)g_routes.head;
+       next && next->prefixlen >= route->prefixlen;
+       prev = next, next = next->flink);
+
+  if (prev)
+    {
+      sq_addafter((FAR sq_entry_t *)prev, (FAR sq_entry_t *)route,
+                  (FAR sq_queue_t *)&g_routes);
+    }
+  else
+    {
+      sq_addfirst((FAR sq_entry_t *)route, (FAR sq_queue_t *)&g_routes);
+    }
+
+  /* Any cached routing decision may now be stale */
 
-  sq_addlast((FAR sq_entry_t *)route, (FAR sq_queue_t *)&g_routes);
+  net_routecache_flush();
   net_unlock(save);
   return OK;
 }
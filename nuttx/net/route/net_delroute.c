@@ -146,7 +146,15 @@ int net_delroute(net_ipaddr_t target, net_ipaddr_t netmask)
 
   /* Then remove the entry from the routing table */
 
-  return net_foreachroute(net_match, &match) ? OK : -ENOENT;
+  if (!net_foreachroute(net_match, &match))
+    {
+      return -ENOENT;
+    }
+
+  /* Any cached routing decision may now be stale */
+
+  net_routecache_flush();
+  return OK;
 }
 
 #endif /* CONFIG_NET && CONFIG_NET_ROUTE  */
@@ -67,7 +67,8 @@
  * Parameters:
  *
  * Returned Value:
- *   0 if in use; 1 if avaialble and the new entry was added
+ *   The non-zero value returned by the handler that terminated the
+ *   traversal; zero if every entry was visited.
  *
  ****************************************************************************/
 
@@ -92,6 +93,13 @@ int net_foreachroute(route_handler_t handler, FAR void *arg)
 
       next = route->flink;
       ret = handler(route, arg);
+
+      /* A non-zero return value terminates the traversal */
+
+      if (ret != 0)
+        {
+          break;
+        }
     }
 
   /* Unlock uIP */
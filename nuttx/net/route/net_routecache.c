@@ -0,0 +1,207 @@
+/****************************************************************************
+ * net/route/net_routecache.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <nuttx/net/net.h>
+#include <nuttx/net/ip.h>
+
+#include "route/route.h"
+
+#if defined(CONFIG_NET) && defined(CONFIG_NET_ROUTE) && \
+    CONFIG_NET_ROUTE_CACHESIZE > 0
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One entry in the per-destination route cache */
+
+struct net_routecache_s
+{
+  FAR struct net_driver_s *dev;  /* Constraining device (NULL: any) */
+  net_ipaddr_t target;           /* The destination IP address */
+  net_ipaddr_t router;           /* The router selected for the target */
+  bool valid;                    /* True: The entry holds a valid route */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The route cache is direct mapped:  Each destination hashes to exactly one
+ * slot and a new destination simply replaces the previous occupant.
+ */
+
+static struct net_routecache_s g_routecache[CONFIG_NET_ROUTE_CACHESIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: net_routecache_hash
+ *
+ * Description:
+ *   Select the cache slot for a destination.  The device is not part of
+ *   the hash; it is only compared when the slot is examined.
+ *
+ ****************************************************************************/
+
+static FAR struct net_routecache_s *net_routecache_hash(net_ipaddr_t target)
+{
+  uint32_t hash;
+
+#ifdef CONFIG_NET_IPv6
+  FAR const uint16_t *ptr = (FAR const uint16_t *)target;
+  int i;
+
+  for (hash = 0, i = 0; i < 8; i++)
+    {
+      hash = (hash << 5) ^ (hash >> 27) ^ ptr[i];
+    }
+#else
+  hash = (uint32_t)target;
+#endif
+
+  hash ^= hash >> 16;
+  hash ^= hash >> 8;
+
+  return &g_routecache[hash % CONFIG_NET_ROUTE_CACHESIZE];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: net_routecache_lookup
+ *
+ * Description:
+ *   Look up the router address for a destination in the per-destination
+ *   route cache.
+ *
+ * Parameters:
+ *   dev    - The device the route is constrained to (NULL for any device)
+ *   target - The destination IP address
+ *   router - The location to return the cached router address
+ *
+ * Returned Value:
+ *   true if the destination was found in the cache; false otherwise.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+bool net_routecache_lookup(FAR struct net_driver_s *dev,
+                           net_ipaddr_t target, FAR net_ipaddr_t *router)
+{
+  FAR struct net_routecache_s *entry = net_routecache_hash(target);
+
+  if (entry->valid && entry->dev == dev &&
+      net_ipaddr_cmp(entry->target, target))
+    {
+      net_ipaddr_copy(*router, entry->router);
+      return true;
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Function: net_routecache_add
+ *
+ * Description:
+ *   Remember the result of a successful routing table lookup, replacing
+ *   whatever destination previously occupied the same cache slot.
+ *
+ * Parameters:
+ *   dev    - The device the route is constrained to (NULL for any device)
+ *   target - The destination IP address
+ *   router - The router address selected for the destination
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void net_routecache_add(FAR struct net_driver_s *dev, net_ipaddr_t target,
+                        FAR net_ipaddr_t *router)
+{
+  FAR struct net_routecache_s *entry = net_routecache_hash(target);
+
+  entry->dev = dev;
+  net_ipaddr_copy(entry->target, target);
+  net_ipaddr_copy(entry->router, *router);
+  entry->valid = true;
+}
+
+/****************************************************************************
+ * Function: net_routecache_flush
+ *
+ * Description:
+ *   Discard all cached routing decisions.  This must be called whenever
+ *   the routing table or the address configuration of a device changes.
+ *
+ * Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void net_routecache_flush(void)
+{
+  net_lock_t save;
+
+  save = net_lock();
+  memset(g_routecache, 0, sizeof(g_routecache));
+  net_unlock(save);
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_ROUTE && CONFIG_NET_ROUTE_CACHESIZE > 0 */
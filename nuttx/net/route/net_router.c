@@ -43,6 +43,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include <nuttx/net/net.h>
 #include <nuttx/net/ip.h>
 
 #include "route/route.h"
@@ -82,9 +83,9 @@ static int net_match(FAR struct net_route_s *route, FAR void *arg)
 {
   FAR struct route_match_s *match = (FAR struct route_match_s *)arg;
 
-  /* To match, the masked target addresses must be the same.  In the event
-   * of multiple matches, only the first is returned.  There not (yet) any
-   * concept for the precedence of networks.
+  /* To match, the masked target addresses must be the same.  The routing
+   * table is sorted by decreasing prefix length so the first match is the
+   * most specific route.
    */
 
   if (net_ipaddr_maskcmp(route->target, match->target, route->netmask))
@@ -129,8 +130,23 @@ int net_router(net_ipaddr_t target, FAR net_ipaddr_t *router)
 #endif
 {
   struct route_match_s match;
+  net_lock_t save;
   int ret;
 
+  save = net_lock();
+
+  /* Check first if we have recently routed a packet to this address */
+
+#ifdef CONFIG_NET_IPv6
+  if (net_routecache_lookup(NULL, target, (FAR net_ipaddr_t *)router))
+#else
+  if (net_routecache_lookup(NULL, target, router))
+#endif
+    {
+      net_unlock(save);
+      return OK;
+    }
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_match_s));
@@ -143,13 +159,16 @@ int net_router(net_ipaddr_t target, FAR net_ipaddr_t *router)
   ret = net_foreachroute(net_match, &match);
   if (ret > 0)
     {
-      /* We found a route.  Return the router address. */
+      /* We found a route.  Return the router address and remember the
+       * routing decision for the next packet to this destination.
+       */
 
 #ifdef CONFIG_NET_IPv6
-      net_ipaddr_copy(router, match.target);
+      net_ipaddr_copy(router, match.router);
 #else
-      net_ipaddr_copy(*router, match.target);
+      net_ipaddr_copy(*router, match.router);
 #endif
+      net_routecache_add(NULL, target, &match.router);
       ret = OK;
     }
   else
@@ -159,6 +178,7 @@ int net_router(net_ipaddr_t target, FAR net_ipaddr_t *router)
       ret = -ENOENT;
     }
 
+  net_unlock(save);
   return ret;
 }
 
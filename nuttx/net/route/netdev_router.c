@@ -43,6 +43,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/ip.h>
 
@@ -89,8 +90,8 @@ static int net_devmatch(FAR struct net_route_s *route, FAR void *arg)
   /* To match, (1) the masked target addresses must be the same, and (2) the
    * router address must like on the network provided by the device.
    *
-   * In the event of multiple matches, only the first is returned.  There
-   * not (yet) any concept for the precedence of networks.
+   * The routing table is sorted by decreasing prefix length so the first
+   * match is the most specific route.
    */
 
   if (net_ipaddr_maskcmp(route->target, match->target, route->netmask) &&
@@ -141,8 +142,23 @@ void netdev_router(FAR struct net_driver_s *dev, net_ipaddr_t target,
 #endif
 {
   struct route_devmatch_s match;
+  net_lock_t save;
   int ret;
 
+  save = net_lock();
+
+  /* Check first if we have recently routed a packet to this address */
+
+#ifdef CONFIG_NET_IPv6
+  if (net_routecache_lookup(dev, target, (FAR net_ipaddr_t *)router))
+#else
+  if (net_routecache_lookup(dev, target, router))
+#endif
+    {
+      net_unlock(save);
+      return;
+    }
+
   /* Set up the comparison structure */
 
   memset(&match, 0, sizeof(struct route_devmatch_s));
@@ -156,14 +172,18 @@ void netdev_router(FAR struct net_driver_s *dev, net_ipaddr_t target,
   ret = net_foreachroute(net_devmatch, &match);
   if (ret > 0)
     {
-      /* We found a route.  Return the router address. */
+      /* We found a route.  Return the router address and remember the
+       * routing decision for the next packet to this destination.  Only
+       * positive results are cached; the device's default router is
+       * cheap to return.
+       */
 
 #ifdef CONFIG_NET_IPv6
-      net_ipaddr_copy(router, match.target);
+      net_ipaddr_copy(router, match.router);
 #else
-      net_ipaddr_copy(*router, match.target);
+      net_ipaddr_copy(*router, match.router);
 #endif
-      ret = OK;
+      net_routecache_add(dev, target, &match.router);
     }
   else
     {
@@ -177,6 +197,8 @@ void netdev_router(FAR struct net_driver_s *dev, net_ipaddr_t target,
       net_ipaddr_copy(*router, dev->d_draddr);
 #endif
     }
+
+  net_unlock(save);
 }
 
 #endif /* CONFIG_NET && CONFIG_NET_ROUTE */
@@ -42,6 +42,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdbool.h>
 #include <queue.h>
 
 #include <net/if.h>
@@ -59,10 +60,17 @@
 #  define CONFIG_NET_MAXROUTES 4
 #endif
 
+#ifndef CONFIG_NET_ROUTE_CACHESIZE
+#  define CONFIG_NET_ROUTE_CACHESIZE 0
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
-/* This structure describes one entry in the routing table */
+/* This structure describes one entry in the routing table.  The routing
+ * table is kept sorted by decreasing prefix length so that the first entry
+ * that matches a destination is also the longest prefix match.
+ */
 
 struct net_route_s
 {
@@ -70,12 +78,15 @@ struct net_route_s
   net_ipaddr_t target;           /* The destination network */
   net_ipaddr_t netmask;          /* The network address mask */
   net_ipaddr_t router;           /* Route packets via this router */
+  uint8_t prefixlen;             /* Number of bits set in netmask */
 };
 
 /* Type of the call out function pointer provided to net_foreachroute() */
 
 typedef int (*route_handler_t)(FAR struct net_route_s *route, FAR void *arg);
 
+struct net_driver_s; /* Forward reference */
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -230,8 +241,6 @@ int net_router(net_ipaddr_t target, FAR net_ipaddr_t *router);
  *
  ****************************************************************************/
 
-struct net_driver_s;
-
 #ifdef CONFIG_NET_IPv6
 void netdev_router(FAR struct net_driver_s *dev, net_ipaddr_t target,
                    net_ipaddr_t router);
@@ -255,6 +264,81 @@ void netdev_router(FAR struct net_driver_s *dev, net_ipaddr_t target,
 
 int net_foreachroute(route_handler_t handler, FAR void *arg);
 
+/****************************************************************************
+ * Function: net_routecache_lookup
+ *
+ * Description:
+ *   Look up the router address for a destination in the per-destination
+ *   route cache.
+ *
+ * Parameters:
+ *   dev    - The device the route is constrained to (NULL for any device)
+ *   target - The destination IP address
+ *   router - The location to return the cached router address
+ *
+ * Returned Value:
+ *   true if the destination was found in the cache; false otherwise.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_ROUTE_CACHESIZE > 0
+bool net_routecache_lookup(FAR struct net_driver_s *dev,
+                           net_ipaddr_t target, FAR net_ipaddr_t *router);
+#else
+#  define net_routecache_lookup(d,t,r) (false)
+#endif
+
+/****************************************************************************
+ * Function: net_routecache_add
+ *
+ * Description:
+ *   Remember the result of a successful routing table lookup, replacing
+ *   whatever destination previously occupied the same cache slot.
+ *
+ * Parameters:
+ *   dev    - The device the route is constrained to (NULL for any device)
+ *   target - The destination IP address
+ *   router - The router address selected for the destination
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_ROUTE_CACHESIZE > 0
+void net_routecache_add(FAR struct net_driver_s *dev, net_ipaddr_t target,
+                        FAR net_ipaddr_t *router);
+#else
+#  define net_routecache_add(d,t,r)
+#endif
+
+/****************************************************************************
+ * Function: net_routecache_flush
+ *
+ * Description:
+ *   Discard all cached routing decisions.  This must be called whenever
+ *   the routing table or the address configuration of a device changes.
+ *
+ * Parameters:
+ *   None
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#if CONFIG_NET_ROUTE_CACHESIZE > 0
+void net_routecache_flush(void);
+#else
+#  define net_routecache_flush()
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -53,6 +53,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <assert.h>
 #include <debug.h>
 
 #include <arch/irq.h>
@@ -62,6 +63,9 @@
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/arp.h>
 #include <nuttx/net/tcp.h>
+#ifdef CONFIG_NET_SENDFILE_IOB
+#  include <nuttx/net/iob.h>
+#endif
 
 #include "netdev/netdev.h"
 #include "devif/devif.h"
@@ -79,6 +83,22 @@
 
 #define TCPBUF ((struct tcp_iphdr_s *)&dev->d_buf[NET_LL_HDRLEN])
 
+#ifdef CONFIG_NET_SENDFILE_IOB
+#  ifndef CONFIG_NET_SENDFILE_NIOBS
+#    define CONFIG_NET_SENDFILE_NIOBS 8
+#  endif
+
+/* The maximum number of file bytes staged in I/O buffers but not yet ACKed.
+ * This must fit in the 16-bit I/O buffer chain packet length.
+ */
+
+#  define SENDFILE_STAGESIZE (CONFIG_NET_SENDFILE_NIOBS * CONFIG_IOB_BUFSIZE)
+
+#  if SENDFILE_STAGESIZE > 65535
+#    error CONFIG_NET_SENDFILE_NIOBS * CONFIG_IOB_BUFSIZE is too large
+#  endif
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -102,6 +122,11 @@ struct sendfile_s
 #ifdef CONFIG_NET_SOCKOPTS
   uint32_t           snd_time;    /* Last send time for determining timeout */
 #endif
+#ifdef CONFIG_NET_SENDFILE_IOB
+  FAR struct iob_s  *snd_iob;     /* Staged file data that is not yet ACKed */
+  uint32_t           snd_iobbase; /* Offset of the first byte in snd_iob */
+  uint32_t           snd_staged;  /* Offset following the last staged byte */
+#endif
 };
 
 /****************************************************************************
@@ -148,6 +173,192 @@ static inline int sendfile_timeout(FAR struct sendfile_s *pstate)
 }
 #endif /* CONFIG_NET_SOCKOPTS */
 
+/****************************************************************************
+ * Function: sendfile_release
+ *
+ * Description:
+ *   Trim the ACKed data from the head of the staged I/O buffer chain,
+ *   freeing the I/O buffers that are no longer needed.
+ *
+ * Parameters:
+ *   pstate   send state structure
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_SENDFILE_IOB
+static void sendfile_release(FAR struct sendfile_s *pstate)
+{
+  uint32_t trimlen;
+
+  if (pstate->snd_iob != NULL && pstate->snd_acked > pstate->snd_iobbase)
+    {
+      trimlen = pstate->snd_acked - pstate->snd_iobbase;
+      if (trimlen >= pstate->snd_iob->io_pktlen)
+        {
+          /* Everything that was staged has been ACKed */
+
+          pstate->snd_iobbase += pstate->snd_iob->io_pktlen;
+          iob_free_chain(pstate->snd_iob);
+          pstate->snd_iob = NULL;
+        }
+      else
+        {
+          pstate->snd_iob      = iob_trimhead(pstate->snd_iob, trimlen);
+          pstate->snd_iobbase += trimlen;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Function: sendfile_stage
+ *
+ * Description:
+ *   Read more of the file straight into a new chain of I/O buffers and add
+ *   it to the staged data.  This runs on the sending thread so the network
+ *   poll logic never has to access the file.
+ *
+ * Parameters:
+ *   pstate   send state structure
+ *   save     The saved network lock state
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on a file read failure.
+ *
+ * Assumptions:
+ *   The network is locked on entry and exit, but the lock is released
+ *   while the file is being read.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_SENDFILE_IOB
+static int sendfile_stage(FAR struct sendfile_s *pstate, FAR net_lock_t *save)
+{
+  FAR struct iob_s *head = NULL;
+  FAR struct iob_s *tail = NULL;
+  FAR struct iob_s *iob;
+  uint32_t stagelen;
+  uint32_t remaining;
+  int errcode = OK;
+  int nread;
+
+  /* How much more can be staged?  Nothing more is read until at least one
+   * full I/O buffer has been ACKed.
+   */
+
+  stagelen = SENDFILE_STAGESIZE - (pstate->snd_staged - pstate->snd_iobbase);
+  if (pstate->snd_iob == NULL)
+    {
+      stagelen = SENDFILE_STAGESIZE;
+    }
+
+  remaining = pstate->snd_flen - pstate->snd_staged;
+  if (stagelen > remaining)
+    {
+      stagelen = remaining;
+    }
+
+  if (stagelen < CONFIG_IOB_BUFSIZE && stagelen < remaining)
+    {
+      return OK;
+    }
+
+  /* Read the file with the network unlocked */
+
+  net_unlock(*save);
+
+  remaining = stagelen;
+  stagelen  = 0;
+
+  while (remaining > 0)
+    {
+      iob = iob_alloc(false);
+      if (iob == NULL)
+        {
+          errcode = -ENOMEM;
+          break;
+        }
+
+      nread = file_read(pstate->snd_file, iob->io_data,
+                        remaining > CONFIG_IOB_BUFSIZE ?
+                        CONFIG_IOB_BUFSIZE : remaining);
+      if (nread <= 0)
+        {
+          /* Zero means that the end of the file was reached */
+
+          if (nread < 0)
+            {
+              errcode = -errno;
+              nlldbg("failed to read from input file: %d\n", errcode);
+            }
+
+          iob_free(iob);
+          break;
+        }
+
+      iob->io_len = nread;
+      if (head == NULL)
+        {
+          head = iob;
+        }
+      else
+        {
+          tail->io_flink = iob;
+        }
+
+      tail       = iob;
+      stagelen  += nread;
+      remaining -= nread;
+    }
+
+  *save = net_lock();
+
+  if (head != NULL)
+    {
+      head->io_pktlen = stagelen;
+
+      /* Add the new file data to the end of the staged I/O buffers */
+
+      if (pstate->snd_iob == NULL)
+        {
+          pstate->snd_iob     = head;
+          pstate->snd_iobbase = pstate->snd_staged;
+        }
+      else
+        {
+          iob_concat(pstate->snd_iob, head);
+        }
+
+      pstate->snd_staged += stagelen;
+    }
+
+  /* If the file was shorter than expected, then send what there is */
+
+  if (errcode == OK && remaining > 0)
+    {
+      nllvdbg("Short file: %d bytes\n", pstate->snd_staged);
+      pstate->snd_flen = pstate->snd_staged;
+    }
+
+  return errcode;
+}
+#endif
+
+/****************************************************************************
+ * Function: ack_interrupt
+ *
+ * Description:
+ *   Handle ACKs, retransmission requests, and loss of connection while the
+ *   file is being sent.
+ *
+ ****************************************************************************/
+
 static uint16_t ack_interrupt(FAR struct net_driver_s *dev, FAR void *pvconn,
                               FAR void *pvpriv, uint16_t flags)
 {
@@ -173,6 +384,12 @@ static uint16_t ack_interrupt(FAR struct net_driver_s *dev, FAR void *pvconn,
       nllvdbg("ACK: acked=%d sent=%d flen=%d\n",
              pstate->snd_acked, pstate->snd_sent, pstate->snd_flen);
 
+#ifdef CONFIG_NET_SENDFILE_IOB
+      /* Release the staged I/O buffers holding the ACKed data */
+
+      sendfile_release(pstate);
+#endif
+
       dev->d_sndlen = 0;
 
       flags &= ~TCP_ACKDATA;
@@ -264,6 +481,22 @@ static uint16_t sendfile_interrupt(FAR struct net_driver_s *dev, FAR void *pvcon
 
       uint32_t sndlen = pstate->snd_flen - pstate->snd_sent;
 
+#ifdef CONFIG_NET_SENDFILE_IOB
+      /* Only file data that has already been staged can be sent.  The
+       * sending thread will stage more data when it is awakened by the next
+       * ACK.
+       */
+
+      if (sndlen > pstate->snd_staged - pstate->snd_sent)
+        {
+          sndlen = pstate->snd_staged - pstate->snd_sent;
+          if (sndlen == 0)
+            {
+              goto wait;
+            }
+        }
+#endif
+
       if (sndlen > tcp_mss(conn))
         {
           sndlen = tcp_mss(conn);
@@ -279,6 +512,14 @@ static uint16_t sendfile_interrupt(FAR struct net_driver_s *dev, FAR void *pvcon
            * happen until the polling cycle completes).
            */
 
+#ifdef CONFIG_NET_SENDFILE_IOB
+          /* Copy the staged file data into the packet */
+
+          ret = iob_copyout(dev->d_snddata, pstate->snd_iob, sndlen,
+                            pstate->snd_sent - pstate->snd_iobbase);
+          DEBUGASSERT(ret == sndlen);
+          UNUSED(ret);
+#else
           ret = file_seek(pstate->snd_file,
                           pstate->snd_foffset + pstate->snd_sent, SEEK_SET);
           if (ret < 0)
@@ -297,6 +538,7 @@ static uint16_t sendfile_interrupt(FAR struct net_driver_s *dev, FAR void *pvcon
               pstate->snd_sent = -errcode;
               goto end_wait;
             }
+#endif
 
           dev->d_sndlen = sndlen;
 
@@ -461,7 +703,10 @@ ssize_t net_sendfile(int outfd, struct file *infile, off_t *offset,
   FAR struct tcp_conn_s *conn = (FAR struct tcp_conn_s*)psock->s_conn;
   struct sendfile_s state;
   net_lock_t save;
-  int err;
+#if defined(CONFIG_NET_SENDFILE_IOB) || defined(CONFIG_NET_ARP_SEND)
+  int ret;
+#endif
+  int err = OK;
 
   /* Verify that the sockfd corresponds to valid, allocated socket */
 
@@ -554,10 +799,32 @@ ssize_t net_sendfile(int outfd, struct file *infile, off_t *offset,
   state.snd_ackcb->priv  = (void*)&state;
   state.snd_ackcb->event = ack_interrupt;
 
+#ifdef CONFIG_NET_SENDFILE_IOB
+  /* The file is read sequentially from the starting offset */
+
+  if (file_seek(infile, state.snd_foffset, SEEK_SET) < 0)
+    {
+      state.snd_sent = -errno;
+      ndbg("ERROR: failed to lseek: %d\n", state.snd_sent);
+      goto errout_ackcb;
+    }
+#endif
+
   /* Perform the TCP send operation */
 
   do
     {
+#ifdef CONFIG_NET_SENDFILE_IOB
+      /* Read more of the file into I/O buffers if there is room */
+
+      ret = sendfile_stage(&state, &save);
+      if (ret < 0)
+        {
+          state.snd_sent = ret;
+          break;
+        }
+#endif
+
       state.snd_datacb->flags = TCP_POLL;
       state.snd_datacb->priv  = (void*)&state;
       state.snd_datacb->event = sendfile_interrupt;
@@ -570,12 +837,25 @@ ssize_t net_sendfile(int outfd, struct file *infile, off_t *offset,
     }
   while (state.snd_sent >= 0 && state.snd_acked < state.snd_flen);
 
+#ifdef CONFIG_NET_SENDFILE_IOB
+ errout_ackcb:
+#endif
+
   /* Set the socket state to idle */
 
   psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
 
   tcp_callback_free(conn, state.snd_ackcb);
 
+#ifdef CONFIG_NET_SENDFILE_IOB
+  /* Free any staged data that was never ACKed */
+
+  if (state.snd_iob != NULL)
+    {
+      iob_free_chain(state.snd_iob);
+    }
+#endif
+
  errout_datacb:
   tcp_callback_free(conn, state.snd_datacb);
 
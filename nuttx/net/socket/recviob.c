@@ -0,0 +1,394 @@
+/****************************************************************************
+ * net/socket/recviob.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP_RECVIOB)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <string.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/iob.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/tcp.h>
+
+#include "devif/devif.h"
+#include "tcp/tcp.h"
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure holds the state of a zero-copy receive while it waits for
+ * data to arrive from the interrupt level.
+ */
+
+struct recviob_s
+{
+  FAR struct socket *ri_sock;          /* The parent socket structure */
+  FAR struct devif_callback_s *ri_cb;  /* Reference to callback instance */
+#ifdef CONFIG_NET_SOCKOPTS
+  uint32_t           ri_starttime;     /* Start time for determining timeout */
+#endif
+  sem_t              ri_sem;           /* Signals data arrival or error */
+  int                ri_result;        /* Success:OK, failure:negated errno */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: recviob_interrupt
+ *
+ * Description:
+ *   Catch new TCP data while a zero-copy receive is waiting.  The data is
+ *   placed in the read-ahead queue where the waiting thread will take it
+ *   without copying it again.
+ *
+ * Parameters:
+ *   dev      The structure of the network driver that caused the interrupt
+ *   conn     The connection structure associated with the socket
+ *   pvpriv   The recviob state structure
+ *   flags    Set of events describing why the callback was invoked
+ *
+ * Returned Value:
+ *   The modified event flags
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static uint16_t recviob_interrupt(FAR struct net_driver_s *dev,
+                                  FAR void *pvconn, FAR void *pvpriv,
+                                  uint16_t flags)
+{
+  FAR struct tcp_conn_s *conn = (FAR struct tcp_conn_s *)pvconn;
+  FAR struct recviob_s *pstate = (FAR struct recviob_s *)pvpriv;
+
+  nllvdbg("flags: %04x\n", flags);
+
+  if (pstate == NULL)
+    {
+      return flags;
+    }
+
+  if ((flags & TCP_NEWDATA) != 0)
+    {
+      /* Zero length TCP_NEWDATA events just cause an ACK.  Leave those
+       * to the default handling.
+       */
+
+      if (dev->d_len == 0)
+        {
+          return flags;
+        }
+
+      /* Save the packet in the read-ahead queue.  If that fails, leave
+       * TCP_NEWDATA set so that the packet is dropped without an ACK and
+       * will be retransmitted by the peer.
+       */
+
+      if (tcp_datahandler(conn, dev->d_appdata, dev->d_len) < dev->d_len)
+        {
+          return flags;
+        }
+
+      /* The data has been consumed and should be ACKed */
+
+      dev->d_len = 0;
+      flags      = (flags & ~TCP_NEWDATA) | TCP_SNDACK;
+      pstate->ri_result = OK;
+    }
+
+  /* Check for a loss of connection */
+
+  else if ((flags & (TCP_CLOSE | TCP_ABORT | TCP_TIMEDOUT)) != 0)
+    {
+      nllvdbg("Lost connection\n");
+
+      net_lostconnection(pstate->ri_sock, flags);
+
+      /* A graceful close is reported as end-of-file (zero) */
+
+      pstate->ri_result = (flags & TCP_CLOSE) != 0 ? OK : -ENOTCONN;
+    }
+
+#ifdef CONFIG_NET_SOCKOPTS
+  /* Otherwise, this is probably a poll.  Check for a timeout. */
+
+  else if (pstate->ri_sock->s_rcvtimeo != 0 &&
+           net_timeo(pstate->ri_starttime, pstate->ri_sock->s_rcvtimeo))
+    {
+      nllvdbg("TCP timeout\n");
+      pstate->ri_result = -EAGAIN;
+    }
+#endif
+
+  else
+    {
+      return flags;
+    }
+
+  /* Do not allow any further callbacks and wake up the waiting thread */
+
+  pstate->ri_cb->flags = 0;
+  pstate->ri_cb->priv  = NULL;
+  pstate->ri_cb->event = NULL;
+
+  sem_post(&pstate->ri_sem);
+  return flags;
+}
+
+/****************************************************************************
+ * Function: recviob_wait
+ *
+ * Description:
+ *   Wait until new data has been placed in the read-ahead queue or until
+ *   the connection is lost or the receive times out.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+static int recviob_wait(FAR struct socket *psock,
+                        FAR struct tcp_conn_s *conn)
+{
+  struct recviob_s state;
+  int ret;
+
+  memset(&state, 0, sizeof(struct recviob_s));
+  (void)sem_init(&state.ri_sem, 0, 0); /* Doesn't really fail */
+  state.ri_sock      = psock;
+  state.ri_result    = -EAGAIN;
+#ifdef CONFIG_NET_SOCKOPTS
+  state.ri_starttime = clock_systimer();
+#endif
+
+  /* Set up the callback in the connection */
+
+  state.ri_cb = tcp_callback_alloc(conn);
+  if (state.ri_cb == NULL)
+    {
+      sem_destroy(&state.ri_sem);
+      return -EBUSY;
+    }
+
+  state.ri_cb->flags = (TCP_NEWDATA | TCP_POLL | TCP_CLOSE | TCP_ABORT |
+                        TCP_TIMEDOUT);
+  state.ri_cb->priv  = (FAR void *)&state;
+  state.ri_cb->event = recviob_interrupt;
+
+  /* Wait for the data, an error, or a timeout.  net_lockedwait() will also
+   * terminate if a signal is received.
+   */
+
+  ret = net_lockedwait(&state.ri_sem);
+  ret = (ret < 0) ? -errno : state.ri_result;
+
+  tcp_callback_free(conn, state.ri_cb);
+  sem_destroy(&state.ri_sem);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_recviob
+ *
+ * Description:
+ *   Receive TCP data by loaning the read-ahead I/O buffer chains directly
+ *   to the caller instead of copying them into a user buffer.  On success,
+ *   '*iobp' refers to a chain of I/O buffers holding the received data.
+ *   The chain belongs to the caller until it is returned with
+ *   recviob_release().
+ *
+ *   Only whole I/O buffers are loaned so less than 'len' bytes may be
+ *   returned even when more data is buffered.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   iobp     Location to return the loaned I/O buffer chain
+ *   len      Maximum number of bytes to receive.  Must be at least
+ *            CONFIG_IOB_BUFSIZE.
+ *   flags    Receive flags (none are supported)
+ *
+ * Returned Value:
+ *   On success, returns the number of bytes in the loaned I/O buffer chain.
+ *   Zero is returned (with '*iobp' set to NULL) if the peer has performed
+ *   an orderly shutdown.  On errors, -1 is returned, and errno is set
+ *   appropriately (see recvfrom()).
+ *
+ ****************************************************************************/
+
+ssize_t psock_recviob(FAR struct socket *psock, FAR struct iob_s **iobp,
+                      size_t len, int flags)
+{
+  FAR struct tcp_conn_s *conn;
+  FAR struct iob_s *iob;
+  net_lock_t save;
+  ssize_t ret;
+  int err;
+
+  /* Verify that the sockfd corresponds to valid, allocated TCP socket */
+
+  if (!psock || psock->s_crefs <= 0)
+    {
+      err = EBADF;
+      goto errout;
+    }
+
+  if (psock->s_type != SOCK_STREAM)
+    {
+      err = EOPNOTSUPP;
+      goto errout;
+    }
+
+  if (iobp == NULL || len < CONFIG_IOB_BUFSIZE)
+    {
+      err = EINVAL;
+      goto errout;
+    }
+
+  *iobp = NULL;
+  conn  = (FAR struct tcp_conn_s *)psock->s_conn;
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_RECV);
+  save = net_lock();
+
+  for (; ; )
+    {
+      /* Loan whatever is at the head of the read-ahead queue.  NOTE that
+       * there may be read-ahead data to be retrieved even after the socket
+       * has been disconnected.
+       */
+
+      iob = iob_splithead_queue(&conn->readahead, len);
+      if (iob != NULL)
+        {
+          nllvdbg("Loaned %d bytes\n", iob->io_pktlen);
+
+          *iobp = iob;
+          ret   = iob->io_pktlen;
+          break;
+        }
+
+      /* Nothing is buffered.  Report end-of-file if the peer closed the
+       * connection gracefully or an error if the connection was lost.
+       */
+
+      if (!_SS_ISCONNECTED(psock->s_flags))
+        {
+          ret = _SS_ISCLOSED(psock->s_flags) ? 0 : -ENOTCONN;
+          break;
+        }
+
+      if (_SS_ISNONBLOCK(psock->s_flags))
+        {
+          ret = -EAGAIN;
+          break;
+        }
+
+      /* Wait for new data to be added to the read-ahead queue */
+
+      ret = recviob_wait(psock, conn);
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  net_unlock(save);
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+
+  if (ret < 0)
+    {
+      err = -ret;
+      goto errout;
+    }
+
+  return ret;
+
+errout:
+  set_errno(err);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Function: recviob
+ *
+ * Description:
+ *   Zero-copy receive on the TCP socket referred to by a socket descriptor.
+ *   See psock_recviob().
+ *
+ ****************************************************************************/
+
+ssize_t recviob(int sockfd, FAR struct iob_s **iobp, size_t len, int flags)
+{
+  return psock_recviob(sockfd_socket(sockfd), iobp, len, flags);
+}
+
+/****************************************************************************
+ * Function: recviob_release
+ *
+ * Description:
+ *   Return an I/O buffer chain loaned by psock_recviob() or recviob().
+ *
+ ****************************************************************************/
+
+void recviob_release(FAR struct iob_s *iob)
+{
+  if (iob != NULL)
+    {
+      iob_free_chain(iob);
+    }
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP_RECVIOB */
@@ -0,0 +1,450 @@
+/****************************************************************************
+ * net/socket/recvmmsg.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_UDP_MMSG)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/clock.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
+#include <nuttx/net/ip.h>
+#include <nuttx/net/udp.h>
+
+#include "netdev/netdev.h"
+#include "devif/devif.h"
+#include "udp/udp.h"
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define UDPBUF ((struct udp_iphdr_s *)&dev->d_buf[NET_LL_HDRLEN])
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct recvmmsg_s
+{
+  FAR struct devif_callback_s *rm_cb; /* Reference to callback instance */
+  sem_t rm_sem;                       /* Semaphore signals recvmmsg completion */
+  FAR struct mmsghdr *rm_msgvec;      /* The vector of datagram buffers */
+  unsigned int rm_vlen;               /* Number of entries in rm_msgvec */
+  unsigned int rm_nrecv;              /* Number of datagrams received */
+  uint32_t rm_starttime;              /* Start time for determining timeout */
+  uint32_t rm_timeout;                /* Timeout in clock ticks (0: none) */
+  int rm_flags;                       /* Receive flags */
+  int rm_result;                      /* Negated errno on failure */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: recvmmsg_newdata
+ *
+ * Description:
+ *   Scatter the new datagram into the next message buffer and record the
+ *   sender's address.
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static void recvmmsg_newdata(FAR struct net_driver_s *dev,
+                             FAR struct mmsghdr *mmsg)
+{
+  FAR struct msghdr *msg = &mmsg->msg_hdr;
+  FAR uint8_t *src = dev->d_appdata;
+  size_t remaining = dev->d_len;
+  size_t ncopy;
+  int i;
+
+  /* Scatter the datagram into the I/O vector */
+
+  for (i = 0; i < msg->msg_iovlen && remaining > 0; i++)
+    {
+      ncopy = msg->msg_iov[i].iov_len;
+      if (ncopy > remaining)
+        {
+          ncopy = remaining;
+        }
+
+      memcpy(msg->msg_iov[i].iov_base, src, ncopy);
+      src       += ncopy;
+      remaining -= ncopy;
+    }
+
+  mmsg->msg_len  = dev->d_len - remaining;
+  msg->msg_flags = (remaining > 0) ? MSG_TRUNC : 0;
+
+  /* Save the sender's address */
+
+  if (msg->msg_name != NULL)
+    {
+#ifdef CONFIG_NET_IPv6
+      FAR struct sockaddr_in6 *infrom =
+        (FAR struct sockaddr_in6 *)msg->msg_name;
+
+      if (msg->msg_namelen >= sizeof(struct sockaddr_in6))
+        {
+          infrom->sin_family = AF_INET6;
+          infrom->sin_port   = UDPBUF->srcport;
+          net_ipaddr_copy(infrom->sin6_addr.s6_addr, UDPBUF->srcipaddr);
+          msg->msg_namelen   = sizeof(struct sockaddr_in6);
+        }
+#else
+      FAR struct sockaddr_in *infrom =
+        (FAR struct sockaddr_in *)msg->msg_name;
+
+      if (msg->msg_namelen >= sizeof(struct sockaddr_in))
+        {
+          infrom->sin_family = AF_INET;
+          infrom->sin_port   = UDPBUF->srcport;
+          net_ipaddr_copy(infrom->sin_addr.s_addr,
+                          net_ip4addr_conv32(UDPBUF->srcipaddr));
+          msg->msg_namelen   = sizeof(struct sockaddr_in);
+        }
+#endif
+    }
+
+  /* Indicate no data in the buffer */
+
+  dev->d_len = 0;
+}
+
+/****************************************************************************
+ * Function: recvmmsg_interrupt
+ *
+ * Description:
+ *   This function is called from the interrupt level to receive datagrams.
+ *   The callback stays armed so that back-to-back datagrams are all caught
+ *   by the same receive operation.
+ *
+ * Parameters:
+ *   dev      The structure of the network driver that caused the interrupt
+ *   conn     The connection structure associated with the socket
+ *   pvpriv   An instance of struct recvmmsg_s cast to void*
+ *   flags    Set of events describing why the callback was invoked
+ *
+ * Returned Value:
+ *   Modified value of the input flags
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static uint16_t recvmmsg_interrupt(FAR struct net_driver_s *dev,
+                                   FAR void *pvconn, FAR void *pvpriv,
+                                   uint16_t flags)
+{
+  FAR struct recvmmsg_s *pstate = (FAR struct recvmmsg_s *)pvpriv;
+
+  nllvdbg("flags: %04x\n", flags);
+
+  if (pstate == NULL)
+    {
+      return flags;
+    }
+
+  if ((flags & UDP_NEWDATA) != 0)
+    {
+      /* Copy the datagram into the next message buffer */
+
+      recvmmsg_newdata(dev, &pstate->rm_msgvec[pstate->rm_nrecv]);
+      pstate->rm_nrecv++;
+
+      /* Indicate that the data has been consumed */
+
+      flags &= ~UDP_NEWDATA;
+
+      /* Keep going until the message vector is full */
+
+      if (pstate->rm_nrecv < pstate->rm_vlen)
+        {
+          return flags;
+        }
+    }
+
+  /* With MSG_WAITFORONE, return what has been received at the next poll */
+
+  else if ((pstate->rm_flags & MSG_WAITFORONE) != 0 && pstate->rm_nrecv > 0)
+    {
+      nllvdbg("UDP batch: %d\n", pstate->rm_nrecv);
+    }
+
+  /* Check for a timeout.  If some datagrams were received, they are
+   * returned without an error.
+   */
+
+  else if (pstate->rm_timeout != 0 &&
+           clock_systimer() - pstate->rm_starttime >= pstate->rm_timeout)
+    {
+      nllvdbg("UDP timeout\n");
+
+      if (pstate->rm_nrecv == 0)
+        {
+          pstate->rm_result = -EAGAIN;
+        }
+    }
+  else
+    {
+      return flags;
+    }
+
+  /* Don't allow any further UDP call backs. */
+
+  pstate->rm_cb->flags = 0;
+  pstate->rm_cb->priv  = NULL;
+  pstate->rm_cb->event = NULL;
+
+  /* Wake up the waiting thread */
+
+  sem_post(&pstate->rm_sem);
+  return flags;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_recvmmsg
+ *
+ * Description:
+ *   Receive several datagrams from a UDP socket in a single operation.
+ *   Datagrams are received until 'vlen' datagrams have been received or
+ *   until the timeout expires.  With MSG_WAITFORONE, the operation also
+ *   completes at the first driver poll after any datagram was received.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msgvec   The array of datagram buffers.  On return, the msg_len field of
+ *            each received datagram holds its length and msg_flags has
+ *            MSG_TRUNC set if the datagram did not fit.
+ *   vlen     The number of entries in msgvec
+ *   flags    Receive flags (MSG_WAITFORONE)
+ *   timeout  The maximum time to wait.  If NULL, the SO_RCVTIMEO value is
+ *            used.
+ *
+ * Returned Value:
+ *   On success, the number of datagrams received.  On errors, -1 is
+ *   returned and errno is set as for recvfrom().
+ *
+ ****************************************************************************/
+
+int psock_recvmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags,
+                   FAR struct timespec *timeout)
+{
+  FAR struct udp_conn_s *conn;
+  struct recvmmsg_s state;
+  net_lock_t save;
+  unsigned int i;
+  int err;
+
+  /* Verify that the psock corresponds to valid, allocated UDP socket */
+
+  if (!psock || psock->s_crefs <= 0)
+    {
+      err = EBADF;
+      goto errout;
+    }
+
+  if (psock->s_type != SOCK_DGRAM)
+    {
+      err = EOPNOTSUPP;
+      goto errout;
+    }
+
+  if (msgvec == NULL || vlen == 0)
+    {
+      err = EINVAL;
+      goto errout;
+    }
+
+  for (i = 0; i < vlen; i++)
+    {
+      if (msgvec[i].msg_hdr.msg_iovlen < 0 ||
+          (msgvec[i].msg_hdr.msg_iovlen > 0 &&
+           msgvec[i].msg_hdr.msg_iov == NULL))
+        {
+          err = EINVAL;
+          goto errout;
+        }
+
+      msgvec[i].msg_len = 0;
+    }
+
+  /* Set the socket state to receiving */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_RECV);
+
+  /* Initialize the state structure.  This is done with the network locked
+   * because we don't want anything to happen until we are ready.
+   */
+
+  save = net_lock();
+  memset(&state, 0, sizeof(struct recvmmsg_s));
+  (void)sem_init(&state.rm_sem, 0, 0); /* Doesn't really fail */
+  state.rm_msgvec    = msgvec;
+  state.rm_vlen      = vlen;
+  state.rm_flags     = flags;
+  state.rm_starttime = clock_systimer();
+
+  if (timeout != NULL)
+    {
+      state.rm_timeout = MSEC2TICK(timeout->tv_sec * MSEC_PER_SEC +
+                                   timeout->tv_nsec / NSEC_PER_MSEC);
+      if (state.rm_timeout == 0 &&
+          (timeout->tv_sec != 0 || timeout->tv_nsec != 0))
+        {
+          state.rm_timeout = 1;
+        }
+    }
+#ifdef CONFIG_NET_SOCKOPTS
+  else
+    {
+      state.rm_timeout = DSEC2TICK(psock->s_rcvtimeo);
+    }
+#endif
+
+  /* Setup the UDP remote connection to accept datagrams from any peer */
+
+  conn = (FAR struct udp_conn_s *)psock->s_conn;
+  (void)udp_connect(conn, NULL);
+
+  /* Set up the callback in the connection */
+
+  state.rm_cb = udp_callback_alloc(conn);
+  if (state.rm_cb)
+    {
+      state.rm_cb->flags = (UDP_NEWDATA | UDP_POLL);
+      state.rm_cb->priv  = (FAR void *)&state;
+      state.rm_cb->event = recvmmsg_interrupt;
+
+      /* Notify the device driver of the receive call */
+
+      netdev_rxnotify(conn->ripaddr);
+
+      /* Wait for the datagrams or for an error/timeout to occur.
+       * net_lockedwait will also terminate if a signal is received.
+       */
+
+      if (net_lockedwait(&state.rm_sem) < 0 && state.rm_nrecv == 0)
+        {
+          state.rm_result = -errno;
+        }
+
+      /* Make sure that no further interrupts are processed */
+
+      udp_callback_free(conn, state.rm_cb);
+    }
+  else
+    {
+      state.rm_result = -EBUSY;
+    }
+
+#ifdef CONFIG_NET_STATISTICS
+  if (state.rm_nrecv > 0)
+    {
+      g_netstats.udp.rcvbatch++;
+      g_netstats.udp.rcvmsgs += state.rm_nrecv;
+    }
+#endif
+
+  net_unlock(save);
+  sem_destroy(&state.rm_sem);
+
+  /* Set the socket state to idle */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+
+  if (state.rm_result < 0)
+    {
+      err = -state.rm_result;
+      goto errout;
+    }
+
+  return state.rm_nrecv;
+
+errout:
+  set_errno(err);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Function: recvmmsg
+ *
+ * Description:
+ *   Receive several datagrams from a UDP socket in a single call.  See
+ *   psock_recvmmsg().
+ *
+ ****************************************************************************/
+
+int recvmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags, FAR struct timespec *timeout)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* And let psock_recvmmsg do all of the work */
+
+  return psock_recvmmsg(psock, msgvec, vlen, flags, timeout);
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_UDP_MMSG */
@@ -0,0 +1,495 @@
+/****************************************************************************
+ * net/socket/sendmmsg.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_UDP_MMSG)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/clock.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/net/netstats.h>
+#include <nuttx/net/udp.h>
+
+#include "netdev/netdev.h"
+#include "devif/devif.h"
+#include "arp/arp.h"
+#include "udp/udp.h"
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NET_SOCKOPTS
+#  undef CONFIG_NET_SENDTO_TIMEOUT
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct sendmmsg_s
+{
+#ifdef CONFIG_NET_SENDTO_TIMEOUT
+  FAR struct socket *sm_sock;         /* Points to the parent socket structure */
+  uint32_t sm_time;                   /* Last send time for determining timeout */
+#endif
+  FAR struct devif_callback_s *sm_cb; /* Reference to callback instance */
+  sem_t sm_sem;                       /* Semaphore signals sendmmsg completion */
+  FAR struct mmsghdr *sm_msgvec;      /* The vector of datagrams to send */
+  unsigned int sm_vlen;               /* Number of datagrams in sm_msgvec */
+  unsigned int sm_nsent;              /* Number of datagrams sent so far */
+  int sm_result;                      /* Negated errno on failure */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: sendmmsg_msglen
+ *
+ * Description:
+ *   Return the total length of the data described by the message I/O
+ *   vector or a negated errno value if the vector is not valid.
+ *
+ ****************************************************************************/
+
+static ssize_t sendmmsg_msglen(FAR const struct msghdr *msg)
+{
+  size_t msglen = 0;
+  int i;
+
+  if (msg->msg_iovlen < 0 || (msg->msg_iovlen > 0 && msg->msg_iov == NULL))
+    {
+      return -EINVAL;
+    }
+
+  /* The datagram must fit into a single packet.  Check each vector
+   * element before adding it so that the sum cannot wrap around.
+   */
+
+  for (i = 0; i < msg->msg_iovlen; i++)
+    {
+      if (msg->msg_iov[i].iov_len > UDP_MSS - msglen)
+        {
+          return -EMSGSIZE;
+        }
+
+      msglen += msg->msg_iov[i].iov_len;
+    }
+
+  return msglen;
+}
+
+/****************************************************************************
+ * Function: sendmmsg_send
+ *
+ * Description:
+ *   Gather one datagram into d_snddata and select its destination.
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static void sendmmsg_send(FAR struct net_driver_s *dev,
+                          FAR struct udp_conn_s *conn,
+                          FAR struct mmsghdr *mmsg)
+{
+  FAR struct msghdr *msg = &mmsg->msg_hdr;
+  FAR uint8_t *dest = dev->d_snddata;
+  int i;
+
+  /* Select the destination.  If no address was provided, the datagram
+   * goes to the same destination as the previous one.
+   */
+
+  if (msg->msg_name != NULL)
+    {
+#ifdef CONFIG_NET_IPv6
+      (void)udp_connect(conn, (FAR const struct sockaddr_in6 *)msg->msg_name);
+#else
+      (void)udp_connect(conn, (FAR const struct sockaddr_in *)msg->msg_name);
+#endif
+    }
+
+  /* Gather the payload into the packet buffer */
+
+  for (i = 0; i < msg->msg_iovlen; i++)
+    {
+      memcpy(dest, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+      dest += msg->msg_iov[i].iov_len;
+    }
+
+  dev->d_sndlen = dest - (FAR uint8_t *)dev->d_snddata;
+  mmsg->msg_len = dev->d_sndlen;
+}
+
+/****************************************************************************
+ * Function: sendmmsg_interrupt
+ *
+ * Description:
+ *   This function is called from the interrupt level to send the next
+ *   datagram when polled by the lower, device interfacing layer.  The
+ *   callback remains armed until all datagrams have been sent, so several
+ *   datagrams may be sent during one poll of the driver (see
+ *   CONFIG_NET_UDP_POLLBATCH).
+ *
+ * Parameters:
+ *   dev        The structure of the network driver that caused the interrupt
+ *   conn       An instance of the UDP connection structure cast to void *
+ *   pvpriv     An instance of struct sendmmsg_s cast to void*
+ *   flags      Set of events describing why the callback was invoked
+ *
+ * Returned Value:
+ *   Modified value of the input flags
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static uint16_t sendmmsg_interrupt(FAR struct net_driver_s *dev,
+                                   FAR void *pvconn, FAR void *pvpriv,
+                                   uint16_t flags)
+{
+  FAR struct udp_conn_s *conn = (FAR struct udp_conn_s *)pvconn;
+  FAR struct sendmmsg_s *pstate = (FAR struct sendmmsg_s *)pvpriv;
+
+  nllvdbg("flags: %04x nsent: %d\n", flags, pstate ? pstate->sm_nsent : 0);
+
+  if (pstate == NULL)
+    {
+      return flags;
+    }
+
+  /* Check if the outgoing packet is available.  It may have been claimed
+   * by a different thread -OR- the output buffer may currently contain
+   * unprocessed incoming data.  In these cases we will just have to wait
+   * for the next polling cycle.
+   */
+
+  if (dev->d_sndlen > 0 || (flags & UDP_NEWDATA) != 0)
+    {
+#ifdef CONFIG_NET_SENDTO_TIMEOUT
+      if (pstate->sm_sock->s_sndtimeo != 0 &&
+          net_timeo(pstate->sm_time, pstate->sm_sock->s_sndtimeo))
+        {
+          nlldbg("SEND timeout\n");
+          pstate->sm_result = -ETIMEDOUT;
+          goto end_wait;
+        }
+#endif
+      return flags;
+    }
+
+  /* Send the next datagram */
+
+  sendmmsg_send(dev, conn, &pstate->sm_msgvec[pstate->sm_nsent]);
+  pstate->sm_nsent++;
+
+#ifdef CONFIG_NET_SENDTO_TIMEOUT
+  pstate->sm_time = clock_systimer();
+#endif
+
+  if (pstate->sm_nsent < pstate->sm_vlen)
+    {
+      return flags;
+    }
+
+#ifdef CONFIG_NET_SENDTO_TIMEOUT
+end_wait:
+#endif
+
+  /* Don't allow any further call backs. */
+
+  pstate->sm_cb->flags = 0;
+  pstate->sm_cb->priv  = NULL;
+  pstate->sm_cb->event = NULL;
+
+  /* Wake up the waiting thread */
+
+  sem_post(&pstate->sm_sem);
+  return flags;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_sendmmsg
+ *
+ * Description:
+ *   Send several datagrams on a UDP socket in a single operation.  All of
+ *   the datagrams are queued on the connection at once and as many as
+ *   possible are sent during each poll of the network driver.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   msgvec   The array of datagrams to send.  On return, the msg_len field
+ *            of each datagram that was sent holds the number of bytes sent.
+ *   vlen     The number of datagrams in msgvec
+ *   flags    Send flags (none are supported)
+ *
+ * Returned Value:
+ *   On success, the number of datagrams sent.  If an error occurs after at
+ *   least one datagram was sent, the number of datagrams sent is returned.
+ *   Otherwise -1 is returned, and errno is set as for sendto().
+ *
+ ****************************************************************************/
+
+int psock_sendmmsg(FAR struct socket *psock, FAR struct mmsghdr *msgvec,
+                   unsigned int vlen, int flags)
+{
+  FAR struct udp_conn_s *conn;
+  FAR struct msghdr *msg;
+  struct sendmmsg_s state;
+  net_lock_t save;
+  ssize_t msglen;
+  unsigned int i;
+#ifdef CONFIG_NET_ARP_SEND
+  int ret;
+#endif
+  int err;
+
+  /* Verify that the psock corresponds to valid, allocated UDP socket */
+
+  if (!psock || psock->s_crefs <= 0)
+    {
+      ndbg("ERROR: Invalid socket\n");
+      err = EBADF;
+      goto errout;
+    }
+
+  if (psock->s_type != SOCK_DGRAM)
+    {
+      ndbg("ERROR: Not a datagram socket\n");
+      err = EOPNOTSUPP;
+      goto errout;
+    }
+
+  if (msgvec == NULL || vlen == 0)
+    {
+      err = EINVAL;
+      goto errout;
+    }
+
+  conn = (FAR struct udp_conn_s *)psock->s_conn;
+
+  /* Verify each datagram before anything is sent */
+
+  for (i = 0; i < vlen; i++)
+    {
+      msg = &msgvec[i].msg_hdr;
+
+      msglen = sendmmsg_msglen(msg);
+      if (msglen < 0)
+        {
+          err = -msglen;
+          goto errout;
+        }
+
+      if (msg->msg_name != NULL)
+        {
+#ifdef CONFIG_NET_IPv6
+          if (((FAR struct sockaddr *)msg->msg_name)->sa_family != AF_INET6 ||
+              msg->msg_namelen < sizeof(struct sockaddr_in6))
+#else
+          if (((FAR struct sockaddr *)msg->msg_name)->sa_family != AF_INET ||
+              msg->msg_namelen < sizeof(struct sockaddr_in))
+#endif
+            {
+              ndbg("ERROR: Invalid address\n");
+              err = EINVAL;
+              goto errout;
+            }
+
+          /* Make sure that the IP address mapping is in the ARP table */
+
+#ifdef CONFIG_NET_ARP_SEND
+          ret = arp_send(((FAR struct sockaddr_in *)msg->msg_name)->
+                         sin_addr.s_addr);
+          if (ret < 0)
+            {
+              ndbg("ERROR: Not reachable\n");
+              err = ENETUNREACH;
+              goto errout;
+            }
+#endif
+        }
+      else if (i == 0 && conn->rport == 0)
+        {
+          ndbg("ERROR: No destination address\n");
+          err = EDESTADDRREQ;
+          goto errout;
+        }
+
+      msgvec[i].msg_len = 0;
+    }
+
+  /* Set the socket state to sending */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
+
+  /* Initialize the state structure.  This is done with the network locked
+   * because we don't want anything to happen until we are ready.
+   */
+
+  save = net_lock();
+  memset(&state, 0, sizeof(struct sendmmsg_s));
+  sem_init(&state.sm_sem, 0, 0);
+  state.sm_msgvec = msgvec;
+  state.sm_vlen   = vlen;
+
+#ifdef CONFIG_NET_SENDTO_TIMEOUT
+  state.sm_sock   = psock;
+  state.sm_time   = clock_systimer();
+#endif
+
+  /* Setup the UDP socket for the first destination.  If the first
+   * datagram has no address, the previous destination is reused.
+   */
+
+  if (msgvec[0].msg_hdr.msg_name != NULL)
+    {
+#ifdef CONFIG_NET_IPv6
+      (void)udp_connect(conn, (FAR const struct sockaddr_in6 *)
+                        msgvec[0].msg_hdr.msg_name);
+#else
+      (void)udp_connect(conn, (FAR const struct sockaddr_in *)
+                        msgvec[0].msg_hdr.msg_name);
+#endif
+    }
+
+  /* Set up the callback in the connection */
+
+  state.sm_cb = udp_callback_alloc(conn);
+  if (state.sm_cb)
+    {
+      state.sm_cb->flags = UDP_POLL;
+      state.sm_cb->priv  = (FAR void *)&state;
+      state.sm_cb->event = sendmmsg_interrupt;
+
+      /* Notify the device driver of the availability of TX data */
+
+      netdev_txnotify(conn->ripaddr);
+
+      /* Wait for all of the datagrams to be sent or for an error/timeout.
+       * net_lockedwait will also terminate if a signal is received.
+       */
+
+      if (net_lockedwait(&state.sm_sem) < 0 && state.sm_result == 0)
+        {
+          state.sm_result = -errno;
+        }
+
+      /* Make sure that no further interrupts are processed */
+
+      udp_callback_free(conn, state.sm_cb);
+    }
+  else
+    {
+      state.sm_result = -EBUSY;
+    }
+
+#ifdef CONFIG_NET_STATISTICS
+  if (state.sm_nsent > 0)
+    {
+      g_netstats.udp.sndbatch++;
+      g_netstats.udp.sndmsgs += state.sm_nsent;
+    }
+#endif
+
+  net_unlock(save);
+  sem_destroy(&state.sm_sem);
+
+  /* Set the socket state to idle */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+
+  /* Report a failure only if nothing was sent */
+
+  if (state.sm_nsent == 0 && state.sm_result < 0)
+    {
+      err = -state.sm_result;
+      goto errout;
+    }
+
+  return state.sm_nsent;
+
+errout:
+  set_errno(err);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Function: sendmmsg
+ *
+ * Description:
+ *   Send several datagrams on a UDP socket in a single call.  See
+ *   psock_sendmmsg().
+ *
+ ****************************************************************************/
+
+int sendmmsg(int sockfd, FAR struct mmsghdr *msgvec, unsigned int vlen,
+             int flags)
+{
+  FAR struct socket *psock;
+
+  /* Get the underlying socket structure */
+
+  psock = sockfd_socket(sockfd);
+
+  /* And let psock_sendmmsg do all of the work */
+
+  return psock_sendmmsg(psock, msgvec, vlen, flags);
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_UDP_MMSG */
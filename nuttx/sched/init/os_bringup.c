@@ -44,6 +44,7 @@
 #include <nuttx/config.h>
 
 #include <sched.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <debug.h>
 
@@ -210,6 +211,11 @@ static inline void os_pgworker(void)
 #ifdef CONFIG_SCHED_WORKQUEUE
 static inline void os_workqueues(void)
 {
+#ifdef CONFIG_SCHED_HPWORK
+  FAR char *argv[2];
+  char arg[4];
+  int wndx;
+#endif
 #if defined(CONFIG_BUILD_PROTECTED) && defined(CONFIG_SCHED_USRWORK)
   int taskid;
 #endif
@@ -221,11 +227,22 @@ static inline void os_workqueues(void)
   svdbg("Starting kernel worker thread\n");
 #endif
 
-  g_work[HPWORK].pid = kernel_thread(HPWORKNAME, CONFIG_SCHED_WORKPRIORITY,
-                                     CONFIG_SCHED_WORKSTACKSIZE,
-                                     (main_t)work_hpthread,
-                                     (FAR char * const *)NULL);
-  DEBUGASSERT(g_work[HPWORK].pid > 0);
+  /* Each thread receives its index within the work queue as its only
+   * argument.
+   */
+
+  argv[0] = arg;
+  argv[1] = NULL;
+
+  for (wndx = 0; wndx < CONFIG_SCHED_WORKNTHREADS; wndx++)
+    {
+      snprintf(arg, sizeof(arg), "%d", wndx);
+      g_work[HPWORK].thread[wndx].pid =
+        kernel_thread(HPWORKNAME, CONFIG_SCHED_WORKPRIORITY,
+                      CONFIG_SCHED_WORKSTACKSIZE, (main_t)work_hpthread,
+                      (FAR char * const *)argv);
+      DEBUGASSERT(g_work[HPWORK].thread[wndx].pid > 0);
+    }
 
   /* Start a lower priority worker thread for other, non-critical continuation
    * tasks
@@ -235,11 +252,15 @@ static inline void os_workqueues(void)
 
   svdbg("Starting low-priority kernel worker thread\n");
 
-  g_work[LPWORK].pid = kernel_thread(LPWORKNAME, CONFIG_SCHED_LPWORKPRIORITY,
-                                     CONFIG_SCHED_LPWORKSTACKSIZE,
-                                     (main_t)work_lpthread,
-                                     (FAR char * const *)NULL);
-  DEBUGASSERT(g_work[LPWORK].pid > 0);
+  for (wndx = 0; wndx < CONFIG_SCHED_LPWORKNTHREADS; wndx++)
+    {
+      snprintf(arg, sizeof(arg), "%d", wndx);
+      g_work[LPWORK].thread[wndx].pid =
+        kernel_thread(LPWORKNAME, CONFIG_SCHED_LPWORKPRIORITY,
+                      CONFIG_SCHED_LPWORKSTACKSIZE, (main_t)work_lpthread,
+                      (FAR char * const *)argv);
+      DEBUGASSERT(g_work[LPWORK].thread[wndx].pid > 0);
+    }
 
 #endif /* CONFIG_SCHED_LPWORK */
 #endif /* CONFIG_SCHED_HPWORK */
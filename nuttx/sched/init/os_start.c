@@ -327,7 +327,7 @@ void os_start(void)
 
   /* Then add the idle task's TCB to the head of the ready to run list */
 
-  dq_addfirst((FAR dq_entry_t*)&g_idletcb, (FAR dq_queue_t*)&g_readytorun);
+  (void)sched_rtrinsert(&g_idletcb.cmn);
 
   /* Initialize the processor-specific portion of the TCB */
 
@@ -522,6 +522,12 @@ void os_start(void)
   g_idletcb.cmn.group->tg_flags = GROUP_FLAG_NOCLDWAIT;
 #endif
 
+  /* Start CPU time accounting.  Time spent before this point is not
+   * charged to any thread.
+   */
+
+  sched_cputime_initialize();
+
   /* Bring Up the System ****************************************************/
   /* Create initial tasks and bring-up the system */
 
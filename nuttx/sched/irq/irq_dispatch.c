@@ -42,7 +42,9 @@
 #include <debug.h>
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
+#include <nuttx/sched_trace.h>
 
+#include "sched/sched.h"
 #include "irq/irq.h"
 
 /****************************************************************************
@@ -100,6 +102,10 @@ void irq_dispatch(int irq, FAR void *context)
 
   /* Then dispatch to the interrupt handler */
 
+  sched_cputime_irqenter();
+  sched_trace_irqenter(irq);
   vector(irq, context);
+  sched_trace_irqleave(irq);
+  sched_cputime_irqleave();
 }
 
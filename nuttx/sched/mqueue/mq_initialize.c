@@ -41,6 +41,8 @@
 
 #include <stdint.h>
 #include <queue.h>
+#include <assert.h>
+#include <errno.h>
 #include <nuttx/kmalloc.h>
 
 #include "mqueue/mqueue.h"
@@ -69,18 +71,24 @@ struct mq_des_block_s
 
 sq_queue_t  g_msgqueues;
 
-/* The g_msgfree is a list of messages that are available for general
- * use.  The number of messages in this list is a system configuration
+/* The g_msgfree is a pool of messages that are available for general
+ * use.  The number of messages in this pool is a system configuration
  * item.
  */
 
-sq_queue_t  g_msgfree;
+struct lfqueue_s g_msgfree;
 
-/* The g_msgfreeInt is a list of messages that are reserved for use by
+/* The g_msgfreeInt is a pool of messages that are reserved for use by
  * interrupt handlers.
  */
 
-sq_queue_t  g_msgfreeirq;
+struct lfqueue_s g_msgfreeirq;
+
+#ifdef CONFIG_MM_SLAB
+/* Object cache for messages allocated when g_msgfree is exhausted */
+
+FAR struct slab_cache_s *g_msgcache;
+#endif
 
 /* The g_desfree data structure is a list of message descriptors available
  * to the operating system for general use. The number of messages in the
@@ -93,18 +101,6 @@ sq_queue_t  g_desfree;
  * Private Variables
  ************************************************************************/
 
-/* g_msgalloc is a pointer to the start of the allocated block of
- * messages.
- */
-
-static mqmsg_t    *g_msgalloc;
-
-/* g_msgfreeirqalloc is a pointer to the start of the allocated block of
- * messages.
- */
-
-static mqmsg_t    *g_msgfreeirqalloc;
-
 /* g_desalloc is a list of allocated block of message queue descriptors. */
 
 static sq_queue_t  g_desalloc;
@@ -117,36 +113,78 @@ static sq_queue_t  g_desalloc;
  * Name: mq_msgblockalloc
  *
  * Description:
- *   Allocate a block of messages and place them on the free list.
+ *   Allocate a block of messages and place them in the free pool.  The
+ *   pool is sized to the next power of two so that it can never
+ *   overflow when every message has been returned.  If either
+ *   allocation fails, nothing is kept and the pool is left
+ *   uninitialized (with no cells) so that the allocation can be
+ *   retried.  A pool of zero messages is valid:  It is initialized
+ *   but empty, and all messages are then allocated dynamically.
  *
  * Inputs Parameters:
- *  queue
+ *   pool - The free pool to initialize
+ *   nmsgs - The number of messages to allocate
+ *   alloc_type - The allocation type of the messages
+ *
+ * Return Value:
+ *   OK on success; -ENOMEM if the pool could not be initialized.
  *
  ************************************************************************/
 
-static mqmsg_t *mq_msgblockalloc(sq_queue_t *queue, uint16_t nmsgs,
-                                 uint8_t alloc_type)
+static int mq_msgblockalloc(FAR struct lfqueue_s *pool, uint16_t nmsgs,
+                            uint8_t alloc_type)
 {
-  mqmsg_t *mqmsgblock;
+  FAR struct lfq_cell_s *cells;
+  mqmsg_t *mqmsgblock = NULL;
+  mqmsg_t *mqmsg;
+  uint16_t ncells;
+  int i;
+
+  ncells = 2;
+  while (ncells < nmsgs)
+    {
+      ncells <<= 1;
+    }
+
+  cells = (FAR struct lfq_cell_s *)
+    kmm_malloc(sizeof(struct lfq_cell_s) * ncells);
+  if (!cells)
+    {
+      return -ENOMEM;
+    }
 
   /* The g_msgfree must be loaded at initialization time to hold the
    * configured number of messages.
    */
 
-  mqmsgblock = (mqmsg_t*)kmm_malloc(sizeof(mqmsg_t) * nmsgs);
-  if (mqmsgblock)
+  if (nmsgs > 0)
     {
-      mqmsg_t *mqmsg = mqmsgblock;
-      int      i;
+      mqmsgblock = (mqmsg_t*)kmm_malloc(sizeof(mqmsg_t) * nmsgs);
+      if (!mqmsgblock)
+        {
+          kmm_free(cells);
+          return -ENOMEM;
+        }
+    }
 
-      for (i = 0; i < nmsgs; i++)
+  if (lfq_init(pool, cells, ncells, 0) < 0)
+    {
+      if (mqmsgblock)
         {
-          mqmsg->type = alloc_type;
-          sq_addlast((FAR sq_entry_t*)mqmsg++, queue);
+          kmm_free(mqmsgblock);
         }
+
+      kmm_free(cells);
+      return -ENOMEM;
+    }
+
+  for (i = 0, mqmsg = mqmsgblock; i < nmsgs; i++)
+    {
+      mqmsg->type = alloc_type;
+      (void)lfq_push(pool, mqmsg++);
     }
 
-  return mqmsgblock;
+  return OK;
 }
 
 /************************************************************************
@@ -175,29 +213,72 @@ void mq_initialize(void)
 
   sq_init(&g_msgqueues);
 
-  /* Initialize the message free lists */
+  /* Initialize the message descriptor block list.  The message free
+   * pools are initialized when their messages are allocated.
+   */
 
-  sq_init(&g_msgfree);
-  sq_init(&g_msgfreeirq);
   sq_init(&g_desalloc);
 
+  /* Allocate the blocks of messages.  If this fails, mq_open() will try
+   * again.
+   */
+
+  (void)mq_msgblockinit();
+
+#ifdef CONFIG_MM_SLAB
+  /* Create the cache for any additional messages */
+
+  g_msgcache = slab_create("mqmsg", sizeof(mqmsg_t), 0, NULL);
+  DEBUGASSERT(g_msgcache != NULL);
+#endif
+
+  /* Allocate a block of message queue descriptors */
+
+  mq_desblockalloc();
+}
+
+/************************************************************************
+ * Name: mq_msgblockinit
+ *
+ * Description:
+ *   Allocate the blocks of messages for the free pools, unless that has
+ *   already been done.  Called by mq_initialize() and by mq_open(), so
+ *   that no message queue can exist without the message pools.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   OK if both pools are set up; -ENOMEM otherwise.
+ *
+ * Assumptions:
+ *   Called with pre-emption disabled or during initialization.
+ *
+ ************************************************************************/
+
+int mq_msgblockinit(void)
+{
+  int ret = OK;
+
   /* Allocate a block of messages for general use */
 
-  g_msgalloc =
-    mq_msgblockalloc(&g_msgfree, CONFIG_PREALLOC_MQ_MSGS,
-                     MQ_ALLOC_FIXED);
+  if (!g_msgfree.cells)
+    {
+      ret = mq_msgblockalloc(&g_msgfree, CONFIG_PREALLOC_MQ_MSGS,
+                             MQ_ALLOC_FIXED);
+    }
 
   /* Allocate a block of messages for use exclusively by
    * interrupt handlers
    */
 
-  g_msgfreeirqalloc =
-    mq_msgblockalloc(&g_msgfreeirq, NUM_INTERRUPT_MSGS,
-                     MQ_ALLOC_IRQ);
-
-  /* Allocate a block of message queue descriptors */
+  if (ret == OK && !g_msgfreeirq.cells)
+    {
+      ret = mq_msgblockalloc(&g_msgfreeirq, NUM_INTERRUPT_MSGS,
+                             MQ_ALLOC_IRQ);
+    }
 
-  mq_desblockalloc();
+  return ret;
 }
 
 /************************************************************************
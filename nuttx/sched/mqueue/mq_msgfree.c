@@ -88,36 +88,24 @@
 
 void mq_msgfree(FAR mqmsg_t *mqmsg)
 {
-  irqstate_t saved_state;
-
   /* If this is a generally available pre-allocated message,
-   * then just put it back in the free list.
+   * then just put it back in the free pool.  The pool is safe
+   * against concurrent access from interrupt handlers and can
+   * hold every pre-allocated message, so this cannot fail.
    */
 
   if (mqmsg->type == MQ_ALLOC_FIXED)
     {
-      /* Make sure we avoid concurrent access to the free
-       * list from interrupt handlers.
-       */
-
-      saved_state = irqsave();
-      sq_addlast((FAR sq_entry_t*)mqmsg, &g_msgfree);
-      irqrestore(saved_state);
+      (void)lfq_push(&g_msgfree, mqmsg);
     }
 
   /* If this is a message pre-allocated for interrupts,
-   * then put it back in the correct  free list.
+   * then put it back in the correct  free pool.
    */
 
   else if (mqmsg->type == MQ_ALLOC_IRQ)
     {
-      /* Make sure we avoid concurrent access to the free
-       * list from interrupt handlers.
-       */
-
-      saved_state = irqsave();
-      sq_addlast((FAR sq_entry_t*)mqmsg, &g_msgfreeirq);
-      irqrestore(saved_state);
+      (void)lfq_push(&g_msgfreeirq, mqmsg);
     }
 
   /* Otherwise, deallocate it.  Note:  interrupt handlers
@@ -127,7 +115,7 @@ void mq_msgfree(FAR mqmsg_t *mqmsg)
 
   else if (mqmsg->type == MQ_ALLOC_DYN)
     {
-      sched_kfree(mqmsg);
+      mq_msgdynfree(mqmsg);
     }
   else
     {
@@ -122,7 +122,10 @@ mqd_t mq_open(const char *mq_name, int oflags, ...)
     {
       sched_lock();
       namelen = strlen(mq_name);
-      if (namelen > 0)
+
+      /* The message pools may not have been allocated at boot time */
+
+      if (namelen > 0 && mq_msgblockinit() == OK)
         {
           /* See if the message queue already exists */
 
@@ -139,16 +139,16 @@ int mq_verifysend(mqd_t mqdes, const void *msg, size_t msglen, int prio)
  * Description:
  *   The mq_msgalloc function will get a free message for use by the
  *   operating system.  The message will be allocated from the g_msgfree
- *   list.
+ *   pool.
  *
- *   If the list is empty AND the message is NOT being allocated from the
+ *   If the pool is empty AND the message is NOT being allocated from the
  *   interrupt level, then the message will be allocated.  If a message
  *   cannot be obtained, the operating system is dead and therefore cannot
  *   continue.
  *
- *   If the list is empty AND the message IS being allocated from the
+ *   If the pool is empty AND the message IS being allocated from the
  *   interrupt level.  This function will attempt to get a message from
- *   the g_msgfreeirq list.  If this is unsuccessful, the calling interrupt
+ *   the g_msgfreeirq pool.  If this is unsuccessful, the calling interrupt
  *   handler will be notified.
  *
  * Inputs:
@@ -163,23 +163,22 @@ int mq_verifysend(mqd_t mqdes, const void *msg, size_t msglen, int prio)
 FAR mqmsg_t *mq_msgalloc(void)
 {
   FAR mqmsg_t *mqmsg;
-  irqstate_t   saved_state;
 
   /* If we were called from an interrupt handler, then try to get the message
-   * from generally available list of messages. If this fails, then try the
-   * list of messages reserved for interrupt handlers
+   * from generally available pool of messages. If this fails, then try the
+   * pool of messages reserved for interrupt handlers
    */
 
   if (up_interrupt_context())
     {
-      /* Try the general free list */
+      /* Try the general free pool */
 
-      mqmsg = (FAR mqmsg_t*)sq_remfirst(&g_msgfree);
+      mqmsg = (FAR mqmsg_t*)lfq_pop(&g_msgfree);
       if (!mqmsg)
         {
-          /* Try the free list reserved for interrupt handlers */
+          /* Try the free pool reserved for interrupt handlers */
 
-          mqmsg = (FAR mqmsg_t*)sq_remfirst(&g_msgfreeirq);
+          mqmsg = (FAR mqmsg_t*)lfq_pop(&g_msgfreeirq);
         }
     }
 
@@ -187,19 +186,18 @@ FAR mqmsg_t *mq_msgalloc(void)
 
   else
     {
-      /* Try to get the message from the generally available free list.
-       * Disable interrupts -- we might be called from an interrupt handler.
+      /* Try to get the message from the generally available free pool.
+       * The pool may be accessed concurrently by interrupt handlers
+       * without disabling interrupts.
        */
 
-      saved_state = irqsave();
-      mqmsg = (FAR mqmsg_t*)sq_remfirst(&g_msgfree);
-      irqrestore(saved_state);
+      mqmsg = (FAR mqmsg_t*)lfq_pop(&g_msgfree);
 
       /* If we cannot a message from the free list, then we will have to allocate one. */
 
       if (!mqmsg)
         {
-          mqmsg = (FAR mqmsg_t *)kmm_malloc((sizeof (mqmsg_t)));
+          mqmsg = mq_msgdynalloc();
 
           /* Check if we got an allocated message */
 
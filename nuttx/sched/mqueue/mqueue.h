@@ -52,6 +52,9 @@
 #include <signal.h>
 
 #include <nuttx/mqueue.h>
+#include <nuttx/lfqueue.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/slab.h>
 
 #if CONFIG_MQ_MAXMSGSIZE > 0
 
@@ -75,6 +78,16 @@
 
 #define NUM_INTERRUPT_MSGS   8
 
+/* Allocation of messages beyond the pre-allocated pools */
+
+#ifdef CONFIG_MM_SLAB
+#  define mq_msgdynalloc()   ((FAR mqmsg_t *)slab_alloc(g_msgcache))
+#  define mq_msgdynfree(m)   slab_free(g_msgcache, (m))
+#else
+#  define mq_msgdynalloc()   ((FAR mqmsg_t *)kmm_malloc(sizeof(mqmsg_t)))
+#  define mq_msgdynfree(m)   sched_kfree(m)
+#endif
+
 /****************************************************************************
  * Global Type Declarations
  ****************************************************************************/
@@ -121,17 +134,25 @@ extern "C"
 
 EXTERN sq_queue_t  g_msgqueues;
 
-/* The g_msgfree is a list of messages that are available for general use.
- * The number of messages in this list is a system configuration item.
+/* The g_msgfree is a pool of messages that are available for general use.
+ * The number of messages in this pool is a system configuration item.
+ * Messages are taken from and returned to the pools by both tasks and
+ * interrupt handlers without disabling interrupts.
  */
 
-EXTERN sq_queue_t  g_msgfree;
+EXTERN struct lfqueue_s g_msgfree;
 
-/* The g_msgfreeInt is a list of messages that are reserved for use by
+/* The g_msgfreeInt is a pool of messages that are reserved for use by
  * interrupt handlers.
  */
 
-EXTERN sq_queue_t  g_msgfreeirq;
+EXTERN struct lfqueue_s g_msgfreeirq;
+
+#ifdef CONFIG_MM_SLAB
+/* Object cache for messages allocated when g_msgfree is exhausted */
+
+EXTERN FAR struct slab_cache_s *g_msgcache;
+#endif
 
 /* The g_desfree data structure is a list of message descriptors available
  * to the operating system for general use. The number of messages in the
@@ -147,6 +168,7 @@ EXTERN sq_queue_t  g_desfree;
 /* Functions defined in mq_initialize.c ************************************/
 
 void weak_function mq_initialize(void);
+int  mq_msgblockinit(void);
 void mq_desblockalloc(void);
 
 mqd_t mq_descreate(FAR struct tcb_s* mtcb, FAR msgq_t* msgq, int oflags);
@@ -228,6 +228,20 @@ void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void sched_removeblocked(FAR struct tcb_s *btcb);
 int  sched_setpriority(FAR struct tcb_s *tcb, int sched_priority);
 
+/* Low level insertion into and removal from the g_readytorun list.  These
+ * do not change task states or inform the instrumentation layer.
+ */
+
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+bool sched_rtrinsert(FAR struct tcb_s *tcb);
+void sched_rtrremove(FAR struct tcb_s *tcb);
+#else
+#  define sched_rtrinsert(tcb) \
+     sched_addprioritized(tcb, (FAR dq_queue_t*)&g_readytorun)
+#  define sched_rtrremove(tcb) \
+     dq_rem((FAR dq_entry_t*)(tcb), (FAR dq_queue_t*)&g_readytorun)
+#endif
+
 #ifdef CONFIG_PRIORITY_INHERITANCE
 int  sched_reprioritize(FAR struct tcb_s *tcb, int sched_priority);
 #else
@@ -250,6 +264,18 @@ void sched_timer_reassess(void);
 void weak_function sched_process_cpuload(void);
 #endif
 
+#ifdef CONFIG_SCHED_CPUTIME
+void sched_cputime_initialize(void);
+void sched_cputime_switch(FAR struct tcb_s *rtcb);
+void sched_cputime_irqenter(void);
+void sched_cputime_irqleave(void);
+#else
+#  define sched_cputime_initialize()
+#  define sched_cputime_switch(rtcb)
+#  define sched_cputime_irqenter()
+#  define sched_cputime_irqleave()
+#endif
+
 bool sched_verifytcb(FAR struct tcb_s *tcb);
 int  sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype);
 
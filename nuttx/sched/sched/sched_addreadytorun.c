@@ -121,11 +121,12 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
 
   /* Otherwise, add the new task to the ready-to-run task list */
 
-  else if (sched_addprioritized(btcb, (FAR dq_queue_t*)&g_readytorun))
+  else if (sched_rtrinsert(btcb))
     {
       /* Inform the instrumentation logic that we are switching tasks */
 
       sched_note_switch(rtcb, btcb);
+      sched_cputime_switch(rtcb);
 
       /* The new btcb was added at the head of the ready-to-run list.  It
        * is now to new active task!
@@ -0,0 +1,238 @@
+/****************************************************************************
+ * sched/sched/sched_cputime.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <arch/irq.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_CPUTIME
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The clock value at the last time that CPU time was charged */
+
+static uint32_t g_cputime_last;
+
+/* The interrupt nesting level.  While non-zero, the time is charged to
+ * interrupt handling rather than to the thread at the head of the
+ * g_readytorun list.
+ */
+
+static uint8_t g_cputime_irqnest;
+
+/* Time spent in interrupt handlers and the total of all charged time */
+
+static uint64_t g_cputime_irq;
+static uint64_t g_cputime_total;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cputime_elapsed
+ *
+ * Description:
+ *   Return the time since CPU time was last charged and start a new
+ *   interval.
+ *
+ ****************************************************************************/
+
+static uint32_t sched_cputime_elapsed(void)
+{
+  uint32_t now     = up_trace_clock();
+  uint32_t elapsed = now - g_cputime_last;
+
+  g_cputime_last   = now;
+  g_cputime_total += elapsed;
+  return elapsed;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_cputime_initialize
+ *
+ * Description:
+ *   Start CPU time accounting.  Called once by os_start() just before the
+ *   initial tasks are created.
+ *
+ ****************************************************************************/
+
+void sched_cputime_initialize(void)
+{
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+  irqstate_t flags;
+
+  flags            = irqsave();
+  g_cputime_last   = up_trace_clock();
+  g_cputime_irq    = 0;
+  g_cputime_total  = 0;
+  rtcb->cputime    = 0;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: sched_cputime_switch
+ *
+ * Description:
+ *   Charge the time since the last context switch to the thread that is
+ *   being switched out.  Called with interrupts disabled whenever the head
+ *   of the g_readytorun list changes.  A context switch that is caused by
+ *   an interrupt handler charges nothing; the time up to the end of the
+ *   interrupt belongs to interrupt handling.
+ *
+ ****************************************************************************/
+
+void sched_cputime_switch(FAR struct tcb_s *rtcb)
+{
+  if (g_cputime_irqnest == 0)
+    {
+      rtcb->cputime += sched_cputime_elapsed();
+    }
+}
+
+/****************************************************************************
+ * Name: sched_cputime_irqenter and sched_cputime_irqleave
+ *
+ * Description:
+ *   Called by irq_dispatch() around each interrupt handler.  The outermost
+ *   interrupt charges the interrupted thread on entry and charges the
+ *   interrupt handling time on exit.
+ *
+ ****************************************************************************/
+
+void sched_cputime_irqenter(void)
+{
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+  irqstate_t flags;
+
+  flags = irqsave();
+  if (g_cputime_irqnest++ == 0)
+    {
+      rtcb->cputime += sched_cputime_elapsed();
+    }
+
+  irqrestore(flags);
+}
+
+void sched_cputime_irqleave(void)
+{
+  irqstate_t flags;
+
+  flags = irqsave();
+  DEBUGASSERT(g_cputime_irqnest > 0);
+
+  if (--g_cputime_irqnest == 0)
+    {
+      g_cputime_irq += sched_cputime_elapsed();
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Function:  clock_cputime
+ *
+ * Description:
+ *   Return the CPU time measurements for the select PID.  The times
+ *   include the interval that is still in progress.
+ *
+ * Parameters:
+ *   pid - The task ID of the thread of interest.  pid == 0 is the IDLE thread.
+ *   cputime - The location to return the CPU times
+ *
+ * Return Value:
+ *   OK (0) on success; a negated errno value on failure.  The only reason
+ *   that this function can fail is if 'pid' no longer refers to a valid
+ *   thread.
+ *
+ ****************************************************************************/
+
+int clock_cputime(int pid, FAR struct cputime_s *cputime)
+{
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+  uint32_t elapsed;
+  int ret = -ESRCH;
+
+  DEBUGASSERT(cputime);
+
+  /* Interrupts are disabled so that the TCB stays valid and the times are
+   * consistent.
+   */
+
+  flags = irqsave();
+  tcb   = sched_gettcb((pid_t)pid);
+  if (tcb)
+    {
+      elapsed         = up_trace_clock() - g_cputime_last;
+      cputime->active = tcb->cputime;
+      cputime->irq    = g_cputime_irq;
+      cputime->total  = g_cputime_total + elapsed;
+
+      if (g_cputime_irqnest > 0)
+        {
+          cputime->irq += elapsed;
+        }
+      else if (tcb == (FAR struct tcb_s*)g_readytorun.head)
+        {
+          cputime->active += elapsed;
+        }
+
+      ret = OK;
+    }
+
+  irqrestore(flags);
+  return ret;
+}
+
+#endif /* CONFIG_SCHED_CPUTIME */
@@ -82,6 +82,31 @@ static void sched_releasepid(pid_t pid)
 #endif
 }
 
+/************************************************************************
+ * Name: sched_releasetcache
+ ************************************************************************/
+
+#ifdef CONFIG_MM_TCACHE
+static void sched_releasetcache(FAR struct tcb_s *tcb)
+{
+  FAR void *mem;
+
+  while ((mem = mm_tcache_take(tcb)) != NULL)
+    {
+#ifdef CONFIG_MM_KERNEL_HEAP
+      if (tcb->tcache.tc_heap == &g_kmmheap)
+        {
+          sched_kfree(mem);
+        }
+      else
+#endif
+        {
+          sched_ufree(mem);
+        }
+    }
+}
+#endif
+
 /************************************************************************
  * Public Functions
  ************************************************************************/
@@ -129,6 +154,16 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
         }
 #endif
 
+#ifdef CONFIG_MM_TCACHE
+      /* Release any chunks still held in the thread's allocation cache.
+       * These are normally returned by task_exithook(), but not after
+       * _exit().  We may not wait for the heap semaphore here so the
+       * deallocation is deferred.
+       */
+
+      sched_releasetcache(tcb);
+#endif
+
       /* Release the task's process ID if one was assigned.  PID
        * zero is reserved for the IDLE task.  The TCB of the IDLE
        * task is never release so a value of zero simply means that
@@ -0,0 +1,239 @@
+/****************************************************************************
+ * sched/sched/sched_rtrindex.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* One bit per priority level, 32 levels per word */
+
+#define RTR_NPRIORITIES  (SCHED_PRIORITY_MAX + 1)
+#define RTR_NWORDS       ((RTR_NPRIORITIES + 31) >> 5)
+
+/* Mask of the bits strictly above bit 'b' of a 32-bit word */
+
+#define RTR_ABOVE(b)     (~((2u << (b)) - 1))
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The g_readytorun list is still a single list in descending priority
+ * order.  The tasks of each priority form a contiguous FIFO band in that
+ * list.  g_rtrtail[] holds the last TCB of each band and g_rtrmap[] has a
+ * bit set for each priority that has a non-empty band.  g_rtrsummary has a
+ * bit set for each non-zero word of g_rtrmap[].
+ */
+
+static FAR struct tcb_s *g_rtrtail[RTR_NPRIORITIES];
+static uint32_t g_rtrmap[RTR_NWORDS];
+static uint32_t g_rtrsummary;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_rtrffs
+ *
+ * Description:
+ *   Return the bit number of the least significant bit set in a non-zero
+ *   word.
+ *
+ ****************************************************************************/
+
+static inline int sched_rtrffs(uint32_t word)
+{
+#ifdef __GNUC__
+  return __builtin_ctz(word);
+#else
+  int bit = 0;
+
+  while ((word & 1) == 0)
+    {
+      word >>= 1;
+      bit++;
+    }
+
+  return bit;
+#endif
+}
+
+/****************************************************************************
+ * Name: sched_rtrabove
+ *
+ * Description:
+ *   Return the TCB that ends the band of the lowest priority that is
+ *   strictly higher than 'priority'; NULL if there is no task of higher
+ *   priority in the g_readytorun list.
+ *
+ ****************************************************************************/
+
+static FAR struct tcb_s *sched_rtrabove(int priority)
+{
+  uint32_t map;
+  int ndx = priority >> 5;
+
+  map = g_rtrmap[ndx] & RTR_ABOVE(priority & 31);
+  if (map == 0)
+    {
+      map = g_rtrsummary & RTR_ABOVE(ndx);
+      if (map == 0)
+        {
+          return NULL;
+        }
+
+      ndx = sched_rtrffs(map);
+      map = g_rtrmap[ndx];
+    }
+
+  return g_rtrtail[(ndx << 5) + sched_rtrffs(map)];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_rtrinsert
+ *
+ * Description:
+ *   Add a TCB to the g_readytorun list after all tasks of the same or
+ *   higher priority.  This is the same position that sched_addprioritized()
+ *   would select but it is found without traversing the list.
+ *
+ * Inputs:
+ *   tcb - Points to the TCB to add.  It must not be in any list.
+ *
+ * Return Value:
+ *   true if the TCB was added at the head of the g_readytorun list.
+ *
+ * Assumptions:
+ * - The caller has established a critical section.
+ * - The caller deals with task states and the head of the list.
+ *
+ ****************************************************************************/
+
+bool sched_rtrinsert(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *prev;
+  int priority = tcb->sched_priority;
+
+  prev = g_rtrtail[priority];
+  if (prev == NULL)
+    {
+      prev = sched_rtrabove(priority);
+    }
+
+  if (prev != NULL)
+    {
+      dq_addafter((FAR dq_entry_t *)prev, (FAR dq_entry_t *)tcb,
+                  (FAR dq_queue_t *)&g_readytorun);
+    }
+  else
+    {
+      dq_addfirst((FAR dq_entry_t *)tcb, (FAR dq_queue_t *)&g_readytorun);
+    }
+
+  /* The TCB is now the last task in the band of its priority */
+
+  g_rtrtail[priority]     = tcb;
+  g_rtrmap[priority >> 5] |= (uint32_t)1 << (priority & 31);
+  g_rtrsummary           |= (uint32_t)1 << (priority >> 5);
+
+  return prev == NULL;
+}
+
+/****************************************************************************
+ * Name: sched_rtrremove
+ *
+ * Description:
+ *   Remove a TCB from the g_readytorun list.
+ *
+ * Inputs:
+ *   tcb - Points to a TCB in the g_readytorun list.  Its priority must not
+ *         have been changed since it was added.
+ *
+ * Assumptions:
+ * - The caller has established a critical section.
+ * - The caller deals with task states and the head of the list.
+ *
+ ****************************************************************************/
+
+void sched_rtrremove(FAR struct tcb_s *tcb)
+{
+  FAR struct tcb_s *prev = tcb->blink;
+  int priority = tcb->sched_priority;
+
+  if (g_rtrtail[priority] == tcb)
+    {
+      if (prev != NULL && prev->sched_priority == priority)
+        {
+          /* The previous task becomes the end of the band */
+
+          g_rtrtail[priority] = prev;
+        }
+      else
+        {
+          /* The band is now empty */
+
+          g_rtrtail[priority] = NULL;
+          g_rtrmap[priority >> 5] &= ~((uint32_t)1 << (priority & 31));
+          if (g_rtrmap[priority >> 5] == 0)
+            {
+              g_rtrsummary &= ~((uint32_t)1 << (priority >> 5));
+            }
+        }
+    }
+
+  dq_rem((FAR dq_entry_t *)tcb, (FAR dq_queue_t *)&g_readytorun);
+}
+
+#endif /* CONFIG_SCHED_READYTORUN_BITMAP */
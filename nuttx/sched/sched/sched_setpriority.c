@@ -149,9 +149,19 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
 
         else
           {
+#ifdef CONFIG_SCHED_READYTORUN_BITMAP
+            /* The task stays at the head of the ready-to-run list but it
+             * must be moved into the band of its new priority.
+             */
+
+            sched_rtrremove(tcb);
+            tcb->sched_priority = (uint8_t)sched_priority;
+            ASSERT(sched_rtrinsert(tcb));
+#else
             /* Change the task priority */
 
             tcb->sched_priority = (uint8_t)sched_priority;
+#endif
           }
         break;
 
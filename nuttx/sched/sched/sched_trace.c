@@ -0,0 +1,263 @@
+/****************************************************************************
+ * sched/sched/sched_trace.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/sched_trace.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_TRACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_SCHED_TRACE_NRECORDS
+#  define CONFIG_SCHED_TRACE_NRECORDS 1024
+#endif
+
+#if (CONFIG_SCHED_TRACE_NRECORDS & (CONFIG_SCHED_TRACE_NRECORDS - 1)) != 0
+#  error CONFIG_SCHED_TRACE_NRECORDS must be a power of two
+#endif
+
+#define TRACE_MASK (CONFIG_SCHED_TRACE_NRECORDS - 1)
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The ring of trace records.  g_trace_seqno is the total number of records
+ * written since boot-up; record n is held in g_trace_ring[n & TRACE_MASK].
+ * The writer never waits for a reader:  The oldest records are simply
+ * overwritten.
+ */
+
+static struct trace_record_s g_trace_ring[CONFIG_SCHED_TRACE_NRECORDS];
+static volatile uint32_t g_trace_seqno;
+static volatile bool g_trace_full;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_trace_clock
+ ****************************************************************************/
+
+static inline uint32_t sched_trace_clock(void)
+{
+#ifdef CONFIG_ARCH_HAVE_TRACECLOCK
+  return up_trace_clock();
+#else
+  return (uint32_t)clock_systimer() * USEC_PER_TICK;
+#endif
+}
+
+/****************************************************************************
+ * Name: sched_trace_add
+ *
+ * Description:
+ *   Add one record to the ring.  Interrupts are disabled only while the
+ *   record is claimed and filled in; most callers have already disabled
+ *   them.
+ *
+ ****************************************************************************/
+
+static void sched_trace_add(uint8_t type, FAR struct tcb_s *tcb,
+                            uint32_t arg)
+{
+  FAR struct trace_record_s *rec;
+  irqstate_t flags;
+
+  flags = irqsave();
+  rec = &g_trace_ring[g_trace_seqno & TRACE_MASK];
+
+  rec->tr_time = sched_trace_clock();
+  rec->tr_type = type;
+  rec->tr_arg  = arg;
+
+  if (tcb != NULL)
+    {
+      rec->tr_priority = tcb->sched_priority;
+      rec->tr_pid      = (int16_t)tcb->pid;
+    }
+  else
+    {
+      rec->tr_priority = 0;
+      rec->tr_pid      = -1;
+    }
+
+  if (++g_trace_seqno == CONFIG_SCHED_TRACE_NRECORDS)
+    {
+      g_trace_full = true;
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_note_start, sched_note_stop, sched_note_switch
+ *
+ * Description:
+ *   The instrumentation hooks of the scheduler (see include/sched.h).
+ *
+ ****************************************************************************/
+
+void sched_note_start(FAR struct tcb_s *tcb)
+{
+  sched_trace_add(TRACE_START, tcb, 0);
+}
+
+void sched_note_stop(FAR struct tcb_s *tcb)
+{
+  sched_trace_add(TRACE_STOP, tcb, 0);
+}
+
+void sched_note_switch(FAR struct tcb_s *pFromTcb, FAR struct tcb_s *pToTcb)
+{
+  sched_trace_add(TRACE_SWITCH, pToTcb, (uint32_t)pFromTcb->pid);
+}
+
+/****************************************************************************
+ * Name: sched_trace_irqenter, sched_trace_irqleave
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TRACE_IRQ
+void sched_trace_irqenter(int irq)
+{
+  sched_trace_add(TRACE_IRQENTER, (FAR struct tcb_s *)g_readytorun.head,
+                  (uint32_t)irq);
+}
+
+void sched_trace_irqleave(int irq)
+{
+  sched_trace_add(TRACE_IRQLEAVE, (FAR struct tcb_s *)g_readytorun.head,
+                  (uint32_t)irq);
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_trace_semblock, sched_trace_semwake
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TRACE_SEM
+void sched_trace_semblock(FAR sem_t *sem)
+{
+  sched_trace_add(TRACE_SEMBLOCK, (FAR struct tcb_s *)g_readytorun.head,
+                  (uint32_t)(uintptr_t)sem);
+}
+
+void sched_trace_semwake(FAR sem_t *sem, FAR struct tcb_s *tcb)
+{
+  sched_trace_add(TRACE_SEMWAKE, tcb, (uint32_t)(uintptr_t)sem);
+}
+#endif
+
+/****************************************************************************
+ * Name: sched_trace_snapshot
+ *
+ * Description:
+ *   Copy the most recent trace records, oldest first.  See
+ *   include/nuttx/sched_trace.h.
+ *
+ ****************************************************************************/
+
+size_t sched_trace_snapshot(FAR struct trace_record_s *buffer,
+                            size_t nrecords, FAR uint32_t *first)
+{
+  uint32_t start;
+  uint32_t end;
+  uint32_t seqno;
+  uint32_t skip;
+  size_t count;
+
+  if (nrecords > CONFIG_SCHED_TRACE_NRECORDS)
+    {
+      nrecords = CONFIG_SCHED_TRACE_NRECORDS;
+    }
+
+  /* Select the most recent records.  Sequence numbers are compared by
+   * their difference so that the wrap-around of the count is harmless.
+   */
+
+  end   = g_trace_seqno;
+  count = (g_trace_full || end >= nrecords) ? nrecords : end;
+  start = end - count;
+
+  for (seqno = start; seqno != end; seqno++)
+    {
+      buffer[seqno - start] = g_trace_ring[seqno & TRACE_MASK];
+    }
+
+  /* Events may have been recorded while we were copying.  Each new record
+   * overwrote the record that is CONFIG_SCHED_TRACE_NRECORDS older.  Drop
+   * any copied records that may have been overwritten.
+   */
+
+  skip = g_trace_seqno - start;
+  if (skip > CONFIG_SCHED_TRACE_NRECORDS)
+    {
+      skip -= CONFIG_SCHED_TRACE_NRECORDS;
+      if (skip > count)
+        {
+          skip = count;
+        }
+
+      count -= skip;
+      start += skip;
+      memmove(buffer, &buffer[skip], count * sizeof(struct trace_record_s));
+    }
+
+  *first = start;
+  return count;
+}
+
+#endif /* CONFIG_SCHED_TRACE */
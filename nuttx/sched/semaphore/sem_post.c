@@ -43,6 +43,7 @@
 #include <semaphore.h>
 #include <sched.h>
 #include <nuttx/arch.h>
+#include <nuttx/sched_trace.h>
 
 #include "sched/sched.h"
 #include "semaphore/semaphore.h"
@@ -106,6 +107,15 @@ int sem_post(FAR sem_t *sem)
   irqstate_t saved_state;
   int ret = ERROR;
 
+  /* If no thread is waiting for the semaphore, give it without disabling
+   * interrupts.
+   */
+
+  if (sem != NULL && sem_fastgive(sem))
+    {
+      return OK;
+    }
+
   /* Make sure we were supplied with a valid semaphore. */
 
   if (sem)
@@ -158,6 +168,7 @@ int sem_post(FAR sem_t *sem)
 
               /* Restart the waiting task. */
 
+              sched_trace_semwake(sem, stcb);
               up_unblock_task(stcb);
             }
         }
@@ -184,6 +184,15 @@ int sem_timedwait(FAR sem_t *sem, FAR const struct timespec *abstime)
     }
 #endif
 
+  /* If the semaphore is uncontended, take it without creating a watchdog
+   * or disabling interrupts.
+   */
+
+  if (sem != NULL && sem_fasttake(sem))
+    {
+      return OK;
+    }
+
   /* Create a watchdog.  We will not actually need this watchdog
    * unless the semaphore is unavailable, but we will reserve it up
    * front before we enter the following critical section.
@@ -104,6 +104,15 @@ int sem_trywait(FAR sem_t *sem)
 
   DEBUGASSERT(up_interrupt_context() == false)
 
+  /* If the semaphore is uncontended, take it without disabling
+   * interrupts.
+   */
+
+  if (sem != NULL && sem_fasttake(sem))
+    {
+      return OK;
+    }
+
   /* Assume any errors reported are due to invalid arguments. */
 
   set_errno(EINVAL);
@@ -44,6 +44,7 @@
 #include <errno.h>
 #include <assert.h>
 #include <nuttx/arch.h>
+#include <nuttx/sched_trace.h>
 
 #include "sched/sched.h"
 #include "semaphore/semaphore.h"
@@ -104,6 +105,15 @@ int sem_wait(FAR sem_t *sem)
 
   DEBUGASSERT(up_interrupt_context() == false)
 
+  /* If the semaphore is uncontended, take it without disabling
+   * interrupts.
+   */
+
+  if (sem != NULL && sem_fasttake(sem))
+    {
+      return OK;
+    }
+
   /* Assume any errors reported are due to invalid arguments. */
 
   set_errno(EINVAL);
@@ -169,6 +179,7 @@ int sem_wait(FAR sem_t *sem)
           /* Add the TCB to the prioritized semaphore wait queue */
 
           set_errno(0);
+          sched_trace_semblock(sem);
           up_block_task(rtcb, TSTATE_WAIT_SEM);
 
           /* When we resume at this point, either (1) the semaphore has been
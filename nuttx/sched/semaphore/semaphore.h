@@ -45,10 +45,15 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <limits.h>
 #include <semaphore.h>
 #include <sched.h>
 #include <queue.h>
 
+#ifdef CONFIG_SCHED_FASTSEM
+#  include <nuttx/arch.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -123,6 +128,63 @@ void sem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem);
 #  define sem_canceled(stcb, sem)
 #endif
 
+/****************************************************************************
+ * Name: sem_fasttake and sem_fastgive
+ *
+ * Description:
+ *   Take or give a count of an uncontended semaphore with a single atomic
+ *   compare-and-swap, without disabling interrupts.  sem_fasttake() fails
+ *   if no count is available; sem_fastgive() fails if a thread is waiting
+ *   for the semaphore.  The caller must then use the normal logic.
+ *
+ *   This is safe because the normal logic modifies the count only with
+ *   interrupts disabled and the compare-and-swap fails if the count was
+ *   modified in the meantime.  It is not available with priority
+ *   inheritance because every count taken must then be recorded.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_FASTSEM
+static inline bool sem_fasttake(FAR sem_t *sem)
+{
+  FAR volatile int16_t *semcount = (FAR volatile int16_t *)&sem->semcount;
+  int16_t count;
+
+  do
+    {
+      count = *semcount;
+      if (count <= 0)
+        {
+          return false;
+        }
+    }
+  while (!up_cmpxchg16(semcount, count, count - 1));
+
+  return true;
+}
+
+static inline bool sem_fastgive(FAR sem_t *sem)
+{
+  FAR volatile int16_t *semcount = (FAR volatile int16_t *)&sem->semcount;
+  int16_t count;
+
+  do
+    {
+      count = *semcount;
+      if (count < 0 || count >= SEM_VALUE_MAX)
+        {
+          return false;
+        }
+    }
+  while (!up_cmpxchg16(semcount, count, count + 1));
+
+  return true;
+}
+#else
+#  define sem_fasttake(sem) (false)
+#  define sem_fastgive(sem) (false)
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
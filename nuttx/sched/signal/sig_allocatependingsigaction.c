@@ -119,7 +119,7 @@ FAR sigq_t *sig_allocatependingsigaction(void)
 
           if (!sigq)
             {
-              sigq = (FAR sigq_t *)kmm_malloc((sizeof (sigq_t)));
+              sigq = sig_sigqalloc();
             }
 
           /* Check if we got an allocated message */
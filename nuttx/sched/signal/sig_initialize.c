@@ -41,6 +41,7 @@
 
 #include <stdint.h>
 #include <queue.h>
+#include <assert.h>
 #include <nuttx/kmalloc.h>
 
 #include "signal/signal.h"
@@ -88,6 +89,15 @@ sq_queue_t  g_sigpendingsignal;
 
 sq_queue_t  g_sigpendingirqsignal;
 
+#ifdef CONFIG_MM_SLAB
+/* Object caches for pending signal actions and pending signals allocated
+ * when the pre-allocated pools are exhausted.
+ */
+
+FAR struct slab_cache_s *g_sigqcache;
+FAR struct slab_cache_s *g_sigpendcache;
+#endif
+
 /************************************************************************
  * Private Variables
  ************************************************************************/
@@ -241,6 +251,14 @@ void sig_initialize(void)
      sig_allocatependingsignalblock(&g_sigpendingirqsignal,
                              NUM_INT_SIGNALS_PENDING,
                              SIG_ALLOC_IRQ);
+
+#ifdef CONFIG_MM_SLAB
+  /* Create the caches used when the pools above are exhausted */
+
+  g_sigqcache    = slab_create("sigq", sizeof(sigq_t), 0, NULL);
+  g_sigpendcache = slab_create("sigpendq", sizeof(sigpendq_t), 0, NULL);
+  DEBUGASSERT(g_sigqcache != NULL && g_sigpendcache != NULL);
+#endif
 }
 
 /************************************************************************
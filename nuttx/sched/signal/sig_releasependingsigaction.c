@@ -114,6 +114,6 @@ void sig_releasependingsigaction(FAR sigq_t *sigq)
 
   else if (sigq->type == SIG_ALLOC_DYN)
     {
-      sched_kfree(sigq);
+      sig_sigqfree(sigq);
     }
 }
@@ -125,6 +125,6 @@ void sig_releasependingsignal(FAR sigpendq_t *sigpend)
 
   else if (sigpend->type == SIG_ALLOC_DYN)
     {
-      sched_kfree(sigpend);
+      sig_sigpendfree(sigpend);
     }
 }
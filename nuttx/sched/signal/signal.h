@@ -47,6 +47,7 @@
 #include <sched.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/mm/slab.h>
 
 /****************************************************************************
  * Definitions
@@ -62,6 +63,23 @@
 #define NUM_SIGNALS_PENDING     16
 #define NUM_INT_SIGNALS_PENDING  8
 
+/* Allocation of pending signal actions and pending signals beyond the
+ * pre-allocated pools.
+ */
+
+#ifdef CONFIG_MM_SLAB
+#  define sig_sigqalloc()       ((FAR sigq_t *)slab_alloc(g_sigqcache))
+#  define sig_sigqfree(q)       slab_free(g_sigqcache, (q))
+#  define sig_sigpendalloc()    ((FAR sigpendq_t *)slab_alloc(g_sigpendcache))
+#  define sig_sigpendfree(p)    slab_free(g_sigpendcache, (p))
+#else
+#  define sig_sigqalloc()       ((FAR sigq_t *)kmm_malloc(sizeof(sigq_t)))
+#  define sig_sigqfree(q)       sched_kfree(q)
+#  define sig_sigpendalloc() \
+     ((FAR sigpendq_t *)kmm_malloc(sizeof(sigpendq_t)))
+#  define sig_sigpendfree(p)    sched_kfree(p)
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
@@ -150,6 +168,15 @@ extern sq_queue_t  g_sigpendingsignal;
 
 extern sq_queue_t  g_sigpendingirqsignal;
 
+#ifdef CONFIG_MM_SLAB
+/* Object caches for pending signal actions and pending signals allocated
+ * when the pre-allocated pools are exhausted.
+ */
+
+extern FAR struct slab_cache_s *g_sigqcache;
+extern FAR struct slab_cache_s *g_sigpendcache;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
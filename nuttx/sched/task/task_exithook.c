@@ -47,6 +47,7 @@
 
 #include <nuttx/sched.h>
 #include <nuttx/fs/fs.h>
+#include <nuttx/mm/mm.h>
 
 #include "sched/sched.h"
 #include "group/group.h"
@@ -683,6 +684,18 @@ void task_exithook(FAR struct tcb_s *tcb, int status, bool nonblocking)
   sig_cleanup(tcb); /* Deallocate Signal lists */
 #endif
 
+#ifdef CONFIG_MM_TCACHE
+  /* Return any chunks held in the thread's allocation cache.  This may
+   * block on the heap semaphore.  If nonblocking is requested, the chunks
+   * will be deferred when the TCB is released.
+   */
+
+  if (!nonblocking)
+    {
+      mm_tcache_release(tcb);
+    }
+#endif
+
   /* This function can be re-entered in certain cases.  Set a flag
    * bit in the TCB to not that we have already completed this exit
    * processing.
@@ -131,7 +131,7 @@ WDOG_ID wd_create (void)
 
   /* We are in a normal tasking context AND there are not enough unreserved,
    * pre-allocated watchdog timers.  We need to allocate one from the kernel
-   * heap.
+   * heap (or the watchdog object cache).
    */
 
   else
@@ -139,7 +139,7 @@ WDOG_ID wd_create (void)
       /* We do not require that interrupts be disabled to do this. */
 
       irqrestore(state);
-      wdog = (FAR struct wdog_s *)kmm_malloc(sizeof(struct wdog_s));
+      wdog = wd_alloc();
 
       /* Did we get one? */
 
@@ -120,16 +120,16 @@ int wd_delete(WDOG_ID wdog)
 
   if (WDOG_ISALLOCED(wdog))
     {
-      /* It was allocated from the heap.  Use sched_kfree() to release the
-       * memory.  If the timer was released from an interrupt handler,
-       * sched_kfree() will defer the actual deallocation of the memory
-       * until a more appropriate time.
+      /* It was allocated from the heap or the watchdog object cache.  If
+       * the timer was released from an interrupt handler, sched_kfree()
+       * will defer the actual deallocation of the memory until a more
+       * appropriate time; the object cache can be used directly.
        *
        * We don't need interrupts disabled to do this.
        */
 
       irqrestore(state);
-      sched_kfree(wdog);
+      wd_free(wdog);
     }
 
   /* This was a pre-allocated timer.  This function should not be called for
@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <queue.h>
+#include <assert.h>
 
 #include "wdog/wdog.h"
 
@@ -61,12 +62,14 @@
 
 sq_queue_t g_wdfreelist;
 
+#ifndef CONFIG_WDOG_TIMERWHEEL
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 sq_queue_t g_wdactivelist;
+#endif
 
 /* This is the number of free, pre-allocated watchdog structures in the
  * g_wdfreelist.  This value is used to enforce a reserve for interrupt
@@ -75,6 +78,14 @@ sq_queue_t g_wdactivelist;
 
 uint16_t g_wdnfree;
 
+#ifdef CONFIG_MM_SLAB
+/* Object cache for watchdogs allocated when the pre-allocated pool is
+ * exhausted.
+ */
+
+FAR struct slab_cache_s *g_wdcache;
+#endif
+
 /************************************************************************
  * Private Data
  ************************************************************************/
@@ -120,7 +131,11 @@ void wd_initialize(void)
   /* Initialize watchdog lists */
 
   sq_init(&g_wdfreelist);
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  wd_wheel_initialize();
+#else
   sq_init(&g_wdactivelist);
+#endif
 
   /* The g_wdfreelist must be loaded at initialization time to hold the
    * configured number of watchdogs.
@@ -134,4 +149,11 @@ void wd_initialize(void)
   /* All watchdogs are free */
 
   g_wdnfree = CONFIG_PREALLOC_WDOGS;
+
+#ifdef CONFIG_MM_SLAB
+  /* Create the cache for any additional watchdogs */
+
+  g_wdcache = slab_create("wdog", sizeof(struct wdog_s), 0, NULL);
+  DEBUGASSERT(g_wdcache != NULL);
+#endif
 }
@@ -0,0 +1,458 @@
+/****************************************************************************
+ * sched/wdog/wd_wheel.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <nuttx/wdog.h>
+
+#include "wdog/wdog.h"
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define WDOG_WHEEL_NWORDS ((WDOG_WHEEL_NSLOTS + 31) >> 5)
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* The current time of the timing wheel in ticks */
+
+uint32_t g_wdnow;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The slots of all levels of the wheel.  Each slot is the head of a list of
+ * watchdogs linked through wdog->next.  wdog->pprev points back to the
+ * slot or to the 'next' field of the preceding watchdog so that any
+ * watchdog can be removed without a search.
+ */
+
+static FAR struct wdog_s *g_wdwheel[WDOG_WHEEL_NSLOTS];
+
+#ifdef CONFIG_SCHED_TICKLESS
+/* One bit per non-empty slot and the number of watchdogs in the wheel.
+ * These are only needed to find the next event without stepping through
+ * every tick.
+ */
+
+static uint32_t g_wdwheelmap[WDOG_WHEEL_NWORDS];
+static unsigned int g_wdwheelcount;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_shift, wd_wheel_size, wd_wheel_base
+ *
+ * Description:
+ *   The number of ticks per slot (as a shift), the number of slots and the
+ *   index of the first slot of one level of the wheel.
+ *
+ ****************************************************************************/
+
+static inline int wd_wheel_shift(int level)
+{
+  return level == 0 ? 0 :
+    CONFIG_WDOG_WHEEL_L0BITS + (level - 1) * CONFIG_WDOG_WHEEL_LNBITS;
+}
+
+static inline int wd_wheel_size(int level)
+{
+  return level == 0 ? WDOG_WHEEL_L0SIZE : WDOG_WHEEL_LNSIZE;
+}
+
+static inline int wd_wheel_base(int level)
+{
+  return level == 0 ? 0 :
+    WDOG_WHEEL_L0SIZE + (level - 1) * WDOG_WHEEL_LNSIZE;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_slot
+ *
+ * Description:
+ *   Return the slot of a level that holds the watchdogs due at 'time'.
+ *
+ ****************************************************************************/
+
+static inline int wd_wheel_slot(int level, uint32_t time)
+{
+  return wd_wheel_base(level) +
+         (int)((time >> wd_wheel_shift(level)) & (wd_wheel_size(level) - 1));
+}
+
+/****************************************************************************
+ * Name: wd_wheel_cascade
+ *
+ * Description:
+ *   Called when the wheel time reaches the start of a slot of an upper
+ *   level:  Redistribute the watchdogs of the slot over the lower levels.
+ *
+ * Return Value:
+ *   The index of the slot within its level.  The next higher level must
+ *   be cascaded too when this is zero.
+ *
+ ****************************************************************************/
+
+static int wd_wheel_cascade(int level)
+{
+  FAR struct wdog_s **slot;
+  FAR struct wdog_s *wdog;
+  int ndx;
+
+  ndx  = wd_wheel_slot(level, g_wdnow);
+  slot = &g_wdwheel[ndx];
+
+  while ((wdog = *slot) != NULL)
+    {
+      wd_wheel_remove(wdog);
+      wd_wheel_add(wdog);
+    }
+
+  return ndx - wd_wheel_base(level);
+}
+
+#ifdef CONFIG_SCHED_TICKLESS
+/****************************************************************************
+ * Name: wd_wheel_findbit
+ *
+ * Description:
+ *   Return the first non-empty slot in the range [first, last) or -1.
+ *
+ ****************************************************************************/
+
+static int wd_wheel_findbit(int first, int last)
+{
+  uint32_t word;
+  int bit;
+
+  while (first < last)
+    {
+      word = g_wdwheelmap[first >> 5] >> (first & 31);
+      if (word != 0)
+        {
+#ifdef __GNUC__
+          bit = first + __builtin_ctz(word);
+#else
+          bit = first;
+          while ((word & 1) == 0)
+            {
+              word >>= 1;
+              bit++;
+            }
+#endif
+          return bit < last ? bit : -1;
+        }
+
+      first = (first | 31) + 1;
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_next
+ *
+ * Description:
+ *   Return the number of ticks until the wheel time reaches the next
+ *   non-empty slot of a level (zero if the level is empty).  For level 0
+ *   this is when the watchdogs in the slot expire; for the upper levels it
+ *   is when the slot is cascaded.
+ *
+ ****************************************************************************/
+
+static unsigned int wd_wheel_next(int level)
+{
+  uint32_t cur;
+  int base;
+  int size;
+  int shift;
+  int ndx;
+
+  base  = wd_wheel_base(level);
+  size  = wd_wheel_size(level);
+  shift = wd_wheel_shift(level);
+  cur   = (g_wdnow >> shift) & (size - 1);
+
+  ndx = wd_wheel_findbit(base + cur + 1, base + size);
+  if (ndx < 0)
+    {
+      ndx = wd_wheel_findbit(base, base + cur + 1);
+      if (ndx < 0)
+        {
+          return 0;
+        }
+    }
+
+  /* Number of slots to advance (1..size), converted to ticks */
+
+  cur = ((ndx - base - cur - 1) & (size - 1)) + 1;
+  return ((((g_wdnow >> shift) + cur) << shift) - g_wdnow);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_wheel_initialize
+ *
+ * Description:
+ *   Empty the timing wheel.
+ *
+ ****************************************************************************/
+
+void wd_wheel_initialize(void)
+{
+  int i;
+
+  for (i = 0; i < WDOG_WHEEL_NSLOTS; i++)
+    {
+      g_wdwheel[i] = NULL;
+    }
+
+#ifdef CONFIG_SCHED_TICKLESS
+  for (i = 0; i < WDOG_WHEEL_NWORDS; i++)
+    {
+      g_wdwheelmap[i] = 0;
+    }
+
+  g_wdwheelcount = 0;
+#endif
+
+  g_wdnow = 0;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_add
+ *
+ * Description:
+ *   Add a watchdog to the wheel.  wdog->expires must be set and must lie
+ *   after the current wheel time.  The level is selected by the distance
+ *   to the expiration time, the slot by the expiration time itself.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_wheel_add(FAR struct wdog_s *wdog)
+{
+  FAR struct wdog_s **slot;
+  uint32_t delta;
+  int level;
+  int ndx;
+
+  delta = wdog->expires - g_wdnow;
+  level = 0;
+
+  while (level < WDOG_WHEEL_NLEVELS - 1 &&
+         delta >= ((uint32_t)1 << wd_wheel_shift(level + 1)))
+    {
+      level++;
+    }
+
+  ndx  = wd_wheel_slot(level, wdog->expires);
+  slot = &g_wdwheel[ndx];
+
+  wdog->next  = *slot;
+  wdog->pprev = slot;
+  if (*slot)
+    {
+      (*slot)->pprev = &wdog->next;
+    }
+
+  *slot = wdog;
+
+#ifdef CONFIG_SCHED_TICKLESS
+  g_wdwheelmap[ndx >> 5] |= (uint32_t)1 << (ndx & 31);
+  g_wdwheelcount++;
+#endif
+}
+
+/****************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove a watchdog from the wheel.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_wheel_remove(FAR struct wdog_s *wdog)
+{
+  DEBUGASSERT(wdog->pprev != NULL);
+
+  *wdog->pprev = wdog->next;
+  if (wdog->next)
+    {
+      wdog->next->pprev = wdog->pprev;
+    }
+
+#ifdef CONFIG_SCHED_TICKLESS
+  else if (wdog->pprev >= &g_wdwheel[0] &&
+           wdog->pprev < &g_wdwheel[WDOG_WHEEL_NSLOTS])
+    {
+      /* This was the only watchdog in its slot */
+
+      int ndx = wdog->pprev - &g_wdwheel[0];
+      g_wdwheelmap[ndx >> 5] &= ~((uint32_t)1 << (ndx & 31));
+    }
+
+  g_wdwheelcount--;
+#endif
+
+  wdog->next  = NULL;
+  wdog->pprev = NULL;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_tick
+ *
+ * Description:
+ *   Advance the wheel time by one tick, cascading the upper levels when
+ *   their slot boundaries are reached.
+ *
+ * Return Value:
+ *   The level 0 slot holding the watchdogs that expire at the new time.
+ *   The caller removes and runs them until the slot is empty.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+FAR struct wdog_s **wd_wheel_tick(void)
+{
+  int level;
+
+  g_wdnow++;
+
+  if ((g_wdnow & (WDOG_WHEEL_L0SIZE - 1)) == 0)
+    {
+      level = 1;
+      while (level < WDOG_WHEEL_NLEVELS && wd_wheel_cascade(level) == 0)
+        {
+          level++;
+        }
+    }
+
+  return &g_wdwheel[wd_wheel_slot(0, g_wdnow)];
+}
+
+#ifdef CONFIG_SCHED_TICKLESS
+/****************************************************************************
+ * Name: wd_wheel_skip
+ *
+ * Description:
+ *   Advance the wheel time by up to 'ticks' ticks, stopping before the
+ *   next tick at which a watchdog expires or a non-empty slot must be
+ *   cascaded.  Slots that are passed over are all empty.
+ *
+ * Return Value:
+ *   The number of ticks skipped.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+unsigned int wd_wheel_skip(unsigned int ticks)
+{
+  unsigned int delay;
+
+  delay = wd_wheel_delay();
+  if (delay > 0 && ticks >= delay)
+    {
+      ticks = delay - 1;
+    }
+
+  g_wdnow += ticks;
+  return ticks;
+}
+
+/****************************************************************************
+ * Name: wd_wheel_delay
+ *
+ * Description:
+ *   Return the number of ticks until the next watchdog expires or, if that
+ *   comes first, until a slot holding watchdogs must be cascaded.  Zero is
+ *   returned if there are no active watchdogs.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+unsigned int wd_wheel_delay(void)
+{
+  unsigned int delay = 0;
+  unsigned int next;
+  int level;
+
+  if (g_wdwheelcount > 0)
+    {
+      for (level = 0; level < WDOG_WHEEL_NLEVELS; level++)
+        {
+          next = wd_wheel_next(level);
+          if (next > 0 && (delay == 0 || next < delay))
+            {
+              delay = next;
+            }
+        }
+    }
+
+  return delay;
+}
+#endif /* CONFIG_SCHED_TICKLESS */
+#endif /* CONFIG_WDOG_TIMERWHEEL */
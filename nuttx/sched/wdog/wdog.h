@@ -46,12 +46,46 @@
 #include <stdbool.h>
 
 #include <nuttx/compiler.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/wdog.h>
+#include <nuttx/mm/slab.h>
 
 /************************************************************************
  * Pre-processor Definitions
  ************************************************************************/
 
+/* Timing wheel geometry.  Level 0 has one slot per tick; each slot of
+ * level n spans all of level n-1.  There are enough levels to hold any
+ * delay that can be passed to wd_start() (31 bits).
+ */
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+#  ifndef CONFIG_WDOG_WHEEL_L0BITS
+#    define CONFIG_WDOG_WHEEL_L0BITS 6
+#  endif
+#  ifndef CONFIG_WDOG_WHEEL_LNBITS
+#    define CONFIG_WDOG_WHEEL_LNBITS 5
+#  endif
+
+#  define WDOG_WHEEL_L0SIZE  (1 << CONFIG_WDOG_WHEEL_L0BITS)
+#  define WDOG_WHEEL_LNSIZE  (1 << CONFIG_WDOG_WHEEL_LNBITS)
+#  define WDOG_WHEEL_NLEVELS \
+     (1 + (31 - CONFIG_WDOG_WHEEL_L0BITS + CONFIG_WDOG_WHEEL_LNBITS - 1) / \
+      CONFIG_WDOG_WHEEL_LNBITS)
+#  define WDOG_WHEEL_NSLOTS \
+     (WDOG_WHEEL_L0SIZE + (WDOG_WHEEL_NLEVELS - 1) * WDOG_WHEEL_LNSIZE)
+#endif
+
+/* Allocation of watchdogs beyond the pre-allocated pool */
+
+#ifdef CONFIG_MM_SLAB
+#  define wd_alloc()  ((FAR struct wdog_s *)slab_alloc(g_wdcache))
+#  define wd_free(w)  slab_free(g_wdcache, (w))
+#else
+#  define wd_alloc()  ((FAR struct wdog_s *)kmm_malloc(sizeof(struct wdog_s)))
+#  define wd_free(w)  sched_kfree(w)
+#endif
+
 /************************************************************************
  * Public Type Declarations
  ************************************************************************/
@@ -74,12 +108,20 @@ extern "C"
 
 extern sq_queue_t g_wdfreelist;
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+/* The current time of the timing wheel in ticks.  All watchdogs that
+ * expire at or before this time have been processed.
+ */
+
+extern uint32_t g_wdnow;
+#else
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 extern sq_queue_t g_wdactivelist;
+#endif
 
 /* This is the number of free, pre-allocated watchdog structures in the
  * g_wdfreelist.  This value is used to enforce a reserve for interrupt
@@ -88,6 +130,14 @@ extern sq_queue_t g_wdactivelist;
 
 extern uint16_t g_wdnfree;
 
+#ifdef CONFIG_MM_SLAB
+/* Object cache for watchdogs allocated when the pre-allocated pool is
+ * exhausted.
+ */
+
+extern FAR struct slab_cache_s *g_wdcache;
+#endif
+
 /************************************************************************
  * Public Function Prototypes
  ************************************************************************/
@@ -144,6 +194,37 @@ unsigned int wd_timer(int ticks);
 void wd_timer(void);
 #endif
 
+/****************************************************************************
+ * Name: wd_wheel_*
+ *
+ * Description:
+ *   Timing wheel primitives (see wd_wheel.c).  All must be called with
+ *   interrupts disabled.
+ *
+ *   wd_wheel_initialize - Empty the wheel
+ *   wd_wheel_add        - Add an active watchdog with wdog->expires set
+ *   wd_wheel_remove     - Remove an active watchdog from the wheel
+ *   wd_wheel_tick       - Advance the wheel time by one tick and return
+ *                         the slot of the watchdogs that expire now
+ *   wd_wheel_skip       - Advance the wheel time by up to 'ticks' ticks
+ *                         during which nothing happens; return the number
+ *                         of ticks skipped
+ *   wd_wheel_delay      - Return the number of ticks to the next wheel
+ *                         event (zero if the wheel is empty)
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+void wd_wheel_initialize(void);
+void wd_wheel_add(FAR struct wdog_s *wdog);
+void wd_wheel_remove(FAR struct wdog_s *wdog);
+FAR struct wdog_s **wd_wheel_tick(void);
+#ifdef CONFIG_SCHED_TICKLESS
+unsigned int wd_wheel_skip(unsigned int ticks);
+unsigned int wd_wheel_delay(void);
+#endif
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
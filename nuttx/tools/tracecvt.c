@@ -0,0 +1,414 @@
+/****************************************************************************
+ * tools/tracecvt.c
+ *
+ *   Copyright (C) 2015 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* These must agree with include/nuttx/sched_trace.h */
+
+#define TRACE_MAGIC     0x5254584e
+#define TRACE_VERSION   1
+
+#define TRACE_START     0
+#define TRACE_STOP      1
+#define TRACE_SWITCH    2
+#define TRACE_IRQENTER  3
+#define TRACE_IRQLEAVE  4
+#define TRACE_SEMBLOCK  5
+#define TRACE_SEMWAKE   6
+
+#define HEADER_SIZE     16
+#define RECORD_SIZE     12
+
+#define MAX_PIDS        32768
+#define MAX_IRQNEST     16
+
+/* Interrupt handlers are shown as a separate thread of this ID */
+
+#define IRQ_TID         -1
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct record_s
+{
+  uint64_t time;
+  int      type;
+  int      priority;
+  int      pid;
+  uint32_t arg;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int g_swap;
+static int g_nevents;
+static FILE *g_out;
+
+static unsigned char g_seen[MAX_PIDS];
+static uint64_t g_waketime[MAX_PIDS];
+
+static uint64_t g_nwakeups;
+static uint64_t g_sumlatency;
+static uint64_t g_maxlatency;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr, "\nUSAGE: %s <trace-file> [<json-file>]\n", progname);
+  fprintf(stderr, "\nWhere:\n");
+  fprintf(stderr, "  <trace-file>:\n");
+  fprintf(stderr, "    Binary trace data read from /proc/trace on the target\n");
+  fprintf(stderr, "  <json-file>:\n");
+  fprintf(stderr, "    Output file in the Chrome trace event format.  This can be\n");
+  fprintf(stderr, "    loaded in chrome://tracing or https://ui.perfetto.dev.\n");
+  fprintf(stderr, "    Default: stdout\n");
+  exit(EXIT_FAILURE);
+}
+
+static uint32_t get32(const unsigned char *p)
+{
+  if (g_swap)
+    {
+      return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+             (uint32_t)p[2] << 8  | (uint32_t)p[3];
+    }
+
+  return (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 |
+         (uint32_t)p[1] << 8  | (uint32_t)p[0];
+}
+
+static uint16_t get16(const unsigned char *p)
+{
+  if (g_swap)
+    {
+      return (uint16_t)(p[0] << 8 | p[1]);
+    }
+
+  return (uint16_t)(p[1] << 8 | p[0]);
+}
+
+static void begin_event(void)
+{
+  fprintf(g_out, "%s\n    ", g_nevents++ > 0 ? "," : "");
+}
+
+static void thread_name(int pid)
+{
+  if (pid >= 0 && pid < MAX_PIDS && !g_seen[pid])
+    {
+      g_seen[pid] = 1;
+      begin_event();
+      fprintf(g_out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+              "\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+              pid, pid == 0 ? "IDLE" : "PID", pid);
+    }
+}
+
+static void slice(const char *name, int tid, uint64_t start, uint64_t end,
+                  const char *args)
+{
+  begin_event();
+  fprintf(g_out, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+          "\"ts\":%llu,\"dur\":%llu,\"args\":{%s}}",
+          name, tid, (unsigned long long)start,
+          (unsigned long long)(end - start), args);
+}
+
+static void instant(const char *name, int tid, uint64_t time,
+                    const char *args)
+{
+  begin_event();
+  fprintf(g_out, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":0,"
+          "\"tid\":%d,\"ts\":%llu,\"args\":{%s}}",
+          name, tid, (unsigned long long)time, args);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv, char **envp)
+{
+  unsigned char hdr[HEADER_SIZE];
+  unsigned char buf[RECORD_SIZE];
+  struct record_s rec;
+  uint64_t irqstart[MAX_IRQNEST];
+  uint32_t irqnum[MAX_IRQNEST];
+  uint64_t runstart = 0;
+  uint64_t runwake  = 0;
+  uint64_t base     = 0;
+  uint64_t last     = 0;
+  uint32_t prevtime = 0;
+  uint32_t count;
+  uint32_t first;
+  uint32_t i;
+  char args[96];
+  int irqnest = 0;
+  int running = -1;
+  int runprio = 0;
+  FILE *in;
+
+  if (argc < 2 || argc > 3)
+    {
+      show_usage(argv[0]);
+    }
+
+  in = fopen(argv[1], "rb");
+  if (!in)
+    {
+      fprintf(stderr, "ERROR: Failed to open %s\n", argv[1]);
+      exit(EXIT_FAILURE);
+    }
+
+  g_out = stdout;
+  if (argc == 3)
+    {
+      g_out = fopen(argv[2], "w");
+      if (!g_out)
+        {
+          fprintf(stderr, "ERROR: Failed to open %s\n", argv[2]);
+          exit(EXIT_FAILURE);
+        }
+    }
+
+  /* Check the header and determine the byte order of the target */
+
+  if (fread(hdr, 1, HEADER_SIZE, in) != HEADER_SIZE)
+    {
+      fprintf(stderr, "ERROR: %s is too short\n", argv[1]);
+      exit(EXIT_FAILURE);
+    }
+
+  g_swap = 0;
+  if (get32(hdr) != TRACE_MAGIC)
+    {
+      g_swap = 1;
+      if (get32(hdr) != TRACE_MAGIC)
+        {
+          fprintf(stderr, "ERROR: %s is not a NuttX trace\n", argv[1]);
+          exit(EXIT_FAILURE);
+        }
+    }
+
+  if (get16(&hdr[4]) != TRACE_VERSION || get16(&hdr[6]) != RECORD_SIZE)
+    {
+      fprintf(stderr, "ERROR: Unsupported trace version %u or record size %u\n",
+              get16(&hdr[4]), get16(&hdr[6]));
+      exit(EXIT_FAILURE);
+    }
+
+  first = get32(&hdr[8]);
+  count = get32(&hdr[12]);
+
+  fprintf(g_out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  begin_event();
+  fprintf(g_out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+          "\"args\":{\"name\":\"NuttX\"}}");
+  begin_event();
+  fprintf(g_out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,"
+          "\"tid\":%d,\"args\":{\"name\":\"Interrupts\"}}", IRQ_TID);
+
+  for (i = 0; i < count && fread(buf, 1, RECORD_SIZE, in) == RECORD_SIZE; i++)
+    {
+      uint32_t time32 = get32(&buf[0]);
+
+      /* Extend the 32-bit microsecond time */
+
+      if (i > 0 && time32 < prevtime)
+        {
+          base += (uint64_t)1 << 32;
+        }
+
+      prevtime     = time32;
+      rec.time     = base + time32;
+      rec.type     = buf[4];
+      rec.priority = buf[5];
+      rec.pid      = (int16_t)get16(&buf[6]);
+      rec.arg      = get32(&buf[8]);
+      last         = rec.time;
+
+      if (i == 0)
+        {
+          runstart = rec.time;
+        }
+
+      thread_name(rec.pid);
+
+      switch (rec.type)
+        {
+          case TRACE_START:
+            snprintf(args, sizeof(args), "\"priority\":%d", rec.priority);
+            instant("start", rec.pid, rec.time, args);
+            break;
+
+          case TRACE_STOP:
+            instant("stop", rec.pid, rec.time, "");
+            break;
+
+          case TRACE_SWITCH:
+
+            /* The first switch tells us which task was running */
+
+            if (running < 0)
+              {
+                running = (int)rec.arg;
+                thread_name(running);
+              }
+
+            /* Close the slice of the task that was running */
+
+            if (runwake > 0)
+              {
+                snprintf(args, sizeof(args),
+                         "\"priority\":%d,\"wakeup_latency_us\":%llu",
+                         runprio, (unsigned long long)runwake);
+              }
+            else
+              {
+                snprintf(args, sizeof(args), "\"priority\":%d", runprio);
+              }
+
+            slice("running", running, runstart, rec.time, args);
+
+            /* Then start the slice of the new task.  If it was awakened by
+             * sem_post(), measure the time until it ran.
+             */
+
+            running  = rec.pid;
+            runstart = rec.time;
+            runprio  = rec.priority;
+            runwake  = 0;
+
+            if (rec.pid >= 0 && rec.pid < MAX_PIDS && g_waketime[rec.pid])
+              {
+                runwake = rec.time - g_waketime[rec.pid];
+                g_waketime[rec.pid] = 0;
+
+                g_nwakeups++;
+                g_sumlatency += runwake;
+                if (runwake > g_maxlatency)
+                  {
+                    g_maxlatency = runwake;
+                  }
+              }
+            break;
+
+          case TRACE_IRQENTER:
+            if (irqnest < MAX_IRQNEST)
+              {
+                irqstart[irqnest] = rec.time;
+                irqnum[irqnest]   = rec.arg;
+              }
+
+            irqnest++;
+            break;
+
+          case TRACE_IRQLEAVE:
+            if (irqnest > 0 && --irqnest < MAX_IRQNEST &&
+                irqnum[irqnest] == rec.arg)
+              {
+                snprintf(args, sizeof(args), "\"irq\":%u,\"pid\":%d",
+                         rec.arg, rec.pid);
+                slice("irq", IRQ_TID, irqstart[irqnest], rec.time, args);
+              }
+            break;
+
+          case TRACE_SEMBLOCK:
+            snprintf(args, sizeof(args), "\"sem\":\"0x%08x\"", rec.arg);
+            instant("sem_wait", rec.pid, rec.time, args);
+            break;
+
+          case TRACE_SEMWAKE:
+            snprintf(args, sizeof(args), "\"sem\":\"0x%08x\",\"by\":%d",
+                     rec.arg, running);
+            instant("sem_post", rec.pid, rec.time, args);
+
+            if (rec.pid >= 0 && rec.pid < MAX_PIDS)
+              {
+                g_waketime[rec.pid] = rec.time;
+              }
+            break;
+
+          default:
+            fprintf(stderr, "WARNING: Unknown record type %d\n", rec.type);
+            break;
+        }
+    }
+
+  /* Close the slice of the task that was running at the end */
+
+  if (running >= 0 && last > runstart)
+    {
+      snprintf(args, sizeof(args), "\"priority\":%d", runprio);
+      slice("running", running, runstart, last, args);
+    }
+
+  fprintf(g_out, "\n  ]\n}\n");
+
+  fprintf(stderr, "%u records (%u lost before the first)\n", i, first);
+  if (g_nwakeups > 0)
+    {
+      fprintf(stderr, "sem_post wake-up to run: %llu wake-ups, "
+              "average %llu usec, maximum %llu usec\n",
+              (unsigned long long)g_nwakeups,
+              (unsigned long long)(g_sumlatency / g_nwakeups),
+              (unsigned long long)g_maxlatency);
+    }
+
+  if (g_out != stdout)
+    {
+      fclose(g_out);
+    }
+
+  fclose(in);
+  return 0;
+}